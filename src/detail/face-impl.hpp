@@ -26,7 +26,9 @@
 #include "../face.hpp"
 
 #include "registered-prefix.hpp"
-#include "pending-interest.hpp"
+#include "pending-interest-table.hpp"
+#include "interest-filter-table.hpp"
+#include "mpsc-queue.hpp"
 
 #include "../util/scheduler.hpp"
 #include "../util/config-file.hpp"
@@ -34,63 +36,219 @@
 #include "../transport/transport.hpp"
 #include "../transport/unix-transport.hpp"
 #include "../transport/tcp-transport.hpp"
+#include "../transport/shm-transport.hpp"
 
 #include "../management/nfd-controller.hpp"
 #include "../management/nfd-command-options.hpp"
 
+#include <exception>
+
 namespace ndn {
 
 class Face::Impl : noncopyable
 {
 public:
-  typedef std::list<shared_ptr<PendingInterest> > PendingInterestTable;
-  typedef std::list<shared_ptr<InterestFilterRecord> > InterestFilterTable;
   typedef std::list<shared_ptr<RegisteredPrefix> > RegisteredPrefixTable;
 
   explicit
   Impl(Face& face)
     : m_face(face)
+    , m_strand(face.m_ioService)
+    , m_isDrainScheduled(false)
   {
   }
 
   /////////////////////////////////////////////////////////////////////////////////////////////////
   /////////////////////////////////////////////////////////////////////////////////////////////////
 
+  /**
+   * @brief Performs @p operation on the strand of the Face: right away when called from it,
+   *        otherwise later like post
+   *
+   * May be called from any thread.
+   */
   void
-  satisfyPendingInterests(Data& data)
+  dispatch(const function<void()>& operation)
+  {
+    if (m_strand.running_in_this_thread())
+      operation();
+    else
+      post(operation);
+  }
+
+  /**
+   * @brief Queues @p operation to be performed on the strand of the Face
+   *
+   * May be called from any thread.  Operations are performed in the order they are queued.
+   * Only the first operation queued since the queue was last drained posts a handler to the
+   * io_service; the others are performed by the same handler.
+   */
+  void
+  post(const function<void()>& operation)
+  {
+    m_submissions.push(operation);
+
+    if (!m_isDrainScheduled.exchange(true))
+      m_strand.post(bind(&Impl::drainSubmissions, this));
+  }
+
+  void
+  drainSubmissions()
   {
-    for (PendingInterestTable::iterator i = m_pendingInterestTable.begin();
-         i != m_pendingInterestTable.end();
-         )
+    // cleared first, so that an operation missed by the loop below schedules another drain
+    m_isDrainScheduled.store(false);
+
+    function<void()> operation;
+    while (m_submissions.pop(operation))
+      operation();
+  }
+
+  /////////////////////////////////////////////////////////////////////////////////////////////////
+  /////////////////////////////////////////////////////////////////////////////////////////////////
+
+  /**
+   * @brief Decodes a packet received from the forwarder, with its LocalControlHeader
+   *
+   * Sets either @p interest or @p data.  Packets of other types are ignored.
+   */
+  static void
+  decodePacket(const Block& blockFromDaemon, shared_ptr<Interest>& interest,
+               shared_ptr<Data>& data)
+  {
+    const Block& block = nfd::LocalControlHeader::getPayload(blockFromDaemon);
+
+    if (block.type() == tlv::Interest)
+      {
+        interest = make_shared<Interest>();
+        interest->wireDecode(block);
+        if (&block != &blockFromDaemon)
+          interest->getLocalControlHeader().wireDecode(blockFromDaemon);
+      }
+    else if (block.type() == tlv::Data)
       {
-        if ((*i)->getInterest()->matchesData(data))
+        data = make_shared<Data>();
+        data->wireDecode(block);
+        if (&block != &blockFromDaemon)
+          data->getLocalControlHeader().wireDecode(blockFromDaemon);
+      }
+  }
+
+  /**
+   * @brief Processes packets received together
+   *
+   * All packets are decoded, and the pending Interests satisfied by any Data of the batch are
+   * removed from the PIT, before the first callback is called.  The callbacks are then
+   * called in the order of the packets.
+   *
+   * A malformed packet is dropped, without affecting the others.  A callback which throws
+   * does not keep the other packets, whose pending Interests have already left the PIT, from
+   * being delivered; the first exception is rethrown once they are.
+   */
+  void
+  processPackets(const std::vector<Block>& wires)
+  {
+    std::vector<ReceivedPacket> packets;
+    packets.reserve(wires.size());
+    for (size_t i = 0; i < wires.size(); ++i)
+      {
+        ReceivedPacket packet;
+        try
           {
-            // Copy pointers to the objects and remove the PIT entry before calling the callback.
-            OnData onData = (*i)->getOnData();
-            shared_ptr<const Interest> interest = (*i)->getInterest();
+            decodePacket(wires[i], packet.interest, packet.data);
+          }
+        catch (const tlv::Error&)
+          {
+            continue;
+          }
+        packets.push_back(packet);
+      }
 
-            PendingInterestTable::iterator next = i;
-            ++next;
-            m_pendingInterestTable.erase(i);
-            i = next;
+    bool hasMatches = false;
+    for (std::vector<ReceivedPacket>::iterator i = packets.begin(); i != packets.end(); ++i)
+      {
+        if (i->data != nullptr)
+          {
+            i->matches = m_pendingInterestTable.extractMatches(*i->data);
+            hasMatches = hasMatches || !i->matches.empty();
+          }
+      }
 
-            if (static_cast<bool>(onData)) {
-              onData(*interest, data);
-            }
+    if (hasMatches && m_pendingInterestTable.empty())
+      schedulePitExpire();
+
+    std::exception_ptr error;
+    for (std::vector<ReceivedPacket>::iterator i = packets.begin(); i != packets.end(); ++i)
+      {
+        try
+          {
+            if (i->interest != nullptr)
+              processInterestFilters(*i->interest);
+            else if (i->data != nullptr)
+              callOnData(i->matches, *i->data);
+          }
+        catch (...)
+          {
+            if (error == nullptr)
+              error = std::current_exception();
           }
-        else
-          ++i;
       }
+
+    if (error != nullptr)
+      std::rethrow_exception(error);
+  }
+
+  void
+  satisfyPendingInterests(Data& data)
+  {
+    // All satisfied entries are removed from the PIT before any callback is called
+    PendingInterestTable::PendingInterestList matches =
+      m_pendingInterestTable.extractMatches(data);
+    if (!matches.empty() && m_pendingInterestTable.empty())
+      schedulePitExpire();
+
+    callOnData(matches, data);
+  }
+
+  /**
+   * @brief Calls onData of all @p matches, which have left the PIT, even if some throws; the
+   *        first exception is rethrown afterwards
+   */
+  static void
+  callOnData(const PendingInterestTable::PendingInterestList& matches, Data& data)
+  {
+    std::exception_ptr error;
+    for (PendingInterestTable::PendingInterestList::const_iterator i = matches.begin();
+         i != matches.end(); ++i)
+      {
+        const OnData& onData = (*i)->getOnData();
+        if (static_cast<bool>(onData)) {
+          try
+            {
+              onData(*(*i)->getInterest(), data);
+            }
+          catch (...)
+            {
+              if (error == nullptr)
+                error = std::current_exception();
+            }
+        }
+      }
+
+    if (error != nullptr)
+      std::rethrow_exception(error);
   }
 
   void
   processInterestFilters(Interest& interest)
   {
-    for (InterestFilterTable::iterator i = m_interestFilterTable.begin();
-         i != m_interestFilterTable.end();
-         ++i)
+    InterestFilterTable::InterestFilterList matches =
+      m_interestFilterTable.findMatches(interest.getName());
+
+    for (InterestFilterTable::InterestFilterList::iterator i = matches.begin();
+         i != matches.end(); ++i)
       {
-        if ((*i)->doesMatch(interest.getName()))
+        // skip the filters unset by a previous callback
+        if (m_interestFilterTable.contains(InterestFilterTable::getId(**i)))
           {
             (**i)(interest);
           }
@@ -117,31 +275,34 @@ public:
   {
     this->ensureConnected();
 
-    m_pendingInterestTable.push_back(make_shared<PendingInterest>(interest, onData, onTimeout));
+    // an Interest identical to an outstanding one is not sent again
+    if (m_pendingInterestTable.insert(make_shared<PendingInterest>(interest, onData, onTimeout)))
+      sendInterest(*interest);
 
-    if (!interest->getLocalControlHeader().empty(false, true))
+    schedulePitExpire();
+  }
+
+  void
+  sendInterest(const Interest& interest)
+  {
+    if (!interest.getLocalControlHeader().empty(false, true))
       {
         // encode only NextHopFaceId towards the forwarder
-        m_face.m_transport->send(interest->getLocalControlHeader()
-                                   .wireEncode(*interest, false, true),
-                                 interest->wireEncode());
+        m_face.m_transport->send(interest.getLocalControlHeader()
+                                   .wireEncode(interest, false, true),
+                                 interest.wireEncode());
       }
     else
       {
-        m_face.m_transport->send(interest->wireEncode());
+        m_face.m_transport->send(interest.wireEncode());
       }
-
-    if (!m_pitTimeoutCheckTimerActive) {
-      m_pitTimeoutCheckTimerActive = true;
-      m_pitTimeoutCheckTimer->expires_from_now(time::milliseconds(100));
-      m_pitTimeoutCheckTimer->async_wait(bind(&Impl::checkPitExpire, this));
-    }
   }
 
   void
   asyncRemovePendingInterest(const PendingInterestId* pendingInterestId)
   {
-    m_pendingInterestTable.remove_if(MatchPendingInterestId(pendingInterestId));
+    if (m_pendingInterestTable.erase(pendingInterestId) && m_pendingInterestTable.empty())
+      schedulePitExpire();
   }
 
   void
@@ -166,19 +327,13 @@ public:
   void
   asyncSetInterestFilter(const shared_ptr<InterestFilterRecord>& interestFilterRecord)
   {
-    m_interestFilterTable.push_back(interestFilterRecord);
+    m_interestFilterTable.insert(interestFilterRecord);
   }
 
   void
   asyncUnsetInterestFilter(const InterestFilterId* interestFilterId)
   {
-    InterestFilterTable::iterator i = std::find_if(m_interestFilterTable.begin(),
-                                                   m_interestFilterTable.end(),
-                                                   MatchInterestFilterId(interestFilterId));
-    if (i != m_interestFilterTable.end())
-      {
-        m_interestFilterTable.erase(i);
-      }
+    m_interestFilterTable.erase(interestFilterId);
   }
 
   /////////////////////////////////////////////////////////////////////////////////////////////////
@@ -241,7 +396,7 @@ public:
 
     if (static_cast<bool>(registeredPrefix->getFilter())) {
       // it was a combined operation
-      m_interestFilterTable.push_back(registeredPrefix->getFilter());
+      m_interestFilterTable.insert(registeredPrefix->getFilter());
     }
 
     if (static_cast<bool>(onSuccess)) {
@@ -263,7 +418,7 @@ public:
         if (static_cast<bool>(filter))
           {
             // it was a combined operation
-            m_interestFilterTable.remove(filter);
+            m_interestFilterTable.erase(InterestFilterTable::getId(*filter));
           }
 
         (*i)->unregister(bind(&Impl::finalizeUnregisterPrefix, this, i, onSuccess),
@@ -300,35 +455,64 @@ public:
   /////////////////////////////////////////////////////////////////////////////////////////////////
   /////////////////////////////////////////////////////////////////////////////////////////////////
 
+  /**
+   * @brief Arms the PIT timer for the earliest timeout, or for now if the PIT is empty so that
+   *        checkPitExpire pauses the transport
+   *
+   * The timer is left alone if it is already armed for an earlier time.
+   */
   void
-  checkPitExpire()
+  schedulePitExpire()
   {
+    time::steady_clock::TimePoint expiry = m_pendingInterestTable.empty() ?
+                                           time::steady_clock::now() :
+                                           m_pendingInterestTable.getNextTimeout();
+
+    if (m_pitTimeoutCheckTimerActive && m_pitTimeoutCheckTimer->expires_at() <= expiry)
+      return;
+
+    // re-arming cancels the previous wait
+    m_pitTimeoutCheckTimerActive = true;
+    m_pitTimeoutCheckTimer->expires_at(expiry);
+    m_pitTimeoutCheckTimer->async_wait(m_strand.wrap(bind(&Impl::checkPitExpire, this, _1)));
+  }
+
+  void
+  checkPitExpire(const boost::system::error_code& error)
+  {
+    if (error) // cancelled or re-armed timer
+      return;
+
+    m_pitTimeoutCheckTimerActive = false;
+
     // Check for PIT entry timeouts.
     time::steady_clock::TimePoint now = time::steady_clock::now();
 
-    PendingInterestTable::iterator i = m_pendingInterestTable.begin();
-    while (i != m_pendingInterestTable.end())
+    // Remove the timed out entries from the PIT.  Then call the callbacks.
+    PendingInterestTable::PendingInterestList timedOut =
+      m_pendingInterestTable.extractTimedOut(now);
+
+    for (PendingInterestTable::PendingInterestList::iterator i = timedOut.begin();
+         i != timedOut.end(); ++i)
       {
-        if ((*i)->isTimedOut(now))
-          {
-            // Save the PendingInterest and remove it from the PIT.  Then call the callback.
-            shared_ptr<PendingInterest> pendingInterest = *i;
+        (*i)->callTimeout();
+      }
 
-            i = m_pendingInterestTable.erase(i);
+    // Send again the aggregated Interests which expired before all their requesters timed out
+    PendingInterestTable::InterestList retransmissions =
+      m_pendingInterestTable.extractRetransmissions(now);
 
-            pendingInterest->callTimeout();
-          }
-        else
-          ++i;
+    for (PendingInterestTable::InterestList::iterator i = retransmissions.begin();
+         i != retransmissions.end(); ++i)
+      {
+        sendInterest(**i);
       }
 
     if (!m_pendingInterestTable.empty()) {
-      m_pitTimeoutCheckTimerActive = true;
-
-      m_pitTimeoutCheckTimer->expires_from_now(time::milliseconds(100));
-      m_pitTimeoutCheckTimer->async_wait(bind(&Impl::checkPitExpire, this));
+      schedulePitExpire();
     }
     else {
+      m_pitTimeoutCheckTimer->cancel(); // a timeout callback might have armed it
       m_pitTimeoutCheckTimerActive = false;
 
       if (m_registeredPrefixTable.empty()) {
@@ -341,8 +525,21 @@ public:
   }
 
 private:
+  struct ReceivedPacket
+  {
+    shared_ptr<Interest> interest;
+    shared_ptr<Data> data;
+    PendingInterestTable::PendingInterestList matches; ///< pending Interests satisfied by data
+  };
+
   Face& m_face;
 
+  /// serializes the handlers which use the state of the Face, so that the io_service can be
+  /// run by several threads
+  boost::asio::io_service::strand m_strand;
+  MpscQueue<function<void()> > m_submissions; ///< operations submitted with post
+  std::atomic<bool> m_isDrainScheduled;
+
   PendingInterestTable m_pendingInterestTable;
   InterestFilterTable m_interestFilterTable;
   RegisteredPrefixTable m_registeredPrefixTable;
@@ -354,6 +551,9 @@ private:
   bool m_pitTimeoutCheckTimerActive;
   shared_ptr<monotonic_deadline_timer> m_processEventsTimeoutTimer;
 
+  util::signal::ScopedConnection m_sendQueueFullConnection;
+  util::signal::ScopedConnection m_sendQueueDrainedConnection;
+
   friend class Face;
 };
 
@@ -0,0 +1,139 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2015 Regents of the University of Tokyo.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_DETAIL_INTEREST_FILTER_TABLE_HPP
+#define NDN_DETAIL_INTEREST_FILTER_TABLE_HPP
+
+#include "../common.hpp"
+#include "interest-filter-record.hpp"
+#include "name-tree.hpp"
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace ndn {
+
+/**
+ * @brief Interest filters, indexed by prefix and by InterestFilterId
+ *
+ * Filters are kept in a NameTree at the node of their prefix, so the filters matching an
+ * Interest are found by visiting one node per component of the Interest name.  The regular
+ * expression of a filter is evaluated only for names under its prefix.
+ */
+class InterestFilterTable : noncopyable
+{
+public:
+  typedef std::vector<shared_ptr<InterestFilterRecord> > InterestFilterList;
+
+  InterestFilterTable()
+    : m_nextSequence(0)
+  {
+  }
+
+  static const InterestFilterId*
+  getId(const InterestFilterRecord& record)
+  {
+    return reinterpret_cast<const InterestFilterId*>(&record);
+  }
+
+  void
+  insert(const shared_ptr<InterestFilterRecord>& record)
+  {
+    const Name& prefix = record->getFilter().getPrefix();
+    m_index[getId(*record)] = m_tree.insert(prefix, prefix.size(),
+                                            Entry(m_nextSequence++, record));
+  }
+
+  /**
+   * @return whether the filter was in the table
+   */
+  bool
+  erase(const InterestFilterId* interestFilterId)
+  {
+    Index::iterator position = m_index.find(interestFilterId);
+    if (position == m_index.end())
+      return false;
+
+    m_tree.erase(position->second);
+    m_index.erase(position);
+    return true;
+  }
+
+  bool
+  contains(const InterestFilterId* interestFilterId) const
+  {
+    return m_index.count(interestFilterId) > 0;
+  }
+
+  /**
+   * @brief Get the filters matching @p name, in the order they were inserted
+   */
+  InterestFilterList
+  findMatches(const Name& name) const
+  {
+    std::vector<Entry> matches;
+    m_tree.forEachPrefixOf(name, [&name, &matches] (const Entry& entry) {
+      if (!entry.second->getFilter().hasRegexFilter() || entry.second->doesMatch(name))
+        matches.push_back(entry);
+    });
+    std::sort(matches.begin(), matches.end(),
+              [] (const Entry& a, const Entry& b) { return a.first < b.first; });
+
+    InterestFilterList records;
+    records.reserve(matches.size());
+    for (std::vector<Entry>::iterator i = matches.begin(); i != matches.end(); ++i)
+      records.push_back(i->second);
+    return records;
+  }
+
+  void
+  clear()
+  {
+    m_index.clear();
+    m_tree.clear();
+  }
+
+  size_t
+  size() const
+  {
+    return m_index.size();
+  }
+
+  bool
+  empty() const
+  {
+    return m_index.empty();
+  }
+
+private:
+  /// insertion sequence number and filter
+  typedef std::pair<uint64_t, shared_ptr<InterestFilterRecord> > Entry;
+  typedef NameTree<Entry> Tree;
+  typedef std::unordered_map<const InterestFilterId*, Tree::Position> Index;
+
+  Tree m_tree;
+  Index m_index;
+  uint64_t m_nextSequence;
+};
+
+} // namespace ndn
+
+#endif // NDN_DETAIL_INTEREST_FILTER_TABLE_HPP
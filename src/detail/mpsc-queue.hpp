@@ -0,0 +1,135 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2015 Regents of the University of Tokyo.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_DETAIL_MPSC_QUEUE_HPP
+#define NDN_DETAIL_MPSC_QUEUE_HPP
+
+#include "../common.hpp"
+
+#include <atomic>
+
+namespace ndn {
+
+/**
+ * @brief Unbounded lock-free queue with many producers and a single consumer
+ *
+ * push may be called from any thread; it takes one allocation and one atomic exchange.
+ * pop must be called from one thread at a time.  While a push is in progress, pop may report
+ * the queue as empty even though later values have already been pushed; the producer is
+ * then expected to notify the consumer once push returns.
+ *
+ * This is the intrusive queue of Dmitry Vyukov, with a stub node that is pushed again
+ * whenever the consumer catches up with the producers.
+ */
+template<typename T>
+class MpscQueue : noncopyable
+{
+public:
+  MpscQueue()
+    : m_head(&m_stub)
+    , m_tail(&m_stub)
+  {
+  }
+
+  ~MpscQueue()
+  {
+    T value;
+    while (pop(value))
+      ;
+  }
+
+  void
+  push(const T& value)
+  {
+    pushNode(new Node(value));
+  }
+
+  /**
+   * @brief Moves the oldest value into @p value
+   * @return false if there is no value to pop
+   */
+  bool
+  pop(T& value)
+  {
+    Node* tail = m_tail;
+    Node* next = tail->next.load();
+
+    if (tail == &m_stub) {
+      if (next == nullptr)
+        return false;
+      m_tail = next;
+      tail = next;
+      next = next->next.load();
+    }
+
+    if (next == nullptr) {
+      if (tail != m_head.load())
+        return false; // a producer has not linked its node yet
+
+      // tail is the last node: put the stub behind it, so that it can be unlinked
+      pushNode(&m_stub);
+      next = tail->next.load();
+      if (next == nullptr)
+        return false;
+    }
+
+    m_tail = next;
+    value = std::move(tail->value);
+    delete tail;
+    return true;
+  }
+
+private:
+  struct Node : noncopyable
+  {
+    Node()
+      : next(nullptr)
+    {
+    }
+
+    explicit
+    Node(const T& value)
+      : next(nullptr)
+      , value(value)
+    {
+    }
+
+    std::atomic<Node*> next;
+    T value;
+  };
+
+  void
+  pushNode(Node* node)
+  {
+    node->next.store(nullptr);
+    Node* previous = m_head.exchange(node);
+    previous->next.store(node);
+  }
+
+private:
+  Node m_stub;
+  std::atomic<Node*> m_head; ///< last pushed node, written by producers
+  Node* m_tail; ///< oldest node, owned by the consumer
+};
+
+} // namespace ndn
+
+#endif // NDN_DETAIL_MPSC_QUEUE_HPP
@@ -0,0 +1,163 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2015 Regents of the University of Tokyo.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_DETAIL_NAME_TREE_HPP
+#define NDN_DETAIL_NAME_TREE_HPP
+
+#include "../common.hpp"
+#include "../name.hpp"
+
+#include <list>
+#include <map>
+
+namespace ndn {
+
+/**
+ * @brief Tree of name components, holding entries at the node of their name
+ *
+ * Finding the entries whose names are prefixes of a name visits one node per component of
+ * that name, whatever the number of entries.  Nodes left without entries or children are
+ * removed.
+ */
+template<typename T>
+class NameTree : noncopyable
+{
+public:
+  struct Node;
+  typedef std::list<T> Entries;
+
+  /**
+   * @brief Location of an entry, valid until the entry is erased
+   */
+  typedef std::pair<Node*, typename Entries::iterator> Position;
+
+  NameTree()
+    : m_root(nullptr, name::Component())
+  {
+  }
+
+  /**
+   * @brief Adds @p entry at the node of the first @p depth components of @p name
+   */
+  Position
+  insert(const Name& name, size_t depth, const T& entry)
+  {
+    BOOST_ASSERT(depth <= name.size());
+
+    Node* node = &m_root;
+    for (size_t i = 0; i < depth; ++i) {
+      unique_ptr<Node>& child = node->children[name.get(i)];
+      if (child == nullptr)
+        child.reset(new Node(node, name.get(i)));
+      node = child.get();
+    }
+
+    node->entries.push_back(entry);
+    return Position(node, --node->entries.end());
+  }
+
+  void
+  erase(const Position& position)
+  {
+    Node* node = position.first;
+    node->entries.erase(position.second);
+
+    while (node != &m_root && node->entries.empty() && node->children.empty()) {
+      Node* parent = node->parent;
+      parent->children.erase(parent->children.find(node->component));
+      node = parent;
+    }
+  }
+
+  /**
+   * @brief Get the entries at the node of the first @p depth components of @p name
+   * @return nullptr if there is no such node
+   */
+  Entries*
+  find(const Name& name, size_t depth)
+  {
+    BOOST_ASSERT(depth <= name.size());
+
+    Node* node = &m_root;
+    for (size_t i = 0; i < depth; ++i) {
+      typename Children::iterator child = node->children.find(name.get(i));
+      if (child == node->children.end())
+        return nullptr;
+      node = child->second.get();
+    }
+    return &node->entries;
+  }
+
+  /**
+   * @brief Calls @p visit for each entry whose name is a prefix of @p name, shorter names first
+   */
+  template<typename Visitor>
+  void
+  forEachPrefixOf(const Name& name, Visitor visit) const
+  {
+    const Node* node = &m_root;
+    for (size_t i = 0; ; ++i) {
+      for (typename Entries::const_iterator entry = node->entries.begin();
+           entry != node->entries.end(); ++entry) {
+        visit(*entry);
+      }
+
+      if (i == name.size())
+        return;
+      typename Children::const_iterator child = node->children.find(name.get(i));
+      if (child == node->children.end())
+        return;
+      node = child->second.get();
+    }
+  }
+
+  void
+  clear()
+  {
+    m_root.entries.clear();
+    m_root.children.clear();
+  }
+
+private:
+  typedef std::map<name::Component, unique_ptr<Node> > Children;
+
+public:
+  struct Node : noncopyable
+  {
+    Node(Node* parent, const name::Component& component)
+      : parent(parent)
+      , component(component)
+    {
+    }
+
+    Node* parent;
+    name::Component component; ///< key of this node in its parent
+    Children children;
+    Entries entries;
+  };
+
+private:
+  Node m_root;
+};
+
+} // namespace ndn
+
+#endif // NDN_DETAIL_NAME_TREE_HPP
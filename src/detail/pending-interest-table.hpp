@@ -0,0 +1,293 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2015 Regents of the University of Tokyo.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_DETAIL_PENDING_INTEREST_TABLE_HPP
+#define NDN_DETAIL_PENDING_INTEREST_TABLE_HPP
+
+#include "../common.hpp"
+#include "pending-interest.hpp"
+#include "name-tree.hpp"
+
+#include <algorithm>
+#include <list>
+#include <map>
+#include <unordered_map>
+
+namespace ndn {
+
+class PendingInterestId;
+
+/**
+ * @brief Pending Interests, indexed by name and by PendingInterestId
+ *
+ * Pending Interests with the same name, selectors and NextHopFaceId are aggregated: only the
+ * first one is sent, and a Data matching it satisfies all of them.  When the lifetime of the
+ * sent Interest ends before the last of them times out, extractRetransmissions gives the
+ * Interest to send again for the remaining ones.
+ *
+ * Aggregates are kept in a NameTree, so the candidates for a Data are found by visiting one
+ * node per component of the Data name, whatever the size of the table.  Each candidate is
+ * then checked with Interest::matchesData.  A trailing implicit digest component is not part
+ * of the index: such an Interest is kept at the node of the Data name.
+ *
+ * Removal by PendingInterestId takes constant time on average.  Timeouts are kept in order,
+ * so finding the timed out Interests costs only as much as there are of them, and the next
+ * timeout is known without a scan.
+ */
+class PendingInterestTable : noncopyable
+{
+public:
+  typedef std::vector<shared_ptr<PendingInterest> > PendingInterestList;
+  typedef std::vector<shared_ptr<const Interest> > InterestList;
+
+  static const PendingInterestId*
+  getId(const PendingInterest& pendingInterest)
+  {
+    return reinterpret_cast<const PendingInterestId*>(pendingInterest.getInterest().get());
+  }
+
+  /**
+   * @return whether the Interest needs to be sent, i.e. it is not aggregated with a
+   *         previously sent one
+   */
+  bool
+  insert(const shared_ptr<PendingInterest>& pendingInterest)
+  {
+    const shared_ptr<const Interest>& interest = pendingInterest->getInterest();
+    const Name& name = interest->getName();
+    size_t depth = name.size();
+    if (depth > 0 && name.get(-1).isImplicitSha256Digest())
+      --depth;
+
+    shared_ptr<Aggregate> aggregate;
+    Tree::Entries* candidates = m_tree.find(name, depth);
+    if (candidates != nullptr) {
+      for (Tree::Entries::iterator i = candidates->begin(); i != candidates->end(); ++i) {
+        if (isSameRequest(*(*i)->interest, *interest)) {
+          aggregate = *i;
+          break;
+        }
+      }
+    }
+
+    bool isNew = aggregate == nullptr;
+    if (isNew) {
+      aggregate = make_shared<Aggregate>();
+      aggregate->interest = interest;
+      aggregate->position = m_tree.insert(name, depth, aggregate);
+      aggregate->expiry = m_expiries.insert(std::make_pair(pendingInterest->getTimeout(),
+                                                           aggregate.get()));
+    }
+
+    Position& position = m_index[getId(*pendingInterest)];
+    position.aggregate = aggregate.get();
+    position.entry = aggregate->entries.insert(aggregate->entries.end(), pendingInterest);
+    position.timeout = m_timeouts.insert(std::make_pair(pendingInterest->getTimeout(),
+                                                        pendingInterest));
+    return isNew;
+  }
+
+  /**
+   * @return whether the pending Interest was in the table
+   */
+  bool
+  erase(const PendingInterestId* pendingInterestId)
+  {
+    Index::iterator position = m_index.find(pendingInterestId);
+    if (position == m_index.end())
+      return false;
+
+    Aggregate* aggregate = position->second.aggregate;
+    aggregate->entries.erase(position->second.entry);
+    m_timeouts.erase(position->second.timeout);
+    m_index.erase(position);
+
+    if (aggregate->entries.empty()) {
+      m_expiries.erase(aggregate->expiry);
+      Tree::Position treePosition = aggregate->position;
+      m_tree.erase(treePosition); // destroys the aggregate
+    }
+    return true;
+  }
+
+  /**
+   * @brief Removes and returns the pending Interests satisfied by @p data
+   */
+  PendingInterestList
+  extractMatches(const Data& data)
+  {
+    PendingInterestList matches;
+    m_tree.forEachPrefixOf(data.getName(),
+                           [&data, &matches] (const shared_ptr<Aggregate>& aggregate) {
+                             if (aggregate->interest->matchesData(data))
+                               matches.insert(matches.end(), aggregate->entries.begin(),
+                                              aggregate->entries.end());
+                           });
+
+    for (PendingInterestList::iterator i = matches.begin(); i != matches.end(); ++i)
+      erase(getId(**i));
+    return matches;
+  }
+
+  /**
+   * @brief Removes and returns the pending Interests which are timed out at @p now
+   */
+  PendingInterestList
+  extractTimedOut(const time::steady_clock::TimePoint& now)
+  {
+    PendingInterestList timedOut;
+    for (Timeouts::const_iterator i = m_timeouts.begin();
+         i != m_timeouts.end() && i->second->isTimedOut(now); ++i) {
+      timedOut.push_back(i->second);
+    }
+
+    for (PendingInterestList::iterator i = timedOut.begin(); i != timedOut.end(); ++i)
+      erase(getId(**i));
+    return timedOut;
+  }
+
+  /**
+   * @brief Get the Interests to send again at @p now
+   *
+   * For each aggregate whose sent Interest expired at @p now while some of its pending
+   * Interests have not timed out, the Interest is sent again with a new nonce and a lifetime
+   * reaching the last timeout.
+   */
+  InterestList
+  extractRetransmissions(const time::steady_clock::TimePoint& now)
+  {
+    std::vector<Aggregate*> expired;
+    for (Expiries::const_iterator i = m_expiries.begin();
+         i != m_expiries.end() && i->first <= now; ++i) {
+      expired.push_back(i->second);
+    }
+
+    InterestList retransmissions;
+    for (std::vector<Aggregate*>::iterator i = expired.begin(); i != expired.end(); ++i) {
+      Aggregate& aggregate = **i;
+
+      time::steady_clock::TimePoint lastTimeout = now;
+      for (Aggregate::Entries::const_iterator entry = aggregate.entries.begin();
+           entry != aggregate.entries.end(); ++entry) {
+        lastTimeout = std::max(lastTimeout, (*entry)->getTimeout());
+      }
+
+      time::milliseconds lifetime =
+        time::duration_cast<time::milliseconds>(lastTimeout - now) + time::milliseconds(1);
+      shared_ptr<Interest> interest = make_shared<Interest>(*aggregate.interest);
+      interest->setInterestLifetime(lifetime);
+      interest->refreshNonce();
+      aggregate.interest = interest;
+
+      m_expiries.erase(aggregate.expiry);
+      aggregate.expiry = m_expiries.insert(std::make_pair(now + lifetime, &aggregate));
+      retransmissions.push_back(interest);
+    }
+    return retransmissions;
+  }
+
+  /**
+   * @brief Get the earliest time at which an Interest times out or needs to be sent again
+   * @pre the table is not empty
+   */
+  time::steady_clock::TimePoint
+  getNextTimeout() const
+  {
+    BOOST_ASSERT(!m_timeouts.empty());
+    return std::min(m_timeouts.begin()->first, m_expiries.begin()->first);
+  }
+
+  void
+  clear()
+  {
+    m_index.clear();
+    m_timeouts.clear();
+    m_expiries.clear();
+    m_tree.clear();
+  }
+
+  /**
+   * @return the number of pending Interests, aggregated ones included
+   */
+  size_t
+  size() const
+  {
+    return m_index.size();
+  }
+
+  bool
+  empty() const
+  {
+    return m_index.empty();
+  }
+
+private:
+  static bool
+  isSameRequest(const Interest& a, const Interest& b)
+  {
+    const nfd::LocalControlHeader& aHeader = a.getLocalControlHeader();
+    const nfd::LocalControlHeader& bHeader = b.getLocalControlHeader();
+
+    return a.getName() == b.getName() &&
+           a.getSelectors() == b.getSelectors() &&
+           aHeader.hasNextHopFaceId() == bHeader.hasNextHopFaceId() &&
+           (!aHeader.hasNextHopFaceId() ||
+            aHeader.getNextHopFaceId() == bHeader.getNextHopFaceId());
+  }
+
+private:
+  struct Aggregate;
+  typedef NameTree<shared_ptr<Aggregate> > Tree;
+  typedef std::multimap<time::steady_clock::TimePoint,
+                        shared_ptr<PendingInterest> > Timeouts;
+  typedef std::multimap<time::steady_clock::TimePoint, Aggregate*> Expiries;
+
+  /**
+   * @brief Pending Interests waiting for the same sent Interest
+   */
+  struct Aggregate : noncopyable
+  {
+    typedef std::list<shared_ptr<PendingInterest> > Entries;
+
+    shared_ptr<const Interest> interest; ///< the Interest last sent
+    Entries entries;
+    Tree::Position position;
+    Expiries::iterator expiry; ///< when the sent Interest expires
+  };
+
+  struct Position
+  {
+    Aggregate* aggregate;
+    Aggregate::Entries::iterator entry;
+    Timeouts::iterator timeout;
+  };
+
+  typedef std::unordered_map<const PendingInterestId*, Position> Index;
+
+  Tree m_tree;
+  Timeouts m_timeouts;
+  Expiries m_expiries;
+  Index m_index;
+};
+
+} // namespace ndn
+
+#endif // NDN_DETAIL_PENDING_INTEREST_TABLE_HPP
@@ -68,6 +68,15 @@ public:
     return m_onData;
   }
 
+  /**
+   * @brief Get the time at which this interest times out
+   */
+  const time::steady_clock::TimePoint&
+  getTimeout() const
+  {
+    return m_timeout;
+  }
+
   /**
    * Check if this interest is timed out.
    * @return true if this interest timed out, otherwise false.
@@ -97,31 +106,6 @@ private:
 };
 
 
-class PendingInterestId;
-
-/**
- * @brief Functor to match pending interests against PendingInterestId
- */
-class MatchPendingInterestId
-{
-public:
-  explicit
-  MatchPendingInterestId(const PendingInterestId* pendingInterestId)
-    : m_id(pendingInterestId)
-  {
-  }
-
-  bool
-  operator()(const shared_ptr<const PendingInterest>& pendingInterest) const
-  {
-    return (reinterpret_cast<const PendingInterestId*>(
-              pendingInterest->getInterest().get()) == m_id);
-  }
-private:
-  const PendingInterestId* m_id;
-};
-
-
 } // namespace ndn
 
 #endif // NDN_DETAIL_PENDING_INTEREST_HPP
@@ -0,0 +1,182 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2015 Regents of the University of Tokyo.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+
+#ifndef NDN_DETAIL_TIMING_WHEEL_HPP
+#define NDN_DETAIL_TIMING_WHEEL_HPP
+
+#include "../common.hpp"
+#include "../util/time.hpp"
+
+#include <list>
+
+namespace ndn {
+
+/**
+ * @brief Values with deadlines, hashed into a ring of slots by deadline
+ *
+ * Inserting and erasing a value take constant time.  advance visits the slots of the ticks
+ * elapsed since the last call, so that the cost of finding the expired values depends on the
+ * elapsed time and on the number of values in the visited slots, not on the number of values
+ * in the wheel.  A value whose deadline lies beyond one turn of the wheel stays in its slot
+ * until a visit finds it due.
+ */
+template<typename T>
+class TimingWheel : noncopyable
+{
+private:
+  struct Item
+  {
+    time::steady_clock::TimePoint deadline;
+    T value;
+  };
+
+  typedef std::list<Item> Slot;
+
+public:
+  /**
+   * @brief Where a value is in the wheel, valid until it is erased or expires
+   */
+  class Position
+  {
+  public:
+    Position()
+      : m_slot(NONE)
+    {
+    }
+
+    bool
+    isScheduled() const
+    {
+      return m_slot != NONE;
+    }
+
+  private:
+    static const size_t NONE = static_cast<size_t>(-1);
+
+    size_t m_slot;
+    typename Slot::iterator m_item;
+
+    friend class TimingWheel;
+  };
+
+  /**
+   * @param nSlots number of slots, one per tick
+   * @param tick time covered by a slot, which bounds the delay of advance past a deadline
+   */
+  TimingWheel(size_t nSlots, const time::nanoseconds& tick)
+    : m_slots(nSlots)
+    , m_tick(tick)
+    , m_currentTick(getTick(time::steady_clock::now()))
+    , m_size(0)
+  {
+    BOOST_ASSERT(nSlots > 0 && tick > time::nanoseconds::zero());
+  }
+
+  Position
+  insert(const time::steady_clock::TimePoint& deadline, const T& value)
+  {
+    // a deadline already passed goes to the current slot, visited by the next advance
+    uint64_t tick = std::max(getTick(deadline), m_currentTick);
+
+    Position position;
+    position.m_slot = tick % m_slots.size();
+    Item item = {deadline, value};
+    Slot& slot = m_slots[position.m_slot];
+    position.m_item = slot.insert(slot.end(), item);
+    ++m_size;
+    return position;
+  }
+
+  /**
+   * @brief Removes the value at @p position, if it is still scheduled, and resets @p position
+   */
+  void
+  erase(Position& position)
+  {
+    if (!position.isScheduled())
+      return;
+
+    m_slots[position.m_slot].erase(position.m_item);
+    position = Position();
+    --m_size;
+  }
+
+  /**
+   * @brief Removes the values whose deadline is not later than @p now, and passes each of
+   *        them to @p onExpired
+   *
+   * Positions of the expired values are no longer valid; @p onExpired may insert and erase
+   * values.
+   */
+  template<typename Callback>
+  void
+  advance(const time::steady_clock::TimePoint& now, const Callback& onExpired)
+  {
+    uint64_t nowTick = std::max(getTick(now), m_currentTick);
+    uint64_t nTicks = std::min<uint64_t>(nowTick - m_currentTick, m_slots.size() - 1) + 1;
+
+    std::vector<T> expired;
+    for (uint64_t tick = m_currentTick; tick < m_currentTick + nTicks; ++tick) {
+      Slot& slot = m_slots[tick % m_slots.size()];
+      for (typename Slot::iterator it = slot.begin(); it != slot.end();) {
+        if (it->deadline <= now) {
+          expired.push_back(it->value);
+          it = slot.erase(it);
+          --m_size;
+        }
+        else {
+          ++it;
+        }
+      }
+    }
+    m_currentTick = nowTick;
+
+    for (typename std::vector<T>::iterator it = expired.begin(); it != expired.end(); ++it)
+      onExpired(*it);
+  }
+
+  size_t
+  size() const
+  {
+    return m_size;
+  }
+
+private:
+  uint64_t
+  getTick(const time::steady_clock::TimePoint& timePoint) const
+  {
+    time::nanoseconds sinceEpoch = timePoint.time_since_epoch();
+    if (sinceEpoch < time::nanoseconds::zero())
+      return 0;
+    return sinceEpoch.count() / m_tick.count();
+  }
+
+private:
+  std::vector<Slot> m_slots;
+  time::nanoseconds m_tick;
+  uint64_t m_currentTick; ///< tick of the last advance
+  size_t m_size;
+};
+
+} // namespace ndn
+
+#endif // NDN_DETAIL_TIMING_WHEEL_HPP
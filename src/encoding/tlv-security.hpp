@@ -29,9 +29,17 @@ namespace tlv {
 namespace security {
 
 enum {
-  IdentityPackage    = 128,
-  KeyPackage         = 129,
-  CertificatePackage = 130
+  IdentityPackage      = 128,
+  KeyPackage           = 129,
+  CertificatePackage   = 130,
+  Manifest             = 131,
+  ManifestFirstSegment = 132,
+
+  MerkleRootSignatureType = 133,
+  MerkleRootSignature     = 134,
+  MerkleLeafIndex         = 135,
+  MerkleNLeaves           = 136,
+  MerkleSibling           = 137
 };
 
 } // namespace security
@@ -93,7 +93,8 @@ enum SignatureTypeValue {
   DigestSha256 = 0,
   SignatureSha256WithRsa = 1,
   SignatureSha256WithEcdsa = 3,
-  SignatureSha256Ibas = 4
+  SignatureSha256Ibas = 4,
+  SignatureSha256Merkle = 5
 };
 
 /** @brief indicates a possible value of ContentType field
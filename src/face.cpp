@@ -30,6 +30,9 @@
 #include "util/random.hpp"
 #include "util/face-uri.hpp"
 
+#include <mutex>
+#include <thread>
+
 namespace ndn {
 
 Face::Face()
@@ -100,6 +103,7 @@ Face::construct(KeyChain* keyChain)
 {
   // transport=unix:///var/run/nfd.sock
   // transport=tcp://localhost:6363
+  // transport=shm:///var/run/nfd-shm.sock
 
   const ConfigFile::Parsed& parsed = m_impl->m_config.getParsedConfiguration();
 
@@ -133,6 +137,12 @@ Face::construct(KeyChain* keyChain)
     {
       construct(TcpTransport::create(m_impl->m_config), keyChain);
     }
+#ifdef NDN_CXX_HAVE_EVENTFD
+  else if (protocol == "shm")
+    {
+      construct(ShmTransport::create(m_impl->m_config), keyChain);
+    }
+#endif // NDN_CXX_HAVE_EVENTFD
   else
     {
       throw ConfigFile::Error("Unsupported transport protocol \"" + protocol + "\"");
@@ -148,8 +158,17 @@ Face::construct(shared_ptr<Transport> transport,
   m_impl->m_pitTimeoutCheckTimerActive = false;
   m_transport = transport;
 
+  m_impl->m_sendQueueFullConnection = m_transport->onSendQueueFull.connect([this] {
+    onSendQueueFull();
+  });
+  m_impl->m_sendQueueDrainedConnection = m_transport->onSendQueueDrained.connect([this] {
+    onSendQueueDrained();
+  });
+
   m_impl->m_pitTimeoutCheckTimer      = make_shared<monotonic_deadline_timer>(ref(m_ioService));
   m_impl->m_processEventsTimeoutTimer = make_shared<monotonic_deadline_timer>(ref(m_ioService));
+  m_transport->setStrand(m_impl->m_strand);
+  m_transport->setReceiveBatchCallback(bind(&Impl::processPackets, m_impl, _1));
   m_impl->ensureConnected(false);
 
   std::string protocol = "nrd-0.1";
@@ -200,9 +219,9 @@ Face::expressInterest(const Interest& interest, const OnData& onData, const OnTi
   if (interestToExpress->wireEncode().size() > MAX_NDN_PACKET_SIZE)
     throw Error("Interest size exceeds maximum limit");
 
-  // If the same ioService thread, dispatch directly calls the method
-  m_ioService.dispatch(bind(&Impl::asyncExpressInterest, m_impl,
-                            interestToExpress, onData, onTimeout));
+  // If called from the strand of the Face, dispatch directly calls the method
+  m_impl->dispatch(bind(&Impl::asyncExpressInterest, m_impl,
+                        interestToExpress, onData, onTimeout));
 
   return reinterpret_cast<const PendingInterestId*>(interestToExpress.get());
 }
@@ -235,14 +254,14 @@ Face::put(const Data& data)
     dataPtr = make_shared<Data>(data);
   }
 
-  // If the same ioService thread, dispatch directly calls the method
-  m_ioService.dispatch(bind(&Impl::asyncPutData, m_impl, dataPtr));
+  // If called from the strand of the Face, dispatch directly calls the method
+  m_impl->dispatch(bind(&Impl::asyncPutData, m_impl, dataPtr));
 }
 
 void
 Face::removePendingInterest(const PendingInterestId* pendingInterestId)
 {
-  m_ioService.post(bind(&Impl::asyncRemovePendingInterest, m_impl, pendingInterestId));
+  m_impl->post(bind(&Impl::asyncRemovePendingInterest, m_impl, pendingInterestId));
 }
 
 size_t
@@ -343,7 +362,7 @@ Face::setInterestFilter(const InterestFilter& interestFilter,
   shared_ptr<InterestFilterRecord> filter =
     make_shared<InterestFilterRecord>(interestFilter, onInterest);
 
-  getIoService().post(bind(&Impl::asyncSetInterestFilter, m_impl, filter));
+  m_impl->post(bind(&Impl::asyncSetInterestFilter, m_impl, filter));
 
   return reinterpret_cast<const InterestFilterId*>(filter.get());
 }
@@ -386,14 +405,14 @@ Face::registerPrefix(const Name& prefix,
 void
 Face::unsetInterestFilter(const RegisteredPrefixId* registeredPrefixId)
 {
-  m_ioService.post(bind(&Impl::asyncUnregisterPrefix, m_impl, registeredPrefixId,
-                        UnregisterPrefixSuccessCallback(), UnregisterPrefixFailureCallback()));
+  m_impl->post(bind(&Impl::asyncUnregisterPrefix, m_impl, registeredPrefixId,
+                    UnregisterPrefixSuccessCallback(), UnregisterPrefixFailureCallback()));
 }
 
 void
 Face::unsetInterestFilter(const InterestFilterId* interestFilterId)
 {
-  m_ioService.post(bind(&Impl::asyncUnsetInterestFilter, m_impl, interestFilterId));
+  m_impl->post(bind(&Impl::asyncUnsetInterestFilter, m_impl, interestFilterId));
 }
 
 void
@@ -401,13 +420,13 @@ Face::unregisterPrefix(const RegisteredPrefixId* registeredPrefixId,
                        const UnregisterPrefixSuccessCallback& onSuccess,
                        const UnregisterPrefixFailureCallback& onFailure)
 {
-  m_ioService.post(bind(&Impl::asyncUnregisterPrefix, m_impl, registeredPrefixId,
-                        onSuccess, onFailure));
+  m_impl->post(bind(&Impl::asyncUnregisterPrefix, m_impl, registeredPrefixId,
+                    onSuccess, onFailure));
 }
 
 void
 Face::processEvents(const time::milliseconds& timeout/* = time::milliseconds::zero()*/,
-                    bool keepThread/* = false*/)
+                    bool keepThread/* = false*/, size_t nThreads/* = 1*/)
 {
   if (m_ioService.stopped()) {
     m_ioService.reset(); // ensure that run()/poll() will do some work
@@ -432,7 +451,7 @@ Face::processEvents(const time::milliseconds& timeout/* = time::milliseconds::ze
       m_impl->m_ioServiceWork = make_shared<boost::asio::io_service::work>(ref(m_ioService));
     }
 
-    m_ioService.run();
+    runIoService(nThreads);
   }
   catch (Face::ProcessEventsTimeout&) {
     // break
@@ -446,10 +465,44 @@ Face::processEvents(const time::milliseconds& timeout/* = time::milliseconds::ze
   }
 }
 
+void
+Face::runIoService(size_t nThreads)
+{
+  if (nThreads <= 1) {
+    m_ioService.run();
+    return;
+  }
+
+  // The first exception thrown by a handler stops all threads, then is rethrown
+  std::exception_ptr error;
+  std::mutex errorMutex;
+  auto run = [this, &error, &errorMutex] {
+    try {
+      m_ioService.run();
+    }
+    catch (...) {
+      std::lock_guard<std::mutex> lock(errorMutex);
+      if (!error)
+        error = std::current_exception();
+      m_ioService.stop();
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < nThreads; ++i)
+    threads.push_back(std::thread(run));
+  run();
+  for (std::vector<std::thread>::iterator i = threads.begin(); i != threads.end(); ++i)
+    i->join();
+
+  if (error)
+    std::rethrow_exception(error);
+}
+
 void
 Face::shutdown()
 {
-  m_ioService.post(bind(&Face::asyncShutdown, this));
+  m_impl->post(bind(&Face::asyncShutdown, this));
 }
 
 void
@@ -479,30 +532,14 @@ Face::fireProcessEventsTimeout(const boost::system::error_code& error)
 void
 Face::onReceiveElement(const Block& blockFromDaemon)
 {
-  const Block& block = nfd::LocalControlHeader::getPayload(blockFromDaemon);
-
-  if (block.type() == tlv::Interest)
-    {
-      shared_ptr<Interest> interest = make_shared<Interest>();
-      interest->wireDecode(block);
-      if (&block != &blockFromDaemon)
-        interest->getLocalControlHeader().wireDecode(blockFromDaemon);
-
-      m_impl->processInterestFilters(*interest);
-    }
-  else if (block.type() == tlv::Data)
-    {
-      shared_ptr<Data> data = make_shared<Data>();
-      data->wireDecode(block);
-      if (&block != &blockFromDaemon)
-        data->getLocalControlHeader().wireDecode(blockFromDaemon);
-
-      m_impl->satisfyPendingInterests(*data);
-
-      if (m_impl->m_pendingInterestTable.empty()) {
-        m_impl->m_pitTimeoutCheckTimer->cancel(); // this will cause checkPitExpire invocation
-      }
-    }
+  shared_ptr<Interest> interest;
+  shared_ptr<Data> data;
+  Impl::decodePacket(blockFromDaemon, interest, data);
+
+  if (interest != nullptr)
+    m_impl->processInterestFilters(*interest);
+  else if (data != nullptr)
+    m_impl->satisfyPendingInterests(*data);
   // ignore any other type
 }
 
@@ -31,6 +31,7 @@
 #include "interest-filter.hpp"
 #include "data.hpp"
 #include "security/identity-certificate.hpp"
+#include "util/signal.hpp"
 
 namespace boost {
 namespace asio {
@@ -89,6 +90,13 @@ typedef function<void(const std::string&)> UnregisterPrefixFailureCallback;
 
 /**
  * @brief Abstraction to communicate with local or remote NDN forwarder
+ *
+ * expressInterest, removePendingInterest, put, setInterestFilter without prefix registration,
+ * unsetInterestFilter, unregisterPrefix and shutdown may be called from any thread.  The
+ * state of the Face is only used from handlers run through one strand of the io_service, so
+ * that callbacks are never called concurrently, even when several threads run the
+ * io_service (see processEvents).  Operations submitted from other threads are put in a
+ * lock-free queue, and performed in order by the io_service.
  */
 class Face : noncopyable
 {
@@ -193,6 +201,10 @@ public: // consumer
    * @param onData    Callback to be called when a matching data packet is received
    * @param onTimeout (optional) A function object to call if the interest times out
    *
+   * An Interest with the same name, selectors and NextHopFaceId as a pending one is not sent
+   * to the forwarder: the Data retrieved for the pending one is given to both callbacks.
+   * Each Interest still times out on its own lifetime.
+   *
    * @return The pending interest ID which can be used with removePendingInterest
    *
    * @throws Error when Interest size exceeds maximum limit (MAX_NDN_PACKET_SIZE)
@@ -228,6 +240,8 @@ public: // consumer
 
   /**
    * @brief Get number of pending Interests
+   * @note Only accurate when called from a callback of this Face, or while the io_service is
+   *       not running
    */
   size_t
   getNPendingInterests() const;
@@ -505,6 +519,11 @@ public: // IO routine
    * @param timeout     maximum time to block the thread
    * @param keepThread  Keep thread in a blocked state (in event processing), even when
    *                    there are no outstanding events (e.g., no Interest/Data is expected)
+   * @param nThreads    Number of threads running the io_service, the calling one included.
+   *                    The callbacks of this Face are still called one at a time, but other
+   *                    handlers posted to the io_service, e.g., signing or validation
+   *                    work, run concurrently.  The first exception thrown by a handler stops
+   *                    all threads and is rethrown.  Not used when timeout is negative.
    *
    * @throw This may throw an exception for reading data or in the callback for processing
    * the data.  If you call this from an main event loop, you may want to catch and
@@ -512,7 +531,7 @@ public: // IO routine
    */
   void
   processEvents(const time::milliseconds& timeout = time::milliseconds::zero(),
-                bool keepThread = false);
+                bool keepThread = false, size_t nThreads = 1);
 
   /**
    * @brief Shutdown face operations
@@ -534,6 +553,20 @@ public: // IO routine
     return m_ioService;
   }
 
+public: // signals
+  /**
+   * @brief Fires when the bytes queued in the transport reach its high-water mark
+   *
+   * Producers should stop calling put() until onSendQueueDrained fires.
+   * @sa Transport::setSendQueueHighWaterMark
+   */
+  util::signal::Signal<Face> onSendQueueFull;
+
+  /**
+   * @brief Fires when the transport send queue is no longer full
+   */
+  util::signal::Signal<Face> onSendQueueDrained;
+
 private:
 
   /**
@@ -563,6 +596,9 @@ private:
   void
   onReceiveElement(const Block& wire);
 
+  void
+  runIoService(size_t nThreads);
+
   void
   asyncShutdown();
 
@@ -34,6 +34,8 @@
 #include <boost/filesystem.hpp>
 #include <boost/lexical_cast.hpp>
 
+#include <set>
+
 namespace ndn {
 namespace security {
 namespace conf {
@@ -101,6 +103,7 @@ public:
       {
       case tlv::SignatureSha256WithRsa:
       case tlv::SignatureSha256WithEcdsa:
+      case tlv::SignatureSha256Merkle:
         {
           if (!static_cast<bool>(m_keyLocatorChecker))
             throw Error("Strong signature requires KeyLocatorChecker");
@@ -172,6 +175,7 @@ private:
           {
           case tlv::SignatureSha256WithRsa:
           case tlv::SignatureSha256WithEcdsa:
+          case tlv::SignatureSha256Merkle:
             {
               if (!signature.hasKeyLocator()) {
                 onValidationFailed(packet.shared_from_this(),
@@ -242,7 +246,8 @@ public:
       m_signers[(*it)->getName().getPrefix(-1)] = (*it);
 
     if (sigType != tlv::SignatureSha256WithRsa &&
-        sigType != tlv::SignatureSha256WithEcdsa)
+        sigType != tlv::SignatureSha256WithEcdsa &&
+        sigType != tlv::SignatureSha256Merkle)
       {
         throw Error("FixedSigner is only meaningful for strong signature type");
       }
@@ -311,6 +316,7 @@ private:
           {
           case tlv::SignatureSha256WithRsa:
           case tlv::SignatureSha256WithEcdsa:
+          case tlv::SignatureSha256Merkle:
             {
               if (!signature.hasKeyLocator()) {
                 onValidationFailed(packet.shared_from_this(),
@@ -371,6 +377,96 @@ private:
   SignerList m_signers;
 };
 
+/**
+ * @brief Checker of IBAS signed Data.
+ *
+ * The checker accepts a packet only if all identities aggregated into its IBAS signature are in
+ * the allowed signer list, and the aggregated signature verifies.  IBAS signatures do not have a
+ * KeyLocator, so the checker never requires a certificate to be fetched.
+ */
+class IbasChecker : public Checker
+{
+public:
+  /**
+   * @param signerIdentities identities allowed to sign
+   * @param verifier instance verifying the signatures; if null, Validator::verifySignatureIbas
+   *        is used, which loads the public params from ~/.ndn/ibas/params.conf
+   */
+  explicit
+  IbasChecker(const std::vector<std::string>& signerIdentities,
+              const shared_ptr<IbasSigner>& verifier = shared_ptr<IbasSigner>())
+    : m_signerIdentities(signerIdentities.begin(), signerIdentities.end())
+    , m_verifier(verifier)
+  {
+    if (m_signerIdentities.empty())
+      throw Error("IBAS checker requires at least one signer identity");
+  }
+
+  virtual int8_t
+  check(const Data& data,
+        const OnDataChecked& onValidated,
+        const OnDataCheckFailed& onValidationFailed)
+  {
+    const Signature& signature = data.getSignature();
+    if (signature.getType() != tlv::SignatureSha256Ibas)
+      {
+        onValidationFailed(data.shared_from_this(),
+                           "Signature type does not match: " +
+                           boost::lexical_cast<std::string>(tlv::SignatureSha256Ibas) +
+                           "!=" +
+                           boost::lexical_cast<std::string>(signature.getType()));
+        return -1;
+      }
+
+    std::vector<std::string> identities = IbasSigner::getSignerIdentities(data);
+    if (identities.empty())
+      {
+        onValidationFailed(data.shared_from_this(),
+                           "Cannot determine IBAS signer identity");
+        return -1;
+      }
+
+    for (std::vector<std::string>::const_iterator it = identities.begin();
+         it != identities.end(); it++)
+      {
+        if (m_signerIdentities.find(*it) == m_signerIdentities.end())
+          {
+            onValidationFailed(data.shared_from_this(),
+                               "Signer is not in the IBAS signer list: " + *it);
+            return -1;
+          }
+      }
+
+    bool isVerified = static_cast<bool>(m_verifier) ? m_verifier->verifySignature(data) :
+                                                      Validator::verifySignatureIbas(data);
+    if (isVerified)
+      {
+        onValidated(data.shared_from_this());
+        return 1;
+      }
+    else
+      {
+        onValidationFailed(data.shared_from_this(),
+                           "IBAS signature cannot be validated");
+        return -1;
+      }
+  }
+
+  virtual int8_t
+  check(const Interest& interest,
+        const OnInterestChecked& onValidated,
+        const OnInterestCheckFailed& onValidationFailed)
+  {
+    onValidationFailed(interest.shared_from_this(),
+                       "IBAS signed Interest is not supported");
+    return -1;
+  }
+
+private:
+  std::set<std::string> m_signerIdentities;
+  shared_ptr<IbasSigner> m_verifier;
+};
+
 class CheckerFactory
 {
 public:
@@ -398,6 +494,8 @@ public:
       return createHierarchicalChecker(configSection, configFilename);
     else if (boost::iequals(type, "fixed-signer"))
       return createFixedSignerChecker(configSection, configFilename);
+    else if (boost::iequals(type, "ibas"))
+      return createIbasChecker(configSection, configFilename);
     else
       throw Error("Unsupported checker type: " + type);
   }
@@ -482,6 +580,29 @@ private:
                                                                  signers));
   }
 
+  static shared_ptr<Checker>
+  createIbasChecker(const ConfigSection& configSection,
+                    const std::string& configFilename)
+  {
+    ConfigSection::const_iterator propertyIt = configSection.begin();
+    propertyIt++;
+
+    std::vector<std::string> signerIdentities;
+    for (; propertyIt != configSection.end(); propertyIt++)
+      {
+        if (!boost::iequals(propertyIt->first, "signer-identity"))
+          throw Error("Expect <checker.signer-identity> but get <checker." +
+                      propertyIt->first + ">");
+
+        signerIdentities.push_back(propertyIt->second.data());
+      }
+
+    if (signerIdentities.empty())
+      throw Error("Expect <checker.signer-identity>");
+
+    return make_shared<IbasChecker>(signerIdentities);
+  }
+
   static shared_ptr<IdentityCertificate>
   getSigner(const ConfigSection& configSection, const std::string& configFilename)
   {
@@ -549,6 +670,8 @@ private:
       return tlv::SignatureSha256WithRsa;
     else if (boost::iequals(sigType, "ecdsa-sha256"))
       return tlv::SignatureSha256WithEcdsa;
+    else if (boost::iequals(sigType, "merkle-sha256"))
+      return tlv::SignatureSha256Merkle;
     else if (boost::iequals(sigType, "sha256"))
       return tlv::DigestSha256;
     else
@@ -0,0 +1,173 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2015 Regents of the University of Tokyo.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "ibas-backend-daemon.hpp"
+#include "ibas-daemon-tlv.hpp"
+
+#include "../encoding/block-helpers.hpp"
+
+namespace ndn {
+
+IbasBackendDaemon::IbasBackendDaemon(const std::string& socketPath)
+  : m_socketPath(socketPath)
+  , m_socket(m_ioService)
+{
+}
+
+std::string
+IbasBackendDaemon::getDefaultSocketPath(const ConfigFile& config)
+{
+  const ConfigFile::Parsed& parsed = config.getParsedConfiguration();
+  boost::optional<std::string> socketPath = parsed.get_optional<std::string>("ibasd_socket");
+  if (socketPath)
+    return *socketPath;
+
+  const char* home = getenv("HOME");
+  return std::string(home != nullptr ? home : "") + "/.ndn/ibas/ibasd.sock";
+}
+
+void
+IbasBackendDaemon::loadPrivateParams(const std::string& privateParamsFilePath)
+{
+  // The daemon may run in a different working directory
+  std::string path = boost::filesystem::absolute(privateParamsFilePath).string();
+
+  Block request(ibasd::tlv::LoadRequest);
+  request.push_back(dataBlock(ibasd::tlv::PrivateParamsPath, path.data(), path.size()));
+  request.encode();
+  exchange(request);
+
+  m_privateParamsPath = path;
+}
+
+bool
+IbasBackendDaemon::canSign() const
+{
+  return !m_privateParamsPath.empty();
+}
+
+void
+IbasBackendDaemon::sign(const uint8_t* data, size_t dataLength, const std::string& w,
+                        const uint8_t* previous, size_t previousLength, Buffer& signature)
+{
+  if (!canSign())
+    throw Error("IBAS private params are not set");
+
+  Block request(ibasd::tlv::SignRequest);
+  request.push_back(dataBlock(ibasd::tlv::PrivateParamsPath,
+                              m_privateParamsPath.data(), m_privateParamsPath.size()));
+  request.push_back(dataBlock(ibasd::tlv::W, w.data(), w.size()));
+  request.push_back(dataBlock(ibasd::tlv::Message, data, dataLength));
+  if (previous != nullptr)
+    request.push_back(dataBlock(ibasd::tlv::Elements, previous, previousLength));
+  request.encode();
+
+  Block response = exchange(request);
+  Block::element_const_iterator elements = response.find(ibasd::tlv::Elements);
+  if (elements == response.elements_end())
+    throw Error("ndn-ibasd returned no signature");
+
+  signature.insert(signature.end(), elements->value_begin(), elements->value_end());
+}
+
+bool
+IbasBackendDaemon::verify(const MessageList& messages, const std::string& w,
+                          const uint8_t* signature, size_t signatureLength)
+{
+  Block request(ibasd::tlv::VerifyRequest);
+  request.push_back(dataBlock(ibasd::tlv::W, w.data(), w.size()));
+  request.push_back(dataBlock(ibasd::tlv::Elements, signature, signatureLength));
+  for (MessageList::const_iterator it = messages.begin(); it != messages.end(); it++) {
+    Block signedMessage(ibasd::tlv::SignedMessage);
+    signedMessage.push_back(dataBlock(ibasd::tlv::Message,
+                                      it->first.data(), it->first.size()));
+    signedMessage.push_back(dataBlock(ibasd::tlv::Identity,
+                                      it->second.data(), it->second.size()));
+    signedMessage.encode();
+    request.push_back(signedMessage);
+  }
+  request.encode();
+
+  Block response = exchange(request);
+  Block::element_const_iterator isVerified = response.find(ibasd::tlv::IsVerified);
+  return isVerified != response.elements_end() && readNonNegativeInteger(*isVerified) == 1;
+}
+
+Block
+IbasBackendDaemon::exchange(const Block& request)
+{
+  Block response;
+  try {
+    response = exchangeOnce(request);
+  }
+  catch (const boost::system::system_error&) {
+    // The daemon may have been restarted since the last request, try a new connection once
+    close();
+    try {
+      response = exchangeOnce(request);
+    }
+    catch (const boost::system::system_error& error) {
+      close();
+      throw Error("Cannot reach ndn-ibasd at " + m_socketPath + ": " + error.what());
+    }
+  }
+
+  response.parse();
+  Block::element_const_iterator statusCode = response.find(ibasd::tlv::StatusCode);
+  if (response.type() != ibasd::tlv::Response || statusCode == response.elements_end())
+    throw Error("Malformed response from ndn-ibasd");
+
+  if (readNonNegativeInteger(*statusCode) != ibasd::STATUS_OK) {
+    Block::element_const_iterator statusText = response.find(ibasd::tlv::StatusText);
+    throw Error("ndn-ibasd: " + (statusText == response.elements_end() ? std::string("failed") :
+                                 std::string(statusText->value_begin(),
+                                             statusText->value_end())));
+  }
+  return response;
+}
+
+Block
+IbasBackendDaemon::exchangeOnce(const Block& request)
+{
+  if (!m_socket.is_open())
+    m_socket.connect(boost::asio::local::stream_protocol::endpoint(m_socketPath));
+
+  boost::asio::write(m_socket, boost::asio::buffer(request.wire(), request.size()));
+
+  // Responses come one at a time, read until a whole TLV block is received
+  Buffer input;
+  uint8_t chunk[MAX_NDN_PACKET_SIZE];
+  Block response;
+  while (input.empty() || !Block::fromBuffer(input.buf(), input.size(), response)) {
+    size_t nBytes = m_socket.read_some(boost::asio::buffer(chunk, sizeof(chunk)));
+    input.insert(input.end(), chunk, chunk + nBytes);
+  }
+  return response;
+}
+
+void
+IbasBackendDaemon::close()
+{
+  boost::system::error_code error; // to silently ignore all errors
+  m_socket.close(error);
+}
+
+} // namespace ndn
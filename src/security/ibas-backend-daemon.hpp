@@ -0,0 +1,98 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2015 Regents of the University of Tokyo.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_SECURITY_IBAS_BACKEND_DAEMON_HPP
+#define NDN_SECURITY_IBAS_BACKEND_DAEMON_HPP
+
+#include "ibas-backend.hpp"
+#include "../encoding/block.hpp"
+#include "../util/config-file.hpp"
+
+#include <boost/asio.hpp>
+
+namespace ndn {
+
+/**
+ * @brief IBAS backend which forwards signing and verification to a local ndn-ibasd
+ *
+ * The daemon loads the pairing params and private params once and keeps them, together with
+ * the precomputed tables of its backend, across requests from all local applications.
+ * The private params never enter the client process: loadPrivateParams only tells the
+ * daemon which identity file to sign with.
+ *
+ * Requests are sent synchronously over a Unix stream socket.  The connection is opened at
+ * the first request and reopened once if the daemon has been restarted in between.
+ */
+class IbasBackendDaemon : public IbasBackend
+{
+public:
+  explicit
+  IbasBackendDaemon(const std::string& socketPath);
+
+  /**
+   * @brief Returns the "ibasd_socket" of client.conf, or ~/.ndn/ibas/ibasd.sock
+   */
+  static std::string
+  getDefaultSocketPath(const ConfigFile& config);
+
+  /**
+   * @brief Asks the daemon to load the private params, which are used in later sign calls
+   * @throws Error if the daemon is not reachable or cannot load the file
+   */
+  virtual void
+  loadPrivateParams(const std::string& privateParamsFilePath);
+
+  virtual bool
+  canSign() const;
+
+  virtual void
+  sign(const uint8_t* data, size_t dataLength, const std::string& w,
+       const uint8_t* previous, size_t previousLength, Buffer& signature);
+
+  virtual bool
+  verify(const MessageList& messages, const std::string& w,
+         const uint8_t* signature, size_t signatureLength);
+
+private:
+  /**
+   * @brief Sends a request and waits for its response
+   * @throws Error on a connection failure or if the response status is not STATUS_OK
+   */
+  Block
+  exchange(const Block& request);
+
+  Block
+  exchangeOnce(const Block& request);
+
+  void
+  close();
+
+private:
+  std::string m_socketPath;
+  std::string m_privateParamsPath;
+
+  boost::asio::io_service m_ioService;
+  boost::asio::local::stream_protocol::socket m_socket;
+};
+
+} // namespace ndn
+
+#endif // NDN_SECURITY_IBAS_BACKEND_DAEMON_HPP
@@ -0,0 +1,352 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2015 Regents of the University of Tokyo.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ *
+ * @author Byambajav Namsraijav  <http://byambajav.com/>
+ */
+
+#include "ibas-backend-pbc.hpp"
+
+#include "../util/ibas-hash.hpp"
+
+#include <fstream>
+#include <iostream>
+
+namespace ndn {
+
+const static int DEFAULT_PARAMS_FILE_SIZE = 16384;
+const static int PARAMS_STORE_BASE = 10; // The PBC library does not work properly otherwise
+
+/* Constructor and destructor */
+
+// Loads the public parameters: (G_1, G_2, e, P, Q)
+IbasBackendPbc::IbasBackendPbc(const std::string& publicParamsFilePath) {
+  // The following cast is used frequently in this class
+  static_assert(std::is_same<unsigned char, uint8_t>::value, "uint8_t is not unsigned char");
+
+  // Read pairing parameters
+  char buffer[DEFAULT_PARAMS_FILE_SIZE];
+  FILE *fp = fopen(publicParamsFilePath.c_str(), "r");
+  if (!fp) pbc_die("error opening %s", publicParamsFilePath.c_str());
+
+  size_t count = fread(buffer, 1, DEFAULT_PARAMS_FILE_SIZE, fp);
+  if (!count) pbc_die("input error");
+  fclose(fp);
+
+  if (pairing_init_set_buf(pairing, buffer, count)) pbc_die("pairing init failed");
+  if (!pairing_is_symmetric(pairing)) pbc_die("pairing must be symmetric");
+
+  // Read P and Q using ifstream, since that is the easier way in C++
+  element_init_G1(P, pairing);
+  element_init_G1(Q, pairing);
+
+  std::ifstream infile(publicParamsFilePath);
+  std::string param, value, value2;
+  while (infile >> param >> value) {
+    if (param == "P") {
+      infile >> value2;
+      value += value2;
+      if (!element_set_str(P, value.c_str(), PARAMS_STORE_BASE)) {
+        pbc_die("Could not read P correctly");
+      }
+    } else if (param == "Q") {
+      infile >> value2;
+      value += value2;
+      if (!element_set_str(Q, value.c_str(), PARAMS_STORE_BASE)) {
+        pbc_die("Could not read Q correctly");
+      }
+    }
+  }
+}
+
+IbasBackendPbc::~IbasBackendPbc() {
+  if (m_hasPrecomputedP) {
+    element_pp_clear(m_precomputedP);
+  }
+
+  element_clear(P);
+  element_clear(Q);
+
+  if (m_canSign) {
+    element_clear(s_P_0);
+    element_clear(s_P_1);
+  }
+
+  pairing_clear(pairing);
+}
+
+/* Public methods */
+
+/**
+ * @brief Reads a point of G1 from its string form
+ * @return false if the string is malformed, or the point is not a non-zero element of G1
+ */
+static bool readPointOfG1(element_t point, const std::string& str, pairing_t pairing) {
+  if (!element_set_str(point, str.c_str(), PARAMS_STORE_BASE) || element_is0(point)) {
+    return false;
+  }
+
+  // A point read from a string is not checked by PBC: it is in G1 iff r * point is zero
+  element_t product;
+  element_init_G1(product, pairing);
+  element_pow_mpz(product, point, pairing->r);
+  bool isInG1 = element_is0(product);
+  element_clear(product);
+  return isInG1;
+}
+
+// Loads the private parameters: (id, s_P_0, s_P_1)
+void IbasBackendPbc::loadPrivateParams(const std::string& privateParamsFilePath) {
+  // The path may come from a client of the IBAS daemon, so the file is fully checked before the
+  // params are replaced, and errors are thrown rather than passed to pbc_die
+  std::ifstream infile(privateParamsFilePath);
+  if (!infile) {
+    throw Error("Cannot open " + privateParamsFilePath);
+  }
+
+  std::string newIdentity, sP0String, sP1String;
+  std::string param, value, value2;
+  while (infile >> param >> value) {
+    if (param == "id") {
+      newIdentity = value;
+    } else if (param == "s_P_0" && infile >> value2) {
+      sP0String = value + value2;
+    } else if (param == "s_P_1" && infile >> value2) {
+      sP1String = value + value2;
+    }
+  }
+  if (newIdentity.empty() || sP0String.empty() || sP1String.empty()) {
+    throw Error("Missing private params in " + privateParamsFilePath);
+  }
+
+  element_t sP0, sP1;
+  element_init_G1(sP0, pairing);
+  element_init_G1(sP1, pairing);
+  bool isValid = readPointOfG1(sP0, sP0String, pairing) && readPointOfG1(sP1, sP1String, pairing);
+  if (isValid) {
+    // If it is first time, init the elements
+    if (!m_canSign) {
+      element_init_G1(s_P_0, pairing);
+      element_init_G1(s_P_1, pairing);
+      m_canSign = true;
+    }
+    element_set(s_P_0, sP0);
+    element_set(s_P_1, sP1);
+    identity = newIdentity;
+  }
+  element_clear(sP0);
+  element_clear(sP1);
+
+  if (!isValid) {
+    throw Error("Malformed private params in " + privateParamsFilePath);
+  }
+}
+
+bool IbasBackendPbc::canSign() const {
+  return m_canSign;
+}
+
+void IbasBackendPbc::sign(const uint8_t* data, size_t dataLength, const std::string& w,
+                          const uint8_t* previous, size_t previousLength, Buffer& signature) {
+  element_t T, S;
+  element_init_G1(T, pairing);
+  element_init_G1(S, pairing);
+
+  // Compute T and S
+  signInternal(T, S, data, dataLength, w);
+
+  if (previous != nullptr) {
+    // NOTE: The previous signature is aggregated without being verified
+    element_t T_old, S_old;
+    element_init_G1(T_old, pairing);
+    element_init_G1(S_old, pairing);
+    if (loadSignature(T_old, S_old, previous, previousLength)) {
+      element_add(T, T, T_old);
+      element_add(S, S, S_old);
+    }
+    element_clear(T_old);
+    element_clear(S_old);
+  }
+
+  // Compress T_i and S_i into unsigned char arrays
+  size_t element_size = element_length_in_bytes_compressed(T); // T and S have same size
+  unsigned char T_compressed[element_size];
+  unsigned char S_compressed[element_size];
+  element_to_bytes_compressed(T_compressed, T);
+  element_to_bytes_compressed(S_compressed, S);
+
+  signature.insert(signature.end(), T_compressed, T_compressed + element_size);
+  signature.insert(signature.end(), S_compressed, S_compressed + element_size);
+
+  element_clear(T);
+  element_clear(S);
+}
+
+bool IbasBackendPbc::verify(const MessageList& messages, const std::string& w,
+                            const uint8_t* signature, size_t signatureLength) {
+  // Load the aggregated signature
+  element_t T_n, S_n;
+  element_init_G1(T_n, pairing);
+  element_init_G1(S_n, pairing);
+  if (messages.empty() || !loadSignature(T_n, S_n, signature, signatureLength)) {
+    // Could not load signature variables successfully
+    element_clear(T_n);
+    element_clear(S_n);
+    return false;
+  }
+
+  // Compute P_w = H_{2}(w)
+  element_t P_w;
+  element_init_G1(P_w, pairing);
+  util::calculateH2(P_w, w, pairing);
+
+  // Compute \sum_{i} (P_{i,0} + c_{i}P_{i,1}), where c_i = H_{3}(m_i, ID_i, w)
+  element_t c_i;
+  element_t P_i_0;
+  element_t P_i_1;
+  element_t g1Sum;
+  element_init_Zr(c_i, pairing);
+  element_init_G1(P_i_0, pairing);
+  element_init_G1(P_i_1, pairing);
+  element_init_G1(g1Sum, pairing);
+  element_set0(g1Sum);
+
+  for (MessageList::const_iterator it = messages.begin(); it != messages.end(); it++) {
+    util::calculateH3(c_i, it->first + it->second + w, pairing);
+    util::calculateH1(P_i_0, it->second + "0", pairing);
+    util::calculateH1(P_i_1, it->second + "1", pairing);
+
+    element_mul_zn(P_i_1, P_i_1, c_i); // c_{i}P_{i,1}
+    element_add(g1Sum, g1Sum, P_i_0);
+    element_add(g1Sum, g1Sum, P_i_1);
+  }
+
+  // Verify signature
+  element_t gtTemp1;
+  element_t gtTemp2;
+  element_init_GT(gtTemp1, pairing);
+  element_init_GT(gtTemp2, pairing);
+
+  element_pairing(gtTemp1, T_n, P_w); // e(T_{n}, P_{w})
+  element_pairing(gtTemp2, Q, g1Sum); // e(Q, \sum_{i} (P_{i,0} + c_{i}P_{i,1}))
+  element_mul(gtTemp1, gtTemp1, gtTemp2);
+
+  element_pairing(gtTemp2, S_n, P); // e(S_{n}, P)
+
+  bool verified = !element_cmp(gtTemp1, gtTemp2);
+
+  element_clear(P_w);
+  element_clear(c_i);
+  element_clear(P_i_0);
+  element_clear(P_i_1);
+  element_clear(g1Sum);
+
+  element_clear(T_n);
+  element_clear(S_n);
+
+  element_clear(gtTemp1);
+  element_clear(gtTemp2);
+
+  return verified;
+}
+
+void IbasBackendPbc::setupPkgParams(const std::string& publicParamsFilePath,
+                                    const std::string& secretParamsFilePath) {
+  FILE *pkgSecretParamsFile = fopen(secretParamsFilePath.c_str(), "w");
+  FILE *pkgPublicParamsFile = fopen(publicParamsFilePath.c_str(), "a");
+
+  //generate secret key, this code was used only once to generate the parameters
+  element_t s;
+  element_init_Zr(s, pairing);
+  element_random(s);
+  element_fprintf(pkgSecretParamsFile, "s %B\n", s);
+  element_random(P);
+  if (m_hasPrecomputedP) {
+    element_pp_clear(m_precomputedP);
+    m_hasPrecomputedP = false;
+  }
+  element_fprintf(pkgPublicParamsFile, "P %B\n", P);
+  element_mul_zn(Q, P, s); // Q = sP
+  element_fprintf(pkgPublicParamsFile, "Q %B\n", Q);
+  element_clear(s);
+
+  // Close the parameter files
+  fclose(pkgPublicParamsFile);
+  fclose(pkgSecretParamsFile);
+  std::cout << "Updated PKG's public parameters at: " << publicParamsFilePath << std::endl;
+  std::cout << "Stored PKG's secret parameters at: " << secretParamsFilePath << std::endl;
+}
+
+void IbasBackendPbc::setupUserParams(const std::string& identity) {
+  util::generateSecretKeyForIdentity(identity, pairing);
+}
+
+/* Private methods */
+
+void IbasBackendPbc::signInternal(element_t T, element_t S, const uint8_t* data,
+                                  size_t dataLength, const std::string& w) {
+  element_t P_w;
+  element_t c, r;
+  element_t temp1;
+
+  element_init_G1(P_w, pairing);
+  element_init_Zr(c, pairing);
+  element_init_Zr(r, pairing);
+  element_init_G1(temp1, pairing);
+
+  // Compute P_w = H_{2}(w)
+  util::calculateH2(P_w, w, pairing);
+
+  // Compute C_i = H_{3}(m_i, ID_i, w)
+  util::calculateH3(c, std::string(data, data + dataLength) + identity + w, pairing);
+
+  element_random(r);
+
+  // Compute T_i = r_{i}P
+  if (!m_hasPrecomputedP) {
+    element_pp_init(m_precomputedP, P);
+    m_hasPrecomputedP = true;
+  }
+  element_pp_pow_zn(T, r, m_precomputedP); // T_i = r_{i}P
+
+  // Compute S_i = r_{i}P_{w} + sP_{i,0} + c_{i}sP_{i,1}
+  element_mul_zn(S, P_w, r); // r_{i}P_{w}
+  element_mul_zn(temp1, s_P_1, c); // c_{i}sP_{i,1}
+  element_add(S, S, s_P_0);
+  element_add(S, S, temp1);
+
+  element_clear(P_w);
+  element_clear(c);
+  element_clear(r);
+  element_clear(temp1);
+}
+
+bool IbasBackendPbc::loadSignature(element_t T, element_t S, const uint8_t* signature,
+                                   size_t signatureLength) {
+  size_t element_size = element_length_in_bytes_compressed(T);
+  if (signatureLength != 2 * element_size) {
+    return false;
+  }
+
+  element_from_bytes_compressed(T, (unsigned char*) signature);
+  element_from_bytes_compressed(S, (unsigned char*) (signature + element_size));
+  return true;
+}
+
+} // namespace ndn
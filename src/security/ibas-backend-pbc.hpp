@@ -0,0 +1,103 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2015 Regents of the University of Tokyo.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ *
+ * @author Byambajav Namsraijav  <http://byambajav.com/>
+ */
+
+#ifndef NDN_SECURITY_IBAS_BACKEND_PBC_HPP
+#define NDN_SECURITY_IBAS_BACKEND_PBC_HPP
+
+#include <pbc/pbc.h>
+
+#include "ibas-backend.hpp"
+
+namespace ndn {
+
+/**
+ * @brief IBAS backend using the PBC library
+ */
+class IbasBackendPbc : public IbasBackend
+{
+public:
+  /**
+   * @brief Initializes the pairing and public params
+   */
+  explicit
+  IbasBackendPbc(const std::string& publicParamsFilePath);
+
+  virtual
+  ~IbasBackendPbc();
+
+  virtual void
+  loadPrivateParams(const std::string& privateParamsFilePath);
+
+  virtual bool
+  canSign() const;
+
+  virtual void
+  sign(const uint8_t* data, size_t dataLength, const std::string& w,
+       const uint8_t* previous, size_t previousLength, Buffer& signature);
+
+  virtual bool
+  verify(const MessageList& messages, const std::string& w,
+         const uint8_t* signature, size_t signatureLength);
+
+  virtual void
+  setupPkgParams(const std::string& publicParamsFilePath,
+                 const std::string& secretParamsFilePath);
+
+  virtual void
+  setupUserParams(const std::string& identity);
+
+private:
+  /**
+   * @brief Calculates T, S signatures of given data using given data and w parameters.
+   *        The method assumes that T and S elements are initialized previously.
+   */
+  void
+  signInternal(element_t T, element_t S, const uint8_t* data, size_t dataLength,
+               const std::string& w);
+
+  /**
+   * @brief Loads compressed T, S.  The method assumes that T and S elements are initialized
+   *        previously.
+   *
+   * @return True if signature variables was successfully loaded, false otherwise.
+   */
+  bool
+  loadSignature(element_t T, element_t S, const uint8_t* signature, size_t signatureLength);
+
+private:
+  bool m_canSign = false;
+
+  // Public params (public in terms of IBAS)
+  pairing_t pairing;
+  element_t P, Q;
+  bool m_hasPrecomputedP = false;
+  element_pp_t m_precomputedP; // Fixed-base table of P, initialized at the first signing
+
+  // Private params
+  std::string identity;
+  element_t s_P_0, s_P_1;
+};
+
+} // namespace ndn
+
+#endif // NDN_SECURITY_IBAS_BACKEND_PBC_HPP
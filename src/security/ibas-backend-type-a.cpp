@@ -0,0 +1,300 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2015 Regents of the University of Tokyo.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "ibas-backend-type-a.hpp"
+
+#include "../util/crypto.hpp"
+#include "../util/random.hpp"
+
+#include <boost/algorithm/string.hpp>
+
+#include <fstream>
+
+namespace ndn {
+
+static const size_t MAX_CACHED_IDENTITIES = 1024;
+
+/**
+ * @brief Reads a PBC formatted params file as "<name> <value>" lines
+ */
+static std::map<std::string, std::string>
+readParamsFile(const std::string& filePath)
+{
+  std::ifstream infile(filePath);
+  if (!infile.is_open())
+    throw IbasBackend::Error("Cannot open " + filePath);
+
+  std::map<std::string, std::string> params;
+  std::string line;
+  while (std::getline(infile, line)) {
+    boost::algorithm::trim(line);
+    size_t pos = line.find(' ');
+    if (pos == std::string::npos)
+      continue;
+    params[line.substr(0, pos)] = boost::algorithm::trim_copy(line.substr(pos + 1));
+  }
+  return params;
+}
+
+template<size_t N>
+static typename IbasBackendTypeA<N>::Integer
+parseInteger(const std::map<std::string, std::string>& params, const std::string& name)
+{
+  std::map<std::string, std::string>::const_iterator it = params.find(name);
+  if (it == params.end())
+    throw IbasBackend::Error("Missing Type A param: " + name);
+
+  typename IbasBackendTypeA<N>::Integer value;
+  if (!value.fromDecimal(it->second))
+    throw IbasBackend::Error("Cannot read Type A param: " + name);
+  return value;
+}
+
+template<size_t N>
+IbasBackendTypeA<N>::IbasBackendTypeA(const std::string& publicParamsFilePath)
+  : m_canSign(false)
+{
+  std::map<std::string, std::string> params = readParamsFile(publicParamsFilePath);
+  if (params["type"] != "a")
+    throw Error("Only Type A pairing params are supported");
+
+  m_curve.reset(new Curve(parseInteger<N>(params, "q"),
+                          parseInteger<N>(params, "r"),
+                          parseInteger<N>(params, "h")));
+
+  if (params.count("P") == 0 || params.count("Q") == 0)
+    throw Error("Missing P or Q in " + publicParamsFilePath);
+  m_p = parsePoint(params["P"]);
+  m_q = parsePoint(params["Q"]);
+}
+
+template<size_t N>
+void
+IbasBackendTypeA<N>::loadPrivateParams(const std::string& privateParamsFilePath)
+{
+  std::map<std::string, std::string> params = readParamsFile(privateParamsFilePath);
+  if (params.count("id") == 0 || params.count("s_P_0") == 0 || params.count("s_P_1") == 0)
+    throw Error("Missing private params in " + privateParamsFilePath);
+
+  // the old params are kept if the new ones cannot be read
+  Point sP0 = parsePoint(params["s_P_0"]);
+  Point sP1 = parsePoint(params["s_P_1"]);
+  m_identity = params["id"];
+  m_sP0 = sP0;
+  m_sP1 = sP1;
+  m_canSign = true;
+}
+
+template<size_t N>
+bool
+IbasBackendTypeA<N>::canSign() const
+{
+  return m_canSign;
+}
+
+template<size_t N>
+void
+IbasBackendTypeA<N>::sign(const uint8_t* data, size_t dataLength, const std::string& w,
+                          const uint8_t* previous, size_t previousLength, Buffer& signature)
+{
+  const Curve& curve = *m_curve;
+
+  // Compute P_w = H_{2}(w) and c_i = H_{3}(m_i, ID_i, w)
+  Point pW = calculateH2(w);
+  Integer c = calculateH3(std::string(data, data + dataLength) + m_identity + w);
+  Integer r = generateRandomScalar();
+
+  if (m_pTable.empty())
+    m_pTable = curve.precompute(m_p);
+
+  // T_i = r_{i}P, S_i = r_{i}P_{w} + sP_{i,0} + c_{i}sP_{i,1}
+  Point t = curve.mulPrecomputed(m_pTable, r);
+  Point s = curve.add(curve.add(curve.mul(pW, r), m_sP0), curve.mul(m_sP1, c));
+
+  if (previous != nullptr) {
+    // NOTE: The previous signature is aggregated without being verified
+    Point tOld, sOld;
+    if (loadSignature(tOld, sOld, previous, previousLength)) {
+      t = curve.add(t, tOld);
+      s = curve.add(s, sOld);
+    }
+  }
+
+  size_t elementSize = curve.getCompressedLength();
+  size_t offset = signature.size();
+  signature.resize(offset + 2 * elementSize);
+  curve.toBytesCompressed(signature.buf() + offset, t);
+  curve.toBytesCompressed(signature.buf() + offset + elementSize, s);
+}
+
+template<size_t N>
+bool
+IbasBackendTypeA<N>::verify(const MessageList& messages, const std::string& w,
+                            const uint8_t* signature, size_t signatureLength)
+{
+  const Curve& curve = *m_curve;
+
+  Point t, s;
+  if (messages.empty() || !loadSignature(t, s, signature, signatureLength))
+    return false;
+
+  Point pW = calculateH2(w);
+
+  // \sum_{i} (P_{i,0} + c_{i}P_{i,1})
+  Point sum = curve.infinity();
+  for (MessageList::const_iterator it = messages.begin(); it != messages.end(); it++) {
+    Integer c = calculateH3(it->first + it->second + w);
+    const std::pair<Point, Point>& points = getIdentityPoints(it->second);
+    sum = curve.add(sum, points.first);
+    sum = curve.add(sum, curve.mul(points.second, c));
+  }
+
+  // e(T_{n}, P_{w}) e(Q, sum) == e(S_{n}, P), checked with a single final exponentiation as
+  // e(T_{n}, P_{w}) e(Q, sum) e(S_{n}, P)^{-1} == 1
+  typename Curve::Fq2 f, g;
+  f = curve.millerLoop(t, pW);
+  g = curve.millerLoop(m_q, sum);
+  curve.fq2Mul(f, f, g);
+  g = curve.millerLoop(s, m_p);
+  curve.fq2Conj(g, g);
+  curve.fq2Mul(f, f, g);
+
+  return curve.isEqual(curve.finalExponentiation(f), curve.fq2One());
+}
+
+template<size_t N>
+typename IbasBackendTypeA<N>::Point
+IbasBackendTypeA<N>::calculateH1(const std::string& str) const
+{
+  uint8_t digest[crypto::SHA256_DIGEST_SIZE];
+  ndn_digestSha256(reinterpret_cast<const uint8_t*>(str.data()), str.size(), digest);
+  return m_curve->hashToPoint(digest, crypto::SHA256_DIGEST_SIZE);
+}
+
+template<size_t N>
+typename IbasBackendTypeA<N>::Point
+IbasBackendTypeA<N>::calculateH2(const std::string& str) const
+{
+  return calculateH1(str + "dummy");
+}
+
+template<size_t N>
+typename IbasBackendTypeA<N>::Integer
+IbasBackendTypeA<N>::calculateH3(const std::string& str) const
+{
+  uint8_t digest[crypto::SHA256_DIGEST_SIZE];
+  ndn_digestSha256(reinterpret_cast<const uint8_t*>(str.data()), str.size(), digest);
+  return m_curve->hashToScalar(digest, crypto::SHA256_DIGEST_SIZE);
+}
+
+template<size_t N>
+typename IbasBackendTypeA<N>::Point
+IbasBackendTypeA<N>::parsePoint(const std::string& str) const
+{
+  std::string value = boost::algorithm::trim_copy(str);
+  size_t comma = value.find(',');
+  if (value.size() < 2 || value[0] != '[' || value[value.size() - 1] != ']' ||
+      comma == std::string::npos)
+    throw Error("Cannot read point: " + str);
+
+  Integer x, y;
+  if (!x.fromDecimal(boost::algorithm::trim_copy(value.substr(1, comma - 1))) ||
+      !y.fromDecimal(boost::algorithm::trim_copy(value.substr(comma + 1,
+                                                              value.size() - comma - 2))))
+    throw Error("Cannot read point: " + str);
+
+  const typename Curve::Field& field = m_curve->getField();
+  if (Integer::compare(x, field.getModulus()) >= 0 ||
+      Integer::compare(y, field.getModulus()) >= 0)
+    throw Error("Point is out of range: " + str);
+
+  Point p;
+  p.x = field.fromInteger(x);
+  p.y = field.fromInteger(y);
+  p.isInfinity = false;
+
+  // the point must be on y^2 = x^3 + x, and in the subgroup of order r
+  typename Curve::Fq lhs, rhs;
+  field.sqr(lhs, p.y);
+  field.sqr(rhs, p.x);
+  field.mul(rhs, rhs, p.x);
+  field.add(rhs, rhs, p.x);
+  if (!field.isEqual(lhs, rhs) || !m_curve->mul(p, m_curve->getOrder()).isInfinity)
+    throw Error("Point is not in G1: " + str);
+  return p;
+}
+
+template<size_t N>
+bool
+IbasBackendTypeA<N>::loadSignature(Point& t, Point& s, const uint8_t* signature,
+                                   size_t signatureLength) const
+{
+  size_t elementSize = m_curve->getCompressedLength();
+  if (signatureLength != 2 * elementSize)
+    return false;
+
+  return m_curve->fromBytesCompressed(t, signature) &&
+         m_curve->fromBytesCompressed(s, signature + elementSize);
+}
+
+template<size_t N>
+typename IbasBackendTypeA<N>::Integer
+IbasBackendTypeA<N>::generateRandomScalar() const
+{
+  const Integer& order = m_curve->getOrder();
+  size_t bits = order.bitLength();
+
+  // Rejection sampling of uniformly random integers in [1, r)
+  Integer r;
+  do {
+    for (size_t i = 0; i < N; i++) {
+      if (i * 64 >= bits)
+        r.limb[i] = 0;
+      else if (bits - i * 64 < 64)
+        r.limb[i] = random::generateSecureWord64() & ((uint64_t(1) << (bits - i * 64)) - 1);
+      else
+        r.limb[i] = random::generateSecureWord64();
+    }
+  } while (r.isZero() || Integer::compare(r, order) >= 0);
+  return r;
+}
+
+template<size_t N>
+const std::pair<typename IbasBackendTypeA<N>::Point, typename IbasBackendTypeA<N>::Point>&
+IbasBackendTypeA<N>::getIdentityPoints(const std::string& identity)
+{
+  typename std::map<std::string, std::pair<Point, Point> >::iterator it =
+    m_identityPoints.find(identity);
+  if (it != m_identityPoints.end())
+    return it->second;
+
+  if (m_identityPoints.size() >= MAX_CACHED_IDENTITIES)
+    m_identityPoints.clear();
+
+  std::pair<Point, Point> points(calculateH1(identity + "0"), calculateH1(identity + "1"));
+  return m_identityPoints.insert(std::make_pair(identity, points)).first->second;
+}
+
+template class IbasBackendTypeA<4>;
+template class IbasBackendTypeA<6>;
+template class IbasBackendTypeA<8>;
+
+} // namespace ndn
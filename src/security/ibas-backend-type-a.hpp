@@ -0,0 +1,133 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2015 Regents of the University of Tokyo.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_SECURITY_IBAS_BACKEND_TYPE_A_HPP
+#define NDN_SECURITY_IBAS_BACKEND_TYPE_A_HPP
+
+#include "ibas-backend.hpp"
+#include "ibas-type-a-curve.hpp"
+
+#include <map>
+
+namespace ndn {
+
+/**
+ * @brief IBAS backend for the Type A pairing, using fixed-limb Montgomery arithmetic
+ *
+ * @tparam N Number of 64-bit limbs of the field characteristic q.  IbasBackend::create
+ *           picks the smallest instantiated N (4, 6 or 8) that fits q of the params file.
+ */
+template<size_t N>
+class IbasBackendTypeA : public IbasBackend
+{
+public:
+  typedef ibas::TypeACurve<N> Curve;
+  typedef typename Curve::Integer Integer;
+  typedef typename Curve::Point Point;
+
+  /**
+   * @brief Reads the Type A pairing params (q, h, r) and P, Q from a PBC formatted file
+   * @throws IbasBackend::Error if the file cannot be parsed
+   */
+  explicit
+  IbasBackendTypeA(const std::string& publicParamsFilePath);
+
+  virtual void
+  loadPrivateParams(const std::string& privateParamsFilePath);
+
+  virtual bool
+  canSign() const;
+
+  virtual void
+  sign(const uint8_t* data, size_t dataLength, const std::string& w,
+       const uint8_t* previous, size_t previousLength, Buffer& signature);
+
+  virtual bool
+  verify(const MessageList& messages, const std::string& w,
+         const uint8_t* signature, size_t signatureLength);
+
+  const Curve&
+  getCurve() const
+  {
+    return *m_curve;
+  }
+
+  /// @brief H_{1}:{0,1}*->G1
+  Point
+  calculateH1(const std::string& str) const;
+
+  /// @brief H_{2}:{0,1}*->G1
+  Point
+  calculateH2(const std::string& str) const;
+
+  /// @brief H_{3}:{0,1}*->Z/rZ
+  Integer
+  calculateH3(const std::string& str) const;
+
+private:
+  /**
+   * @brief Parses a point printed by PBC as "[x, y]" in decimal
+   */
+  Point
+  parsePoint(const std::string& str) const;
+
+  /**
+   * @brief Loads compressed T, S
+   * @return false if the signature is malformed
+   */
+  bool
+  loadSignature(Point& t, Point& s, const uint8_t* signature, size_t signatureLength) const;
+
+  Integer
+  generateRandomScalar() const;
+
+  /**
+   * @brief Returns P_{ID,0} = H_{1}(ID || 0) and P_{ID,1} = H_{1}(ID || 1), cached per identity
+   */
+  const std::pair<Point, Point>&
+  getIdentityPoints(const std::string& identity);
+
+private:
+  unique_ptr<Curve> m_curve;
+
+  // Public params (public in terms of IBAS)
+  Point m_p;
+  Point m_q;
+  std::vector<Point> m_pTable; ///< 2^{i}P, computed at the first signing
+
+  // Private params
+  bool m_canSign;
+  std::string m_identity;
+  Point m_sP0;
+  Point m_sP1;
+
+  // Identities of a trust domain are few, while hashing them to G1 is the costliest part
+  // of the verification after the pairings
+  std::map<std::string, std::pair<Point, Point> > m_identityPoints;
+};
+
+extern template class IbasBackendTypeA<4>;
+extern template class IbasBackendTypeA<6>;
+extern template class IbasBackendTypeA<8>;
+
+} // namespace ndn
+
+#endif // NDN_SECURITY_IBAS_BACKEND_TYPE_A_HPP
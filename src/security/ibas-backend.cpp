@@ -0,0 +1,97 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2015 Regents of the University of Tokyo.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "ibas-backend.hpp"
+#include "ibas-backend-pbc.hpp"
+#include "ibas-backend-type-a.hpp"
+#include "ibas-backend-daemon.hpp"
+
+#include <fstream>
+
+namespace ndn {
+
+/**
+ * @brief Returns the bit length of q in a PBC formatted params file, or
+ *        std::numeric_limits<size_t>::max() if q has more than 512 bits
+ * @throw IbasBackend::Error q is missing or is not a decimal number
+ */
+static size_t
+getFieldBitLength(const std::string& publicParamsFilePath)
+{
+  std::ifstream infile(publicParamsFilePath);
+  std::string param, value;
+  while (infile >> param >> value) {
+    if (param != "q")
+      continue;
+
+    if (value.find_first_not_of("0123456789") != std::string::npos)
+      throw IbasBackend::Error("q is not a decimal number in " + publicParamsFilePath);
+
+    ibas::FixedUint<8> q;
+    if (!q.fromDecimal(value))
+      return std::numeric_limits<size_t>::max();
+    return q.bitLength();
+  }
+
+  throw IbasBackend::Error("Cannot find q in " + publicParamsFilePath);
+}
+
+unique_ptr<IbasBackend>
+IbasBackend::create(const std::string& backendType, const std::string& publicParamsFilePath)
+{
+  if (backendType.empty() || backendType == "pbc") {
+    return unique_ptr<IbasBackend>(new IbasBackendPbc(publicParamsFilePath));
+  }
+  else if (backendType == "type-a") {
+    size_t bits = getFieldBitLength(publicParamsFilePath);
+    if (bits > 512)
+      throw Error("Type A backend supports q of at most 512 bits");
+    else if (bits <= 256)
+      return unique_ptr<IbasBackend>(new IbasBackendTypeA<4>(publicParamsFilePath));
+    else if (bits <= 384)
+      return unique_ptr<IbasBackend>(new IbasBackendTypeA<6>(publicParamsFilePath));
+    else
+      return unique_ptr<IbasBackend>(new IbasBackendTypeA<8>(publicParamsFilePath));
+  }
+  else if (backendType == "daemon") {
+    ConfigFile config;
+    return unique_ptr<IbasBackend>(
+      new IbasBackendDaemon(IbasBackendDaemon::getDefaultSocketPath(config)));
+  }
+  else {
+    throw Error("IBAS backend '" + backendType + "' is not supported");
+  }
+}
+
+void
+IbasBackend::setupPkgParams(const std::string& publicParamsFilePath,
+                            const std::string& secretParamsFilePath)
+{
+  throw Error("PKG params setup is not supported by this IBAS backend");
+}
+
+void
+IbasBackend::setupUserParams(const std::string& identity)
+{
+  throw Error("User params setup is not supported by this IBAS backend");
+}
+
+} // namespace ndn
@@ -0,0 +1,133 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2015 Regents of the University of Tokyo.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_SECURITY_IBAS_BACKEND_HPP
+#define NDN_SECURITY_IBAS_BACKEND_HPP
+
+#include "../common.hpp"
+#include "../encoding/buffer.hpp"
+
+#include <vector>
+
+namespace ndn {
+
+/**
+ * @brief IbasBackend is the interface of the pairing based arithmetic behind IbasSigner.
+ *
+ * A backend holds the public params (pairing, P, Q) and optionally the private params
+ * (id, s_P_0, s_P_1) of one identity.  Signatures are exchanged with IbasSigner as the
+ * compressed T and S elements, concatenated; the w part is handled by IbasSigner.
+ *
+ * Three backends are available:
+ * - "pbc" (default), which uses the PBC library;
+ * - "type-a", which uses in-tree fixed-limb Montgomery arithmetic and supports only the Type A
+ *   pairing parameters.  It is compatible with the PBC backend, i.e., signatures created by one
+ *   backend are verified by the other;
+ * - "daemon", which forwards to a local ndn-ibasd running one of the other backends.
+ */
+class IbasBackend
+{
+public:
+  class Error : public std::runtime_error
+  {
+  public:
+    explicit
+    Error(const std::string& what)
+      : std::runtime_error(what)
+    {
+    }
+  };
+
+  /**
+   * @brief Messages whose signatures are aggregated in one signature, each paired with the
+   *        identity which signed it.  All of them were signed using the same w.
+   */
+  typedef std::vector<std::pair<std::string/*message*/, std::string/*identity*/> > MessageList;
+
+  virtual
+  ~IbasBackend()
+  {
+  }
+
+  /**
+   * @brief Creates a backend and loads the public params into it
+   *
+   * @param backendType "pbc", "type-a" or "daemon"
+   * @param publicParamsFilePath Path of the PBC formatted params file, including P and Q.
+   *                             It is not read by the "daemon" backend.
+   * @throws Error if the backend type is unknown or the params cannot be loaded
+   */
+  static unique_ptr<IbasBackend>
+  create(const std::string& backendType, const std::string& publicParamsFilePath);
+
+  /**
+   * @brief Loads the private params (id, s_P_0, s_P_1) from file, overriding the old ones
+   * @throw Error the file cannot be read, or a param is missing or is not a point of G1; the
+   *        old params are kept
+   */
+  virtual void
+  loadPrivateParams(const std::string& privateParamsFilePath) = 0;
+
+  /**
+   * @brief True if the private params are loaded
+   */
+  virtual bool
+  canSign() const = 0;
+
+  /**
+   * @brief Signs data using w and appends the compressed T and S to @p signature
+   *
+   * @param previous If not null, the compressed T and S of an earlier signature with the same
+   *                 w, which are aggregated with the new T and S
+   */
+  virtual void
+  sign(const uint8_t* data, size_t dataLength, const std::string& w,
+       const uint8_t* previous, size_t previousLength, Buffer& signature) = 0;
+
+  /**
+   * @brief Verifies an aggregated signature
+   *
+   * @param messages The signed messages and their signers, in the order of signing
+   * @param w The w part of the signature
+   * @param signature The compressed T and S
+   */
+  virtual bool
+  verify(const MessageList& messages, const std::string& w,
+         const uint8_t* signature, size_t signatureLength) = 0;
+
+  /**
+   * @brief Generates the PKG's secret s, and P, Q = sP.  Appends P and Q to the public params
+   *        file and stores s in the secret params file.
+   */
+  virtual void
+  setupPkgParams(const std::string& publicParamsFilePath,
+                 const std::string& secretParamsFilePath);
+
+  /**
+   * @brief Generates and stores the private params of an identity using the PKG's secret
+   */
+  virtual void
+  setupUserParams(const std::string& identity);
+};
+
+} // namespace ndn
+
+#endif // NDN_SECURITY_IBAS_BACKEND_HPP
@@ -0,0 +1,77 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2015 Regents of the University of Tokyo.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_SECURITY_IBAS_DAEMON_TLV_HPP
+#define NDN_SECURITY_IBAS_DAEMON_TLV_HPP
+
+#include "../encoding/tlv.hpp"
+
+namespace ndn {
+namespace ibasd {
+namespace tlv {
+
+/**
+ * @brief TLV types of the local IBAS signing daemon protocol
+ *
+ * Requests and responses are exchanged over a Unix stream socket, one TLV block each.
+ * A client may send several requests before reading the responses, which come back in order.
+ *
+ *     LoadRequest   ::= LOAD-REQUEST-TYPE TLV-LENGTH PrivateParamsPath
+ *     SignRequest   ::= SIGN-REQUEST-TYPE TLV-LENGTH
+ *                         PrivateParamsPath W Message Elements?
+ *     VerifyRequest ::= VERIFY-REQUEST-TYPE TLV-LENGTH
+ *                         W Elements SignedMessage+
+ *     SignedMessage ::= SIGNED-MESSAGE-TYPE TLV-LENGTH Message Identity
+ *     Response      ::= RESPONSE-TYPE TLV-LENGTH
+ *                         StatusCode StatusText? Elements? IsVerified?
+ *
+ * Elements carries the compressed T and S of a signature.  In a SignRequest it is the earlier
+ * signature to aggregate with.
+ */
+enum {
+  LoadRequest       = 200,
+  SignRequest       = 201,
+  VerifyRequest     = 202,
+  Response          = 203,
+
+  PrivateParamsPath = 210,
+  W                 = 211,
+  Message           = 212,
+  Elements          = 213,
+  SignedMessage     = 214,
+  Identity          = 215,
+  StatusCode        = 216,
+  StatusText        = 217,
+  IsVerified        = 218
+};
+
+} // namespace tlv
+
+enum {
+  STATUS_OK          = 200,
+  STATUS_BAD_REQUEST = 400,
+  STATUS_FAILED      = 500
+};
+
+} // namespace ibasd
+} // namespace ndn
+
+#endif // NDN_SECURITY_IBAS_DAEMON_TLV_HPP
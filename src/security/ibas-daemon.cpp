@@ -0,0 +1,345 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2015 Regents of the University of Tokyo.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "ibas-daemon.hpp"
+#include "ibas-daemon-tlv.hpp"
+
+#include "../encoding/block-helpers.hpp"
+
+#include <boost/filesystem.hpp>
+
+#include <sys/stat.h>
+
+namespace ndn {
+
+const size_t IbasDaemon::MAX_REQUEST_SIZE = 65536;
+
+static std::string
+readString(const Block& block)
+{
+  return std::string(block.value_begin(), block.value_end());
+}
+
+class IbasDaemon::Connection : public enable_shared_from_this<Connection>
+{
+public:
+  Connection(IbasDaemon& daemon, boost::asio::io_service& ioService)
+    : m_daemon(daemon)
+    , m_socket(ioService)
+    , m_input(MAX_REQUEST_SIZE)
+    , m_inputSize(0)
+  {
+  }
+
+  boost::asio::local::stream_protocol::socket&
+  getSocket()
+  {
+    return m_socket;
+  }
+
+  void
+  receive()
+  {
+    m_socket.async_read_some(boost::asio::buffer(m_input.buf() + m_inputSize,
+                                                 m_input.size() - m_inputSize),
+                             bind(&Connection::handleReceive, shared_from_this(), _1, _2));
+  }
+
+  void
+  close()
+  {
+    boost::system::error_code error; // to silently ignore all errors
+    m_socket.close(error);
+  }
+
+private:
+  void
+  handleReceive(const boost::system::error_code& error, size_t nBytesReceived)
+  {
+    if (error) {
+      if (error != boost::asio::error::operation_aborted)
+        m_daemon.removeConnection(shared_from_this());
+      return;
+    }
+
+    m_inputSize += nBytesReceived;
+
+    // Process all complete requests, their responses are sent together
+    size_t offset = 0;
+    Block request;
+    while (offset < m_inputSize &&
+           Block::fromBuffer(m_input.buf() + offset, m_inputSize - offset, request)) {
+      m_responses.push_back(m_daemon.processRequest(request));
+      offset += request.size();
+    }
+
+    if (offset == 0 && m_inputSize == m_input.size()) {
+      // The request does not fit into the input buffer
+      m_daemon.removeConnection(shared_from_this());
+      return;
+    }
+
+    std::copy(m_input.begin() + offset, m_input.begin() + m_inputSize, m_input.begin());
+    m_inputSize -= offset;
+
+    if (m_responses.empty()) {
+      receive();
+      return;
+    }
+
+    boost::asio::async_write(m_socket, m_responses,
+                             bind(&Connection::handleSend, shared_from_this(), _1));
+  }
+
+  void
+  handleSend(const boost::system::error_code& error)
+  {
+    m_responses.clear();
+
+    if (error) {
+      if (error != boost::asio::error::operation_aborted)
+        m_daemon.removeConnection(shared_from_this());
+      return;
+    }
+
+    receive();
+  }
+
+private:
+  IbasDaemon& m_daemon;
+  boost::asio::local::stream_protocol::socket m_socket;
+
+  Buffer m_input;
+  size_t m_inputSize;
+  std::vector<Block> m_responses;
+};
+
+IbasDaemon::IbasDaemon(boost::asio::io_service& ioService, const std::string& socketPath,
+                       const BackendFactory& createBackend)
+  : m_ioService(ioService)
+  , m_acceptor(ioService)
+  , m_socketPath(socketPath)
+  , m_createBackend(createBackend)
+{
+}
+
+IbasDaemon::~IbasDaemon()
+{
+  stop();
+}
+
+void
+IbasDaemon::start()
+{
+  boost::asio::local::stream_protocol::endpoint endpoint(m_socketPath);
+
+  boost::filesystem::path socketPath(m_socketPath);
+  if (boost::filesystem::exists(socketPath)) {
+    boost::asio::local::stream_protocol::socket probe(m_ioService);
+    boost::system::error_code error;
+    probe.connect(endpoint, error);
+    if (!error)
+      throw Error("Another ndn-ibasd is listening on " + m_socketPath);
+
+    // Left by a daemon which did not exit cleanly
+    boost::filesystem::remove(socketPath);
+  }
+  if (socketPath.has_parent_path())
+    boost::filesystem::create_directories(socketPath.parent_path());
+
+  try {
+    m_acceptor.open(endpoint.protocol());
+
+    // Only the owner may connect
+    mode_t oldMask = ::umask(S_IRWXG | S_IRWXO);
+    boost::system::error_code error;
+    m_acceptor.bind(endpoint, error);
+    ::umask(oldMask);
+    if (error)
+      throw boost::system::system_error(error);
+
+    m_acceptor.listen();
+  }
+  catch (const boost::system::system_error& error) {
+    throw Error("Cannot listen on " + m_socketPath + ": " + error.what());
+  }
+
+  startAccept();
+}
+
+void
+IbasDaemon::stop()
+{
+  if (!m_acceptor.is_open())
+    return;
+
+  boost::system::error_code error; // to silently ignore all errors
+  m_acceptor.close(error);
+  boost::filesystem::remove(m_socketPath, error);
+
+  for (std::set<shared_ptr<Connection> >::iterator it = m_connections.begin();
+       it != m_connections.end(); ++it) {
+    (*it)->close();
+  }
+  m_connections.clear();
+}
+
+void
+IbasDaemon::startAccept()
+{
+  shared_ptr<Connection> connection = make_shared<Connection>(ref(*this), ref(m_ioService));
+  m_acceptor.async_accept(connection->getSocket(),
+                          bind(&IbasDaemon::handleAccept, this, connection, _1));
+}
+
+void
+IbasDaemon::handleAccept(const shared_ptr<Connection>& connection,
+                         const boost::system::error_code& error)
+{
+  if (error) {
+    if (error != boost::asio::error::operation_aborted)
+      startAccept();
+    return;
+  }
+
+  m_connections.insert(connection);
+  connection->receive();
+  startAccept();
+}
+
+void
+IbasDaemon::removeConnection(const shared_ptr<Connection>& connection)
+{
+  connection->close();
+  m_connections.erase(connection);
+}
+
+Block
+IbasDaemon::processRequest(const Block& request)
+{
+  uint64_t statusCode = ibasd::STATUS_OK;
+  std::string statusText;
+  Block elements;
+  Block isVerified;
+
+  try {
+    request.parse();
+
+    switch (request.type()) {
+    case ibasd::tlv::LoadRequest:
+      getSigner(readString(request.get(ibasd::tlv::PrivateParamsPath)));
+      break;
+
+    case ibasd::tlv::SignRequest: {
+      IbasBackend& signer = getSigner(readString(request.get(ibasd::tlv::PrivateParamsPath)));
+      const Block& message = request.get(ibasd::tlv::Message);
+      Block::element_const_iterator previous = request.find(ibasd::tlv::Elements);
+
+      BufferPtr signature = make_shared<Buffer>();
+      if (previous != request.elements_end())
+        signer.sign(message.value(), message.value_size(),
+                    readString(request.get(ibasd::tlv::W)),
+                    previous->value(), previous->value_size(), *signature);
+      else
+        signer.sign(message.value(), message.value_size(),
+                    readString(request.get(ibasd::tlv::W)),
+                    nullptr, 0, *signature);
+      elements = Block(ibasd::tlv::Elements, signature);
+      break;
+    }
+
+    case ibasd::tlv::VerifyRequest: {
+      IbasBackend::MessageList messages;
+      for (Block::element_const_iterator it = request.elements_begin();
+           it != request.elements_end(); ++it) {
+        if (it->type() != ibasd::tlv::SignedMessage)
+          continue;
+        it->parse();
+        messages.push_back(std::make_pair(readString(it->get(ibasd::tlv::Message)),
+                                          readString(it->get(ibasd::tlv::Identity))));
+      }
+
+      const Block& signature = request.get(ibasd::tlv::Elements);
+      bool result = getVerifier().verify(messages, readString(request.get(ibasd::tlv::W)),
+                                         signature.value(), signature.value_size());
+      isVerified = nonNegativeIntegerBlock(ibasd::tlv::IsVerified, result ? 1 : 0);
+      break;
+    }
+
+    default:
+      throw tlv::Error("Unknown request type");
+    }
+  }
+  catch (const tlv::Error& error) {
+    statusCode = ibasd::STATUS_BAD_REQUEST;
+    statusText = error.what();
+  }
+  catch (const IbasBackend::Error& error) {
+    statusCode = ibasd::STATUS_FAILED;
+    statusText = error.what();
+  }
+  catch (const std::exception& error) {
+    // e.g. std::bad_alloc; one failed request must not stop the daemon
+    statusCode = ibasd::STATUS_FAILED;
+    statusText = error.what();
+  }
+
+  Block response(ibasd::tlv::Response);
+  response.push_back(nonNegativeIntegerBlock(ibasd::tlv::StatusCode, statusCode));
+  if (!statusText.empty())
+    response.push_back(dataBlock(ibasd::tlv::StatusText, statusText.data(), statusText.size()));
+  if (!elements.empty())
+    response.push_back(elements);
+  if (!isVerified.empty())
+    response.push_back(isVerified);
+  response.encode();
+  return response;
+}
+
+IbasBackend&
+IbasDaemon::getSigner(const std::string& privateParamsPath)
+{
+  std::map<std::string, unique_ptr<IbasBackend> >::iterator it =
+    m_signers.find(privateParamsPath);
+  if (it != m_signers.end())
+    return *it->second;
+
+  boost::system::error_code errorCode;
+  if (!boost::filesystem::is_regular_file(privateParamsPath, errorCode))
+    throw IbasBackend::Error("Cannot open " + privateParamsPath);
+
+  unique_ptr<IbasBackend> signer = m_createBackend();
+  signer->loadPrivateParams(privateParamsPath);
+
+  IbasBackend& result = *signer;
+  m_signers[privateParamsPath] = std::move(signer);
+  return result;
+}
+
+IbasBackend&
+IbasDaemon::getVerifier()
+{
+  if (m_verifier == nullptr)
+    m_verifier = m_createBackend();
+  return *m_verifier;
+}
+
+} // namespace ndn
@@ -0,0 +1,129 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2015 Regents of the University of Tokyo.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_SECURITY_IBAS_DAEMON_HPP
+#define NDN_SECURITY_IBAS_DAEMON_HPP
+
+#include "ibas-backend.hpp"
+#include "../encoding/block.hpp"
+
+#include <boost/asio.hpp>
+
+#include <map>
+#include <set>
+
+namespace ndn {
+
+/**
+ * @brief Local IBAS signing service, used by IbasBackendDaemon clients
+ *
+ * The daemon creates one backend for verification and one backend per private params file,
+ * each on first use, and keeps them for its lifetime.  Applications which forward to the
+ * daemon skip loading the pairing params, and share the identity and fixed-base tables
+ * built by the backends.
+ *
+ * Requests are processed one at a time on the io_service thread.  All complete requests
+ * received from a client in one read are processed together and answered with one write;
+ * the next read from that client starts once the write is done.
+ *
+ * The socket is created with mode 0600, since any client can sign with any private params
+ * file readable by the daemon.
+ */
+class IbasDaemon : noncopyable
+{
+public:
+  class Error : public std::runtime_error
+  {
+  public:
+    explicit
+    Error(const std::string& what)
+      : std::runtime_error(what)
+    {
+    }
+  };
+
+  typedef function<unique_ptr<IbasBackend>()> BackendFactory;
+
+  /**
+   * @brief Maximum size of a request, which may carry several Data packets to verify
+   */
+  static const size_t MAX_REQUEST_SIZE;
+
+  /**
+   * @param createBackend Creates a backend with the public params loaded
+   */
+  IbasDaemon(boost::asio::io_service& ioService, const std::string& socketPath,
+             const BackendFactory& createBackend);
+
+  ~IbasDaemon();
+
+  /**
+   * @brief Starts accepting clients, removing a stale socket file first
+   * @throws Error if another daemon is listening on the socket, or the socket cannot be created
+   */
+  void
+  start();
+
+  /**
+   * @brief Closes the socket and all client connections
+   */
+  void
+  stop();
+
+  /**
+   * @brief Processes one request block and returns the response block
+   */
+  Block
+  processRequest(const Block& request);
+
+private:
+  class Connection;
+
+  void
+  startAccept();
+
+  void
+  handleAccept(const shared_ptr<Connection>& connection,
+               const boost::system::error_code& error);
+
+  void
+  removeConnection(const shared_ptr<Connection>& connection);
+
+  IbasBackend&
+  getSigner(const std::string& privateParamsPath);
+
+  IbasBackend&
+  getVerifier();
+
+private:
+  boost::asio::io_service& m_ioService;
+  boost::asio::local::stream_protocol::acceptor m_acceptor;
+  std::string m_socketPath;
+  BackendFactory m_createBackend;
+
+  unique_ptr<IbasBackend> m_verifier;
+  std::map<std::string, unique_ptr<IbasBackend> > m_signers;
+  std::set<shared_ptr<Connection> > m_connections;
+};
+
+} // namespace ndn
+
+#endif // NDN_SECURITY_IBAS_DAEMON_HPP
@@ -24,11 +24,10 @@
 #ifndef NDN_SECURITY_IBAS_SIGNER_HPP
 #define NDN_SECURITY_IBAS_SIGNER_HPP
 
-#include <pbc/pbc.h>
-
 #include "../encoding/block.hpp"
 #include "../signature.hpp"
 #include "../data.hpp"
+#include "ibas-backend.hpp"
 
 // This class should be merged into SecTpmFile.
 // Making it a separate class is just for the ease of implementation.
@@ -40,6 +39,9 @@ namespace ndn {
  *
  * There are two possible instance states. In one state the instance can only verify data and its
  * signature; it cannot sign a data. The state can be checked by calling 'canSign()' method.
+ *
+ * The pairing arithmetic is done by an IbasBackend.  The backend is chosen by the "ibas" key of
+ * client.conf, which defaults to "pbc".
  */
 class IbasSigner
 {
@@ -50,6 +52,19 @@ class IbasSigner
    */
   IbasSigner();
 
+  /**
+   * @brief Constructs an instance using the given IBAS backend type, "pbc", "type-a" or
+   *        "daemon"
+   */
+  explicit
+  IbasSigner(const std::string& backendType);
+
+  /**
+   * @brief Constructs an instance using the given IBAS backend type and the public params in
+   *        @p publicParamsFilePath rather than in ~/.ndn/ibas/params.conf
+   */
+  IbasSigner(const std::string& backendType, const std::string& publicParamsFilePath);
+
   ~IbasSigner();
 
   /**
@@ -112,57 +127,32 @@ class IbasSigner
    */
   bool verifySignature(const Data& data);
 
- private:
-  /**
-   * @brief Verify non-moderated data signature, i.e., the data starts with 'From: '
-   */
-  bool verifySignatureSimple(element_t T, element_t S, element_t P_w,
-                             const std::string& w, const std::string& identity,
-                             const Data& data);
-
   /**
-   * @brief Initializes the pairing and public params
+   * @brief Returns identities whose signatures are aggregated in the data, i.e., the 'From: <ID>'
+   *        identity followed by the 'Moderator: <ID>' identity if the data is moderated.
+   *        Returns an empty list if the content does not contain a 'From: ' part.
+   *
+   * @param data The data to inspect
    */
-  void initializePublicParams(const std::string& publicParamsFilePath);
+  static std::vector<std::string> getSignerIdentities(const Data& data);
 
+ private:
   /**
    * @brief Generates a random w, current time as a string with random padding at end
    */
   const std::string generateW();
 
   /**
-   * @brief Calculates T, S signatures of given data using given data and w parameters.
-   *        The method assumes that T and S elements are initialized previously.
-   */
-  void signInternal(element_t T, element_t S, const uint8_t* data, size_t dataLength,
-                                const std::string& w);
-
-  /**
-   * @brief Writes w, T, S into a block as a signature
-   *
-   * @param clear If true clear T, S elements after using
-   */
-  Block signIntoBlock(element_t T, element_t S, const std::string& w, bool clear);
-
-  /**
-   * @brief Loads signature variables T, S, w from a signature
-   *        The method assumes that T and S elements are initialized previously.
+   * @brief Loads signature variables w and compressed T, S from a signature
    *
    * @return True if signature variables was successfully loaded, false otherwise.
    */
-  bool loadSignature(element_t T, element_t S, std::string& w, const Signature& signature);
+  bool loadSignature(std::string& w, const uint8_t*& elements, size_t& elementsLength,
+                     const Signature& signature);
 
 
  private:
-  bool m_canSign = false;
-
-  // Public params (public in terms of IBAS)
-  pairing_t pairing;
-  element_t P, Q;
-
-  // Private params
-  std::string identity;
-  element_t s_P_0, s_P_1;
+  unique_ptr<IbasBackend> m_backend;
 };
 
 } // namespace ndn
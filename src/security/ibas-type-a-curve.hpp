@@ -0,0 +1,1139 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2015 Regents of the University of Tokyo.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_SECURITY_IBAS_TYPE_A_CURVE_HPP
+#define NDN_SECURITY_IBAS_TYPE_A_CURVE_HPP
+
+#include "../common.hpp"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+/** @file
+ *  @brief Fixed-limb arithmetic for the PBC "Type A" pairing used by IBAS.
+ *
+ *  The Type A curve is the supersingular curve E: y^2 = x^3 + x over F_q, q = 3 (mod 4), with
+ *  embedding degree 2.  G1 is the order r subgroup of E(F_q), GT the order r subgroup of F_q^2,
+ *  and the pairing is the reduced Tate pairing composed with the distortion map
+ *  (x, y) -> (-x, iy).
+ *
+ *  All values have a number of 64-bit limbs fixed at compile time, so no operation allocates.
+ *  Field multiplication uses Montgomery's CIOS method, inversion the binary extended Euclidean
+ *  algorithm.
+ */
+
+namespace ndn {
+namespace ibas {
+
+/**
+ * @brief Returns the low 64 bits of a * b + c + d, stores the high 64 bits into @p hi
+ */
+inline uint64_t
+mulAdd(uint64_t a, uint64_t b, uint64_t c, uint64_t d, uint64_t& hi)
+{
+#ifdef __SIZEOF_INT128__
+  unsigned __int128 t = static_cast<unsigned __int128>(a) * b + c + d;
+  hi = static_cast<uint64_t>(t >> 64);
+  return static_cast<uint64_t>(t);
+#else
+  const uint64_t mask = 0xFFFFFFFFULL;
+  uint64_t aL = a & mask, aH = a >> 32;
+  uint64_t bL = b & mask, bH = b >> 32;
+
+  uint64_t ll = aL * bL;
+  uint64_t lh = aL * bH;
+  uint64_t hl = aH * bL;
+  uint64_t hh = aH * bH;
+
+  uint64_t mid = (ll >> 32) + (lh & mask) + (hl & mask);
+  uint64_t lo = (ll & mask) | (mid << 32);
+  hi = hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+
+  lo += c;
+  hi += (lo < c);
+  lo += d;
+  hi += (lo < d);
+  return lo;
+#endif
+}
+
+/**
+ * @brief Returns the low 64 bits of a + b + carry, stores the carry out into @p carry
+ */
+inline uint64_t
+addCarry(uint64_t a, uint64_t b, uint64_t& carry)
+{
+  uint64_t t = a + carry;
+  uint64_t c = (t < a);
+  t += b;
+  carry = c + (t < b);
+  return t;
+}
+
+/**
+ * @brief Returns the low 64 bits of a - b - borrow, stores the borrow out into @p borrow
+ */
+inline uint64_t
+subBorrow(uint64_t a, uint64_t b, uint64_t& borrow)
+{
+  uint64_t t = a - b;
+  uint64_t c = (a < b);
+  uint64_t r = t - borrow;
+  borrow = c + (t < borrow);
+  return r;
+}
+
+/**
+ * @brief Unsigned integer of N 64-bit limbs, least significant limb first
+ */
+template<size_t N>
+struct FixedUint
+{
+  uint64_t limb[N];
+
+  static FixedUint
+  fromWord(uint64_t word)
+  {
+    FixedUint r;
+    r.limb[0] = word;
+    for (size_t i = 1; i < N; i++)
+      r.limb[i] = 0;
+    return r;
+  }
+
+  bool
+  isZero() const
+  {
+    for (size_t i = 0; i < N; i++)
+      if (limb[i] != 0)
+        return false;
+    return true;
+  }
+
+  bool
+  testBit(size_t i) const
+  {
+    return (limb[i / 64] >> (i % 64)) & 1;
+  }
+
+  size_t
+  bitLength() const
+  {
+    for (size_t i = N; i > 0; i--)
+      if (limb[i - 1] != 0) {
+        size_t bits = 64;
+        while (!((limb[i - 1] >> (bits - 1)) & 1))
+          bits--;
+        return (i - 1) * 64 + bits;
+      }
+    return 0;
+  }
+
+  void
+  shiftRight1()
+  {
+    for (size_t i = 0; i < N - 1; i++)
+      limb[i] = (limb[i] >> 1) | (limb[i + 1] << 63);
+    limb[N - 1] >>= 1;
+  }
+
+  /// @return carry out
+  static uint64_t
+  add(FixedUint& r, const FixedUint& a, const FixedUint& b)
+  {
+    uint64_t carry = 0;
+    for (size_t i = 0; i < N; i++)
+      r.limb[i] = addCarry(a.limb[i], b.limb[i], carry);
+    return carry;
+  }
+
+  /// @return borrow out
+  static uint64_t
+  sub(FixedUint& r, const FixedUint& a, const FixedUint& b)
+  {
+    uint64_t borrow = 0;
+    for (size_t i = 0; i < N; i++)
+      r.limb[i] = subBorrow(a.limb[i], b.limb[i], borrow);
+    return borrow;
+  }
+
+  static int
+  compare(const FixedUint& a, const FixedUint& b)
+  {
+    for (size_t i = N; i > 0; i--) {
+      if (a.limb[i - 1] != b.limb[i - 1])
+        return a.limb[i - 1] < b.limb[i - 1] ? -1 : 1;
+    }
+    return 0;
+  }
+
+  /**
+   * @brief Reads a big-endian byte string
+   * @return false if the value does not fit into N limbs
+   */
+  bool
+  fromBytes(const uint8_t* bytes, size_t size)
+  {
+    for (size_t i = 0; i < N; i++)
+      limb[i] = 0;
+    for (size_t i = 0; i < size; i++) {
+      size_t bytePos = size - 1 - i;
+      if (bytes[i] == 0)
+        continue;
+      if (bytePos >= N * 8)
+        return false;
+      limb[bytePos / 8] |= static_cast<uint64_t>(bytes[i]) << (8 * (bytePos % 8));
+    }
+    return true;
+  }
+
+  /**
+   * @brief Writes the value as a big-endian byte string of exactly @p size bytes
+   */
+  void
+  toBytes(uint8_t* bytes, size_t size) const
+  {
+    for (size_t i = 0; i < size; i++) {
+      size_t bytePos = size - 1 - i;
+      bytes[i] = bytePos < N * 8 ?
+                 static_cast<uint8_t>(limb[bytePos / 8] >> (8 * (bytePos % 8))) : 0;
+    }
+  }
+
+  /**
+   * @brief Reads a non-negative decimal number
+   * @return false if the string is not a decimal number or does not fit into N limbs
+   */
+  bool
+  fromDecimal(const std::string& str)
+  {
+    for (size_t i = 0; i < N; i++)
+      limb[i] = 0;
+    if (str.empty())
+      return false;
+
+    for (std::string::const_iterator it = str.begin(); it != str.end(); it++) {
+      if (*it < '0' || *it > '9')
+        return false;
+      uint64_t carry = static_cast<uint64_t>(*it - '0');
+      for (size_t i = 0; i < N; i++)
+        limb[i] = mulAdd(limb[i], 10, carry, 0, carry);
+      if (carry != 0)
+        return false;
+    }
+    return true;
+  }
+};
+
+/**
+ * @brief Prime field F_p of at most 64 * N bits, elements are kept in Montgomery form
+ */
+template<size_t N>
+class MontgomeryField
+{
+public:
+  typedef FixedUint<N> Integer;
+
+  struct Element
+  {
+    Integer value;
+  };
+
+  explicit
+  MontgomeryField(const Integer& modulus)
+    : m_modulus(modulus)
+  {
+    // m_inverse = -p^{-1} mod 2^64, by Newton iteration
+    uint64_t inverse = 1;
+    for (int i = 0; i < 6; i++)
+      inverse *= 2 - m_modulus.limb[0] * inverse;
+    m_inverse = ~inverse + 1;
+
+    // R mod p and R^2 mod p, where R = 2^(64 * N)
+    Integer r = Integer::fromWord(1);
+    for (size_t i = 0; i < 64 * N; i++)
+      doubleMod(r);
+    m_one.value = r;
+    for (size_t i = 0; i < 64 * N; i++)
+      doubleMod(r);
+    m_rSquare = r;
+    montgomeryMul(m_rCube, m_rSquare, m_rSquare);
+
+    m_zero.value = Integer::fromWord(0);
+
+    // (p + 1) / 4, used for the square root since p = 3 (mod 4)
+    Integer one = Integer::fromWord(1);
+    uint64_t carry = Integer::add(m_sqrtExponent, m_modulus, one);
+    m_sqrtExponent.shiftRight1();
+    m_sqrtExponent.limb[N - 1] |= carry << 63;
+    m_sqrtExponent.shiftRight1();
+
+    m_byteLength = (m_modulus.bitLength() + 7) / 8;
+  }
+
+  const Integer&
+  getModulus() const
+  {
+    return m_modulus;
+  }
+
+  /// @brief Number of bytes of the big-endian encoding of an element
+  size_t
+  getByteLength() const
+  {
+    return m_byteLength;
+  }
+
+  const Element&
+  zero() const
+  {
+    return m_zero;
+  }
+
+  const Element&
+  one() const
+  {
+    return m_one;
+  }
+
+  /// @brief Converts an integer smaller than the modulus into the Montgomery form
+  Element
+  fromInteger(const Integer& a) const
+  {
+    Element e;
+    montgomeryMul(e.value, a, m_rSquare);
+    return e;
+  }
+
+  Integer
+  toInteger(const Element& a) const
+  {
+    Integer r;
+    montgomeryMul(r, a.value, Integer::fromWord(1));
+    return r;
+  }
+
+  bool
+  isZero(const Element& a) const
+  {
+    return a.value.isZero();
+  }
+
+  bool
+  isEqual(const Element& a, const Element& b) const
+  {
+    return Integer::compare(a.value, b.value) == 0;
+  }
+
+  /// @brief Parity of the integer value, the "sign" used by the PBC point compression
+  bool
+  isOdd(const Element& a) const
+  {
+    return toInteger(a).limb[0] & 1;
+  }
+
+  void
+  add(Element& r, const Element& a, const Element& b) const
+  {
+    uint64_t carry = Integer::add(r.value, a.value, b.value);
+    if (carry != 0 || Integer::compare(r.value, m_modulus) >= 0)
+      Integer::sub(r.value, r.value, m_modulus);
+  }
+
+  void
+  sub(Element& r, const Element& a, const Element& b) const
+  {
+    uint64_t borrow = Integer::sub(r.value, a.value, b.value);
+    if (borrow != 0)
+      Integer::add(r.value, r.value, m_modulus);
+  }
+
+  void
+  neg(Element& r, const Element& a) const
+  {
+    if (a.value.isZero())
+      r = a;
+    else
+      Integer::sub(r.value, m_modulus, a.value);
+  }
+
+  void
+  mul(Element& r, const Element& a, const Element& b) const
+  {
+    montgomeryMul(r.value, a.value, b.value);
+  }
+
+  void
+  sqr(Element& r, const Element& a) const
+  {
+    montgomeryMul(r.value, a.value, a.value);
+  }
+
+  void
+  pow(Element& r, const Element& a, const Integer& exponent) const
+  {
+    Element result = m_one;
+    for (size_t i = exponent.bitLength(); i > 0; i--) {
+      sqr(result, result);
+      if (exponent.testBit(i - 1))
+        mul(result, result, a);
+    }
+    r = result;
+  }
+
+  /// @brief Inverse by the binary extended Euclidean algorithm, the inverse of zero is zero
+  void
+  inv(Element& r, const Element& a) const
+  {
+    if (a.value.isZero()) {
+      r = a;
+      return;
+    }
+
+    // a = xR, the binary algorithm gives x^{-1}R^{-1}, then x^{-1}R = x^{-1}R^{-1} R^3 R^{-1}
+    Integer u = a.value;
+    Integer v = m_modulus;
+    Integer x1 = Integer::fromWord(1);
+    Integer x2 = Integer::fromWord(0);
+    while (!isOne(u) && !isOne(v)) {
+      while (!(u.limb[0] & 1)) {
+        u.shiftRight1();
+        halve(x1);
+      }
+      while (!(v.limb[0] & 1)) {
+        v.shiftRight1();
+        halve(x2);
+      }
+      if (Integer::compare(u, v) >= 0) {
+        Integer::sub(u, u, v);
+        subInteger(x1, x1, x2);
+      }
+      else {
+        Integer::sub(v, v, u);
+        subInteger(x2, x2, x1);
+      }
+    }
+    montgomeryMul(r.value, isOne(u) ? x1 : x2, m_rCube);
+  }
+
+  /// @brief True if @p a is zero or a quadratic residue, using the binary Jacobi symbol algorithm
+  bool
+  isSquare(const Element& a) const
+  {
+    Integer x = toInteger(a);
+    Integer n = m_modulus;
+    bool isPositive = true;
+    while (!x.isZero()) {
+      while (!(x.limb[0] & 1)) {
+        x.shiftRight1();
+        uint64_t nMod8 = n.limb[0] & 7;
+        if (nMod8 == 3 || nMod8 == 5)
+          isPositive = !isPositive;
+      }
+      if (Integer::compare(x, n) < 0) {
+        std::swap(x, n);
+        if ((x.limb[0] & 3) == 3 && (n.limb[0] & 3) == 3)
+          isPositive = !isPositive;
+      }
+      Integer::sub(x, x, n);
+    }
+    return !isOne(n) || isPositive;
+  }
+
+  /**
+   * @brief Computes a square root of @p a
+   * @return false if @p a is not a quadratic residue
+   */
+  bool
+  sqrt(Element& r, const Element& a) const
+  {
+    Element root, check;
+    pow(root, a, m_sqrtExponent);
+    sqr(check, root);
+    if (!isEqual(check, a))
+      return false;
+    r = root;
+    return true;
+  }
+
+private:
+  static bool
+  isOne(const Integer& a)
+  {
+    if (a.limb[0] != 1)
+      return false;
+    for (size_t i = 1; i < N; i++)
+      if (a.limb[i] != 0)
+        return false;
+    return true;
+  }
+
+  /// @brief a = a / 2 mod p
+  void
+  halve(Integer& a) const
+  {
+    uint64_t carry = 0;
+    if (a.limb[0] & 1)
+      carry = Integer::add(a, a, m_modulus);
+    a.shiftRight1();
+    a.limb[N - 1] |= carry << 63;
+  }
+
+  /// @brief r = a - b mod p
+  void
+  subInteger(Integer& r, const Integer& a, const Integer& b) const
+  {
+    if (Integer::sub(r, a, b) != 0)
+      Integer::add(r, r, m_modulus);
+  }
+
+  void
+  doubleMod(Integer& a) const
+  {
+    uint64_t carry = Integer::add(a, a, a);
+    if (carry != 0 || Integer::compare(a, m_modulus) >= 0)
+      Integer::sub(a, a, m_modulus);
+  }
+
+  /// @brief r = a * b * R^{-1} mod p (CIOS)
+  void
+  montgomeryMul(Integer& r, const Integer& a, const Integer& b) const
+  {
+    uint64_t t[N + 2];
+    for (size_t i = 0; i < N + 2; i++)
+      t[i] = 0;
+
+    for (size_t i = 0; i < N; i++) {
+      uint64_t carry = 0;
+      for (size_t j = 0; j < N; j++)
+        t[j] = mulAdd(a.limb[j], b.limb[i], t[j], carry, carry);
+      uint64_t c2 = 0;
+      t[N] = addCarry(t[N], carry, c2);
+      t[N + 1] = c2;
+
+      uint64_t m = t[0] * m_inverse;
+      mulAdd(m, m_modulus.limb[0], t[0], 0, carry);
+      for (size_t j = 1; j < N; j++)
+        t[j - 1] = mulAdd(m, m_modulus.limb[j], t[j], carry, carry);
+      c2 = 0;
+      t[N - 1] = addCarry(t[N], carry, c2);
+      t[N] = t[N + 1] + c2;
+    }
+
+    for (size_t i = 0; i < N; i++)
+      r.limb[i] = t[i];
+    if (t[N] != 0 || Integer::compare(r, m_modulus) >= 0)
+      Integer::sub(r, r, m_modulus);
+  }
+
+private:
+  Integer m_modulus;
+  uint64_t m_inverse;
+  Integer m_rSquare;
+  Integer m_rCube;
+  Integer m_sqrtExponent;
+  Element m_zero;
+  Element m_one;
+  size_t m_byteLength;
+};
+
+/**
+ * @brief The Type A curve y^2 = x^3 + x over F_q and its pairing into F_q^2 = F_q[i]/(i^2 + 1)
+ */
+template<size_t N>
+class TypeACurve
+{
+public:
+  typedef MontgomeryField<N> Field;
+  typedef typename Field::Integer Integer;
+  typedef typename Field::Element Fq;
+
+  /// @brief Element a + bi of F_q^2
+  struct Fq2
+  {
+    Fq a;
+    Fq b;
+  };
+
+  /// @brief Point in affine coordinates
+  struct Point
+  {
+    Fq x;
+    Fq y;
+    bool isInfinity;
+  };
+
+  /**
+   * @param q     The field characteristic
+   * @param r     The order of G1 and GT
+   * @param h     The cofactor, (q + 1) / r
+   */
+  TypeACurve(const Integer& q, const Integer& r, const Integer& h)
+    : m_field(q)
+    , m_order(r)
+    , m_cofactor(h)
+  {
+  }
+
+  const Field&
+  getField() const
+  {
+    return m_field;
+  }
+
+  const Integer&
+  getOrder() const
+  {
+    return m_order;
+  }
+
+  Point
+  infinity() const
+  {
+    Point p;
+    p.x = m_field.zero();
+    p.y = m_field.zero();
+    p.isInfinity = true;
+    return p;
+  }
+
+  bool
+  isEqual(const Point& p1, const Point& p2) const
+  {
+    if (p1.isInfinity || p2.isInfinity)
+      return p1.isInfinity == p2.isInfinity;
+    return m_field.isEqual(p1.x, p2.x) && m_field.isEqual(p1.y, p2.y);
+  }
+
+  /**
+   * @brief Computes x^3 + x and its square root with odd parity
+   * @return false if there is no point with the given x
+   */
+  bool
+  pointFromX(Point& p, const Fq& x) const
+  {
+    Fq t;
+    m_field.sqr(t, x);
+    m_field.add(t, t, m_field.one());
+    m_field.mul(t, t, x);
+
+    Fq y;
+    if (!m_field.isSquare(t) || !m_field.sqrt(y, t))
+      return false;
+    if (!m_field.isOdd(y))
+      m_field.neg(y, y);
+
+    p.x = x;
+    p.y = y;
+    p.isInfinity = false;
+    return true;
+  }
+
+  /**
+   * @brief Maps a hash into G1 the same way as PBC's element_from_hash
+   *
+   * x is derived from the hash as by pbc_mpz_from_hash, then replaced by x^2 + 1 until x^3 + x
+   * is a square.  The point with the odd y is multiplied by the cofactor.
+   */
+  Point
+  hashToPoint(const uint8_t* hash, size_t hashLength) const
+  {
+    Integer xInt = integerFromHash(hash, hashLength, m_field.getModulus());
+    if (Integer::compare(xInt, m_field.getModulus()) == 0)
+      xInt = Integer::fromWord(0);
+    Fq x = m_field.fromInteger(xInt);
+
+    Point p;
+    while (!pointFromX(p, x)) {
+      m_field.sqr(x, x);
+      m_field.add(x, x, m_field.one());
+    }
+    return mul(p, m_cofactor);
+  }
+
+  /**
+   * @brief Maps a hash into Z_r the same way as PBC's element_from_hash
+   */
+  Integer
+  hashToScalar(const uint8_t* hash, size_t hashLength) const
+  {
+    Integer c = integerFromHash(hash, hashLength, m_order);
+    if (Integer::compare(c, m_order) == 0)
+      c = Integer::fromWord(0);
+    return c;
+  }
+
+  Point
+  add(const Point& p1, const Point& p2) const
+  {
+    if (p1.isInfinity)
+      return p2;
+    Jacobian t = toJacobian(p1);
+    addMixed(t, p2, 0);
+    return toAffine(t);
+  }
+
+  Point
+  neg(const Point& p) const
+  {
+    Point r = p;
+    m_field.neg(r.y, p.y);
+    return r;
+  }
+
+  Point
+  mul(const Point& p, const Integer& k) const
+  {
+    if (p.isInfinity)
+      return p;
+
+    Jacobian t = toJacobian(infinity());
+    for (size_t i = k.bitLength(); i > 0; i--) {
+      dbl(t, 0);
+      if (k.testBit(i - 1))
+        addMixed(t, p, 0);
+    }
+    return toAffine(t);
+  }
+
+  /**
+   * @brief Computes the table 2^{i}P, i < bit length of r, for mulPrecomputed
+   */
+  std::vector<Point>
+  precompute(const Point& p) const
+  {
+    std::vector<Point> table;
+    table.reserve(m_order.bitLength());
+    table.push_back(p);
+    while (table.size() < m_order.bitLength()) {
+      const Point& last = table.back();
+      if (last.isInfinity) {
+        table.push_back(last);
+        continue;
+      }
+      Jacobian t = toJacobian(last);
+      dbl(t, 0);
+      table.push_back(toAffine(t));
+    }
+    return table;
+  }
+
+  /**
+   * @brief Computes kP using the table of P, k < r, with additions only
+   */
+  Point
+  mulPrecomputed(const std::vector<Point>& table, const Integer& k) const
+  {
+    Jacobian t = toJacobian(infinity());
+    for (size_t i = 0; i < k.bitLength() && i < table.size(); i++) {
+      if (k.testBit(i))
+        addMixed(t, table[i], 0);
+    }
+    return toAffine(t);
+  }
+
+  /// @brief Length of a point in PBC's compressed form: x followed by the parity of y
+  size_t
+  getCompressedLength() const
+  {
+    return m_field.getByteLength() + 1;
+  }
+
+  /**
+   * @brief Writes the point in PBC's compressed form, getCompressedLength() bytes
+   */
+  void
+  toBytesCompressed(uint8_t* bytes, const Point& p) const
+  {
+    size_t length = m_field.getByteLength();
+    if (p.isInfinity) {
+      std::fill(bytes, bytes + length + 1, 0);
+      return;
+    }
+    m_field.toInteger(p.x).toBytes(bytes, length);
+    bytes[length] = m_field.isOdd(p.y) ? 1 : 0;
+  }
+
+  /**
+   * @brief Reads a point in PBC's compressed form, getCompressedLength() bytes
+   * @return false if the bytes do not encode a point of the curve
+   */
+  bool
+  fromBytesCompressed(Point& p, const uint8_t* bytes) const
+  {
+    size_t length = m_field.getByteLength();
+    Integer x;
+    if (!x.fromBytes(bytes, length) || Integer::compare(x, m_field.getModulus()) >= 0)
+      return false;
+
+    if (x.isZero() && bytes[length] == 0) {
+      p = infinity();
+      return true;
+    }
+
+    if (!pointFromX(p, m_field.fromInteger(x)))
+      return false;
+    if (bytes[length] == 0)
+      m_field.neg(p.y, p.y);
+    return true;
+  }
+
+  /**
+   * @brief Computes the reduced Tate pairing e(P, phi(Q)), phi(x, y) = (-x, iy)
+   */
+  Fq2
+  pairing(const Point& p, const Point& q) const
+  {
+    return finalExponentiation(millerLoop(p, q));
+  }
+
+  /**
+   * @brief Computes the Miller function f_{r,P} at phi(Q), without the final exponentiation
+   *
+   * Products of pairings can share one final exponentiation by multiplying Miller loop values.
+   * The conjugate of a Miller loop value corresponds to the inverse of the pairing.
+   */
+  Fq2
+  millerLoop(const Point& p, const Point& q) const
+  {
+    Fq2 f = fq2One();
+    if (p.isInfinity || q.isInfinity)
+      return f;
+
+    LineTarget target = { q.x, q.y };
+    Jacobian t = toJacobian(p);
+    Fq2 line;
+    for (size_t i = m_order.bitLength() - 1; i > 0; i--) {
+      fq2Sqr(f, f);
+      dbl(t, &target, &line);
+      fq2Mul(f, f, line);
+      if (m_order.testBit(i - 1)) {
+        if (addMixed(t, p, &target, &line))
+          fq2Mul(f, f, line);
+      }
+    }
+
+    return f;
+  }
+
+  /// @brief f^((q^2 - 1) / r) = (f^(q - 1))^h
+  Fq2
+  finalExponentiation(const Fq2& f) const
+  {
+    Fq2 inverse, r;
+    fq2Inv(inverse, f);
+    fq2Conj(r, f);
+    fq2Mul(r, r, inverse);
+    fq2Pow(r, r, m_cofactor);
+    return r;
+  }
+
+  Fq2
+  fq2One() const
+  {
+    Fq2 r;
+    r.a = m_field.one();
+    r.b = m_field.zero();
+    return r;
+  }
+
+  bool
+  isEqual(const Fq2& a, const Fq2& b) const
+  {
+    return m_field.isEqual(a.a, b.a) && m_field.isEqual(a.b, b.b);
+  }
+
+  void
+  fq2Mul(Fq2& r, const Fq2& x, const Fq2& y) const
+  {
+    Fq ac, bd, s1, s2;
+    m_field.mul(ac, x.a, y.a);
+    m_field.mul(bd, x.b, y.b);
+    m_field.add(s1, x.a, x.b);
+    m_field.add(s2, y.a, y.b);
+    m_field.mul(s1, s1, s2);
+    m_field.sub(s1, s1, ac);
+    m_field.sub(r.b, s1, bd);
+    m_field.sub(r.a, ac, bd);
+  }
+
+  void
+  fq2Sqr(Fq2& r, const Fq2& x) const
+  {
+    Fq s, d, ab;
+    m_field.add(s, x.a, x.b);
+    m_field.sub(d, x.a, x.b);
+    m_field.mul(ab, x.a, x.b);
+    m_field.mul(r.a, s, d);
+    m_field.add(r.b, ab, ab);
+  }
+
+  void
+  fq2Conj(Fq2& r, const Fq2& x) const
+  {
+    r.a = x.a;
+    m_field.neg(r.b, x.b);
+  }
+
+  void
+  fq2Inv(Fq2& r, const Fq2& x) const
+  {
+    Fq norm, t;
+    m_field.sqr(norm, x.a);
+    m_field.sqr(t, x.b);
+    m_field.add(norm, norm, t);
+    m_field.inv(norm, norm);
+    m_field.mul(r.a, x.a, norm);
+    m_field.mul(t, x.b, norm);
+    m_field.neg(r.b, t);
+  }
+
+  void
+  fq2Pow(Fq2& r, const Fq2& x, const Integer& exponent) const
+  {
+    Fq2 result = fq2One();
+    for (size_t i = exponent.bitLength(); i > 0; i--) {
+      fq2Sqr(result, result);
+      if (exponent.testBit(i - 1))
+        fq2Mul(result, result, x);
+    }
+    r = result;
+  }
+
+private:
+  struct Jacobian
+  {
+    Fq x;
+    Fq y;
+    Fq z;
+  };
+
+  /// @brief Coordinates of Q, the line functions are evaluated at phi(Q) = (-x, iy)
+  struct LineTarget
+  {
+    Fq x;
+    Fq y;
+  };
+
+  Jacobian
+  toJacobian(const Point& p) const
+  {
+    Jacobian t;
+    t.x = p.x;
+    t.y = p.y;
+    t.z = p.isInfinity ? m_field.zero() : m_field.one();
+    return t;
+  }
+
+  Point
+  toAffine(const Jacobian& t) const
+  {
+    if (m_field.isZero(t.z))
+      return infinity();
+
+    Fq zInv, zInv2;
+    m_field.inv(zInv, t.z);
+    m_field.sqr(zInv2, zInv);
+
+    Point p;
+    m_field.mul(p.x, t.x, zInv2);
+    m_field.mul(p.y, t.y, zInv2);
+    m_field.mul(p.y, p.y, zInv);
+    p.isInfinity = false;
+    return p;
+  }
+
+  /**
+   * @brief t = 2t, optionally evaluates the tangent line at phi(Q) scaled by an F_q factor
+   */
+  void
+  dbl(Jacobian& t, const LineTarget* target, Fq2* line = 0) const
+  {
+    if (m_field.isZero(t.z))
+      {
+        if (line != 0)
+          *line = fq2One();
+        return;
+      }
+
+    Fq xx, yy, yyyy, zz, s, m, tmp;
+    m_field.sqr(xx, t.x);
+    m_field.sqr(yy, t.y);
+    m_field.sqr(yyyy, yy);
+    m_field.sqr(zz, t.z);
+
+    // S = 4 X YY
+    m_field.mul(s, t.x, yy);
+    m_field.add(s, s, s);
+    m_field.add(s, s, s);
+
+    // M = 3 XX + ZZ^2
+    m_field.add(m, xx, xx);
+    m_field.add(m, m, xx);
+    m_field.sqr(tmp, zz);
+    m_field.add(m, m, tmp);
+
+    Jacobian r;
+    // X3 = M^2 - 2S
+    m_field.sqr(r.x, m);
+    m_field.sub(r.x, r.x, s);
+    m_field.sub(r.x, r.x, s);
+    // Y3 = M (S - X3) - 8 YYYY
+    m_field.sub(tmp, s, r.x);
+    m_field.mul(r.y, m, tmp);
+    m_field.add(tmp, yyyy, yyyy);
+    m_field.add(tmp, tmp, tmp);
+    m_field.add(tmp, tmp, tmp);
+    m_field.sub(r.y, r.y, tmp);
+    // Z3 = 2 Y Z
+    m_field.mul(r.z, t.y, t.z);
+    m_field.add(r.z, r.z, r.z);
+
+    if (line != 0)
+      {
+        // l = M (X + ZZ x_Q) - 2 YY + (Z3 ZZ y_Q) i
+        m_field.mul(tmp, zz, target->x);
+        m_field.add(tmp, tmp, t.x);
+        m_field.mul(line->a, m, tmp);
+        m_field.sub(line->a, line->a, yy);
+        m_field.sub(line->a, line->a, yy);
+        m_field.mul(tmp, r.z, zz);
+        m_field.mul(line->b, tmp, target->y);
+      }
+
+    t = r;
+  }
+
+  /**
+   * @brief t = t + p, optionally evaluates the line through t and p at phi(Q)
+   * @return false if the line is vertical, i.e., its value is eliminated by the final
+   *         exponentiation and @p line is not set
+   */
+  bool
+  addMixed(Jacobian& t, const Point& p, const LineTarget* target, Fq2* line = 0) const
+  {
+    if (p.isInfinity)
+      return false;
+    if (m_field.isZero(t.z))
+      {
+        t = toJacobian(p);
+        return false;
+      }
+
+    Fq z1z1, u2, s2, h, r, hh, hhh, v, tmp;
+    m_field.sqr(z1z1, t.z);
+    m_field.mul(u2, p.x, z1z1);
+    m_field.mul(s2, p.y, t.z);
+    m_field.mul(s2, s2, z1z1);
+    m_field.sub(h, u2, t.x);
+    m_field.sub(r, s2, t.y);
+
+    if (m_field.isZero(h))
+      {
+        if (m_field.isZero(r))
+          {
+            dbl(t, target, line);
+            return line != 0;
+          }
+        t = toJacobian(infinity());
+        return false;
+      }
+
+    m_field.sqr(hh, h);
+    m_field.mul(hhh, h, hh);
+    m_field.mul(v, t.x, hh);
+
+    Jacobian result;
+    // X3 = R^2 - HHH - 2V
+    m_field.sqr(result.x, r);
+    m_field.sub(result.x, result.x, hhh);
+    m_field.sub(result.x, result.x, v);
+    m_field.sub(result.x, result.x, v);
+    // Y3 = R (V - X3) - Y1 HHH
+    m_field.sub(tmp, v, result.x);
+    m_field.mul(result.y, r, tmp);
+    m_field.mul(tmp, t.y, hhh);
+    m_field.sub(result.y, result.y, tmp);
+    // Z3 = Z1 H
+    m_field.mul(result.z, t.z, h);
+
+    if (line != 0)
+      {
+        // l = R (x_Q + x_P) - Z3 y_P + (Z3 y_Q) i
+        m_field.add(tmp, target->x, p.x);
+        m_field.mul(line->a, r, tmp);
+        m_field.mul(tmp, result.z, p.y);
+        m_field.sub(line->a, line->a, tmp);
+        m_field.mul(line->b, result.z, target->y);
+      }
+
+    t = result;
+    return line != 0;
+  }
+
+  /**
+   * @brief Same as pbc_mpz_from_hash: expands the hash to the byte length of the limit,
+   *        inserting a counter byte between copies, then halves it until it is not greater
+   *        than the limit
+   */
+  static Integer
+  integerFromHash(const uint8_t* hash, size_t hashLength, const Integer& limit)
+  {
+    size_t count = (limit.bitLength() + 7) / 8;
+    uint8_t buffer[N * 8];
+    size_t i = 0;
+    uint8_t counter = 0;
+    for (;;) {
+      size_t n = hashLength;
+      bool isDone = false;
+      if (hashLength >= count - i) {
+        n = count - i;
+        isDone = true;
+      }
+      std::copy(hash, hash + n, buffer + i);
+      i += n;
+      if (isDone)
+        break;
+      buffer[i] = counter;
+      counter++;
+      i++;
+      if (i == count)
+        break;
+    }
+
+    Integer z;
+    z.fromBytes(buffer, count);
+    while (Integer::compare(z, limit) > 0)
+      z.shiftRight1();
+    return z;
+  }
+
+private:
+  Field m_field;
+  Integer m_order;
+  Integer m_cofactor;
+};
+
+} // namespace ibas
+} // namespace ndn
+
+#endif // NDN_SECURITY_IBAS_TYPE_A_CURVE_HPP
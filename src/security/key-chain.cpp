@@ -694,6 +694,114 @@ KeyChain::signWithSha256(Data& data)
   data.setSignatureValue(sigValue);
 }
 
+std::vector<shared_ptr<Data> >
+KeyChain::signWithManifests(const std::vector<shared_ptr<Data> >& segments,
+                            size_t nSegmentsPerManifest, const Name& manifestPrefix)
+{
+  BOOST_ASSERT(nSegmentsPerManifest > 0);
+
+  std::vector<shared_ptr<Data> > manifests;
+  for (size_t first = 0; first < segments.size(); first += nSegmentsPerManifest) {
+    uint64_t firstSegment = 0;
+    try {
+      firstSegment = segments[first]->getName().get(-1).toSegment();
+    }
+    catch (const tlv::Error& e) {
+      throw Error(std::string("Segment is not named by a segment number: ") + e.what());
+    }
+
+    Name manifestName = Name(manifestPrefix).appendSegment(firstSegment);
+    Manifest manifest(firstSegment);
+    size_t last = std::min(first + nSegmentsPerManifest, segments.size());
+    for (size_t i = first; i < last; ++i) {
+      Data& data = *segments[i];
+      data.setSignature(Signature(SignatureInfo(tlv::DigestSha256, KeyLocator(manifestName))));
+
+      Block sigValue(tlv::SignatureValue,
+                     crypto::sha256(data.wireEncode().value(),
+                                    data.wireEncode().value_size() -
+                                    data.getSignature().getValue().size()));
+      data.setSignatureValue(sigValue);
+      manifest.addSegment(data);
+    }
+
+    shared_ptr<Data> manifestData = make_shared<Data>(manifestName);
+    manifestData->setContent(manifest.wireEncode());
+    sign(*manifestData);
+    manifests.push_back(manifestData);
+  }
+  return manifests;
+}
+
+void
+KeyChain::signBatch(std::vector<shared_ptr<Data> >& packets)
+{
+  if (!static_cast<bool>(m_pib->getDefaultCertificate()))
+    setDefaultCertificateInternal();
+
+  signBatch(packets, m_pib->getDefaultCertificate()->getName());
+}
+
+void
+KeyChain::signBatch(std::vector<shared_ptr<Data> >& packets, const Name& certificateName)
+{
+  if (packets.empty())
+    return;
+
+  shared_ptr<IdentityCertificate> certificate = m_pib->getCertificate(certificateName);
+  KeyLocator keyLocator(certificate->getName().getPrefix(-1));
+  shared_ptr<Signature> rootSignature =
+    determineSignatureWithPublicKey(keyLocator, certificate->getPublicKeyInfo().getKeyType());
+
+  if (!static_cast<bool>(rootSignature))
+    throw SecTpm::Error("unknown key type");
+
+  // levels of the tree, from the leaves up to the root
+  std::vector<std::vector<ConstBufferPtr> > levels(1);
+  SignatureSha256Merkle signature(keyLocator);
+  for (size_t i = 0; i < packets.size(); ++i) {
+    packets[i]->setSignature(signature);
+
+    EncodingBuffer encoder;
+    packets[i]->wireEncode(encoder, true);
+    levels[0].push_back(SignatureSha256Merkle::hashLeaf(encoder.buf(), encoder.size()));
+  }
+
+  while (levels.back().size() > 1) {
+    std::vector<ConstBufferPtr> parents;
+    const std::vector<ConstBufferPtr>& level = levels.back();
+    for (size_t i = 0; i < level.size(); i += 2) {
+      if (i + 1 < level.size())
+        parents.push_back(SignatureSha256Merkle::hashNode(*level[i], *level[i + 1]));
+      else
+        parents.push_back(level[i]);
+    }
+    levels.push_back(parents);
+  }
+
+  ConstBufferPtr root = levels.back().front();
+  Block rootValue = m_tpm->signInTpm(root->buf(), root->size(),
+                                     certificate->getPublicKeyName(), DIGEST_ALGORITHM_SHA256);
+
+  for (size_t i = 0; i < packets.size(); ++i) {
+    std::vector<ConstBufferPtr> siblings;
+    size_t index = i;
+    for (size_t level = 0; level + 1 < levels.size(); ++level, index /= 2) {
+      size_t sibling = index ^ 1;
+      if (sibling < levels[level].size())
+        siblings.push_back(levels[level][sibling]);
+    }
+
+    Block signatureValue =
+      SignatureSha256Merkle::encodeValue(rootSignature->getType(), rootValue,
+                                         i, packets.size(), siblings);
+
+    EncodingBuffer encoder;
+    packets[i]->wireEncode(encoder, true);
+    packets[i]->wireEncode(encoder, signatureValue);
+  }
+}
+
 void
 KeyChain::signWithSha256(Interest& interest)
 {
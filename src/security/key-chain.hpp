@@ -32,7 +32,9 @@
 #include "signature-sha256-with-rsa.hpp"
 #include "signature-sha256-with-ecdsa.hpp"
 #include "signature-sha256-ibas.hpp"
+#include "signature-sha256-merkle.hpp"
 #include "digest-sha256.hpp"
+#include "manifest.hpp"
 
 #include "ibas-signer.hpp"
 
@@ -311,6 +313,46 @@ public:
   void
   signWithSha256(Interest& interest);
 
+  /**
+   * @brief Sign segments of an object with manifests
+   *
+   * The segments are split in groups of @p nSegmentsPerManifest.  Each group is listed by a
+   * Manifest, carried by a Data named @p manifestPrefix followed by the segment number of the
+   * first segment of the group, and signed with the default certificate.  The segments get
+   * a DigestSha256 signature whose KeyLocator is the name of their manifest.
+   *
+   * @param segments consecutive segments in order, the last component of their names being
+   *                 the segment number
+   * @return the manifests, in order
+   * @throws Error if a segment is not named by a segment number
+   */
+  std::vector<shared_ptr<Data> >
+  signWithManifests(const std::vector<shared_ptr<Data> >& segments,
+                    size_t nSegmentsPerManifest, const Name& manifestPrefix);
+
+  /**
+   * @brief Sign a batch of Data packets with the default certificate, computing one signature
+   *        for all of them
+   *
+   * @see signBatch(std::vector<shared_ptr<Data> >&, const Name&)
+   */
+  void
+  signBatch(std::vector<shared_ptr<Data> >& packets);
+
+  /**
+   * @brief Sign a batch of Data packets with a certificate, computing one signature for all of
+   *        them
+   *
+   * The root of a Merkle tree over the signed portions of the packets is signed, and each
+   * packet gets a SignatureSha256Merkle carrying the signature of the root and the path from
+   * the packet to the root, so that it can be verified on its own.
+   *
+   * @param packets the packets to sign, which are not modified anymore once signed
+   * @param certificateName the name of the certificate, whose key is an RSA or ECDSA key
+   */
+  void
+  signBatch(std::vector<shared_ptr<Data> >& packets, const Name& certificateName);
+
   /**
    * @brief Generate a self-signed certificate for a public key.
    *
@@ -0,0 +1,103 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2015 Regents of the University of Tokyo.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+
+#include "manifest.hpp"
+#include "encoding/block-helpers.hpp"
+#include "encoding/tlv-security.hpp"
+#include "util/concepts.hpp"
+
+namespace ndn {
+
+BOOST_CONCEPT_ASSERT((WireEncodable<Manifest>));
+BOOST_CONCEPT_ASSERT((WireDecodable<Manifest>));
+static_assert(std::is_base_of<tlv::Error, Manifest::Error>::value,
+              "Manifest::Error must inherit from tlv::Error");
+
+Manifest::Manifest(uint64_t firstSegment)
+  : m_firstSegment(firstSegment)
+{
+}
+
+Manifest::Manifest(const Block& wire)
+{
+  this->wireDecode(wire);
+}
+
+void
+Manifest::wireDecode(const Block& wire)
+{
+  if (wire.type() != tlv::security::Manifest)
+    throw Error("Unexpected TLV type when decoding Manifest");
+
+  m_wire = wire;
+  m_wire.parse();
+
+  Block::element_const_iterator element = m_wire.elements_begin();
+  if (element == m_wire.elements_end() ||
+      element->type() != tlv::security::ManifestFirstSegment)
+    throw Error("ManifestFirstSegment is missing");
+  m_firstSegment = readNonNegativeInteger(*element);
+
+  m_digests.clear();
+  for (++element; element != m_wire.elements_end(); ++element) {
+    if (element->type() != tlv::ImplicitSha256DigestComponent)
+      throw Error("Unexpected TLV type in Manifest");
+
+    name::Component digest(*element);
+    if (!digest.isImplicitSha256Digest())
+      throw Error("Malformed ImplicitSha256DigestComponent in Manifest");
+    m_digests.push_back(digest);
+  }
+}
+
+const Block&
+Manifest::wireEncode() const
+{
+  if (m_wire.hasWire())
+    return m_wire;
+
+  m_wire = Block(tlv::security::Manifest);
+  m_wire.push_back(nonNegativeIntegerBlock(tlv::security::ManifestFirstSegment,
+                                           m_firstSegment));
+  for (std::vector<name::Component>::const_iterator digest = m_digests.begin();
+       digest != m_digests.end(); ++digest)
+    m_wire.push_back(*digest);
+
+  m_wire.encode();
+  return m_wire;
+}
+
+void
+Manifest::addSegment(const Data& segment)
+{
+  m_digests.push_back(segment.getFullName().get(-1));
+  m_wire = Block();
+}
+
+bool
+Manifest::matches(uint64_t segmentNo, const Data& segment) const
+{
+  return covers(segmentNo) &&
+         segment.getFullName().get(-1) == m_digests[segmentNo - m_firstSegment];
+}
+
+} // namespace ndn
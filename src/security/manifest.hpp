@@ -0,0 +1,118 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2015 Regents of the University of Tokyo.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+
+#ifndef NDN_SECURITY_MANIFEST_HPP
+#define NDN_SECURITY_MANIFEST_HPP
+
+#include "../common.hpp"
+#include "../data.hpp"
+
+namespace ndn {
+
+/**
+ * @brief List of the implicit SHA-256 digests of consecutive segments
+ *
+ * A manifest is carried as the content of a signed Data.  The segments it lists need only a
+ * DigestSha256 signature: once the manifest is verified, a segment is authenticated by
+ * comparing the implicit digest of its full name with the listed one.
+ *
+ *     Manifest ::= MANIFEST-TYPE TLV-LENGTH
+ *                    ManifestFirstSegment
+ *                    ImplicitSha256DigestComponent*
+ *
+ *     ManifestFirstSegment ::= MANIFEST-FIRST-SEGMENT-TYPE TLV-LENGTH nonNegativeInteger
+ *
+ * @sa KeyChain::signWithManifests
+ */
+class Manifest
+{
+public:
+  class Error : public tlv::Error
+  {
+  public:
+    explicit
+    Error(const std::string& what)
+      : tlv::Error(what)
+    {
+    }
+  };
+
+  explicit
+  Manifest(uint64_t firstSegment = 0);
+
+  /**
+   * @brief Decodes a manifest from its wire format
+   * @throws Error if decoding fails
+   */
+  explicit
+  Manifest(const Block& wire);
+
+  void
+  wireDecode(const Block& wire);
+
+  const Block&
+  wireEncode() const;
+
+  uint64_t
+  getFirstSegment() const
+  {
+    return m_firstSegment;
+  }
+
+  /**
+   * @return the number of listed segments
+   */
+  size_t
+  size() const
+  {
+    return m_digests.size();
+  }
+
+  /**
+   * @brief Lists @p segment as the segment following the last listed one
+   * @pre @p segment is signed, so that its full name is known
+   */
+  void
+  addSegment(const Data& segment);
+
+  bool
+  covers(uint64_t segmentNo) const
+  {
+    return segmentNo >= m_firstSegment && segmentNo - m_firstSegment < m_digests.size();
+  }
+
+  /**
+   * @return whether @p segment is listed as segment @p segmentNo
+   */
+  bool
+  matches(uint64_t segmentNo, const Data& segment) const;
+
+private:
+  uint64_t m_firstSegment;
+  std::vector<name::Component> m_digests;
+
+  mutable Block m_wire;
+};
+
+} // namespace ndn
+
+#endif // NDN_SECURITY_MANIFEST_HPP
@@ -0,0 +1,167 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2015 Regents of the University of Tokyo.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+
+#include "signature-sha256-merkle.hpp"
+#include "cryptopp.hpp"
+#include "encoding/block-helpers.hpp"
+#include "encoding/tlv-security.hpp"
+#include "util/crypto.hpp"
+
+namespace ndn {
+
+static const uint8_t LEAF_PREFIX = 0x00;
+static const uint8_t NODE_PREFIX = 0x01;
+
+SignatureSha256Merkle::SignatureSha256Merkle(const KeyLocator& keyLocator)
+  : Signature(SignatureInfo(tlv::SignatureSha256Merkle, keyLocator))
+  , m_rootSignatureType(tlv::DigestSha256)
+  , m_leafIndex(0)
+  , m_nLeaves(0)
+{
+}
+
+SignatureSha256Merkle::SignatureSha256Merkle(const Signature& signature)
+  : Signature(signature)
+  , m_rootSignatureType(tlv::DigestSha256)
+  , m_leafIndex(0)
+  , m_nLeaves(0)
+{
+  if (getType() != tlv::SignatureSha256Merkle)
+    throw Error("Incorrect signature type");
+
+  if (!hasKeyLocator())
+    throw Error("KeyLocator is missing");
+
+  if (getValue().hasWire())
+    decodeValue(getValue());
+}
+
+static const Block&
+readElement(const Block& wire, Block::element_const_iterator& element, uint32_t type)
+{
+  if (element == wire.elements_end() || element->type() != type)
+    throw SignatureSha256Merkle::Error("Incomplete Merkle inclusion proof");
+  return *element++;
+}
+
+void
+SignatureSha256Merkle::decodeValue(const Block& value)
+{
+  Block wire = value;
+  wire.parse();
+
+  Block::element_const_iterator element = wire.elements_begin();
+  m_rootSignatureType =
+    readNonNegativeInteger(readElement(wire, element, tlv::security::MerkleRootSignatureType));
+  const Block& rootSignature = readElement(wire, element, tlv::security::MerkleRootSignature);
+  m_rootSignature = Block(tlv::SignatureValue,
+                          make_shared<Buffer>(rootSignature.value(), rootSignature.value_size()));
+  m_leafIndex = readNonNegativeInteger(readElement(wire, element, tlv::security::MerkleLeafIndex));
+  m_nLeaves = readNonNegativeInteger(readElement(wire, element, tlv::security::MerkleNLeaves));
+
+  m_siblings.clear();
+  for (; element != wire.elements_end(); ++element) {
+    if (element->type() != tlv::security::MerkleSibling ||
+        element->value_size() != crypto::SHA256_DIGEST_SIZE)
+      throw Error("Malformed MerkleSibling");
+    m_siblings.push_back(make_shared<Buffer>(element->value(), element->value_size()));
+  }
+}
+
+ConstBufferPtr
+SignatureSha256Merkle::computeRoot(const uint8_t* buf, size_t size) const
+{
+  if (m_leafIndex >= m_nLeaves)
+    return ConstBufferPtr();
+
+  ConstBufferPtr digest = hashLeaf(buf, size);
+  std::vector<ConstBufferPtr>::const_iterator sibling = m_siblings.begin();
+  uint64_t index = m_leafIndex;
+  for (uint64_t nNodes = m_nLeaves; nNodes > 1; nNodes = (nNodes + 1) / 2, index /= 2) {
+    // the last node of an odd level has no sibling
+    if (index % 2 == 0 && index + 1 == nNodes)
+      continue;
+
+    if (sibling == m_siblings.end())
+      return ConstBufferPtr();
+    digest = index % 2 == 0 ? hashNode(*digest, **sibling) : hashNode(**sibling, *digest);
+    ++sibling;
+  }
+
+  if (sibling != m_siblings.end())
+    return ConstBufferPtr();
+  return digest;
+}
+
+Block
+SignatureSha256Merkle::encodeValue(uint32_t rootSignatureType, const Block& rootSignature,
+                                   uint64_t leafIndex, uint64_t nLeaves,
+                                   const std::vector<ConstBufferPtr>& siblings)
+{
+  Block value(tlv::SignatureValue);
+  value.push_back(nonNegativeIntegerBlock(tlv::security::MerkleRootSignatureType,
+                                          rootSignatureType));
+  value.push_back(dataBlock(tlv::security::MerkleRootSignature,
+                            rootSignature.value(), rootSignature.value_size()));
+  value.push_back(nonNegativeIntegerBlock(tlv::security::MerkleLeafIndex, leafIndex));
+  value.push_back(nonNegativeIntegerBlock(tlv::security::MerkleNLeaves, nLeaves));
+  for (std::vector<ConstBufferPtr>::const_iterator sibling = siblings.begin();
+       sibling != siblings.end(); ++sibling)
+    value.push_back(dataBlock(tlv::security::MerkleSibling,
+                              (*sibling)->buf(), (*sibling)->size()));
+
+  value.encode();
+  return value;
+}
+
+ConstBufferPtr
+SignatureSha256Merkle::hashLeaf(const uint8_t* buf, size_t size)
+{
+  CryptoPP::SHA256 hash;
+  hash.Update(&LEAF_PREFIX, 1);
+  hash.Update(buf, size);
+
+  shared_ptr<Buffer> digest = make_shared<Buffer>(crypto::SHA256_DIGEST_SIZE);
+  hash.Final(digest->buf());
+  return digest;
+}
+
+ConstBufferPtr
+SignatureSha256Merkle::hashNode(const Buffer& left, const Buffer& right)
+{
+  CryptoPP::SHA256 hash;
+  hash.Update(&NODE_PREFIX, 1);
+  hash.Update(left.buf(), left.size());
+  hash.Update(right.buf(), right.size());
+
+  shared_ptr<Buffer> digest = make_shared<Buffer>(crypto::SHA256_DIGEST_SIZE);
+  hash.Final(digest->buf());
+  return digest;
+}
+
+void
+SignatureSha256Merkle::unsetKeyLocator()
+{
+  throw Error("KeyLocator cannot be reset for SignatureSha256Merkle");
+}
+
+} // namespace ndn
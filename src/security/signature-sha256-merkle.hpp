@@ -0,0 +1,141 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2015 Regents of the University of Tokyo.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+
+#ifndef NDN_SECURITY_SIGNATURE_SHA256_MERKLE_HPP
+#define NDN_SECURITY_SIGNATURE_SHA256_MERKLE_HPP
+
+#include "../signature.hpp"
+
+namespace ndn {
+
+/**
+ * @brief Signature of a packet signed in a batch, with one signature over a Merkle tree
+ *
+ * The leaves of the tree are the SHA-256 digests of the signed portions of the packets of the
+ * batch, and each node is the SHA-256 digest of its two children.  A node without a sibling,
+ * at the end of an odd level, is moved up unchanged.  Leaves are prefixed by 0x00 and nodes by
+ * 0x01 before hashing, so that a leaf cannot pass for a node.
+ *
+ * The root is signed with the key named by the KeyLocator.  The SignatureValue of each packet
+ * carries that signature and the path from the packet to the root:
+ *
+ *     SignatureValue ::= SIGNATURE-VALUE-TYPE TLV-LENGTH
+ *                          MerkleRootSignatureType  ; SignatureSha256WithRsa or WithEcdsa
+ *                          MerkleRootSignature      ; value of the root SignatureValue
+ *                          MerkleLeafIndex
+ *                          MerkleNLeaves
+ *                          MerkleSibling*           ; from the leaf level up
+ *
+ * @sa KeyChain::signBatch
+ */
+class SignatureSha256Merkle : public Signature
+{
+public:
+  class Error : public Signature::Error
+  {
+  public:
+    explicit
+    Error(const std::string& what)
+      : Signature::Error(what)
+    {
+    }
+  };
+
+  explicit
+  SignatureSha256Merkle(const KeyLocator& keyLocator = KeyLocator());
+
+  /**
+   * @brief Decodes the inclusion proof in the value of @p signature, if it has one
+   * @throws Error if @p signature is not a SignatureSha256Merkle or cannot be decoded
+   */
+  explicit
+  SignatureSha256Merkle(const Signature& signature);
+
+  uint32_t
+  getRootSignatureType() const
+  {
+    return m_rootSignatureType;
+  }
+
+  /**
+   * @return the signature of the root, as a SignatureValue block
+   */
+  const Block&
+  getRootSignature() const
+  {
+    return m_rootSignature;
+  }
+
+  uint64_t
+  getLeafIndex() const
+  {
+    return m_leafIndex;
+  }
+
+  uint64_t
+  getNLeaves() const
+  {
+    return m_nLeaves;
+  }
+
+  /**
+   * @brief Computes the root of the tree from the signed portion of the packet and the
+   *        inclusion proof
+   * @return the root, or a null pointer if the proof does not fit the shape of the tree
+   */
+  ConstBufferPtr
+  computeRoot(const uint8_t* buf, size_t size) const;
+
+  /**
+   * @brief Encodes an inclusion proof as a SignatureValue
+   * @param rootSignature the SignatureValue of the root
+   * @param siblings the siblings of the nodes on the path from the leaf to the root
+   */
+  static Block
+  encodeValue(uint32_t rootSignatureType, const Block& rootSignature,
+              uint64_t leafIndex, uint64_t nLeaves,
+              const std::vector<ConstBufferPtr>& siblings);
+
+  static ConstBufferPtr
+  hashLeaf(const uint8_t* buf, size_t size);
+
+  static ConstBufferPtr
+  hashNode(const Buffer& left, const Buffer& right);
+
+private:
+  void
+  decodeValue(const Block& value);
+
+  void
+  unsetKeyLocator();
+
+private:
+  uint32_t m_rootSignatureType;
+  Block m_rootSignature;
+  uint64_t m_leafIndex;
+  uint64_t m_nLeaves;
+  std::vector<ConstBufferPtr> m_siblings;
+};
+
+} // namespace ndn
+
+#endif // NDN_SECURITY_SIGNATURE_SHA256_MERKLE_HPP
@@ -30,13 +30,15 @@
 
 #include "cryptopp.hpp"
 
+#include <deque>
+#include <mutex>
+#include <set>
+
 namespace ndn {
 
 static OID SECP256R1("1.2.840.10045.3.1.7");
 static OID SECP384R1("1.3.132.0.34");
 
-IbasSigner Validator::s_ibas = IbasSigner();
-
 Validator::Validator(Face* face)
   : m_face(face)
 {
@@ -108,7 +110,12 @@ Validator::onData(const Interest& interest,
 bool
 Validator::verifySignatureIbas(const Data& data)
 {
-  return s_ibas.verifySignature(data);
+  // Public params are loaded only when the first IBAS packet needs to be verified
+  static IbasSigner ibas;
+  static std::mutex ibasMutex;
+
+  std::lock_guard<std::mutex> lock(ibasMutex);
+  return ibas.verifySignature(data);
 }
 
 bool
@@ -236,6 +243,8 @@ Validator::verifySignature(const uint8_t* buf,
                 return false;
               }
           }
+        case tlv::SignatureSha256Merkle:
+          return verifySignatureMerkle(buf, size, sig, key);
         default:
           // Unsupported sig type
           return false;
@@ -247,6 +256,68 @@ Validator::verifySignature(const uint8_t* buf,
     }
 }
 
+bool
+Validator::verifySignatureMerkle(const uint8_t* buf, size_t size, const Signature& sig,
+                                 const PublicKey& key)
+{
+  static const size_t MAX_VERIFIED_ROOTS = 1024;
+  static std::set<std::string> verifiedRoots;
+  static std::deque<std::string> verifiedRootsOrder; ///< oldest first, for eviction
+  static std::mutex verifiedRootsMutex;
+
+  ConstBufferPtr root;
+  uint32_t rootSignatureType = tlv::DigestSha256;
+  Block rootSignatureValue;
+  try
+    {
+      SignatureSha256Merkle merkle(sig);
+      root = merkle.computeRoot(buf, size);
+      rootSignatureType = merkle.getRootSignatureType();
+      rootSignatureValue = merkle.getRootSignature();
+    }
+  catch (tlv::Error& e)
+    {
+      return false;
+    }
+
+  if (!static_cast<bool>(root) ||
+      (rootSignatureType != tlv::SignatureSha256WithRsa &&
+       rootSignatureType != tlv::SignatureSha256WithEcdsa))
+    return false;
+
+  using namespace CryptoPP;
+
+  std::string id(crypto::SHA256_DIGEST_SIZE, '\0');
+  SHA256 hash;
+  hash.Update(root->buf(), root->size());
+  hash.Update(rootSignatureValue.value(), rootSignatureValue.value_size());
+  hash.Update(key.get().buf(), key.get().size());
+  hash.Final(reinterpret_cast<byte*>(&id[0]));
+
+  {
+    std::lock_guard<std::mutex> lock(verifiedRootsMutex);
+    if (verifiedRoots.count(id) > 0)
+      return true;
+  }
+
+  Signature rootSignature(SignatureInfo(static_cast<tlv::SignatureTypeValue>(rootSignatureType)),
+                          rootSignatureValue);
+  if (!verifySignature(root->buf(), root->size(), rootSignature, key))
+    return false;
+
+  std::lock_guard<std::mutex> lock(verifiedRootsMutex);
+  if (verifiedRoots.insert(id).second)
+    {
+      verifiedRootsOrder.push_back(id);
+      if (verifiedRootsOrder.size() > MAX_VERIFIED_ROOTS)
+        {
+          verifiedRoots.erase(verifiedRootsOrder.front());
+          verifiedRootsOrder.pop_front();
+        }
+    }
+  return true;
+}
+
 bool
 Validator::verifySignature(const uint8_t* buf, const size_t size, const DigestSha256& sig)
 {
@@ -34,6 +34,7 @@
 #include "signature-sha256-with-rsa.hpp"
 #include "signature-sha256-with-ecdsa.hpp"
 #include "digest-sha256.hpp"
+#include "signature-sha256-merkle.hpp"
 #include "validation-request.hpp"
 #include "ibas-signer.hpp"
 
@@ -109,6 +110,10 @@ public:
    * @brief Verify the data using IBAS verification
    *        The data's content should contain exactly one 'From: <ID>' part, and zero or more
    *        'Moderator: <ID>' parts.
+   *
+   * The verification is done by an IbasSigner shared by all validators of the process. It is
+   * created on first use and the calls into it are serialized, so the method can be called from
+   * multiple threads.
    */
   static bool
   verifySignatureIbas(const Data& data);
@@ -208,6 +213,20 @@ public:
   static bool
   verifySignature(const uint8_t* buf, const size_t size, const DigestSha256& sig);
 
+private:
+  /**
+   * @brief Verify the blob against a SignatureSha256Merkle, by verifying the signature of the
+   *        root computed from the blob and the inclusion proof
+   *
+   * Verified roots are kept in a cache shared by all validators of the process, so that the
+   * other packets of a batch are verified by hashing only.  A root is cached together with its
+   * signature and the public key, so a packet carrying a different signature of the same root
+   * is verified again.
+   */
+  static bool
+  verifySignatureMerkle(const uint8_t* buf, size_t size, const Signature& sig,
+                        const PublicKey& publicKey);
+
 protected:
   /**
    * @brief Check the Data against policy and return the next validation step if necessary.
@@ -321,8 +340,6 @@ protected:
 
 protected:
   Face* m_face;
-private:
-  static IbasSigner s_ibas;
 };
 
 } // namespace ndn
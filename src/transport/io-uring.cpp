@@ -0,0 +1,254 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2015 Regents of the University of Tokyo.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "io-uring.hpp"
+
+#ifdef NDN_CXX_HAVE_IO_URING
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace ndn {
+
+static std::string
+makeErrorMessage(const std::string& what)
+{
+  return what + " (" + std::strerror(errno) + ")";
+}
+
+template<typename T>
+static T
+loadAcquire(const T* p)
+{
+  return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+template<typename T>
+static void
+storeRelease(T* p, T value)
+{
+  __atomic_store_n(p, value, __ATOMIC_RELEASE);
+}
+
+static void*
+mapMemory(size_t size, int fd, off_t offset)
+{
+  int flags = fd < 0 ? (MAP_PRIVATE | MAP_ANONYMOUS) : (MAP_SHARED | MAP_POPULATE);
+  void* memory = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, flags, fd, offset);
+  return memory == MAP_FAILED ? nullptr : memory;
+}
+
+IoUring::IoUring(unsigned nEntries)
+  : m_fd(-1)
+  , m_sqRing(nullptr)
+  , m_sqRingSize(0)
+  , m_cqRing(nullptr)
+  , m_cqRingSize(0)
+  , m_sqes(nullptr)
+  , m_sqesSize(0)
+  , m_sqLocalTail(0)
+  , m_nUnsubmitted(0)
+  , m_bufferRing(nullptr)
+  , m_bufferRingSize(0)
+  , m_buffers(nullptr)
+  , m_bufferSize(0)
+  , m_nBuffers(0)
+  , m_bufferRingTail(0)
+{
+  io_uring_params params;
+  std::memset(&params, 0, sizeof(params));
+
+  m_fd = ::syscall(__NR_io_uring_setup, nEntries, &params);
+  if (m_fd < 0)
+    throw Error(makeErrorMessage("io_uring_setup failed"));
+
+  m_sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  m_cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  bool isSingleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (isSingleMap)
+    m_sqRingSize = m_cqRingSize = std::max(m_sqRingSize, m_cqRingSize);
+
+  m_sqRing = mapMemory(m_sqRingSize, m_fd, IORING_OFF_SQ_RING);
+  if (m_sqRing != nullptr)
+    m_cqRing = isSingleMap ? m_sqRing : mapMemory(m_cqRingSize, m_fd, IORING_OFF_CQ_RING);
+  m_sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+  if (m_cqRing != nullptr)
+    m_sqes = static_cast<io_uring_sqe*>(mapMemory(m_sqesSize, m_fd, IORING_OFF_SQES));
+
+  if (m_sqes == nullptr) {
+    std::string message = makeErrorMessage("cannot map io_uring queues");
+    release();
+    throw Error(message);
+  }
+
+  uint8_t* sq = static_cast<uint8_t*>(m_sqRing);
+  m_sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+  m_sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+  m_sqMask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+  m_sqEntries = params.sq_entries;
+  m_sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+  m_sqLocalTail = *m_sqTail;
+
+  uint8_t* cq = static_cast<uint8_t*>(m_cqRing);
+  m_cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+  m_cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+  m_cqMask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+  m_cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+}
+
+IoUring::~IoUring()
+{
+  release();
+}
+
+void
+IoUring::release()
+{
+  // closing the ring cancels the operations in progress and unregisters the buffer ring
+  if (m_fd >= 0)
+    ::close(m_fd);
+
+  if (m_buffers != nullptr)
+    ::munmap(m_buffers, m_bufferSize * m_nBuffers);
+  if (m_bufferRing != nullptr)
+    ::munmap(m_bufferRing, m_bufferRingSize);
+  if (m_sqes != nullptr)
+    ::munmap(m_sqes, m_sqesSize);
+  if (m_cqRing != nullptr && m_cqRing != m_sqRing)
+    ::munmap(m_cqRing, m_cqRingSize);
+  if (m_sqRing != nullptr)
+    ::munmap(m_sqRing, m_sqRingSize);
+}
+
+io_uring_sqe*
+IoUring::getSqe()
+{
+  if (m_sqLocalTail - loadAcquire(m_sqHead) >= m_sqEntries)
+    return nullptr;
+
+  unsigned index = m_sqLocalTail & m_sqMask;
+  io_uring_sqe* sqe = &m_sqes[index];
+  std::memset(sqe, 0, sizeof(*sqe));
+  m_sqArray[index] = index;
+  ++m_sqLocalTail;
+  ++m_nUnsubmitted;
+  return sqe;
+}
+
+void
+IoUring::submit()
+{
+  if (m_nUnsubmitted > 0)
+    enter(0, 0);
+}
+
+void
+IoUring::wait()
+{
+  enter(1, IORING_ENTER_GETEVENTS);
+}
+
+void
+IoUring::enter(unsigned minComplete, unsigned flags)
+{
+  storeRelease(m_sqTail, m_sqLocalTail);
+
+  int nSubmitted;
+  do {
+    nSubmitted = ::syscall(__NR_io_uring_enter, m_fd, m_nUnsubmitted, minComplete, flags,
+                           nullptr, 0);
+  } while (nSubmitted < 0 && errno == EINTR);
+
+  if (nSubmitted < 0)
+    throw Error(makeErrorMessage("io_uring_enter failed"));
+
+  m_nUnsubmitted -= nSubmitted;
+}
+
+bool
+IoUring::hasCompletions() const
+{
+  return loadAcquire(m_cqTail) != *m_cqHead;
+}
+
+void
+IoUring::reapCompletions(std::vector<Completion>& completions)
+{
+  unsigned head = *m_cqHead;
+  unsigned tail = loadAcquire(m_cqTail);
+
+  for (; head != tail; ++head) {
+    const io_uring_cqe& cqe = m_cqes[head & m_cqMask];
+    Completion completion = {cqe.user_data, cqe.res, cqe.flags};
+    completions.push_back(completion);
+  }
+
+  storeRelease(m_cqHead, head);
+}
+
+void
+IoUring::registerBufferRing(uint16_t groupId, uint16_t nBuffers, size_t bufferSize)
+{
+  BOOST_ASSERT(m_bufferRing == nullptr);
+  BOOST_ASSERT(nBuffers > 0 && (nBuffers & (nBuffers - 1)) == 0);
+
+  m_bufferRingSize = nBuffers * sizeof(io_uring_buf);
+  m_bufferRing = static_cast<io_uring_buf*>(mapMemory(m_bufferRingSize, -1, 0));
+  if (m_bufferRing == nullptr)
+    throw Error(makeErrorMessage("cannot allocate the buffer ring"));
+
+  io_uring_buf_reg registration;
+  std::memset(&registration, 0, sizeof(registration));
+  registration.ring_addr = reinterpret_cast<uint64_t>(m_bufferRing);
+  registration.ring_entries = nBuffers;
+  registration.bgid = groupId;
+  if (::syscall(__NR_io_uring_register, m_fd, IORING_REGISTER_PBUF_RING, &registration, 1) < 0)
+    throw Error(makeErrorMessage("cannot register the buffer ring"));
+
+  m_buffers = static_cast<uint8_t*>(mapMemory(bufferSize * nBuffers, -1, 0));
+  if (m_buffers == nullptr)
+    throw Error(makeErrorMessage("cannot allocate the provided buffers"));
+  m_bufferSize = bufferSize;
+  m_nBuffers = nBuffers;
+
+  for (uint16_t i = 0; i < nBuffers; ++i)
+    recycleBuffer(i);
+}
+
+void
+IoUring::recycleBuffer(uint16_t bufferId)
+{
+  io_uring_buf& buffer = m_bufferRing[m_bufferRingTail & (m_nBuffers - 1)];
+  buffer.addr = reinterpret_cast<uint64_t>(getBuffer(bufferId));
+  buffer.len = m_bufferSize;
+  buffer.bid = bufferId;
+
+  ++m_bufferRingTail;
+  storeRelease(&m_bufferRing[0].resv, m_bufferRingTail);
+}
+
+} // namespace ndn
+
+#endif // NDN_CXX_HAVE_IO_URING
@@ -0,0 +1,180 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2015 Regents of the University of Tokyo.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_TRANSPORT_IO_URING_HPP
+#define NDN_TRANSPORT_IO_URING_HPP
+
+#include "../common.hpp"
+
+#ifdef NDN_CXX_HAVE_IO_URING
+
+#include <vector>
+#include <linux/io_uring.h>
+
+namespace ndn {
+
+/**
+ * @brief Minimal io_uring instance, driven through the raw system calls
+ *
+ * Besides the submission and completion queues, the ring can hold one ring of provided
+ * buffers, registered with the kernel, from which receive operations with IOSQE_BUFFER_SELECT
+ * pick the buffer to fill.
+ *
+ * All methods must be called from one thread at a time.
+ */
+class IoUring : noncopyable
+{
+public:
+  class Error : public std::runtime_error
+  {
+  public:
+    explicit
+    Error(const std::string& what)
+      : std::runtime_error(what)
+    {
+    }
+  };
+
+  struct Completion
+  {
+    uint64_t userData;
+    int32_t result;
+    uint32_t flags;
+  };
+
+  /**
+   * @brief Sets up a ring with room for @p nEntries submissions
+   * @throws Error if io_uring is not available, e.g., not supported by the kernel or
+   *         forbidden by a seccomp policy
+   */
+  explicit
+  IoUring(unsigned nEntries);
+
+  ~IoUring();
+
+  /**
+   * @brief Get the file descriptor of the ring, which is readable when completions are
+   *        available
+   */
+  int
+  getFd() const
+  {
+    return m_fd;
+  }
+
+  /**
+   * @return a cleared submission entry, or nullptr if the submission queue is full
+   */
+  io_uring_sqe*
+  getSqe();
+
+  /**
+   * @brief Hands the entries obtained from getSqe to the kernel, with one system call
+   * @throws Error on failure
+   */
+  void
+  submit();
+
+  /**
+   * @brief Submits the pending entries and blocks until a completion is available
+   * @throws Error on failure
+   */
+  void
+  wait();
+
+  bool
+  hasCompletions() const;
+
+  /**
+   * @brief Appends the available completions to @p completions and removes them from the
+   *        completion queue
+   */
+  void
+  reapCompletions(std::vector<Completion>& completions);
+
+  /**
+   * @brief Registers a ring of @p nBuffers buffers of @p bufferSize bytes as buffer group
+   *        @p groupId
+   * @param nBuffers a power of two
+   * @throws Error if the kernel does not support provided buffer rings
+   */
+  void
+  registerBufferRing(uint16_t groupId, uint16_t nBuffers, size_t bufferSize);
+
+  uint8_t*
+  getBuffer(uint16_t bufferId)
+  {
+    return m_buffers + static_cast<size_t>(bufferId) * m_bufferSize;
+  }
+
+  /**
+   * @brief Gives buffer @p bufferId back to the kernel once its content has been consumed
+   */
+  void
+  recycleBuffer(uint16_t bufferId);
+
+private:
+  void
+  enter(unsigned minComplete, unsigned flags);
+
+  void
+  release();
+
+private:
+  int m_fd;
+
+  void* m_sqRing;
+  size_t m_sqRingSize;
+  void* m_cqRing;
+  size_t m_cqRingSize;
+  io_uring_sqe* m_sqes;
+  size_t m_sqesSize;
+
+  unsigned* m_sqHead;
+  unsigned* m_sqTail;
+  unsigned m_sqMask;
+  unsigned m_sqEntries;
+  unsigned* m_sqArray;
+  unsigned m_sqLocalTail; ///< tail including the entries not submitted yet
+  unsigned m_nUnsubmitted;
+
+  unsigned* m_cqHead;
+  unsigned* m_cqTail;
+  unsigned m_cqMask;
+  io_uring_cqe* m_cqes;
+
+  /**
+   * The tail of the ring overlaps the resv field of the first entry.  io_uring_buf_ring is not
+   * used: in C++, its flexible array member does not start at offset 0.
+   */
+  io_uring_buf* m_bufferRing;
+  size_t m_bufferRingSize;
+  uint8_t* m_buffers;
+  size_t m_bufferSize;
+  uint16_t m_nBuffers;
+  uint16_t m_bufferRingTail;
+};
+
+} // namespace ndn
+
+#endif // NDN_CXX_HAVE_IO_URING
+
+#endif // NDN_TRANSPORT_IO_URING_HPP
@@ -0,0 +1,550 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2015 Regents of the University of Tokyo.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "shm-channel.hpp"
+
+#ifdef NDN_CXX_HAVE_EVENTFD
+
+#include "../util/random.hpp"
+
+#include <boost/lexical_cast.hpp>
+
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace ndn {
+
+/**
+ * @brief Start of the shared memory segment, followed by the ring from the client to the
+ *        peer, then by the ring from the peer to the client
+ */
+struct ShmSegmentHeader
+{
+  uint32_t magic;
+  uint32_t capacity;
+};
+
+static const uint32_t SHM_SEGMENT_MAGIC = 0x4e444e53; // "NDNS"
+static const size_t SHM_SEGMENT_HEADER_SIZE = 64; // keeps the rings on cache lines of their own
+
+/// how long accept waits for the descriptors of a connecting client
+static const int SHM_ACCEPT_TIMEOUT = 4000; // milliseconds
+
+static size_t
+getSegmentSize(size_t capacity)
+{
+  return SHM_SEGMENT_HEADER_SIZE + 2 * ShmRing::getMemorySize(capacity);
+}
+
+static std::string
+makeErrorMessage(const std::string& what)
+{
+  return what + " (" + std::strerror(errno) + ")";
+}
+
+/**
+ * @brief Closes a file descriptor unless it is released
+ */
+class FileDescriptor : noncopyable
+{
+public:
+  explicit
+  FileDescriptor(int fd = -1)
+    : m_fd(fd)
+  {
+  }
+
+  ~FileDescriptor()
+  {
+    if (m_fd >= 0)
+      ::close(m_fd);
+  }
+
+  int
+  get() const
+  {
+    return m_fd;
+  }
+
+  int
+  release()
+  {
+    int fd = m_fd;
+    m_fd = -1;
+    return fd;
+  }
+
+private:
+  int m_fd;
+};
+
+unique_ptr<ShmChannel>
+ShmChannel::connect(boost::asio::io_service& ioService, const std::string& socketPath,
+                    size_t capacity)
+{
+  if (capacity < MAX_NDN_PACKET_SIZE || (capacity & (capacity - 1)) != 0 ||
+      capacity > std::numeric_limits<uint32_t>::max())
+    throw Error("the capacity of the rings must be a power of two of at least " +
+                boost::lexical_cast<std::string>(MAX_NDN_PACKET_SIZE));
+
+  sockaddr_un address;
+  std::memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (socketPath.size() >= sizeof(address.sun_path))
+    throw Error("socket path is too long: " + socketPath);
+  std::copy(socketPath.begin(), socketPath.end(), address.sun_path);
+
+  FileDescriptor socket(::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0));
+  if (socket.get() < 0 ||
+      ::connect(socket.get(), reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0)
+    throw Error(makeErrorMessage("cannot connect to " + socketPath));
+
+  // the segment has no name once both ends have it
+  std::string name = "/ndn-shm-" + boost::lexical_cast<std::string>(::getpid()) + "-" +
+                     boost::lexical_cast<std::string>(random::generateWord32());
+  FileDescriptor segmentFd(::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC,
+                                      0600));
+  if (segmentFd.get() < 0)
+    throw Error(makeErrorMessage("cannot create the shared memory segment"));
+  ::shm_unlink(name.c_str());
+
+  size_t segmentSize = getSegmentSize(capacity);
+  if (::ftruncate(segmentFd.get(), segmentSize) < 0)
+    throw Error(makeErrorMessage("cannot size the shared memory segment"));
+
+  FileDescriptor doorbell(::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC));
+  FileDescriptor remoteDoorbell(::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC));
+  if (doorbell.get() < 0 || remoteDoorbell.get() < 0)
+    throw Error(makeErrorMessage("cannot create the doorbells"));
+
+  void* segment = ::mmap(nullptr, segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED,
+                         segmentFd.get(), 0);
+  if (segment == MAP_FAILED)
+    throw Error(makeErrorMessage("cannot map the shared memory segment"));
+
+  ShmSegmentHeader* header = static_cast<ShmSegmentHeader*>(segment);
+  header->magic = SHM_SEGMENT_MAGIC;
+  header->capacity = capacity;
+
+  // the channel initializes the rings, so it is created before the peer gets the segment
+  unique_ptr<ShmChannel> channel(new ShmChannel(ioService, static_cast<uint8_t*>(segment),
+                                                capacity, true, socket.release(),
+                                                doorbell.release(), remoteDoorbell.release()));
+
+  // the peer receives the segment, its own doorbell, then the doorbell of the client
+  int fds[] = {segmentFd.get(), channel->m_remoteDoorbell, channel->m_doorbell.native_handle()};
+  char control[CMSG_SPACE(sizeof(fds))];
+  std::memset(control, 0, sizeof(control));
+  uint8_t byte = 0;
+  iovec iov = {&byte, 1};
+
+  msghdr message = msghdr();
+  message.msg_iov = &iov;
+  message.msg_iovlen = 1;
+  message.msg_control = control;
+  message.msg_controllen = sizeof(control);
+  cmsghdr* cmsg = CMSG_FIRSTHDR(&message);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+  std::memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+
+  if (::sendmsg(channel->m_socket.native_handle(), &message, MSG_NOSIGNAL) != 1)
+    throw Error(makeErrorMessage("cannot hand the shared memory segment to " + socketPath));
+
+  return channel;
+}
+
+unique_ptr<ShmChannel>
+ShmChannel::accept(boost::asio::io_service& ioService, int socketFd)
+{
+  FileDescriptor socket(socketFd);
+
+  pollfd pfd = {socketFd, POLLIN, 0};
+  if (::poll(&pfd, 1, SHM_ACCEPT_TIMEOUT) != 1)
+    throw Error("the client did not hand a shared memory segment");
+
+  int fds[3];
+  char control[CMSG_SPACE(sizeof(fds))];
+  uint8_t byte = 0;
+  iovec iov = {&byte, 1};
+
+  msghdr message = msghdr();
+  message.msg_iov = &iov;
+  message.msg_iovlen = 1;
+  message.msg_control = control;
+  message.msg_controllen = sizeof(control);
+
+  if (::recvmsg(socketFd, &message, MSG_CMSG_CLOEXEC) != 1)
+    throw Error(makeErrorMessage("cannot receive the shared memory segment"));
+
+  cmsghdr* cmsg = CMSG_FIRSTHDR(&message);
+  if (cmsg == nullptr || cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS ||
+      cmsg->cmsg_len != CMSG_LEN(sizeof(fds)))
+    throw Error("the client did not hand a shared memory segment");
+  std::memcpy(fds, CMSG_DATA(cmsg), sizeof(fds));
+
+  FileDescriptor segmentFd(fds[0]);
+  FileDescriptor doorbell(fds[1]);
+  FileDescriptor remoteDoorbell(fds[2]);
+
+  struct stat status;
+  if (::fstat(segmentFd.get(), &status) < 0 ||
+      static_cast<size_t>(status.st_size) < SHM_SEGMENT_HEADER_SIZE)
+    throw Error("invalid shared memory segment");
+
+  size_t segmentSize = status.st_size;
+  void* segment = ::mmap(nullptr, segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED,
+                         segmentFd.get(), 0);
+  if (segment == MAP_FAILED)
+    throw Error(makeErrorMessage("cannot map the shared memory segment"));
+
+  const ShmSegmentHeader* header = static_cast<const ShmSegmentHeader*>(segment);
+  size_t capacity = header->capacity;
+  if (header->magic != SHM_SEGMENT_MAGIC || capacity < MAX_NDN_PACKET_SIZE ||
+      (capacity & (capacity - 1)) != 0 || getSegmentSize(capacity) != segmentSize)
+    {
+      ::munmap(segment, segmentSize);
+      throw Error("invalid shared memory segment");
+    }
+
+  return unique_ptr<ShmChannel>(new ShmChannel(ioService, static_cast<uint8_t*>(segment),
+                                               capacity, false, socket.release(),
+                                               doorbell.release(), remoteDoorbell.release()));
+}
+
+ShmChannel::ShmChannel(boost::asio::io_service& ioService, uint8_t* segment, size_t capacity,
+                       bool isClient, int socketFd, int doorbell, int remoteDoorbell)
+  : m_strand(nullptr)
+  , m_segment(segment)
+  , m_segmentSize(getSegmentSize(capacity))
+  , m_socket(ioService, boost::asio::local::stream_protocol(), socketFd)
+  , m_socketByte(0)
+  , m_doorbell(ioService, doorbell)
+  , m_remoteDoorbell(remoteDoorbell)
+  , m_isOpen(true)
+  , m_isExpectingData(false)
+  , m_isWaiting(false)
+  , m_isProcessing(false)
+{
+  uint8_t* toPeer = segment + SHM_SEGMENT_HEADER_SIZE;
+  uint8_t* toClient = toPeer + ShmRing::getMemorySize(capacity);
+  m_tx = ShmRing(isClient ? toPeer : toClient, capacity, isClient);
+  m_rx = ShmRing(isClient ? toClient : toPeer, capacity, isClient);
+}
+
+ShmChannel::~ShmChannel()
+{
+  close();
+}
+
+void
+ShmChannel::setStrand(boost::asio::io_service::strand& strand)
+{
+  m_strand = &strand;
+}
+
+template<typename Handler>
+ShmChannel::IoHandler
+ShmChannel::wrap(const Handler& handler)
+{
+  if (m_strand == nullptr)
+    return handler;
+  return m_strand->wrap(handler);
+}
+
+void
+ShmChannel::start(const ReceiveCallback& onReceive, const WriteCallback& onWrite,
+                  const ErrorCallback& onError)
+{
+  m_onReceive = onReceive;
+  m_onWrite = onWrite;
+  m_onError = onError;
+
+  m_socket.async_receive(boost::asio::buffer(&m_socketByte, 1),
+                         wrap(bind(&ShmChannel::handleSocketReceive, this, _1)));
+  resume();
+}
+
+bool
+ShmChannel::send(const Block& wire)
+{
+  if (m_queue.empty() && m_tx.getWritableSize() >= wire.size())
+    {
+      m_tx.write(wire.wire(), wire.size());
+      commit();
+      return true;
+    }
+
+  QueuedBlock queued = {Block(), wire, wire.size()};
+  m_queue.push_back(queued);
+  scheduleWrite();
+  return false;
+}
+
+bool
+ShmChannel::send(const Block& header, const Block& payload)
+{
+  if (m_queue.empty() && m_tx.getWritableSize() >= header.size() + payload.size())
+    {
+      m_tx.write(header.wire(), header.size());
+      m_tx.write(payload.wire(), payload.size());
+      commit();
+      return true;
+    }
+
+  // queued as one, since the TLV-LENGTH of a LocalControlHeader covers the payload: the
+  // other end cannot read the header without it
+  QueuedBlock queued = {header, payload, header.size() + payload.size()};
+  m_queue.push_back(queued);
+  scheduleWrite();
+  return false;
+}
+
+void
+ShmChannel::pause()
+{
+  m_isExpectingData = false;
+}
+
+void
+ShmChannel::resume()
+{
+  if (m_isExpectingData)
+    return;
+
+  // the ring may hold data already; it is read by the doorbell handler, not by the caller
+  m_isExpectingData = true;
+  ringDoorbell();
+}
+
+void
+ShmChannel::close()
+{
+  if (!m_isOpen)
+    return;
+
+  m_isOpen = false;
+  m_isExpectingData = false;
+  m_queue.clear();
+
+  boost::system::error_code error; // to silently ignore all errors
+  m_socket.close(error);
+  m_doorbell.close(error);
+  ::close(m_remoteDoorbell);
+  ::munmap(m_segment, m_segmentSize);
+}
+
+void
+ShmChannel::commit()
+{
+  if (m_tx.commit())
+    ringRemoteDoorbell();
+}
+
+void
+ShmChannel::scheduleWrite()
+{
+  if (m_isProcessing)
+    return; // the processing in progress writes the queue before waiting
+
+  if (m_tx.waitForRoom(m_queue.front().size))
+    return; // the other end rings the doorbell once there is room
+
+  ringDoorbell();
+}
+
+void
+ShmChannel::ringDoorbell()
+{
+  // going through the doorbell rather than posting a handler keeps every handler tied to a
+  // descriptor, which close cancels
+  waitForDoorbell();
+  uint64_t value = 1;
+  ssize_t result = ::write(m_doorbell.native_handle(), &value, sizeof(value));
+  static_cast<void>(result);
+}
+
+void
+ShmChannel::ringRemoteDoorbell()
+{
+  uint64_t value = 1;
+  // cannot fail but by overflowing the counter, in which case the other end is awake anyway
+  ssize_t result = ::write(m_remoteDoorbell, &value, sizeof(value));
+  static_cast<void>(result);
+}
+
+void
+ShmChannel::waitForDoorbell()
+{
+  if (m_isWaiting)
+    return;
+
+  m_isWaiting = true;
+  m_doorbell.async_read_some(boost::asio::null_buffers(),
+                             wrap(bind(&ShmChannel::handleDoorbell, this, _1)));
+}
+
+void
+ShmChannel::handleDoorbell(const boost::system::error_code& error)
+{
+  if (error)
+    {
+      if (error == boost::system::errc::operation_canceled)
+        return;
+
+      fail("error while waiting for the doorbell (" + error.message() + ")");
+      return;
+    }
+
+  m_isWaiting = false;
+  uint64_t value;
+  ssize_t result = ::read(m_doorbell.native_handle(), &value, sizeof(value));
+  static_cast<void>(result); // EAGAIN if the ring has been noticed already
+
+  process();
+}
+
+void
+ShmChannel::handleSocketReceive(const boost::system::error_code& error)
+{
+  if (error == boost::system::errc::operation_canceled)
+    return;
+
+  // nothing is sent over the socket once the segment is handed
+  fail("the other end closed the connection");
+}
+
+void
+ShmChannel::process()
+{
+  if (m_isProcessing)
+    return; // the processing in progress loops until nothing is left to do
+
+  m_isProcessing = true;
+  try
+    {
+      bool isIdle = false;
+      while (m_isOpen && !isIdle)
+        {
+          if (m_isExpectingData)
+            readAll();
+          if (m_isOpen)
+            writeQueue();
+          if (!m_isOpen)
+            break;
+
+          // wait before announcing it, so that a ring in between is not missed
+          waitForDoorbell();
+          isIdle = (!m_isExpectingData || m_rx.waitForData()) &&
+                   (m_queue.empty() || m_tx.waitForRoom(m_queue.front().size));
+        }
+    }
+  catch (...)
+    {
+      m_isProcessing = false;
+      throw;
+    }
+  m_isProcessing = false;
+}
+
+void
+ShmChannel::readAll()
+{
+  size_t size = m_rx.getReadableSize();
+  if (size == 0)
+    return;
+
+  // the tail is written by the other end, which may be another process
+  if (size > m_rx.getCapacity())
+    {
+      fail("invalid tail in the shared memory ring");
+      return;
+    }
+
+  BufferPtr buffer = make_shared<Buffer>(size);
+  m_rx.read(buffer->buf(), size);
+  if (m_rx.release())
+    ringRemoteDoorbell();
+
+  // blocks are committed whole, so the buffer holds complete blocks only
+  std::vector<Block> wires;
+  Buffer::const_iterator begin = buffer->begin();
+  Buffer::const_iterator end = buffer->end();
+  while (begin != end)
+    {
+      Buffer::const_iterator valueBegin = begin;
+      uint32_t type = 0;
+      uint64_t length = 0;
+      if (!tlv::readType(valueBegin, end, type) ||
+          !tlv::readVarNumber(valueBegin, end, length) ||
+          length > static_cast<uint64_t>(end - valueBegin))
+        {
+          fail("malformed block in the shared memory ring");
+          return;
+        }
+
+      Buffer::const_iterator valueEnd = valueBegin + length;
+      wires.push_back(Block(buffer, type, begin, valueEnd, valueBegin, valueEnd));
+      begin = valueEnd;
+    }
+
+  m_onReceive(wires);
+}
+
+void
+ShmChannel::writeQueue()
+{
+  size_t nBytes = 0;
+  while (!m_queue.empty() && m_tx.getWritableSize() >= m_queue.front().size)
+    {
+      const QueuedBlock& queued = m_queue.front();
+      if (!queued.header.empty())
+        m_tx.write(queued.header.wire(), queued.header.size());
+      m_tx.write(queued.wire.wire(), queued.wire.size());
+      nBytes += queued.size;
+      m_queue.pop_front();
+    }
+
+  if (nBytes > 0)
+    {
+      commit();
+      m_onWrite(nBytes);
+    }
+}
+
+void
+ShmChannel::fail(const std::string& reason)
+{
+  close();
+  m_onError(reason);
+}
+
+} // namespace ndn
+
+#endif // NDN_CXX_HAVE_EVENTFD
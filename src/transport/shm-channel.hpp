@@ -0,0 +1,224 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2015 Regents of the University of Tokyo.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_TRANSPORT_SHM_CHANNEL_HPP
+#define NDN_TRANSPORT_SHM_CHANNEL_HPP
+
+#include "../common.hpp"
+
+#ifdef NDN_CXX_HAVE_EVENTFD
+
+#include "shm-ring.hpp"
+#include "../encoding/block.hpp"
+
+#include <boost/asio.hpp>
+#include <deque>
+
+namespace ndn {
+
+/** @brief Default capacity of each ring of a shared memory channel
+ */
+const size_t SHM_CHANNEL_DEFAULT_CAPACITY = 1048576;
+
+/**
+ * @brief One end of a connection exchanging TLV blocks through shared memory
+ *
+ * The client creates a shared memory segment holding two ShmRing, one per direction, and two
+ * eventfd doorbells, one per end, and hands their descriptors to the peer over a Unix stream
+ * socket, which then stays open so that each end notices when the other goes away.
+ *
+ * Blocks are copied into the ring whole and committed at once, so the consumer never sees a
+ * partial block.  All the blocks in the ring are read with one copy and delivered together.
+ * An end only rings the doorbell of the other when the other has announced that it is going
+ * to wait, so there are no system calls while both ends keep up with the traffic.  Blocks
+ * which do not fit in the ring are queued until the other end makes room.
+ */
+class ShmChannel : noncopyable
+{
+public:
+  class Error : public std::runtime_error
+  {
+  public:
+    explicit
+    Error(const std::string& what)
+      : std::runtime_error(what)
+    {
+    }
+  };
+
+  typedef function<void (const std::vector<Block>& wires)> ReceiveCallback;
+  typedef function<void (size_t nBytes)> WriteCallback;
+  typedef function<void (const std::string& reason)> ErrorCallback;
+
+  /**
+   * @brief Creates the segment and the doorbells, and hands them to the peer listening on the
+   *        Unix socket @p socketPath
+   * @param capacity capacity of each ring, a power of two of at least MAX_NDN_PACKET_SIZE
+   * @throws Error
+   */
+  static unique_ptr<ShmChannel>
+  connect(boost::asio::io_service& ioService, const std::string& socketPath,
+          size_t capacity = SHM_CHANNEL_DEFAULT_CAPACITY);
+
+  /**
+   * @brief Takes the segment and the doorbells handed by a client over the Unix stream socket
+   *        @p socketFd, which the channel then owns
+   * @throws Error
+   */
+  static unique_ptr<ShmChannel>
+  accept(boost::asio::io_service& ioService, int socketFd);
+
+  ~ShmChannel();
+
+  /**
+   * @brief Runs the handlers, and so the callbacks, through @p strand
+   */
+  void
+  setStrand(boost::asio::io_service::strand& strand);
+
+  /**
+   * @brief Starts receiving
+   * @param onReceive called with the blocks read from the ring at once
+   * @param onWrite called with the number of queued bytes which got written to the ring
+   * @param onError called when the other end goes away or misbehaves; the channel is closed
+   *        afterwards
+   */
+  void
+  start(const ReceiveCallback& onReceive, const WriteCallback& onWrite,
+        const ErrorCallback& onError);
+
+  /**
+   * @return true if the block has been written to the ring, false if it has been queued
+   */
+  bool
+  send(const Block& wire);
+
+  /**
+   * @return true if both blocks have been written to the ring, false if some has been queued
+   */
+  bool
+  send(const Block& header, const Block& payload);
+
+  /**
+   * @brief Stops reading from the ring; the other end stops once the ring is full
+   */
+  void
+  pause();
+
+  void
+  resume();
+
+  void
+  close();
+
+  bool
+  isOpen() const
+  {
+    return m_isOpen;
+  }
+
+private:
+  ShmChannel(boost::asio::io_service& ioService, uint8_t* segment, size_t capacity,
+             bool isClient, int socketFd, int doorbell, int remoteDoorbell);
+
+  typedef function<void (const boost::system::error_code&, size_t)> IoHandler;
+
+  /** @brief A block waiting for room in the ring, with the header written together with it
+   */
+  struct QueuedBlock
+  {
+    Block header; ///< empty if the block has no header
+    Block wire;
+    size_t size; ///< size of both blocks
+  };
+
+  template<typename Handler>
+  IoHandler
+  wrap(const Handler& handler);
+
+  void
+  commit();
+
+  /** @brief Makes sure the queue gets written once there is room
+   */
+  void
+  scheduleWrite();
+
+  /** @brief Wakes this end up, to process from a handler
+   */
+  void
+  ringDoorbell();
+
+  void
+  ringRemoteDoorbell();
+
+  void
+  waitForDoorbell();
+
+  void
+  handleDoorbell(const boost::system::error_code& error);
+
+  void
+  handleSocketReceive(const boost::system::error_code& error);
+
+  /** @brief Reads the ring, writes the queue, and waits for the doorbell if nothing is left
+   *         to do
+   */
+  void
+  process();
+
+  void
+  readAll();
+
+  void
+  writeQueue();
+
+  void
+  fail(const std::string& reason);
+
+private:
+  boost::asio::io_service::strand* m_strand;
+  uint8_t* m_segment;
+  size_t m_segmentSize;
+  ShmRing m_tx;
+  ShmRing m_rx;
+
+  boost::asio::local::stream_protocol::socket m_socket;
+  uint8_t m_socketByte;
+  boost::asio::posix::stream_descriptor m_doorbell;
+  int m_remoteDoorbell;
+
+  ReceiveCallback m_onReceive;
+  WriteCallback m_onWrite;
+  ErrorCallback m_onError;
+
+  std::deque<QueuedBlock> m_queue; ///< blocks waiting for room in the ring
+  bool m_isOpen;
+  bool m_isExpectingData;
+  bool m_isWaiting; ///< a wait for the doorbell is in progress
+  bool m_isProcessing;
+};
+
+} // namespace ndn
+
+#endif // NDN_CXX_HAVE_EVENTFD
+
+#endif // NDN_TRANSPORT_SHM_CHANNEL_HPP
@@ -0,0 +1,117 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2015 Regents of the University of Tokyo.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "shm-loopback-peer.hpp"
+
+#ifdef NDN_CXX_HAVE_EVENTFD
+
+#include <unistd.h>
+
+namespace ndn {
+
+ShmLoopbackPeer::ShmLoopbackPeer(boost::asio::io_service& ioService,
+                                 const std::string& socketPath)
+  : m_ioService(ioService)
+  , m_socketPath(socketPath)
+  , m_acceptor(ioService)
+  , m_socket(ioService)
+  , m_nPackets(0)
+{
+  ::unlink(m_socketPath.c_str());
+
+  boost::asio::local::stream_protocol::endpoint endpoint(m_socketPath);
+  m_acceptor.open(endpoint.protocol());
+  m_acceptor.bind(endpoint);
+  m_acceptor.listen();
+  accept();
+}
+
+ShmLoopbackPeer::~ShmLoopbackPeer()
+{
+  close();
+}
+
+void
+ShmLoopbackPeer::close()
+{
+  if (!m_acceptor.is_open())
+    return;
+
+  boost::system::error_code error; // to silently ignore all errors
+  m_acceptor.close(error);
+  ::unlink(m_socketPath.c_str());
+
+  // channels stay allocated until the peer is destroyed, as their handlers may still run
+  for (size_t i = 0; i < m_channels.size(); ++i)
+    m_channels[i]->close();
+}
+
+void
+ShmLoopbackPeer::accept()
+{
+  m_acceptor.async_accept(m_socket, bind(&ShmLoopbackPeer::handleAccept, this, _1));
+}
+
+void
+ShmLoopbackPeer::handleAccept(const boost::system::error_code& error)
+{
+  if (error)
+    {
+      if (error == boost::system::errc::operation_canceled)
+        return;
+
+      throw boost::system::system_error(error);
+    }
+
+  int fd = ::dup(m_socket.native_handle());
+  boost::system::error_code closeError;
+  m_socket.close(closeError);
+  try
+    {
+      if (fd < 0)
+        throw ShmChannel::Error("cannot take the accepted socket");
+
+      shared_ptr<ShmChannel> channel(ShmChannel::accept(m_ioService, fd));
+      // errors only mean that the client went away, and the channel is closed already
+      channel->start(bind(&ShmLoopbackPeer::handleReceive, this, channel.get(), _1),
+                     [] (size_t) {},
+                     [] (const std::string&) {});
+      m_channels.push_back(channel);
+    }
+  catch (const ShmChannel::Error&)
+    {
+      // the client did not hand a usable segment; ignore it
+    }
+
+  accept();
+}
+
+void
+ShmLoopbackPeer::handleReceive(ShmChannel* channel, const std::vector<Block>& wires)
+{
+  m_nPackets += wires.size();
+  for (size_t i = 0; i < wires.size(); ++i)
+    channel->send(wires[i]);
+}
+
+} // namespace ndn
+
+#endif // NDN_CXX_HAVE_EVENTFD
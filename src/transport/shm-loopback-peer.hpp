@@ -0,0 +1,90 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2015 Regents of the University of Tokyo.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_TRANSPORT_SHM_LOOPBACK_PEER_HPP
+#define NDN_TRANSPORT_SHM_LOOPBACK_PEER_HPP
+
+#include "../common.hpp"
+
+#ifdef NDN_CXX_HAVE_EVENTFD
+
+#include "shm-channel.hpp"
+
+namespace ndn {
+
+/**
+ * @brief Minimal forwarder end of shared memory channels, which sends every received block
+ *        back on the channel it came from
+ *
+ * It accepts ShmTransport connections on a Unix socket, so that the transport can be
+ * exercised without a forwarder.  A forwarder accepts channels the same way, with
+ * ShmChannel::accept.
+ */
+class ShmLoopbackPeer : noncopyable
+{
+public:
+  /**
+   * @brief Listens on @p socketPath, replacing any socket file already there
+   * @throws boost::system::system_error if the socket cannot be bound
+   */
+  ShmLoopbackPeer(boost::asio::io_service& ioService, const std::string& socketPath);
+
+  ~ShmLoopbackPeer();
+
+  /**
+   * @return the number of blocks received on all channels
+   */
+  size_t
+  getNPackets() const
+  {
+    return m_nPackets;
+  }
+
+  /**
+   * @brief Stops listening and closes the accepted channels
+   */
+  void
+  close();
+
+private:
+  void
+  accept();
+
+  void
+  handleAccept(const boost::system::error_code& error);
+
+  void
+  handleReceive(ShmChannel* channel, const std::vector<Block>& wires);
+
+private:
+  boost::asio::io_service& m_ioService;
+  std::string m_socketPath;
+  boost::asio::local::stream_protocol::acceptor m_acceptor;
+  boost::asio::local::stream_protocol::socket m_socket; ///< next accepted socket
+  std::vector<shared_ptr<ShmChannel> > m_channels;
+  size_t m_nPackets;
+};
+
+} // namespace ndn
+
+#endif // NDN_CXX_HAVE_EVENTFD
+
+#endif // NDN_TRANSPORT_SHM_LOOPBACK_PEER_HPP
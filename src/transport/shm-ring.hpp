@@ -0,0 +1,221 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2015 Regents of the University of Tokyo.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_TRANSPORT_SHM_RING_HPP
+#define NDN_TRANSPORT_SHM_RING_HPP
+
+#include "../common.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+namespace ndn {
+
+/**
+ * @brief Lock-free ring of bytes with a single producer and a single consumer, possibly in
+ *        two processes sharing the memory of the ring
+ *
+ * The producer writes bytes after the tail and publishes them with commit; the consumer reads
+ * them from the head and gives the room back with release.  Positions only grow, the offset
+ * in the ring being the position modulo the capacity.
+ *
+ * Either side can announce that it is going to sleep, the consumer until there is data, the
+ * producer until there is room.  The other side clears the announcement when it commits or
+ * releases, and then has to wake the sleeper up.  The announcement and the check that
+ * follows it are sequentially consistent with the commit or release and the clearing, so a
+ * wake-up is never missed.
+ */
+class ShmRing
+{
+public:
+  /**
+   * @brief Shared state of the ring, each position on its own cache line
+   */
+  struct Header
+  {
+    alignas(64) std::atomic<uint64_t> head;
+    alignas(64) std::atomic<uint64_t> tail;
+    alignas(64) std::atomic<uint32_t> isConsumerWaiting;
+    std::atomic<uint32_t> isProducerWaiting;
+  };
+
+  static_assert(ATOMIC_LLONG_LOCK_FREE == 2 && ATOMIC_INT_LOCK_FREE == 2,
+                "atomics in shared memory must be lock-free");
+
+  /**
+   * @return the size of the memory holding a ring of @p capacity bytes
+   */
+  static size_t
+  getMemorySize(size_t capacity)
+  {
+    return sizeof(Header) + capacity;
+  }
+
+  ShmRing()
+    : m_header(nullptr)
+    , m_data(nullptr)
+    , m_capacity(0)
+    , m_head(0)
+    , m_tail(0)
+  {
+  }
+
+  /**
+   * @brief Attaches to the ring in @p memory
+   * @param memory getMemorySize(capacity) bytes aligned on a cache line; when @p isNew, the
+   *        ring is initialized empty
+   * @param capacity a power of two
+   */
+  ShmRing(uint8_t* memory, size_t capacity, bool isNew)
+    : m_header(reinterpret_cast<Header*>(memory))
+    , m_data(memory + sizeof(Header))
+    , m_capacity(capacity)
+  {
+    BOOST_ASSERT(capacity > 0 && (capacity & (capacity - 1)) == 0);
+
+    if (isNew)
+      {
+        new (m_header) Header;
+        m_header->head.store(0);
+        m_header->tail.store(0);
+        m_header->isConsumerWaiting.store(0);
+        m_header->isProducerWaiting.store(0);
+      }
+    m_head = m_header->head.load();
+    m_tail = m_header->tail.load();
+  }
+
+  size_t
+  getCapacity() const
+  {
+    return m_capacity;
+  }
+
+public: // producer
+  /**
+   * @return the number of bytes which can be written, including those written and not
+   *         committed yet
+   */
+  size_t
+  getWritableSize() const
+  {
+    return m_capacity - static_cast<size_t>(m_tail -
+                                            m_header->head.load(std::memory_order_acquire));
+  }
+
+  /**
+   * @pre @p size <= getWritableSize()
+   */
+  void
+  write(const uint8_t* data, size_t size)
+  {
+    BOOST_ASSERT(size <= getWritableSize());
+
+    size_t offset = m_tail & (m_capacity - 1);
+    size_t nFirst = std::min(size, m_capacity - offset);
+    std::memcpy(m_data + offset, data, nFirst);
+    std::memcpy(m_data, data + nFirst, size - nFirst);
+    m_tail += size;
+  }
+
+  /**
+   * @brief Publishes the written bytes to the consumer
+   * @return whether the consumer announced that it waits for data, and needs to be woken up
+   */
+  bool
+  commit()
+  {
+    m_header->tail.store(m_tail);
+    return m_header->isConsumerWaiting.exchange(0) != 0;
+  }
+
+  /**
+   * @brief Announces that the producer waits until @p size bytes can be written
+   * @return false if they already can, so the producer should not wait
+   */
+  bool
+  waitForRoom(size_t size)
+  {
+    m_header->isProducerWaiting.store(1);
+    return m_capacity - static_cast<size_t>(m_tail - m_header->head.load()) < size;
+  }
+
+public: // consumer
+  /**
+   * @return the number of committed bytes which are not read yet; more than the capacity if
+   *         the tail has been corrupted by the producer, which the consumer must check before
+   *         reading
+   */
+  size_t
+  getReadableSize() const
+  {
+    return static_cast<size_t>(m_header->tail.load(std::memory_order_acquire) - m_head);
+  }
+
+  /**
+   * @pre @p size <= getReadableSize()
+   */
+  void
+  read(uint8_t* data, size_t size)
+  {
+    BOOST_ASSERT(size <= getReadableSize());
+
+    size_t offset = m_head & (m_capacity - 1);
+    size_t nFirst = std::min(size, m_capacity - offset);
+    std::memcpy(data, m_data + offset, nFirst);
+    std::memcpy(data + nFirst, m_data, size - nFirst);
+    m_head += size;
+  }
+
+  /**
+   * @brief Gives the room of the read bytes back to the producer
+   * @return whether the producer announced that it waits for room, and needs to be woken up
+   */
+  bool
+  release()
+  {
+    m_header->head.store(m_head);
+    return m_header->isProducerWaiting.exchange(0) != 0;
+  }
+
+  /**
+   * @brief Announces that the consumer waits until there is data to read
+   * @return false if there already is, so the consumer should not wait
+   */
+  bool
+  waitForData()
+  {
+    m_header->isConsumerWaiting.store(1);
+    return m_header->tail.load() == m_head;
+  }
+
+private:
+  Header* m_header;
+  uint8_t* m_data;
+  size_t m_capacity;
+  uint64_t m_head; ///< read position of the consumer
+  uint64_t m_tail; ///< write position of the producer
+};
+
+} // namespace ndn
+
+#endif // NDN_TRANSPORT_SHM_RING_HPP
@@ -0,0 +1,169 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2015 Regents of the University of Tokyo.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "shm-transport.hpp"
+
+#ifdef NDN_CXX_HAVE_EVENTFD
+
+#include "../util/face-uri.hpp"
+
+namespace ndn {
+
+ShmTransport::ShmTransport(const std::string& socketPath, size_t capacity)
+  : m_socketPath(socketPath)
+  , m_capacity(capacity)
+{
+}
+
+ShmTransport::~ShmTransport()
+{
+}
+
+std::string
+ShmTransport::getDefaultSocketName(const ConfigFile& config)
+{
+  const ConfigFile::Parsed& parsed = config.getParsedConfiguration();
+
+  try
+    {
+      const util::FaceUri uri(parsed.get<std::string>("transport"));
+
+      if (uri.getScheme() != "shm")
+        {
+          throw Transport::Error("Cannot create ShmTransport from \"" +
+                                 uri.getScheme() + "\" URI");
+        }
+
+      if (!uri.getPath().empty())
+        {
+          return uri.getPath();
+        }
+    }
+  catch (const boost::property_tree::ptree_bad_path& error)
+    {
+      // no transport specified
+    }
+  catch (const boost::property_tree::ptree_bad_data& error)
+    {
+      throw ConfigFile::Error(error.what());
+    }
+  catch (const util::FaceUri::Error& error)
+    {
+      throw ConfigFile::Error(error.what());
+    }
+
+  return "/var/run/nfd-shm.sock";
+}
+
+shared_ptr<ShmTransport>
+ShmTransport::create(const ConfigFile& config)
+{
+  return make_shared<ShmTransport>(getDefaultSocketName(config));
+}
+
+void
+ShmTransport::connect(boost::asio::io_service& ioService,
+                      const ReceiveCallback& receiveCallback)
+{
+  Transport::connect(ioService, receiveCallback);
+
+  if (static_cast<bool>(m_channel) && m_channel->isOpen())
+    return;
+
+  try
+    {
+      m_channel = ShmChannel::connect(ioService, m_socketPath, m_capacity);
+    }
+  catch (const ShmChannel::Error& error)
+    {
+      throw Transport::Error(error.what());
+    }
+
+  if (m_strand != nullptr)
+    m_channel->setStrand(*m_strand);
+
+  m_isConnected = true;
+  m_isExpectingData = true;
+  m_channel->start(bind(&ShmTransport::handleReceive, this, _1),
+                   bind(&ShmTransport::decreaseSendQueueSize, this, _1),
+                   bind(&ShmTransport::handleError, this, _1));
+}
+
+void
+ShmTransport::send(const Block& wire)
+{
+  BOOST_ASSERT(static_cast<bool>(m_channel));
+  if (!m_channel->send(wire))
+    increaseSendQueueSize(wire.size());
+}
+
+void
+ShmTransport::send(const Block& header, const Block& payload)
+{
+  BOOST_ASSERT(static_cast<bool>(m_channel));
+  if (!m_channel->send(header, payload))
+    increaseSendQueueSize(header.size() + payload.size());
+}
+
+void
+ShmTransport::close()
+{
+  // the channel is kept until the next connect, as close may be called from its callbacks
+  if (static_cast<bool>(m_channel))
+    m_channel->close();
+
+  m_isConnected = false;
+  m_isExpectingData = false;
+  resetSendQueueSize();
+}
+
+void
+ShmTransport::pause()
+{
+  if (static_cast<bool>(m_channel))
+    m_channel->pause();
+  m_isExpectingData = false;
+}
+
+void
+ShmTransport::resume()
+{
+  BOOST_ASSERT(static_cast<bool>(m_channel));
+  m_channel->resume();
+  m_isExpectingData = true;
+}
+
+void
+ShmTransport::handleReceive(const std::vector<Block>& wires)
+{
+  receive(wires);
+}
+
+void
+ShmTransport::handleError(const std::string& reason)
+{
+  close();
+  throw Transport::Error(reason);
+}
+
+} // namespace ndn
+
+#endif // NDN_CXX_HAVE_EVENTFD
@@ -0,0 +1,107 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2015 Regents of the University of Tokyo.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_TRANSPORT_SHM_TRANSPORT_HPP
+#define NDN_TRANSPORT_SHM_TRANSPORT_HPP
+
+#include "../common.hpp"
+#include "transport.hpp"
+#include "../util/config-file.hpp"
+
+#ifdef NDN_CXX_HAVE_EVENTFD
+
+#include "shm-channel.hpp"
+
+namespace ndn {
+
+/**
+ * @brief Transport to a local forwarder through shared memory rings
+ *
+ * The forwarder listens on a Unix socket, over which the transport hands it the shared memory
+ * segment and the doorbells of a ShmChannel.  Packets then go through the rings without
+ * system calls while both ends keep up; see ShmChannel.
+ *
+ * This transport is only available on systems with eventfd, i.e., Linux.
+ */
+class ShmTransport : public Transport
+{
+public:
+  /**
+   * @param socketPath Unix socket on which the forwarder accepts shared memory channels
+   * @param capacity capacity of each ring, a power of two of at least MAX_NDN_PACKET_SIZE
+   */
+  explicit
+  ShmTransport(const std::string& socketPath,
+               size_t capacity = SHM_CHANNEL_DEFAULT_CAPACITY);
+
+  ~ShmTransport();
+
+  // from Transport
+  virtual void
+  connect(boost::asio::io_service& ioService,
+          const ReceiveCallback& receiveCallback);
+
+  virtual void
+  close();
+
+  virtual void
+  pause();
+
+  virtual void
+  resume();
+
+  virtual void
+  send(const Block& wire);
+
+  virtual void
+  send(const Block& header, const Block& payload);
+
+  static shared_ptr<ShmTransport>
+  create(const ConfigFile& config);
+
+NDN_CXX_PUBLIC_WITH_TESTS_ELSE_PRIVATE:
+  /**
+   * Determine the socket on which the forwarder accepts shared memory channels
+   *
+   * @returns the path of a "shm" transport in config, else /var/run/nfd-shm.sock
+   * @throws ConfigFile::Error if fail to parse value of a present "transport" field
+   */
+  static std::string
+  getDefaultSocketName(const ConfigFile& config);
+
+private:
+  void
+  handleReceive(const std::vector<Block>& wires);
+
+  void
+  handleError(const std::string& reason);
+
+private:
+  std::string m_socketPath;
+  size_t m_capacity;
+  unique_ptr<ShmChannel> m_channel;
+};
+
+} // namespace ndn
+
+#endif // NDN_CXX_HAVE_EVENTFD
+
+#endif // NDN_TRANSPORT_SHM_TRANSPORT_HPP
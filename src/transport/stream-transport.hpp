@@ -24,28 +24,63 @@
 
 #include "transport.hpp"
 
-#include <list>
+#include <algorithm>
+#include <deque>
 
 namespace ndn {
 
+/** @brief Size of the slabs stream transports receive into
+ *
+ *  Received Blocks reference the slab directly, so a slab is never overwritten while a Block
+ *  refers to it.  A new slab is allocated when the rest of the current one cannot hold a
+ *  packet of maximum size, and the current one is freed with its last Block.
+ */
+const size_t STREAM_TRANSPORT_SLAB_SIZE = 8 * MAX_NDN_PACKET_SIZE;
+
+/** @brief Maximum number of bytes gathered into one write
+ *
+ *  Blocks queued while a write is in progress are sent together by the next write, with
+ *  at least one block per write.
+ */
+const size_t STREAM_TRANSPORT_WRITE_SIZE = 65536;
+
 template<class BaseTransport, class Protocol>
 class StreamTransportImpl
 {
 public:
   typedef StreamTransportImpl<BaseTransport,Protocol> Impl;
 
-  typedef std::list<Block> BlockSequence;
-  typedef std::list<BlockSequence> TransmissionQueue;
+  typedef std::deque<Block> TransmissionQueue;
+  typedef void ErrorHandler(const boost::system::error_code&);
+  typedef void TransferHandler(const boost::system::error_code&, size_t);
 
   StreamTransportImpl(BaseTransport& transport, boost::asio::io_service& ioService)
     : m_transport(transport)
     , m_socket(ioService)
+    , m_inputBufferStart(0)
     , m_inputBufferSize(0)
+    , m_nOutgoingBlocks(0)
     , m_connectionInProgress(false)
     , m_connectTimer(ioService)
   {
   }
 
+  virtual
+  ~StreamTransportImpl()
+  {
+  }
+
+  /** @brief Returns @p handler, to be run through the strand of the transport if it has one
+   */
+  template<typename Signature, typename Handler>
+  function<Signature>
+  wrap(const Handler& handler)
+  {
+    if (m_transport.m_strand == nullptr)
+      return handler;
+    return m_transport.m_strand->wrap(handler);
+  }
+
   void
   connectHandler(const boost::system::error_code& error)
   {
@@ -57,11 +92,8 @@ public:
         resume();
         m_transport.m_isConnected = true;
 
-        if (!m_transmissionQueue.empty()) {
-          boost::asio::async_write(m_socket, *m_transmissionQueue.begin(),
-                                   bind(&Impl::handleAsyncWrite, this, _1,
-                                        m_transmissionQueue.begin()));
-        }
+        if (!m_transmissionQueue.empty())
+          asyncWrite();
       }
     else
       {
@@ -91,15 +123,16 @@ public:
       // Wait at most 4 seconds to connect
       /// @todo Decide whether this number should be configurable
       m_connectTimer.expires_from_now(boost::posix_time::seconds(4));
-      m_connectTimer.async_wait(bind(&Impl::connectTimeoutHandler, this, _1));
+      m_connectTimer.async_wait(wrap<ErrorHandler>(bind(&Impl::connectTimeoutHandler,
+                                                        this, _1)));
 
       m_socket.open();
       m_socket.async_connect(endpoint,
-                             bind(&Impl::connectHandler, this, _1));
+                             wrap<ErrorHandler>(bind(&Impl::connectHandler, this, _1)));
     }
   }
 
-  void
+  virtual void
   close()
   {
     m_connectionInProgress = false;
@@ -112,9 +145,12 @@ public:
     m_transport.m_isConnected = false;
     m_transport.m_isExpectingData = false;
     m_transmissionQueue.clear();
+    m_outgoingBuffers.clear();
+    m_nOutgoingBlocks = 0;
+    m_transport.resetSendQueueSize();
   }
 
-  void
+  virtual void
   pause()
   {
     if (m_connectionInProgress)
@@ -136,50 +172,73 @@ public:
     if (!m_transport.m_isExpectingData)
       {
         m_transport.m_isExpectingData = true;
+        m_inputBuffer = make_shared<Buffer>(STREAM_TRANSPORT_SLAB_SIZE);
+        m_inputBufferStart = 0;
         m_inputBufferSize = 0;
-        m_socket.async_receive(boost::asio::buffer(m_inputBuffer, MAX_NDN_PACKET_SIZE), 0,
-                               bind(&Impl::handleAsyncReceive, this, _1, _2));
+        asyncReceive();
       }
   }
 
   void
   send(const Block& wire)
   {
-    BlockSequence sequence;
-    sequence.push_back(wire);
-    m_transmissionQueue.push_back(sequence);
-
-    if (m_transport.m_isConnected && m_transmissionQueue.size() == 1) {
-      boost::asio::async_write(m_socket, *m_transmissionQueue.begin(),
-                               bind(&Impl::handleAsyncWrite, this, _1,
-                                    m_transmissionQueue.begin()));
-    }
+    m_transmissionQueue.push_back(wire);
 
-    // if not connected or there is transmission in progress (m_transmissionQueue.size() > 1),
-    // next write will be scheduled either in connectHandler or in asyncWriteHandler
+    if (m_transport.m_isConnected && m_nOutgoingBlocks == 0)
+      asyncWrite();
+
+    // if not connected or there is a write in progress, the block will be written
+    // either in connectHandler or in handleAsyncWrite
+    m_transport.increaseSendQueueSize(wire.size());
   }
 
   void
   send(const Block& header, const Block& payload)
   {
-    BlockSequence sequence;
-    sequence.push_back(header);
-    sequence.push_back(payload);
-    m_transmissionQueue.push_back(sequence);
-
-    if (m_transport.m_isConnected && m_transmissionQueue.size() == 1) {
-      boost::asio::async_write(m_socket, *m_transmissionQueue.begin(),
-                               bind(&Impl::handleAsyncWrite, this, _1,
-                                    m_transmissionQueue.begin()));
-    }
+    m_transmissionQueue.push_back(header);
+    m_transmissionQueue.push_back(payload);
+
+    if (m_transport.m_isConnected && m_nOutgoingBlocks == 0)
+      asyncWrite();
+
+    m_transport.increaseSendQueueSize(header.size() + payload.size());
+  }
+
+  /** @brief Writes the blocks at the front of the queue with one scatter/gather write
+   *
+   *  Up to STREAM_TRANSPORT_WRITE_SIZE bytes are gathered, at least one block.
+   */
+  void
+  asyncWrite()
+  {
+    BOOST_ASSERT(m_nOutgoingBlocks == 0 && !m_transmissionQueue.empty());
+
+    size_t nBytes = 0;
+    for (TransmissionQueue::const_iterator i = m_transmissionQueue.begin();
+         i != m_transmissionQueue.end() &&
+           (m_nOutgoingBlocks == 0 || nBytes + i->size() <= STREAM_TRANSPORT_WRITE_SIZE);
+         ++i)
+      {
+        m_outgoingBuffers.push_back(boost::asio::buffer(i->wire(), i->size()));
+        nBytes += i->size();
+        ++m_nOutgoingBlocks;
+      }
+
+    startWrite();
+  }
 
-    // if not connected or there is transmission in progress (m_transmissionQueue.size() > 1),
-    // next write will be scheduled either in connectHandler or in asyncWriteHandler
+  /** @brief Writes all of m_outgoingBuffers, then calls handleAsyncWrite
+   */
+  virtual void
+  startWrite()
+  {
+    boost::asio::async_write(m_socket, m_outgoingBuffers,
+                             wrap<TransferHandler>(bind(&Impl::handleAsyncWrite,
+                                                        this, _1, _2)));
   }
 
   void
-  handleAsyncWrite(const boost::system::error_code& error,
-                   TransmissionQueue::iterator queueItem)
+  handleAsyncWrite(const boost::system::error_code& error, size_t nBytesSent)
   {
     if (error)
       {
@@ -192,29 +251,65 @@ public:
         throw Transport::Error(error, "error while sending data to socket");
       }
 
-    m_transmissionQueue.erase(queueItem);
+    m_transmissionQueue.erase(m_transmissionQueue.begin(),
+                              m_transmissionQueue.begin() + m_nOutgoingBlocks);
+    m_outgoingBuffers.clear();
+    m_nOutgoingBlocks = 0;
 
-    if (!m_transmissionQueue.empty()) {
-      boost::asio::async_write(m_socket, *m_transmissionQueue.begin(),
-                               bind(&Impl::handleAsyncWrite, this, _1,
-                                    m_transmissionQueue.begin()));
-    }
+    if (!m_transmissionQueue.empty())
+      asyncWrite();
+
+    m_transport.decreaseSendQueueSize(nBytesSent);
   }
 
-  bool
-  processAll(uint8_t* buffer, size_t& offset, size_t nBytesAvailable)
+  /** @brief Delivers all complete TLV blocks in the slab, starting from m_inputBufferStart,
+   *         together
+   *
+   *  The blocks are not copied, they point into the slab.
+   */
+  void
+  processAll()
   {
-    while (offset < nBytesAvailable)
+    const Buffer::const_iterator slabBegin = m_inputBuffer->begin();
+    m_receivedBlocks.clear(); // left over if a callback threw
+
+    while (m_inputBufferStart < m_inputBufferSize)
       {
-        Block element;
-        bool ok = Block::fromBuffer(buffer + offset, nBytesAvailable - offset, element);
-        if (!ok)
-          return false;
+        Buffer::const_iterator begin = slabBegin + m_inputBufferStart;
+        Buffer::const_iterator valueBegin = begin;
+        // a block larger than MAX_NDN_PACKET_SIZE never completes, see onBytesReceived
+        Buffer::const_iterator end = slabBegin + std::min(m_inputBufferSize,
+                                                          m_inputBufferStart + MAX_NDN_PACKET_SIZE);
+
+        uint32_t type = 0;
+        uint64_t length = 0;
+        if (!tlv::readType(valueBegin, end, type) ||
+            !tlv::readVarNumber(valueBegin, end, length) ||
+            length > static_cast<uint64_t>(end - valueBegin))
+          break;
+
+        Buffer::const_iterator valueEnd = valueBegin + length;
+        m_inputBufferStart = valueEnd - slabBegin;
+        m_receivedBlocks.push_back(Block(m_inputBuffer, type, begin, valueEnd,
+                                         valueBegin, valueEnd));
+      }
 
-        m_transport.receive(element);
-        offset += element.size();
+    if (!m_receivedBlocks.empty())
+      {
+        m_transport.receive(m_receivedBlocks);
+        m_receivedBlocks.clear();
       }
-    return true;
+  }
+
+  /** @brief Receives into the slab, from m_inputBufferSize on, then calls handleAsyncReceive
+   */
+  virtual void
+  asyncReceive()
+  {
+    m_socket.async_receive(boost::asio::buffer(m_inputBuffer->buf() + m_inputBufferSize,
+                                               m_inputBuffer->size() - m_inputBufferSize), 0,
+                           wrap<TransferHandler>(bind(&Impl::handleAsyncReceive,
+                                                      this, _1, _2)));
   }
 
   void
@@ -231,45 +326,71 @@ public:
         throw Transport::Error(error, "error while receiving data from socket");
       }
 
+    if (onBytesReceived(nBytesRecvd))
+      asyncReceive();
+  }
+
+protected:
+  bool
+  isExpectingData() const
+  {
+    return m_transport.m_isExpectingData;
+  }
+
+  /** @brief Delivers the blocks completed by @p nBytesRecvd more bytes in the slab, and makes
+   *         room for the next receive
+   *  @return whether to keep receiving, i.e. the transport was not paused or closed by a
+   *          receive callback
+   */
+  bool
+  onBytesReceived(size_t nBytesRecvd)
+  {
     m_inputBufferSize += nBytesRecvd;
-    // do magic
 
-    std::size_t offset = 0;
-    bool hasProcessedSome = processAll(m_inputBuffer, offset, m_inputBufferSize);
-    if (!hasProcessedSome && m_inputBufferSize == MAX_NDN_PACKET_SIZE && offset == 0)
+    processAll();
+    if (!m_transport.m_isExpectingData)
+      return false;
+
+    size_t nBytesPending = m_inputBufferSize - m_inputBufferStart;
+    if (nBytesPending >= MAX_NDN_PACKET_SIZE)
       {
         m_transport.close();
         throw Transport::Error(boost::system::error_code(),
                                "input buffer full, but a valid TLV cannot be decoded");
       }
 
-    if (offset > 0)
+    if (nBytesPending == 0 && m_inputBuffer.unique())
       {
-        if (offset != m_inputBufferSize)
-          {
-            std::copy(m_inputBuffer + offset, m_inputBuffer + m_inputBufferSize,
-                      m_inputBuffer);
-            m_inputBufferSize -= offset;
-          }
-        else
-          {
-            m_inputBufferSize = 0;
-          }
+        // No block refers to the slab anymore, so it can be reused from the start
+        m_inputBufferStart = 0;
+        m_inputBufferSize = 0;
+      }
+    else if (m_inputBufferStart + MAX_NDN_PACKET_SIZE > m_inputBuffer->size())
+      {
+        // Move the partial packet to a new slab, the old one stays with its blocks
+        BufferPtr slab = make_shared<Buffer>(STREAM_TRANSPORT_SLAB_SIZE);
+        std::copy(m_inputBuffer->begin() + m_inputBufferStart,
+                  m_inputBuffer->begin() + m_inputBufferSize, slab->begin());
+        m_inputBuffer = slab;
+        m_inputBufferStart = 0;
+        m_inputBufferSize = nBytesPending;
       }
 
-    m_socket.async_receive(boost::asio::buffer(m_inputBuffer + m_inputBufferSize,
-                                               MAX_NDN_PACKET_SIZE - m_inputBufferSize), 0,
-                           bind(&Impl::handleAsyncReceive, this, _1, _2));
+    return true;
   }
 
 protected:
   BaseTransport& m_transport;
 
   typename Protocol::socket m_socket;
-  uint8_t m_inputBuffer[MAX_NDN_PACKET_SIZE];
-  size_t m_inputBufferSize;
+  BufferPtr m_inputBuffer; ///< current slab
+  size_t m_inputBufferStart; ///< offset of the first byte which is not delivered yet
+  size_t m_inputBufferSize; ///< offset of the end of received bytes
+  std::vector<Block> m_receivedBlocks; ///< blocks completed by the last read
 
   TransmissionQueue m_transmissionQueue;
+  std::vector<boost::asio::const_buffer> m_outgoingBuffers; ///< buffers of the write in progress
+  size_t m_nOutgoingBlocks; ///< number of queued blocks in the write in progress
   bool m_connectionInProgress;
 
   boost::asio::deadline_timer m_connectTimer;
@@ -281,6 +402,8 @@ class StreamTransportWithResolverImpl : public StreamTransportImpl<BaseTransport
 {
 public:
   typedef StreamTransportWithResolverImpl<BaseTransport,Protocol> Impl;
+  typedef void ResolveHandler(const boost::system::error_code&,
+                              typename Protocol::resolver::iterator);
 
   StreamTransportWithResolverImpl(BaseTransport& transport, boost::asio::io_service& ioService)
     : StreamTransportImpl<BaseTransport, Protocol>(transport, ioService)
@@ -308,7 +431,8 @@ public:
       }
 
     this->m_socket.async_connect(*endpoint,
-                                 bind(&Impl::connectHandler, this, _1));
+                                 this->template wrap<typename Impl::ErrorHandler>(
+                                   bind(&Impl::connectHandler, this, _1)));
   }
 
   void
@@ -320,13 +444,15 @@ public:
       // Wait at most 4 seconds to connect
       /// @todo Decide whether this number should be configurable
       this->m_connectTimer.expires_from_now(boost::posix_time::seconds(4));
-      this->m_connectTimer.async_wait(bind(&Impl::connectTimeoutHandler, this, _1));
+      this->m_connectTimer.async_wait(this->template wrap<typename Impl::ErrorHandler>(
+                                        bind(&Impl::connectTimeoutHandler, this, _1)));
 
       // typename boost::asio::ip::basic_resolver< Protocol > resolver;
       shared_ptr<typename Protocol::resolver> resolver =
         make_shared<typename Protocol::resolver>(ref(this->m_socket.get_io_service()));
 
-      resolver->async_resolve(query, bind(&Impl::resolveHandler, this, _1, _2, resolver));
+      resolver->async_resolve(query, this->template wrap<ResolveHandler>(
+                                       bind(&Impl::resolveHandler, this, _1, _2, resolver)));
     }
   }
 };
@@ -22,15 +22,17 @@
 #include "common.hpp"
 
 #include "tcp-transport.hpp"
-#include "stream-transport.hpp"
+#include "uring-stream-transport.hpp"
 #include "util/face-uri.hpp"
 
 namespace ndn {
 
-TcpTransport::TcpTransport(const std::string& host, const std::string& port/* = "6363"*/)
+TcpTransport::TcpTransport(const std::string& host, const std::string& port/* = "6363"*/,
+                           TransportIoBackend ioBackend/* = TRANSPORT_IO_ASIO*/)
   : m_host(host)
   , m_port(port)
 {
+  m_ioBackend = ioBackend;
 }
 
 TcpTransport::~TcpTransport()
@@ -42,7 +44,8 @@ TcpTransport::create(const ConfigFile& config)
 {
   const auto hostAndPort(getDefaultSocketHostAndPort(config));
   return make_shared<TcpTransport>(hostAndPort.first,
-                                   hostAndPort.second);
+                                   hostAndPort.second,
+                                   getDefaultIoBackend(config));
 }
 
 std::pair<std::string, std::string>
@@ -96,7 +99,13 @@ TcpTransport::connect(boost::asio::io_service& ioService,
   if (!static_cast<bool>(m_impl)) {
     Transport::connect(ioService, receiveCallback);
 
-    m_impl = make_shared<Impl>(ref(*this), ref(ioService));
+    if (m_ioBackend == TRANSPORT_IO_URING) {
+      m_impl = makeUringStreamTransportImpl<Impl>(*this, ioService);
+      if (!static_cast<bool>(m_impl))
+        m_ioBackend = TRANSPORT_IO_ASIO; // io_uring is not available
+    }
+    if (!static_cast<bool>(m_impl))
+      m_impl = make_shared<Impl>(ref(*this), ref(ioService));
   }
 
   boost::asio::ip::tcp::resolver::query query(m_host, m_port);
@@ -39,7 +39,11 @@ template<class T, class U> class StreamTransportWithResolverImpl;
 class TcpTransport : public Transport
 {
 public:
-  TcpTransport(const std::string& host, const std::string& port = "6363");
+  /**
+   * @param ioBackend the I/O backend to use, see Transport::getIoBackend
+   */
+  TcpTransport(const std::string& host, const std::string& port = "6363",
+               TransportIoBackend ioBackend = TRANSPORT_IO_ASIO);
   ~TcpTransport();
 
   // from Transport
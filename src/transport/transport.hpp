@@ -24,11 +24,27 @@
 
 #include "../common.hpp"
 #include "../encoding/block.hpp"
+#include "../util/signal.hpp"
 
 #include <boost/asio.hpp>
 
 namespace ndn {
 
+/** @brief Default number of queued outgoing bytes at which Transport::onSendQueueFull is emitted
+ */
+const size_t DEFAULT_SEND_QUEUE_HIGH_WATER_MARK = 1048576;
+
+class ConfigFile;
+
+/** @brief How stream transports perform their I/O
+ */
+enum TransportIoBackend {
+  /// Boost.Asio reactor, with one system call per receive and per write
+  TRANSPORT_IO_ASIO,
+  /// io_uring with multishot receive into registered buffers, on Linux only
+  TRANSPORT_IO_URING
+};
+
 class Transport : noncopyable
 {
 public:
@@ -40,6 +56,7 @@ public:
   };
 
   typedef function<void (const Block& wire)> ReceiveCallback;
+  typedef function<void (const std::vector<Block>& wires)> ReceiveBatchCallback;
   typedef function<void ()> ErrorCallback;
 
   inline
@@ -86,28 +103,135 @@ public:
   virtual void
   resume() = 0;
 
+  /**
+   * @brief Run the handlers of asynchronous operations, and so the receive callback, through
+   *        @p strand
+   *
+   * This allows the transport to be used from an io_service run by several threads, as long
+   * as its other methods are called through the same strand.  It must be set before connect.
+   */
+  inline void
+  setStrand(boost::asio::io_service::strand& strand);
+
+  /**
+   * @brief Deliver the packets received together to @p receiveBatchCallback, in one call,
+   *        instead of to the receive callback one at a time
+   *
+   * Stream transports deliver all the packets completed by one read as a batch.  Other
+   * transports may deliver batches of one packet, or keep using the receive callback.
+   */
+  inline void
+  setReceiveBatchCallback(const ReceiveBatchCallback& receiveBatchCallback);
+
+  /**
+   * @brief Get the I/O backend in use
+   *
+   * A transport asked to use TRANSPORT_IO_URING falls back to TRANSPORT_IO_ASIO on connect when
+   * io_uring is not available, e.g., on other systems, older kernels or under a seccomp policy.
+   */
+  inline TransportIoBackend
+  getIoBackend() const;
+
+  /**
+   * @brief Get the I/O backend from the "transport_io" field of @p config
+   * @return TRANSPORT_IO_ASIO if the field is not present
+   * @throws ConfigFile::Error if the field is neither "asio" nor "io_uring"
+   */
+  static TransportIoBackend
+  getDefaultIoBackend(const ConfigFile& config);
+
   inline bool
   isConnected();
 
   inline bool
   isExpectingData();
 
+  /**
+   * @brief Set the number of queued outgoing bytes at which onSendQueueFull is emitted
+   *
+   * onSendQueueDrained is emitted once the queue shrinks to half of the high-water mark.
+   * Packets are queued regardless of the mark; it is up to the producer to slow down.
+   */
+  inline void
+  setSendQueueHighWaterMark(size_t nBytes);
+
+  inline size_t
+  getSendQueueHighWaterMark() const;
+
+  /**
+   * @brief Get the number of outgoing bytes which are queued and not yet written
+   */
+  inline size_t
+  getSendQueueSize() const;
+
+public: // signals
+  /**
+   * @brief Fires when the send queue reaches the high-water mark
+   */
+  util::signal::Signal<Transport> onSendQueueFull;
+
+  /**
+   * @brief Fires when the send queue, after being full, shrinks to half of the high-water
+   *        mark or is discarded by close()
+   */
+  util::signal::Signal<Transport> onSendQueueDrained;
+
 protected:
   inline void
   receive(const Block& wire);
 
+  /**
+   * @brief Deliver @p wires to the receive batch callback, or else one at a time to the
+   *        receive callback
+   */
+  inline void
+  receive(const std::vector<Block>& wires);
+
+  /**
+   * @brief Account for @p nBytes more queued bytes, emitting onSendQueueFull if needed
+   * @note Signal handlers may close the transport, so call this last
+   */
+  inline void
+  increaseSendQueueSize(size_t nBytes);
+
+  /**
+   * @brief Account for @p nBytes written bytes, emitting onSendQueueDrained if needed
+   * @note Signal handlers may close the transport, so call this last
+   */
+  inline void
+  decreaseSendQueueSize(size_t nBytes);
+
+  /**
+   * @brief Account for a discarded send queue, emitting onSendQueueDrained if it was full
+   */
+  inline void
+  resetSendQueueSize();
+
 protected:
   boost::asio::io_service* m_ioService;
+  boost::asio::io_service::strand* m_strand;
+  TransportIoBackend m_ioBackend;
   bool m_isConnected;
   bool m_isExpectingData;
   ReceiveCallback m_receiveCallback;
+  ReceiveBatchCallback m_receiveBatchCallback;
+
+private:
+  size_t m_sendQueueSize;
+  size_t m_sendQueueHighWaterMark;
+  bool m_isSendQueueFull;
 };
 
 inline
 Transport::Transport()
   : m_ioService(0)
+  , m_strand(0)
+  , m_ioBackend(TRANSPORT_IO_ASIO)
   , m_isConnected(false)
   , m_isExpectingData(false)
+  , m_sendQueueSize(0)
+  , m_sendQueueHighWaterMark(DEFAULT_SEND_QUEUE_HIGH_WATER_MARK)
+  , m_isSendQueueFull(false)
 {
 }
 
@@ -136,6 +260,24 @@ Transport::connect(boost::asio::io_service& ioService,
   m_receiveCallback = receiveCallback;
 }
 
+inline void
+Transport::setStrand(boost::asio::io_service::strand& strand)
+{
+  m_strand = &strand;
+}
+
+inline void
+Transport::setReceiveBatchCallback(const ReceiveBatchCallback& receiveBatchCallback)
+{
+  m_receiveBatchCallback = receiveBatchCallback;
+}
+
+inline TransportIoBackend
+Transport::getIoBackend() const
+{
+  return m_ioBackend;
+}
+
 inline bool
 Transport::isConnected()
 {
@@ -148,12 +290,77 @@ Transport::isExpectingData()
   return m_isExpectingData;
 }
 
+inline void
+Transport::setSendQueueHighWaterMark(size_t nBytes)
+{
+  m_sendQueueHighWaterMark = nBytes;
+}
+
+inline size_t
+Transport::getSendQueueHighWaterMark() const
+{
+  return m_sendQueueHighWaterMark;
+}
+
+inline size_t
+Transport::getSendQueueSize() const
+{
+  return m_sendQueueSize;
+}
+
 inline void
 Transport::receive(const Block& wire)
 {
   m_receiveCallback(wire);
 }
 
+inline void
+Transport::receive(const std::vector<Block>& wires)
+{
+  if (static_cast<bool>(m_receiveBatchCallback))
+    {
+      m_receiveBatchCallback(wires);
+      return;
+    }
+
+  for (std::vector<Block>::const_iterator i = wires.begin(); i != wires.end(); ++i)
+    m_receiveCallback(*i);
+}
+
+inline void
+Transport::increaseSendQueueSize(size_t nBytes)
+{
+  m_sendQueueSize += nBytes;
+  if (!m_isSendQueueFull && m_sendQueueSize >= m_sendQueueHighWaterMark)
+    {
+      m_isSendQueueFull = true;
+      onSendQueueFull();
+    }
+}
+
+inline void
+Transport::decreaseSendQueueSize(size_t nBytes)
+{
+  BOOST_ASSERT(nBytes <= m_sendQueueSize);
+  m_sendQueueSize -= nBytes;
+  if (m_isSendQueueFull && m_sendQueueSize <= m_sendQueueHighWaterMark / 2)
+    {
+      m_isSendQueueFull = false;
+      onSendQueueDrained();
+    }
+}
+
+inline void
+Transport::resetSendQueueSize()
+{
+  m_sendQueueSize = 0;
+  if (m_isSendQueueFull)
+    {
+      m_isSendQueueFull = false;
+      onSendQueueDrained();
+    }
+}
+
 } // namespace ndn
 
 #endif // NDN_TRANSPORT_TRANSPORT_HPP
@@ -22,16 +22,17 @@
 #include "common.hpp"
 
 #include "unix-transport.hpp"
-#include "stream-transport.hpp"
+#include "uring-stream-transport.hpp"
 
 #include "../face.hpp"
 #include "util/face-uri.hpp"
 
 namespace ndn {
 
-UnixTransport::UnixTransport(const std::string& unixSocket)
+UnixTransport::UnixTransport(const std::string& unixSocket, TransportIoBackend ioBackend)
   : m_unixSocket(unixSocket)
 {
+  m_ioBackend = ioBackend;
 }
 
 UnixTransport::~UnixTransport()
@@ -78,7 +79,7 @@ UnixTransport::getDefaultSocketName(const ConfigFile& config)
 shared_ptr<UnixTransport>
 UnixTransport::create(const ConfigFile& config)
 {
-  return make_shared<UnixTransport>(getDefaultSocketName(config));
+  return make_shared<UnixTransport>(getDefaultSocketName(config), getDefaultIoBackend(config));
 }
 
 void
@@ -88,7 +89,13 @@ UnixTransport::connect(boost::asio::io_service& ioService,
   if (!static_cast<bool>(m_impl)) {
     Transport::connect(ioService, receiveCallback);
 
-    m_impl = make_shared<Impl>(ref(*this), ref(ioService));
+    if (m_ioBackend == TRANSPORT_IO_URING) {
+      m_impl = makeUringStreamTransportImpl<Impl>(*this, ioService);
+      if (!static_cast<bool>(m_impl))
+        m_ioBackend = TRANSPORT_IO_ASIO; // io_uring is not available
+    }
+    if (!static_cast<bool>(m_impl))
+      m_impl = make_shared<Impl>(ref(*this), ref(ioService));
   }
 
   m_impl->connect(boost::asio::local::stream_protocol::endpoint(m_unixSocket));
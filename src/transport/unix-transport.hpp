@@ -43,9 +43,10 @@ public:
    * Create Unix transport based on the socket specified
    * in a well-known configuration file or fallback to /var/run/nfd.sock
    *
+   * @param ioBackend the I/O backend to use, see Transport::getIoBackend
    * @throws Throws UnixTransport::Error on failure to parse a discovered configuration file
    */
-  UnixTransport(const std::string& unixSocket);
+  UnixTransport(const std::string& unixSocket, TransportIoBackend ioBackend = TRANSPORT_IO_ASIO);
 
   ~UnixTransport();
 
@@ -0,0 +1,544 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2015 Regents of the University of Tokyo.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_TRANSPORT_URING_STREAM_TRANSPORT_HPP
+#define NDN_TRANSPORT_URING_STREAM_TRANSPORT_HPP
+
+#include "stream-transport.hpp"
+#include "io-uring.hpp"
+
+#ifdef NDN_CXX_HAVE_IO_URING
+
+#include <cerrno>
+#include <climits>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+namespace ndn {
+
+/** @brief Number of registered buffers the kernel receives into
+ *
+ *  Each buffer is given back to the kernel as soon as its content is copied into the slab,
+ *  so this bounds the data received by the kernel but not yet seen by the transport.
+ */
+const uint16_t URING_TRANSPORT_N_BUFFERS = 64;
+
+/** @brief Size of each registered receive buffer
+ */
+const size_t URING_TRANSPORT_BUFFER_SIZE = MAX_NDN_PACKET_SIZE;
+
+/**
+ * @brief Stream transport implementation doing its I/O through io_uring
+ *
+ * A multishot receive stays armed while the transport expects data: the kernel fills
+ * buffers of a registered buffer ring as data arrives, without a system call per read.  Their
+ * content is copied into the slab of BaseImpl, which delivers the packets as usual.  A write
+ * sends all the blocks gathered by BaseImpl with one sendmsg, resumed after a partial send.
+ * The operations started while handling completions, e.g., the write of a Data produced by an
+ * Interest callback, are submitted together after the handling, with one io_uring_enter.
+ *
+ * Completions are awaited by polling the descriptor of the ring through the io_service, so
+ * the handlers run like those of the Asio implementation, through the strand if there is one.
+ *
+ * @tparam BaseImpl StreamTransportImpl or StreamTransportWithResolverImpl, which still
+ *         establishes the connection
+ */
+template<class BaseImpl>
+class UringStreamTransportImpl : public BaseImpl
+                               , public enable_shared_from_this<UringStreamTransportImpl<BaseImpl> >
+{
+public:
+  typedef UringStreamTransportImpl<BaseImpl> Impl;
+
+  /**
+   * @throws IoUring::Error if io_uring or registered buffer rings are not available
+   */
+  template<class BaseTransport>
+  UringStreamTransportImpl(BaseTransport& transport, boost::asio::io_service& ioService)
+    : BaseImpl(transport, ioService)
+    , m_ring(new IoUring(N_RING_ENTRIES))
+    , m_ringDescriptor(ioService)
+    , m_isReceiving(false)
+    , m_isMultishot(true)
+    , m_isSending(false)
+    , m_isWaiting(false)
+    , m_isReaping(false)
+    , m_nCompletionsHandled(0)
+    , m_nIovecsSent(0)
+    , m_nBytesSent(0)
+  {
+    m_ring->registerBufferRing(BUFFER_GROUP, URING_TRANSPORT_N_BUFFERS,
+                               URING_TRANSPORT_BUFFER_SIZE);
+
+    // the descriptor object closes its own copy, the ring stays with m_ring
+    int fd = ::dup(m_ring->getFd());
+    if (fd < 0)
+      throw IoUring::Error("cannot duplicate the descriptor of the ring");
+    m_ringDescriptor.assign(fd);
+    waitForCompletions();
+  }
+
+  virtual
+  ~UringStreamTransportImpl()
+  {
+    stopRing();
+  }
+
+  virtual void
+  close()
+  {
+    stopRing();
+    BaseImpl::close();
+  }
+
+  virtual void
+  pause()
+  {
+    bool wasExpectingData = this->isExpectingData();
+    BaseImpl::pause();
+
+    if (wasExpectingData && !this->isExpectingData() && m_isReceiving)
+      {
+        io_uring_sqe* sqe = getSqe();
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->addr = RECEIVE;
+        sqe->user_data = CANCEL;
+        submit();
+      }
+  }
+
+  virtual void
+  asyncReceive()
+  {
+    if (m_isReceiving)
+      return; // the multishot receive is still armed
+
+    io_uring_sqe* sqe = getSqe();
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = this->m_socket.native_handle();
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = BUFFER_GROUP;
+    if (m_isMultishot)
+      sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->user_data = RECEIVE;
+    m_isReceiving = true;
+    submit();
+  }
+
+  virtual void
+  startWrite()
+  {
+    m_iovecs.resize(this->m_outgoingBuffers.size());
+    for (size_t i = 0; i < m_iovecs.size(); ++i)
+      {
+        const boost::asio::const_buffer& buffer = this->m_outgoingBuffers[i];
+        m_iovecs[i].iov_base = const_cast<void*>(boost::asio::buffer_cast<const void*>(buffer));
+        m_iovecs[i].iov_len = boost::asio::buffer_size(buffer);
+      }
+    m_nIovecsSent = 0;
+    m_nBytesSent = 0;
+
+    sendIovecs();
+  }
+
+private:
+  enum {
+    N_RING_ENTRIES = 64, // the completion queue has twice as many, more than the buffers
+    BUFFER_GROUP = 0
+  };
+
+  /// user data of the submissions
+  enum Operation {
+    RECEIVE = 1,
+    SEND,
+    CANCEL,
+    NOP
+  };
+
+  /** @brief Defers the submissions while completions are handled, and ends the handling with
+   *         abortReaping if a callback throws
+   */
+  class ReapingGuard : noncopyable
+  {
+  public:
+    explicit
+    ReapingGuard(Impl& impl)
+      : m_impl(impl)
+    {
+      m_impl.m_isReaping = true;
+    }
+
+    ~ReapingGuard()
+    {
+      if (m_impl.m_isReaping)
+        m_impl.abortReaping();
+    }
+
+  private:
+    Impl& m_impl;
+  };
+
+  io_uring_sqe*
+  getSqe()
+  {
+    io_uring_sqe* sqe = m_ring->getSqe();
+    if (sqe == nullptr)
+      {
+        // the submission queue is full of entries waiting for the end of the handling
+        m_ring->submit();
+        sqe = m_ring->getSqe();
+      }
+    BOOST_ASSERT(sqe != nullptr);
+    return sqe;
+  }
+
+  /** @brief Submits the pending entries, unless completions are being handled, in which case
+   *         they are submitted together afterwards
+   */
+  void
+  submit()
+  {
+    if (m_isReaping)
+      return;
+
+    try
+      {
+        m_ring->submit();
+      }
+    catch (const IoUring::Error& error)
+      {
+        this->m_transport.close();
+        throw Transport::Error(error.what());
+      }
+  }
+
+  void
+  sendIovecs()
+  {
+    m_message = msghdr();
+    m_message.msg_iov = &m_iovecs[m_nIovecsSent];
+    m_message.msg_iovlen = std::min<size_t>(m_iovecs.size() - m_nIovecsSent, IOV_MAX);
+
+    io_uring_sqe* sqe = getSqe();
+    sqe->opcode = IORING_OP_SENDMSG;
+    sqe->fd = this->m_socket.native_handle();
+    sqe->addr = reinterpret_cast<uint64_t>(&m_message);
+    sqe->len = 1;
+    sqe->msg_flags = MSG_NOSIGNAL | MSG_WAITALL;
+    sqe->user_data = SEND;
+    m_isSending = true;
+    submit();
+  }
+
+  void
+  waitForCompletions()
+  {
+    if (m_isWaiting)
+      return;
+
+    m_isWaiting = true;
+    m_ringDescriptor.async_read_some(boost::asio::null_buffers(),
+                                     this->template wrap<typename BaseImpl::TransferHandler>(
+                                       bind(&Impl::handleRingReadable, this, _1)));
+  }
+
+  void
+  handleRingReadable(const boost::system::error_code& error)
+  {
+    if (error)
+      {
+        if (error == boost::system::errc::operation_canceled)
+          return;
+
+        this->m_transport.close();
+        throw Transport::Error(error, "error while waiting for io_uring completions");
+      }
+
+    m_isWaiting = false;
+    // a callback may close the transport, which releases this object
+    shared_ptr<Impl> self = this->shared_from_this();
+    do {
+      // wait again before reaping, so that a completion posted meanwhile is not missed
+      waitForCompletions();
+      if (!reapCompletions())
+        return;
+    } while (m_ring->hasCompletions());
+  }
+
+  /** @return false if the transport has been closed
+   */
+  bool
+  reapCompletions()
+  {
+    // the completions left by a callback which threw are handled first
+    m_completions.erase(m_completions.begin(), m_completions.begin() + m_nCompletionsHandled);
+    m_nCompletionsHandled = 0;
+    m_ring->reapCompletions(m_completions);
+
+    ReapingGuard guard(*this);
+    while (m_nCompletionsHandled < m_completions.size())
+      {
+        // counted as handled before its callbacks run, so that it is not handled twice
+        const IoUring::Completion& completion = m_completions[m_nCompletionsHandled++];
+        switch (completion.userData) {
+        case RECEIVE:
+          onReceiveCompleted(completion.result, completion.flags);
+          break;
+        case SEND:
+          onSendCompleted(completion.result);
+          break;
+        default:
+          break;
+        }
+
+        if (m_ring == nullptr)
+          return false;
+      }
+    m_isReaping = false;
+
+    submit();
+    return true;
+  }
+
+  /** @brief Ends the handling of completions left by an exception
+   *
+   *  The entries deferred so far are submitted.  The completions not handled yet are kept for
+   *  the next pass, which the completion of a no-op triggers.
+   */
+  void
+  abortReaping()
+  {
+    m_isReaping = false;
+    if (m_ring == nullptr)
+      return;
+
+    try
+      {
+        if (m_nCompletionsHandled < m_completions.size())
+          {
+            io_uring_sqe* sqe = getSqe();
+            sqe->opcode = IORING_OP_NOP;
+            sqe->user_data = NOP;
+          }
+        m_ring->submit();
+      }
+    catch (const IoUring::Error&)
+      {
+        // the error is reported by the next submission
+      }
+  }
+
+  void
+  onReceiveCompleted(int32_t result, uint32_t flags)
+  {
+    if ((flags & IORING_CQE_F_MORE) == 0)
+      m_isReceiving = false;
+
+    if (result > 0)
+      {
+        uint16_t bufferId = flags >> IORING_CQE_BUFFER_SHIFT;
+        bool isExpectingData = this->isExpectingData(); // otherwise the data arrived after pause
+        if (isExpectingData)
+          copyToSlab(m_ring->getBuffer(bufferId), result);
+        // given back before the bytes are delivered, in case a receive callback throws
+        m_ring->recycleBuffer(bufferId);
+        if (isExpectingData)
+          this->onBytesReceived(result);
+      }
+    else if (result == 0)
+      {
+        if (this->isExpectingData())
+          this->handleAsyncReceive(boost::asio::error::eof, 0); // closes and throws
+        return; // noticed on resume
+      }
+    else if (result == -EINVAL && m_isMultishot)
+      {
+        // the kernel does not support multishot receive, submit one receive per read
+        m_isMultishot = false;
+      }
+    else if (result != -ECANCELED && result != -ENOBUFS)
+      {
+        this->handleAsyncReceive(boost::system::error_code(-result,
+                                                           boost::system::system_category()),
+                                 0);
+      }
+
+    // the receive stops when cancelled by pause or when the kernel runs out of buffers
+    if (!m_isReceiving && this->isExpectingData())
+      asyncReceive();
+  }
+
+  /** @brief Copies @p nBytes received bytes after the end of the received bytes in the slab
+   *
+   *  If the rest of the slab is too small, the partial packet is moved to a new slab first, so
+   *  that all the bytes are copied before they are delivered by onBytesReceived.
+   */
+  void
+  copyToSlab(const uint8_t* data, size_t nBytes)
+  {
+    if (this->m_inputBufferSize + nBytes > this->m_inputBuffer->size())
+      {
+        size_t nBytesPending = this->m_inputBufferSize - this->m_inputBufferStart;
+        BufferPtr slab = make_shared<Buffer>(STREAM_TRANSPORT_SLAB_SIZE);
+        std::copy(this->m_inputBuffer->begin() + this->m_inputBufferStart,
+                  this->m_inputBuffer->begin() + this->m_inputBufferSize, slab->begin());
+        this->m_inputBuffer = slab;
+        this->m_inputBufferStart = 0;
+        this->m_inputBufferSize = nBytesPending;
+      }
+
+    std::copy(data, data + nBytes, this->m_inputBuffer->begin() + this->m_inputBufferSize);
+  }
+
+  void
+  onSendCompleted(int32_t result)
+  {
+    m_isSending = false;
+
+    if (result <= 0)
+      {
+        boost::system::error_code error(result == 0 ? EPIPE : -result,
+                                        boost::system::system_category());
+        this->handleAsyncWrite(error, 0);
+        return;
+      }
+
+    m_nBytesSent += result;
+    for (size_t nBytes = result; nBytes > 0; )
+      {
+        iovec& iov = m_iovecs[m_nIovecsSent];
+        if (nBytes < iov.iov_len)
+          {
+            iov.iov_base = static_cast<uint8_t*>(iov.iov_base) + nBytes;
+            iov.iov_len -= nBytes;
+            break;
+          }
+        nBytes -= iov.iov_len;
+        ++m_nIovecsSent;
+      }
+
+    if (m_nIovecsSent < m_iovecs.size())
+      sendIovecs();
+    else
+      this->handleAsyncWrite(boost::system::error_code(), m_nBytesSent);
+  }
+
+  /** @brief Cancels the operations in progress and waits for their completion, so that the
+   *         kernel no longer refers to the buffers, then destroys the ring
+   */
+  void
+  stopRing()
+  {
+    if (m_ring == nullptr)
+      return;
+
+    boost::system::error_code error; // to silently ignore all errors
+    m_ringDescriptor.close(error);
+
+    try
+      {
+        if (m_isReceiving || m_isSending)
+          {
+            io_uring_sqe* sqe = getSqe();
+            sqe->opcode = IORING_OP_ASYNC_CANCEL;
+            sqe->fd = -1;
+            sqe->cancel_flags = IORING_ASYNC_CANCEL_ANY | IORING_ASYNC_CANCEL_ALL;
+            sqe->user_data = CANCEL;
+          }
+
+        std::vector<IoUring::Completion> completions;
+        while (m_isReceiving || m_isSending)
+          {
+            m_ring->wait();
+            completions.clear();
+            m_ring->reapCompletions(completions);
+            for (size_t i = 0; i < completions.size(); ++i)
+              {
+                if (completions[i].userData == RECEIVE &&
+                    (completions[i].flags & IORING_CQE_F_MORE) == 0)
+                  m_isReceiving = false;
+                else if (completions[i].userData == SEND)
+                  m_isSending = false;
+              }
+          }
+      }
+    catch (const IoUring::Error&)
+      {
+        // closing the ring cancels the operations anyway
+      }
+
+    m_ring.reset();
+  }
+
+private:
+  unique_ptr<IoUring> m_ring;
+  boost::asio::posix::stream_descriptor m_ringDescriptor;
+  std::vector<IoUring::Completion> m_completions;
+  size_t m_nCompletionsHandled; ///< completions at the front of m_completions already handled
+
+  bool m_isReceiving; ///< a receive is armed
+  bool m_isMultishot;
+  bool m_isSending;
+  bool m_isWaiting; ///< a wait for completions is in progress
+  bool m_isReaping; ///< completions are being handled, submissions are deferred
+
+  std::vector<iovec> m_iovecs; ///< buffers of the write in progress
+  size_t m_nIovecsSent;
+  size_t m_nBytesSent;
+  msghdr m_message;
+};
+
+/**
+ * @brief Creates the io_uring implementation of a stream transport
+ * @return nullptr if io_uring is not available
+ */
+template<class BaseImpl, class BaseTransport>
+shared_ptr<BaseImpl>
+makeUringStreamTransportImpl(BaseTransport& transport, boost::asio::io_service& ioService)
+{
+  try
+    {
+      return make_shared<UringStreamTransportImpl<BaseImpl> >(transport, ioService);
+    }
+  catch (const IoUring::Error&)
+    {
+      return nullptr;
+    }
+}
+
+} // namespace ndn
+
+#else // NDN_CXX_HAVE_IO_URING
+
+namespace ndn {
+
+template<class BaseImpl, class BaseTransport>
+shared_ptr<BaseImpl>
+makeUringStreamTransportImpl(BaseTransport&, boost::asio::io_service&)
+{
+  return nullptr;
+}
+
+} // namespace ndn
+
+#endif // NDN_CXX_HAVE_IO_URING
+
+#endif // NDN_TRANSPORT_URING_STREAM_TRANSPORT_HPP
@@ -0,0 +1,355 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2015 Regents of the University of Tokyo.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+
+#include "disk-storage.hpp"
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ndn {
+namespace util {
+
+static const char SEGMENT_EXTENSION[] = ".log";
+
+static std::string
+makeErrorMessage(const std::string& what)
+{
+  return what + " (" + std::strerror(errno) + ")";
+}
+
+/// @return the name without its implicit digest, under which a packet is indexed
+static Name
+stripImplicitDigest(const Name& name)
+{
+  if (!name.empty() && name.get(-1).isImplicitSha256Digest())
+    return name.getPrefix(-1);
+  return name;
+}
+
+DiskStorage::DiskStorage(const std::string& directory, size_t limitInBytes, size_t segmentSize)
+  : m_directory(directory)
+  , m_limitInBytes(limitInBytes)
+  , m_segmentSize(segmentSize)
+  , m_nBytes(0)
+{
+  boost::system::error_code error;
+  boost::filesystem::create_directories(m_directory, error);
+  if (!boost::filesystem::is_directory(m_directory))
+    throw Error("cannot create directory " + m_directory);
+
+  std::vector<uint64_t> ids;
+  for (boost::filesystem::directory_iterator it(m_directory);
+       it != boost::filesystem::directory_iterator(); ++it) {
+    if (it->path().extension() != SEGMENT_EXTENSION)
+      continue;
+
+    std::string stem = it->path().stem().string();
+    char* end = nullptr;
+    uint64_t id = std::strtoull(stem.c_str(), &end, 16);
+    if (!stem.empty() && *end == '\0')
+      ids.push_back(id);
+  }
+
+  std::sort(ids.begin(), ids.end());
+  for (uint64_t id : ids)
+    openSegment(id, false);
+
+  if (m_segments.empty())
+    openSegment(0, true);
+}
+
+DiskStorage::~DiskStorage()
+{
+  for (auto& i : m_segments) {
+    ::munmap(const_cast<uint8_t*>(i.second.memory), i.second.capacity);
+    ::close(i.second.fd);
+  }
+}
+
+std::string
+DiskStorage::getSegmentPath(uint64_t id) const
+{
+  char fileName[32];
+  std::snprintf(fileName, sizeof(fileName), "%016llx%s",
+                static_cast<unsigned long long>(id), SEGMENT_EXTENSION);
+  return (boost::filesystem::path(m_directory) / fileName).string();
+}
+
+void
+DiskStorage::openSegment(uint64_t id, bool isNew)
+{
+  std::string path = getSegmentPath(id);
+  int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+  if (fd < 0)
+    throw Error(makeErrorMessage("cannot open " + path));
+
+  // a new segment is a sparse file, which takes room on disk as packets are appended
+  struct stat status;
+  if ((isNew && ::ftruncate(fd, m_segmentSize) < 0) || ::fstat(fd, &status) < 0) {
+    std::string message = makeErrorMessage("cannot allocate " + path);
+    ::close(fd);
+    throw Error(message);
+  }
+
+  Segment segment = {fd, nullptr, static_cast<size_t>(status.st_size), 0, 0};
+  if (segment.capacity > 0) {
+    void* memory = ::mmap(nullptr, segment.capacity, PROT_READ, MAP_SHARED, fd, 0);
+    if (memory == MAP_FAILED) {
+      std::string message = makeErrorMessage("cannot map " + path);
+      ::close(fd);
+      throw Error(message);
+    }
+    segment.memory = static_cast<const uint8_t*>(memory);
+  }
+
+  // index the packets of an existing segment, up to the zeros which follow the last one
+  while (!isNew && segment.end < segment.capacity) {
+    Block block;
+    if (!Block::fromBuffer(segment.memory + segment.end, segment.capacity - segment.end, block) ||
+        block.type() != tlv::Data)
+      break;
+
+    try {
+      Data data(block);
+      Record record = {id, segment.end, block.size(), time::steady_clock::TimePoint::min()};
+      m_index.insert(std::make_pair(data.getName(), record));
+    }
+    catch (const tlv::Error&) {
+      break;
+    }
+    segment.end += block.size();
+    ++segment.nRecords;
+  }
+
+  m_nBytes += segment.end;
+  m_segments[id] = segment;
+}
+
+void
+DiskStorage::dropSegment(uint64_t id)
+{
+  std::map<uint64_t, Segment>::iterator segment = m_segments.find(id);
+  BOOST_ASSERT(segment != m_segments.end());
+
+  for (Index::iterator it = m_index.begin();
+       segment->second.nRecords > 0 && it != m_index.end();) {
+    if (it->second.segmentId == id) {
+      --segment->second.nRecords;
+      it = m_index.erase(it);
+    }
+    else {
+      ++it;
+    }
+  }
+
+  ::munmap(const_cast<uint8_t*>(segment->second.memory), segment->second.capacity);
+  ::close(segment->second.fd);
+  ::unlink(getSegmentPath(id).c_str());
+
+  m_nBytes -= segment->second.end;
+  m_segments.erase(segment);
+}
+
+void
+DiskStorage::insert(const Data& data, const time::steady_clock::TimePoint& freshUntil)
+{
+  const Block& wire = data.wireEncode();
+  if (wire.size() > m_segmentSize)
+    throw Error("Data packet is larger than a segment of the disk storage");
+
+  // an identical packet is refreshed rather than appended again
+  std::pair<Index::iterator, Index::iterator> range = m_index.equal_range(data.getName());
+  for (Index::iterator it = range.first; it != range.second; ++it) {
+    const Segment& segment = m_segments[it->second.segmentId];
+    if (it->second.size == wire.size() &&
+        std::memcmp(segment.memory + it->second.offset, wire.wire(), wire.size()) == 0) {
+      it->second.freshUntil = std::max(it->second.freshUntil, freshUntil);
+      return;
+    }
+  }
+
+  std::map<uint64_t, Segment>::iterator active = std::prev(m_segments.end());
+  if (active->second.end + wire.size() > active->second.capacity) {
+    openSegment(active->first + 1, true);
+    active = std::prev(m_segments.end());
+    if (active->second.end + wire.size() > active->second.capacity)
+      throw Error("Data packet does not fit in a new segment of the disk storage");
+  }
+
+  Segment& segment = active->second;
+  ssize_t nWritten = ::pwrite(segment.fd, wire.wire(), wire.size(), segment.end);
+  if (nWritten != static_cast<ssize_t>(wire.size()))
+    throw Error(makeErrorMessage("cannot append to " + getSegmentPath(active->first)));
+
+  Record record = {active->first, segment.end, wire.size(), freshUntil};
+  m_index.insert(std::make_pair(data.getName(), record));
+  segment.end += wire.size();
+  ++segment.nRecords;
+  m_nBytes += wire.size();
+
+  while (m_nBytes > m_limitInBytes && m_segments.size() > 1)
+    dropSegment(m_segments.begin()->first);
+}
+
+shared_ptr<const Data>
+DiskStorage::read(const Record& record) const
+{
+  const Segment& segment = m_segments.find(record.segmentId)->second;
+  return make_shared<Data>(Block(segment.memory + record.offset, record.size));
+}
+
+DiskStorage::Index::iterator
+DiskStorage::findRecord(const Interest& interest, shared_ptr<const Data>& data)
+{
+  const Name& prefix = stripImplicitDigest(interest.getName());
+  time::steady_clock::TimePoint now = time::steady_clock::now();
+
+  std::vector<Index::iterator> candidates;
+  for (Index::iterator it = m_index.lower_bound(prefix);
+       it != m_index.end() && prefix.isPrefixOf(it->first); ++it) {
+    if (!interest.getMustBeFresh() || it->second.freshUntil > now)
+      candidates.push_back(it);
+  }
+
+  if (interest.getChildSelector() > 0)
+    std::reverse(candidates.begin(), candidates.end());
+
+  for (Index::iterator it : candidates) {
+    data = read(it->second);
+    if (interest.matchesData(*data))
+      return it;
+  }
+
+  data.reset();
+  return m_index.end();
+}
+
+DiskStorage::Index::iterator
+DiskStorage::findRecord(const Name& name, shared_ptr<const Data>& data)
+{
+  if (!name.empty() && name.get(-1).isImplicitSha256Digest()) {
+    std::pair<Index::iterator, Index::iterator> range = m_index.equal_range(name.getPrefix(-1));
+    for (Index::iterator it = range.first; it != range.second; ++it) {
+      data = read(it->second);
+      if (data->getFullName() == name)
+        return it;
+    }
+  }
+  else {
+    Index::iterator it = m_index.lower_bound(name);
+    if (it != m_index.end() && name.isPrefixOf(it->first)) {
+      data = read(it->second);
+      return it;
+    }
+  }
+
+  data.reset();
+  return m_index.end();
+}
+
+shared_ptr<const Data>
+DiskStorage::find(const Interest& interest, time::steady_clock::TimePoint* freshUntil)
+{
+  shared_ptr<const Data> data;
+  Index::iterator it = findRecord(interest, data);
+  if (it != m_index.end() && freshUntil != nullptr)
+    *freshUntil = it->second.freshUntil;
+  return data;
+}
+
+shared_ptr<const Data>
+DiskStorage::find(const Name& name, time::steady_clock::TimePoint* freshUntil)
+{
+  shared_ptr<const Data> data;
+  Index::iterator it = findRecord(name, data);
+  if (it != m_index.end() && freshUntil != nullptr)
+    *freshUntil = it->second.freshUntil;
+  return data;
+}
+
+shared_ptr<const Data>
+DiskStorage::extract(const Interest& interest, time::steady_clock::TimePoint* freshUntil)
+{
+  shared_ptr<const Data> data;
+  Index::iterator it = findRecord(interest, data);
+  if (it != m_index.end()) {
+    if (freshUntil != nullptr)
+      *freshUntil = it->second.freshUntil;
+    eraseRecord(it);
+  }
+  return data;
+}
+
+shared_ptr<const Data>
+DiskStorage::extract(const Name& name, time::steady_clock::TimePoint* freshUntil)
+{
+  shared_ptr<const Data> data;
+  Index::iterator it = findRecord(name, data);
+  if (it != m_index.end()) {
+    if (freshUntil != nullptr)
+      *freshUntil = it->second.freshUntil;
+    eraseRecord(it);
+  }
+  return data;
+}
+
+void
+DiskStorage::erase(const Name& prefix, bool isPrefix)
+{
+  if (isPrefix) {
+    Index::iterator it = m_index.lower_bound(prefix);
+    while (it != m_index.end() && prefix.isPrefixOf(it->first)) {
+      Index::iterator next = std::next(it);
+      eraseRecord(it);
+      it = next;
+    }
+  }
+  else {
+    shared_ptr<const Data> data;
+    Index::iterator it = findRecord(prefix, data);
+    if (it != m_index.end() && data->getFullName() == prefix)
+      eraseRecord(it);
+  }
+}
+
+void
+DiskStorage::eraseRecord(Index::iterator it)
+{
+  uint64_t id = it->second.segmentId;
+  m_index.erase(it);
+
+  // the active segment is kept, as packets are still appended to it
+  Segment& segment = m_segments[id];
+  if (--segment.nRecords == 0 && id != std::prev(m_segments.end())->first)
+    dropSegment(id);
+}
+
+} // namespace util
+} // namespace ndn
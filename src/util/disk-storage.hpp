@@ -0,0 +1,200 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2015 Regents of the University of Tokyo.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+
+#ifndef NDN_UTIL_DISK_STORAGE_HPP
+#define NDN_UTIL_DISK_STORAGE_HPP
+
+#include "../common.hpp"
+#include "../interest.hpp"
+#include "../data.hpp"
+
+#include <map>
+
+namespace ndn {
+namespace util {
+
+/** @brief Stores Data packets in an append-only log of segment files on local disk
+ *
+ *  Packets are appended, in their wire encoding, to the last segment file of a directory.
+ *  Once it is full, a new segment is started.  Segments are read through a memory mapping,
+ *  while the names of the packets and their location are kept in an index in memory.
+ *
+ *  Erasing a packet removes it from the index only.  Its bytes are reclaimed with its segment,
+ *  once no packet of the segment is left, or once the limit in bytes is reached, in which case
+ *  the oldest segment is dropped as a whole.
+ *
+ *  When a directory holding segments is opened, its packets are indexed again, as stale ones.
+ *  Packets erased before are indexed as well, unless their segment was reclaimed.
+ *
+ *  It is used as the overflow tier of InMemoryStorage, see InMemoryStorage::setOverflowStorage.
+ */
+class DiskStorage : noncopyable
+{
+public:
+  class Error : public std::runtime_error
+  {
+  public:
+    explicit
+    Error(const std::string& what)
+      : std::runtime_error(what)
+    {
+    }
+  };
+
+  /** @param directory where the segment files are, created if needed
+   *  @param limitInBytes maximum size of the segment files, reached by dropping the oldest
+   *         segments
+   *  @param segmentSize size of each segment file, which bounds the size of a packet
+   *  @throw Error the directory or a segment file cannot be opened
+   */
+  explicit
+  DiskStorage(const std::string& directory,
+              size_t limitInBytes = std::numeric_limits<size_t>::max(),
+              size_t segmentSize = 64 * 1024 * 1024);
+
+  ~DiskStorage();
+
+  /** @brief Appends a Data packet, unless an identical one is stored
+   *  @param freshUntil the time at which the packet becomes stale
+   *  @throw Error the packet is larger than a segment, or cannot be written
+   */
+  void
+  insert(const Data& data,
+         const time::steady_clock::TimePoint& freshUntil = time::steady_clock::TimePoint::max());
+
+  /** @brief Finds the best match Data for an Interest
+   *
+   *  Packets under the Interest name are read in canonical order, or in reverse order with a
+   *  rightmost ChildSelector, and the first one matching the Interest is returned.
+   *  If the Interest has MustBeFresh, stale packets are skipped.
+   *
+   *  @param[out] freshUntil if not null, receives the time at which the packet becomes stale
+   *  @return{ the best match, if any; otherwise a null shared_ptr }
+   */
+  shared_ptr<const Data>
+  find(const Interest& interest, time::steady_clock::TimePoint* freshUntil = nullptr);
+
+  /** @brief Finds the first Data under a Name with or without the implicit digest
+   *  @param[out] freshUntil if not null, receives the time at which the packet becomes stale
+   */
+  shared_ptr<const Data>
+  find(const Name& name, time::steady_clock::TimePoint* freshUntil = nullptr);
+
+  /** @brief Finds the best match Data for an Interest, like find, and erases it
+   */
+  shared_ptr<const Data>
+  extract(const Interest& interest, time::steady_clock::TimePoint* freshUntil = nullptr);
+
+  /** @brief Finds the first Data under a Name, like find, and erases it
+   */
+  shared_ptr<const Data>
+  extract(const Name& name, time::steady_clock::TimePoint* freshUntil = nullptr);
+
+  /** @brief Erases the packets under @p prefix, or the one whose full name is @p prefix if
+   *  @p isPrefix is clear
+   */
+  void
+  erase(const Name& prefix, bool isPrefix = true);
+
+  /** @return{ number of packets in the index }
+   */
+  size_t
+  size() const
+  {
+    return m_index.size();
+  }
+
+  /** @return{ number of bytes written to the segment files, erased packets included }
+   */
+  size_t
+  sizeInBytes() const
+  {
+    return m_nBytes;
+  }
+
+  size_t
+  getLimitInBytes() const
+  {
+    return m_limitInBytes;
+  }
+
+  size_t
+  getNSegments() const
+  {
+    return m_segments.size();
+  }
+
+private:
+  struct Record
+  {
+    uint64_t segmentId;
+    size_t offset;
+    size_t size;
+    time::steady_clock::TimePoint freshUntil;
+  };
+
+  struct Segment
+  {
+    int fd;
+    const uint8_t* memory;
+    size_t capacity;
+    size_t end; ///< where the next packet is appended
+    size_t nRecords; ///< number of packets in the index
+  };
+
+  typedef std::multimap<Name, Record> Index;
+
+  void
+  openSegment(uint64_t id, bool isNew);
+
+  void
+  dropSegment(uint64_t id);
+
+  std::string
+  getSegmentPath(uint64_t id) const;
+
+  shared_ptr<const Data>
+  read(const Record& record) const;
+
+  Index::iterator
+  findRecord(const Interest& interest, shared_ptr<const Data>& data);
+
+  Index::iterator
+  findRecord(const Name& name, shared_ptr<const Data>& data);
+
+  void
+  eraseRecord(Index::iterator it);
+
+private:
+  std::string m_directory;
+  size_t m_limitInBytes;
+  size_t m_segmentSize;
+  size_t m_nBytes;
+
+  Index m_index;
+  std::map<uint64_t, Segment> m_segments; ///< oldest first, packets are appended to the last
+};
+
+} // namespace util
+} // namespace ndn
+
+#endif // NDN_UTIL_DISK_STORAGE_HPP
@@ -39,6 +39,12 @@ public:
       m_receiveCallback(block);
   }
 
+  void
+  receive(const std::vector<Block>& wires)
+  {
+    ndn::Transport::receive(wires);
+  }
+
   virtual void
   close()
   {
@@ -165,6 +171,12 @@ DummyClientFace::receive<Interest>(const Interest& packet);
 template void
 DummyClientFace::receive<Data>(const Data& packet);
 
+void
+DummyClientFace::receive(const std::vector<Block>& wires)
+{
+  m_transport->receive(wires);
+}
+
 
 shared_ptr<DummyClientFace>
 makeDummyClientFace(const DummyClientFace::Options& options)
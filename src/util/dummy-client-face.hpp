@@ -54,6 +54,12 @@ public:
   void
   receive(const Packet& packet);
 
+  /** \brief cause the Face to receive packets together, as if completed by one read of a
+   *         stream transport
+   */
+  void
+  receive(const std::vector<Block>& wires);
+
 private: // constructors
   class Transport;
 
@@ -28,12 +28,25 @@ void
 InMemoryStorageEntry::release()
 {
   m_dataPacket.reset();
+  m_freshnessPosition = FreshnessWheel::Position();
 }
 
 void
 InMemoryStorageEntry::setData(const Data& data)
 {
   m_dataPacket = data.shared_from_this();
+
+  if (data.getFreshnessPeriod() >= time::milliseconds::zero())
+    m_freshUntil = time::steady_clock::now() + data.getFreshnessPeriod();
+  else
+    m_freshUntil = time::steady_clock::TimePoint::max();
+}
+
+void
+InMemoryStorageEntry::setData(const Data& data, const time::steady_clock::TimePoint& freshUntil)
+{
+  m_dataPacket = data.shared_from_this();
+  m_freshUntil = freshUntil;
 }
 
 } // namespace util
@@ -25,6 +25,7 @@
 #include "../common.hpp"
 #include "../interest.hpp"
 #include "../data.hpp"
+#include "../detail/timing-wheel.hpp"
 
 namespace ndn {
 namespace util {
@@ -34,6 +35,8 @@ namespace util {
 class InMemoryStorageEntry : noncopyable
 {
 public:
+  typedef TimingWheel<InMemoryStorageEntry*> FreshnessWheel;
+
   /** @brief Releases reference counts on shared objects
    */
   void
@@ -67,12 +70,50 @@ public:
 
 
   /** @brief Changes the content of in-memory storage entry
+   *
+   *  The packet is fresh for its FreshnessPeriod from now on, or forever if it has none.
    */
   void
   setData(const Data& data);
 
+  /** @brief Changes the content of in-memory storage entry, which is fresh until @p freshUntil
+   */
+  void
+  setData(const Data& data, const time::steady_clock::TimePoint& freshUntil);
+
+  /** @brief Returns the time at which the Data packet becomes stale,
+   *         time::steady_clock::TimePoint::max() if it never does
+   */
+  const time::steady_clock::TimePoint&
+  getFreshUntil() const
+  {
+    return m_freshUntil;
+  }
+
+  bool
+  isFresh(const time::steady_clock::TimePoint& now) const
+  {
+    return now < m_freshUntil;
+  }
+
+  /** @brief Returns where the entry is in the freshness wheel of the in-memory storage
+   */
+  const FreshnessWheel::Position&
+  getFreshnessPosition() const
+  {
+    return m_freshnessPosition;
+  }
+
+  void
+  setFreshnessPosition(const FreshnessWheel::Position& position)
+  {
+    m_freshnessPosition = position;
+  }
+
 private:
   shared_ptr<const Data> m_dataPacket;
+  time::steady_clock::TimePoint m_freshUntil;
+  FreshnessWheel::Position m_freshnessPosition;
 };
 
 } // namespace util
@@ -38,7 +38,8 @@ class InMemoryStorageFifo : public InMemoryStorage
 {
 public:
   explicit
-  InMemoryStorageFifo(size_t limit = 10);
+  InMemoryStorageFifo(size_t limit = 10,
+                      size_t limitInBytes = std::numeric_limits<size_t>::max());
 
   virtual
   ~InMemoryStorageFifo();
@@ -24,8 +24,8 @@
 namespace ndn {
 namespace util {
 
-InMemoryStorageLfu::InMemoryStorageLfu(size_t limit)
-  : InMemoryStorage(limit)
+InMemoryStorageLfu::InMemoryStorageLfu(size_t limit, size_t limitInBytes)
+  : InMemoryStorage(limit, limitInBytes)
 {
 }
 
@@ -48,7 +48,7 @@ InMemoryStorageLfu::evictItem()
 {
   if (!m_cleanupIndex.get<byFrequency>().empty()) {
     CleanupIndex::index<byFrequency>::type::iterator it = m_cleanupIndex.get<byFrequency>().begin();
-    eraseImpl(((*it).entry)->getFullName());
+    eraseImpl((*it).entry);
     m_cleanupIndex.get<byFrequency>().erase(it);
     return true;
   }
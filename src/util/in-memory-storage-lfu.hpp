@@ -41,7 +41,8 @@ class InMemoryStorageLfu : public InMemoryStorage
 {
 public:
   explicit
-  InMemoryStorageLfu(size_t limit = 10);
+  InMemoryStorageLfu(size_t limit = 10,
+                     size_t limitInBytes = std::numeric_limits<size_t>::max());
 
   virtual
   ~InMemoryStorageLfu();
@@ -24,8 +24,8 @@
 namespace ndn {
 namespace util {
 
-InMemoryStorageLru::InMemoryStorageLru(size_t limit)
-  : InMemoryStorage(limit)
+InMemoryStorageLru::InMemoryStorageLru(size_t limit, size_t limitInBytes)
+  : InMemoryStorage(limit, limitInBytes)
 {
 }
 
@@ -46,7 +46,7 @@ InMemoryStorageLru::evictItem()
 {
   if (!m_cleanupIndex.get<byUsedTime>().empty()) {
     CleanupIndex::index<byUsedTime>::type::iterator it = m_cleanupIndex.get<byUsedTime>().begin();
-    eraseImpl((*it)->getFullName());
+    eraseImpl(*it);
     m_cleanupIndex.get<byUsedTime>().erase(it);
     return true;
   }
@@ -40,7 +40,8 @@ class InMemoryStorageLru : public InMemoryStorage
 {
 public:
   explicit
-  InMemoryStorageLru(size_t limit = 10);
+  InMemoryStorageLru(size_t limit = 10,
+                     size_t limitInBytes = std::numeric_limits<size_t>::max());
 
   virtual
   ~InMemoryStorageLru();
@@ -24,8 +24,8 @@
 namespace ndn {
 namespace util {
 
-InMemoryStoragePersistent::InMemoryStoragePersistent()
-  : InMemoryStorage()
+InMemoryStoragePersistent::InMemoryStoragePersistent(size_t limitInBytes)
+  : InMemoryStorage(std::numeric_limits<size_t>::max(), limitInBytes)
 {
 }
 
@@ -39,5 +39,11 @@ InMemoryStoragePersistent::evictItem()
   return false;
 }
 
+bool
+InMemoryStoragePersistent::evictStaleItem()
+{
+  return false;
+}
+
 } // namespace util
 } // namespace ndn
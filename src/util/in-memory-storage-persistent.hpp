@@ -33,8 +33,11 @@ namespace util {
 class InMemoryStoragePersistent : public InMemoryStorage
 {
 public:
+  /** @param limitInBytes maximum number of bytes accounted to the stored packets; as nothing
+   *         is evicted, insert() throws once it is reached
+   */
   explicit
-  InMemoryStoragePersistent();
+  InMemoryStoragePersistent(size_t limitInBytes = std::numeric_limits<size_t>::max());
 
   virtual
   ~InMemoryStoragePersistent();
@@ -48,6 +51,15 @@ NDN_CXX_PUBLIC_WITH_TESTS_ELSE_PROTECTED:
    */
   virtual bool
   evictItem();
+
+  /** @brief Do nothing.
+   *
+   *  Stale packets are kept as well.
+   *
+   *  @return false
+   */
+  virtual bool
+  evictStaleItem();
 };
 
 } // namespace util
@@ -0,0 +1,156 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2015 Regents of the University of Tokyo.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+
+#include "in-memory-storage-sharded.hpp"
+
+#include <boost/functional/hash.hpp>
+
+namespace ndn {
+namespace util {
+
+InMemoryStorageSharded::InMemoryStorageSharded(size_t nShards, size_t nShardingComponents,
+                                               const ShardFactory& makeShard)
+  : m_nShardingComponents(nShardingComponents)
+{
+  BOOST_ASSERT(nShards > 0);
+
+  for (size_t i = 0; i < nShards; ++i) {
+    unique_ptr<Shard> shard(new Shard);
+    shard->storage = makeShard();
+    m_shards.push_back(std::move(shard));
+  }
+}
+
+size_t
+InMemoryStorageSharded::getShardIndex(const Name& name) const
+{
+  size_t nComponents = name.size();
+  if (nComponents > 0 && name.get(-1).isImplicitSha256Digest())
+    --nComponents;
+  if (nComponents < m_nShardingComponents)
+    return m_shards.size();
+
+  size_t seed = 0;
+  for (size_t i = 0; i < m_nShardingComponents; ++i) {
+    const name::Component& component = name.get(i);
+    boost::hash_combine(seed, component.type());
+    boost::hash_combine(seed, boost::hash_range(component.value_begin(),
+                                                component.value_end()));
+  }
+  return seed % m_shards.size();
+}
+
+void
+InMemoryStorageSharded::insert(const Data& data)
+{
+  size_t index = getShardIndex(data.getName());
+  if (index == m_shards.size())
+    index = 0; // names shorter than the sharding prefix all go to the first shard
+
+  Shard& shard = *m_shards[index];
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  shard.storage->insert(data);
+}
+
+shared_ptr<const Data>
+InMemoryStorageSharded::find(const Interest& interest)
+{
+  size_t index = getShardIndex(interest.getName());
+  if (index < m_shards.size()) {
+    Shard& shard = *m_shards[index];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    return shard.storage->find(interest);
+  }
+
+  bool isRightmost = interest.getChildSelector() > 0;
+  shared_ptr<const Data> best;
+  for (size_t i = 0; i < m_shards.size(); ++i) {
+    shared_ptr<const Data> match;
+    {
+      std::lock_guard<std::mutex> lock(m_shards[i]->mutex);
+      match = m_shards[i]->storage->find(interest);
+    }
+
+    if (match != nullptr &&
+        (best == nullptr || (isRightmost ? best->getName() < match->getName()
+                                         : match->getName() < best->getName())))
+      best = match;
+  }
+  return best;
+}
+
+shared_ptr<const Data>
+InMemoryStorageSharded::find(const Name& name)
+{
+  size_t index = getShardIndex(name);
+  if (index < m_shards.size()) {
+    Shard& shard = *m_shards[index];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    return shard.storage->find(name);
+  }
+
+  for (size_t i = 0; i < m_shards.size(); ++i) {
+    std::lock_guard<std::mutex> lock(m_shards[i]->mutex);
+    shared_ptr<const Data> match = m_shards[i]->storage->find(name);
+    if (match != nullptr)
+      return match;
+  }
+  return shared_ptr<const Data>();
+}
+
+void
+InMemoryStorageSharded::erase(const Name& prefix, bool isPrefix)
+{
+  size_t index = getShardIndex(prefix);
+  for (size_t i = 0; i < m_shards.size(); ++i) {
+    if (index < m_shards.size() && i != index)
+      continue;
+
+    std::lock_guard<std::mutex> lock(m_shards[i]->mutex);
+    m_shards[i]->storage->erase(prefix, isPrefix);
+  }
+}
+
+size_t
+InMemoryStorageSharded::size() const
+{
+  size_t nPackets = 0;
+  for (size_t i = 0; i < m_shards.size(); ++i) {
+    std::lock_guard<std::mutex> lock(m_shards[i]->mutex);
+    nPackets += m_shards[i]->storage->size();
+  }
+  return nPackets;
+}
+
+size_t
+InMemoryStorageSharded::sizeInBytes() const
+{
+  size_t nBytes = 0;
+  for (size_t i = 0; i < m_shards.size(); ++i) {
+    std::lock_guard<std::mutex> lock(m_shards[i]->mutex);
+    nBytes += m_shards[i]->storage->sizeInBytes();
+  }
+  return nBytes;
+}
+
+} // namespace util
+} // namespace ndn
@@ -0,0 +1,124 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2015 Regents of the University of Tokyo.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+
+#ifndef NDN_UTIL_IN_MEMORY_STORAGE_SHARDED_HPP
+#define NDN_UTIL_IN_MEMORY_STORAGE_SHARDED_HPP
+
+#include "in-memory-storage.hpp"
+
+#include <mutex>
+
+namespace ndn {
+namespace util {
+
+/** @brief Provides in-memory storage that can be used from several threads, split into shards
+ *  each guarded by its own lock.
+ *
+ *  Each shard is an InMemoryStorage created by a factory, so that it keeps its own replacement
+ *  policy, its hooks and its limits.  A packet goes to the shard chosen by a hash of the first
+ *  nShardingComponents components of its name, or to the first shard if its name is shorter.
+ *  An Interest or a Name with at least that many components, not counting an implicit digest,
+ *  is looked up in that shard only, under its lock; shorter ones are looked up in every shard
+ *  in turn.
+ *
+ *  In the latter case, the best match of each shard is accessed, and the leftmost or the
+ *  rightmost of them is returned according to the ChildSelector.  With a rightmost
+ *  ChildSelector, it may not be the leftmost packet of the rightmost child when the child
+ *  is spread over several shards.
+ *
+ *  Lookups lock the shard because accessing a packet updates the replacement policy; the
+ *  contention is spread over the shards rather than removed.
+ */
+class InMemoryStorageSharded : noncopyable
+{
+public:
+  typedef function<unique_ptr<InMemoryStorage>()> ShardFactory;
+
+  /** @param nShards number of shards, at least 1
+   *  @param nShardingComponents number of name components hashed to choose a shard
+   *  @param makeShard creates the storage of each shard
+   */
+  InMemoryStorageSharded(size_t nShards, size_t nShardingComponents,
+                         const ShardFactory& makeShard);
+
+  /** @brief Inserts a Data packet in its shard
+   *  @throw InMemoryStorage::Error see InMemoryStorage::insert
+   */
+  void
+  insert(const Data& data);
+
+  /** @brief Finds the best match Data for an Interest
+   *  @return{ the best match, if any; otherwise a null shared_ptr }
+   */
+  shared_ptr<const Data>
+  find(const Interest& interest);
+
+  /** @brief Finds the best match Data for a Name with or without the implicit digest
+   *  @return{ the one matched the Name; otherwise a null shared_ptr }
+   */
+  shared_ptr<const Data>
+  find(const Name& name);
+
+  /** @brief Deletes in-memory storage entries by prefix, or by full name if @p isPrefix is
+   *  clear
+   */
+  void
+  erase(const Name& prefix, bool isPrefix = true);
+
+  size_t
+  getNShards() const
+  {
+    return m_shards.size();
+  }
+
+  /** @return{ number of packets stored in all shards }
+   */
+  size_t
+  size() const;
+
+  /** @return{ number of bytes accounted to the packets stored in all shards }
+   */
+  size_t
+  sizeInBytes() const;
+
+NDN_CXX_PUBLIC_WITH_TESTS_ELSE_PRIVATE:
+  /** @return the shard of packets named under @p name, or getNShards() if @p name is too short
+   *          to tell
+   */
+  size_t
+  getShardIndex(const Name& name) const;
+
+private:
+  struct Shard : noncopyable
+  {
+    mutable std::mutex mutex;
+    unique_ptr<InMemoryStorage> storage;
+  };
+
+  size_t m_nShardingComponents;
+  std::vector<unique_ptr<Shard>> m_shards;
+};
+
+} // namespace util
+} // namespace ndn
+
+#endif // NDN_UTIL_IN_MEMORY_STORAGE_SHARDED_HPP
@@ -0,0 +1,199 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2015 Regents of the University of Tokyo.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+
+#include "in-memory-storage-tiny-lfu.hpp"
+
+namespace ndn {
+namespace util {
+
+static const size_t SKETCH_DEPTH = 4;
+static const uint8_t SKETCH_MAX_COUNT = 15;
+
+static uint64_t
+mixHash(uint64_t value)
+{
+  // finalizer of MurmurHash3
+  value ^= value >> 33;
+  value *= 0xff51afd7ed558ccdULL;
+  value ^= value >> 33;
+  value *= 0xc4ceb9fe1a85ec53ULL;
+  value ^= value >> 33;
+  return value;
+}
+
+InMemoryStorageTinyLfu::InMemoryStorageTinyLfu(size_t limit, size_t limitInBytes)
+  : InMemoryStorage(limit, limitInBytes)
+  , m_nIncrements(0)
+{
+  // four counters per packet in each row, so that the names accessed since the last reset
+  // rarely share all their counters
+  size_t width = 16;
+  size_t minWidth = limit < (1 << 20) ? 4 * limit : (1 << 22);
+  while (width < minWidth)
+    width *= 2;
+
+  m_sketch.resize(SKETCH_DEPTH * width);
+  m_sketchMask = width - 1;
+  m_resetPeriod = 10 * width;
+}
+
+InMemoryStorageTinyLfu::~InMemoryStorageTinyLfu()
+{
+}
+
+size_t
+InMemoryStorageTinyLfu::getCounterIndex(const Name& name, size_t row) const
+{
+  uint64_t hash1 = mixHash(std::hash<Name>()(name));
+  uint64_t hash2 = mixHash(hash1) | 1;
+  return row * (m_sketchMask + 1) + ((hash1 + row * hash2) & m_sketchMask);
+}
+
+void
+InMemoryStorageTinyLfu::recordAccess(const Name& name)
+{
+  for (size_t row = 0; row < SKETCH_DEPTH; ++row) {
+    uint8_t& count = m_sketch[getCounterIndex(name, row)];
+    if (count < SKETCH_MAX_COUNT)
+      ++count;
+  }
+
+  if (++m_nIncrements >= m_resetPeriod) {
+    for (std::vector<uint8_t>::iterator it = m_sketch.begin(); it != m_sketch.end(); ++it)
+      *it >>= 1;
+    m_nIncrements /= 2;
+  }
+}
+
+uint8_t
+InMemoryStorageTinyLfu::estimateFrequency(const Name& name) const
+{
+  uint8_t frequency = SKETCH_MAX_COUNT;
+  for (size_t row = 0; row < SKETCH_DEPTH; ++row)
+    frequency = std::min(frequency, m_sketch[getCounterIndex(name, row)]);
+  return frequency;
+}
+
+size_t
+InMemoryStorageTinyLfu::getWindowTarget() const
+{
+  return std::max<size_t>(size() / 100, 1);
+}
+
+size_t
+InMemoryStorageTinyLfu::getProtectedTarget() const
+{
+  size_t windowTarget = getWindowTarget();
+  return size() > windowTarget ? (size() - windowTarget) * 4 / 5 : 0;
+}
+
+bool
+InMemoryStorageTinyLfu::eraseFrom(CleanupIndex& index, InMemoryStorageEntry* entry)
+{
+  CleanupIndex::index<byEntity>::type::iterator it = index.get<byEntity>().find(entry);
+  if (it == index.get<byEntity>().end())
+    return false;
+
+  index.get<byEntity>().erase(it);
+  return true;
+}
+
+void
+InMemoryStorageTinyLfu::evict(CleanupIndex& index, InMemoryStorageEntry* entry)
+{
+  eraseFrom(index, entry);
+  eraseImpl(entry);
+}
+
+void
+InMemoryStorageTinyLfu::afterInsert(InMemoryStorageEntry* entry)
+{
+  recordAccess(entry->getName());
+  m_window.insert(entry);
+
+  while (m_window.size() > getWindowTarget()) {
+    InMemoryStorageEntry* leaving = getLeastRecent(m_window);
+    eraseFrom(m_window, leaving);
+    m_probation.insert(leaving);
+  }
+}
+
+bool
+InMemoryStorageTinyLfu::evictItem()
+{
+  if (m_probation.empty() && m_protected.empty()) {
+    if (m_window.empty())
+      return false;
+
+    evict(m_window, getLeastRecent(m_window));
+    return true;
+  }
+
+  CleanupIndex& mainSegment = !m_probation.empty() ? m_probation : m_protected;
+  InMemoryStorageEntry* victim = getLeastRecent(mainSegment);
+
+  // the packet inserted next pushes the least recent one out of a full window
+  if (!m_window.empty() && m_window.size() >= getWindowTarget()) {
+    InMemoryStorageEntry* candidate = getLeastRecent(m_window);
+    if (estimateFrequency(candidate->getName()) <= estimateFrequency(victim->getName())) {
+      evict(m_window, candidate);
+      return true;
+    }
+
+    eraseFrom(m_window, candidate);
+    m_probation.insert(candidate);
+  }
+
+  evict(mainSegment, victim);
+  return true;
+}
+
+void
+InMemoryStorageTinyLfu::beforeErase(InMemoryStorageEntry* entry)
+{
+  if (!eraseFrom(m_window, entry) && !eraseFrom(m_probation, entry))
+    eraseFrom(m_protected, entry);
+}
+
+void
+InMemoryStorageTinyLfu::afterAccess(InMemoryStorageEntry* entry)
+{
+  recordAccess(entry->getName());
+
+  if (eraseFrom(m_window, entry)) {
+    m_window.insert(entry);
+    return;
+  }
+
+  if (!eraseFrom(m_probation, entry))
+    eraseFrom(m_protected, entry);
+  m_protected.insert(entry);
+
+  while (m_protected.size() > getProtectedTarget()) {
+    InMemoryStorageEntry* demoted = getLeastRecent(m_protected);
+    eraseFrom(m_protected, demoted);
+    m_probation.insert(demoted);
+  }
+}
+
+} // namespace util
+} // namespace ndn
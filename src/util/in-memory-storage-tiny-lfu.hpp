@@ -0,0 +1,157 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2015 Regents of the University of Tokyo.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+
+#ifndef NDN_UTIL_IN_MEMORY_STORAGE_TINY_LFU_HPP
+#define NDN_UTIL_IN_MEMORY_STORAGE_TINY_LFU_HPP
+
+#include "in-memory-storage.hpp"
+
+#include <boost/multi_index_container.hpp>
+#include <boost/multi_index/sequenced_index.hpp>
+#include <boost/multi_index/hashed_index.hpp>
+#include <boost/multi_index/identity.hpp>
+
+namespace ndn {
+namespace util {
+
+/** @brief Provides in-memory storage employing W-TinyLFU replacement policy, which admits a
+ *  packet into the main space only if it is accessed more often than the packet it replaces.
+ *
+ *  New packets enter a small LRU window of 1% of the capacity.  The packet pushed out of the
+ *  window competes with the least recently used packet of the main space, and the one
+ *  accessed less often is evicted.  Access frequencies are estimated by a count-min sketch
+ *  of 4-bit counters over the Data names, which are halved periodically so that the estimates
+ *  follow changes in popularity.  The main space is a segmented LRU: packets accessed again
+ *  move from the probation segment to the protected segment, which holds up to 80% of it.
+ *
+ *  Bursts of packets accessed once, such as scans, stay in the window and in probation, while
+ *  the bookkeeping of an access is a few list moves and counter updates.
+ */
+class InMemoryStorageTinyLfu : public InMemoryStorage
+{
+public:
+  explicit
+  InMemoryStorageTinyLfu(size_t limit = 10,
+                         size_t limitInBytes = std::numeric_limits<size_t>::max());
+
+  virtual
+  ~InMemoryStorageTinyLfu();
+
+NDN_CXX_PUBLIC_WITH_TESTS_ELSE_PROTECTED:
+  /** @brief Removes one Data packet from in-memory storage based on W-TinyLFU, i.e. either the
+   *  packet leaving the window or the least recently used packet of the main space, whichever
+   *  is less frequently accessed
+   *  @return{ whether the Data was removed }
+   */
+  virtual bool
+  evictItem();
+
+  /** @brief Update the entry when the entry is returned by the find() function, count the
+   *  access and promote the entry within its segment or to the protected segment
+   */
+  virtual void
+  afterAccess(InMemoryStorageEntry* entry);
+
+  /** @brief Update the entry after a entry is successfully inserted, count the access and add
+   *  it to the window
+   */
+  virtual void
+  afterInsert(InMemoryStorageEntry* entry);
+
+  /** @brief Update the entry or other data structures before a entry is successfully erased,
+   *  erase it from its segment
+   */
+  virtual void
+  beforeErase(InMemoryStorageEntry* entry);
+
+  /** @return{ the estimated number of recent accesses to packets named @p name, at most 15 }
+   */
+  uint8_t
+  estimateFrequency(const Name& name) const;
+
+private:
+  //multi_index_container to implement each LRU segment
+  class byUsedTime;
+  class byEntity;
+
+  typedef boost::multi_index_container<
+    InMemoryStorageEntry*,
+    boost::multi_index::indexed_by<
+
+      // by Entry itself
+      boost::multi_index::hashed_unique<
+        boost::multi_index::tag<byEntity>,
+        boost::multi_index::identity<InMemoryStorageEntry*>
+      >,
+
+      // by last used time (LRU)
+      boost::multi_index::sequenced<
+        boost::multi_index::tag<byUsedTime>
+      >
+
+    >
+  > CleanupIndex;
+
+  /** @return{ whether @p entry was in @p index }
+   */
+  static bool
+  eraseFrom(CleanupIndex& index, InMemoryStorageEntry* entry);
+
+  static InMemoryStorageEntry*
+  getLeastRecent(const CleanupIndex& index)
+  {
+    return *index.get<byUsedTime>().begin();
+  }
+
+  void
+  evict(CleanupIndex& index, InMemoryStorageEntry* entry);
+
+  void
+  recordAccess(const Name& name);
+
+  /** @return{ index of the counter of @p name in row @p row of the sketch }
+   */
+  size_t
+  getCounterIndex(const Name& name, size_t row) const;
+
+  size_t
+  getWindowTarget() const;
+
+  size_t
+  getProtectedTarget() const;
+
+private:
+  CleanupIndex m_window;
+  CleanupIndex m_probation;
+  CleanupIndex m_protected;
+
+  /// count-min sketch: 4 rows of m_sketchMask + 1 counters
+  std::vector<uint8_t> m_sketch;
+  size_t m_sketchMask;
+  size_t m_nIncrements;
+  size_t m_resetPeriod;
+};
+
+} // namespace util
+} // namespace ndn
+
+#endif // NDN_UTIL_IN_MEMORY_STORAGE_TINY_LFU_HPP
@@ -29,8 +29,47 @@
 namespace ndn {
 namespace util {
 
+/// the freshness wheel turns in about 10 seconds, so that a FreshnessPeriod of up to that
+/// is found expired within 10 milliseconds
+static const size_t FRESHNESS_WHEEL_SIZE = 1024;
+static const time::milliseconds FRESHNESS_WHEEL_TICK(10);
+
+static bool
+matchesEntry(const Interest& interest, const InMemoryStorageEntry* entry,
+             const time::steady_clock::TimePoint& now)
+{
+  return (!interest.getMustBeFresh() || entry->isFresh(now)) &&
+         interest.matchesData(entry->getData());
+}
+
+/** @brief Finds the range of excluded components which @p child falls in
+ *  @param[out] first least component of the range
+ *  @param[out] last greatest component of the range, nullptr if the range is unbounded
+ *  @pre @p child is excluded
+ */
+static void
+getExcludedRange(const Exclude& exclude, const name::Component& child,
+                 const name::Component*& first, const name::Component*& last)
+{
+  //exclude terms are ordered from the greatest component, which bounds the range of ANY
+  //following it
+  const name::Component* greater = nullptr;
+  Exclude::const_iterator term = exclude.begin();
+  for (; term != exclude.end() && child < term->first; ++term)
+    greater = &term->first;
+
+  BOOST_ASSERT(term != exclude.end());
+  if (term->second) {
+    first = &term->first;
+    last = greater;
+  }
+  else {
+    first = last = &child;
+  }
+}
+
 InMemoryStorage::const_iterator::const_iterator(const Data* ptr, const Cache* cache,
-                                                Cache::index<byFullName>::type::iterator it)
+                                                Cache::index<byName>::type::iterator it)
   : m_ptr(ptr)
   , m_cache(cache)
   , m_it(it)
@@ -41,7 +80,7 @@ InMemoryStorage::const_iterator&
 InMemoryStorage::const_iterator::operator++()
 {
   m_it++;
-  if (m_it != m_cache->get<byFullName>().end()) {
+  if (m_it != m_cache->get<byName>().end()) {
     m_ptr = &((*m_it)->getData());
   }
   else {
@@ -83,9 +122,12 @@ InMemoryStorage::const_iterator::operator!=(const const_iterator& rhs)
   return m_it != rhs.m_it;
 }
 
-InMemoryStorage::InMemoryStorage(size_t limit)
+InMemoryStorage::InMemoryStorage(size_t limit, size_t limitInBytes)
   : m_limit(limit)
   , m_nPackets(0)
+  , m_limitInBytes(limitInBytes)
+  , m_nBytes(0)
+  , m_freshnessWheel(FRESHNESS_WHEEL_SIZE, FRESHNESS_WHEEL_TICK)
 {
   // TODO consider a more suitable initial value
   m_capacity = 10;
@@ -124,7 +166,7 @@ InMemoryStorage::setCapacity(size_t capacity)
   if (size() > m_capacity) {
     ssize_t nAllowedFailures = size() - m_capacity;
     while (size() > m_capacity) {
-      if (!evictItem() && --nAllowedFailures < 0) {
+      if (!evictOne() && --nAllowedFailures < 0) {
         throw Error();
       }
     }
@@ -148,10 +190,26 @@ InMemoryStorage::setCapacity(size_t capacity)
 void
 InMemoryStorage::insert(const Data& data)
 {
-  //check if identical Data/Name already exists
-  Cache::index<byFullName>::type::iterator it = m_cache.get<byFullName>().find(data.getFullName());
-  if (it != m_cache.get<byFullName>().end())
-    return;
+  insertImpl(data, nullptr);
+}
+
+void
+InMemoryStorage::insertImpl(const Data& data, const time::steady_clock::TimePoint* freshUntil)
+{
+  //check if identical Data/Name already exists; the digest is needed only to tell apart
+  //packets with the same name
+  std::pair<Cache::index<byName>::type::iterator, Cache::index<byName>::type::iterator> range =
+    m_cache.get<byName>().equal_range(data.getName());
+  for (Cache::index<byName>::type::iterator it = range.first; it != range.second; ++it) {
+    if ((*it)->getFullName() == data.getFullName())
+      return;
+  }
+
+  expireStaleItems(time::steady_clock::now());
+
+  size_t entrySize = getEntrySize(data);
+  if (entrySize > getLimitInBytes())
+    throw Error("Data packet is larger than the limit in bytes of the in-memory storage");
 
   //if full, double the capacity
   bool doesReachLimit = (getLimit() == getCapacity());
@@ -161,9 +219,17 @@ InMemoryStorage::insert(const Data& data)
     setCapacity(newCapacity);
   }
 
-  //if full and reach limitation of the capacity, employ replacement policy
+  //if full and reach limitation of the capacity, evict a stale packet or employ replacement
+  //policy
   if (isFull() && doesReachLimit) {
-    evictItem();
+    evictOne();
+  }
+
+  //make room within the limit in bytes
+  while (sizeInBytes() + entrySize > getLimitInBytes()) {
+    if (!evictOne())
+      throw Error("Cannot make room for a Data packet within the limit in bytes of the "
+                  "in-memory storage");
   }
 
   //insert to cache
@@ -172,8 +238,14 @@ InMemoryStorage::insert(const Data& data)
   InMemoryStorageEntry* entry = m_freeEntries.top();
   m_freeEntries.pop();
   m_nPackets++;
-  entry->setData(data);
+  m_nBytes += entrySize;
+  if (freshUntil != nullptr)
+    entry->setData(data, *freshUntil);
+  else
+    entry->setData(data);
   m_cache.insert(entry);
+  if (entry->getFreshUntil() != time::steady_clock::TimePoint::max())
+    entry->setFreshnessPosition(m_freshnessWheel.insert(entry->getFreshUntil(), entry));
 
   //let derived class do something with the entry
   afterInsert(entry);
@@ -182,16 +254,26 @@ InMemoryStorage::insert(const Data& data)
 shared_ptr<const Data>
 InMemoryStorage::find(const Name& name)
 {
-  Cache::index<byFullName>::type::iterator it = m_cache.get<byFullName>().lower_bound(name);
+  Cache::index<byName>::type::iterator it;
+  if (!name.empty() && name.get(-1).isImplicitSha256Digest()) {
+    it = findByFullName(name);
+  }
+  else {
+    it = m_cache.get<byName>().lower_bound(name);
 
-  //if not found, return null
-  if (it == m_cache.get<byFullName>().end()) {
-    return shared_ptr<const Data>();
+    //if the given name is not the prefix of the lower_bound, it is not found
+    if (it != m_cache.get<byName>().end() && !name.isPrefixOf((*it)->getName())) {
+      it = m_cache.get<byName>().end();
+    }
   }
 
-  //if the given name is not the prefix of the lower_bound, return null
-  if (!name.isPrefixOf((*it)->getFullName())) {
-    return shared_ptr<const Data>();
+  //if not found, search the overflow storage
+  if (it == m_cache.get<byName>().end()) {
+    if (m_overflow == nullptr)
+      return shared_ptr<const Data>();
+
+    time::steady_clock::TimePoint freshUntil;
+    return promote(m_overflow->extract(name, &freshUntil), freshUntil);
   }
 
   afterAccess(*it);
@@ -202,118 +284,133 @@ shared_ptr<const Data>
 InMemoryStorage::find(const Interest& interest)
 {
   //if the interest contains implicit digest, it is possible to directly locate a packet.
-  Cache::index<byFullName>::type::iterator it = m_cache.get<byFullName>()
-                                                    .find(interest.getName());
-
-  //if a packet is located by its full name, it must be the packet to return.
-  if (it != m_cache.get<byFullName>().end()) {
-    return ((*it)->getData()).shared_from_this();
+  Cache::index<byName>::type::iterator it = findByFullName(interest.getName());
+
+  //if a packet is located by its full name, it must be the packet to return, unless it is
+  //stale and the Interest requires a fresh one.
+  time::steady_clock::TimePoint now = time::steady_clock::now();
+  if (it != m_cache.get<byName>().end()) {
+    if (!interest.getMustBeFresh() || (*it)->isFresh(now))
+      return ((*it)->getData()).shared_from_this();
+    return shared_ptr<const Data>();
   }
 
   //if the packet is not discovered by last step, either the packet is not in the storage or
   //the interest doesn't contains implicit digest.
-  it = m_cache.get<byFullName>().lower_bound(interest.getName());
-
-  if (it == m_cache.get<byFullName>().end()) {
-    return shared_ptr<const Data>();
-  }
-
-
-  //to locate the element that has a just smaller name than the interest's
-  if (it != m_cache.get<byFullName>().begin())
-    it--;
-
-  InMemoryStorageEntry* ret = selectChild(interest, it);
+  InMemoryStorageEntry* ret = selectChild(interest, now);
   if (ret != 0) {
     //let derived class do something with the entry
     afterAccess(ret);
     return ret->getData().shared_from_this();
   }
-  else {
+
+  if (m_overflow == nullptr)
     return shared_ptr<const Data>();
+
+  time::steady_clock::TimePoint freshUntil;
+  return promote(m_overflow->extract(interest, &freshUntil), freshUntil);
+}
+
+shared_ptr<const Data>
+InMemoryStorage::promote(const shared_ptr<const Data>& data,
+                         const time::steady_clock::TimePoint& freshUntil)
+{
+  if (data == nullptr)
+    return data;
+
+  try {
+    insertImpl(*data, &freshUntil);
+  }
+  catch (const Error&) {
+    //the packet does not fit in memory: leave it in the overflow storage
+    m_overflow->insert(*data, freshUntil);
   }
+  return data;
 }
 
 InMemoryStorageEntry*
 InMemoryStorage::selectChild(const Interest& interest,
-                             Cache::index<byFullName>::type::iterator startingPoint) const
+                             const time::steady_clock::TimePoint& now) const
 {
-  BOOST_ASSERT(startingPoint != m_cache.get<byFullName>().end());
-
-  if (startingPoint != m_cache.get<byFullName>().begin())
-    {
-      BOOST_ASSERT((*startingPoint)->getFullName() < interest.getName());
+  const Cache::index<byName>::type& index = m_cache.get<byName>();
+  const Name& prefix = interest.getName();
+  const Exclude& exclude = interest.getExclude();
+
+  Cache::index<byName>::type::iterator first = index.lower_bound(prefix);
+  //names under the Interest name sort before its successor
+  Cache::index<byName>::type::iterator last =
+    prefix.empty() ? index.end() : index.lower_bound(prefix.getSuccessor());
+
+  if (interest.getChildSelector() <= 0) {
+    //packets named as the Interest sort first; the child of each is its implicit digest,
+    //which is computed only to order several matching packets
+    Cache::index<byName>::type::iterator it = first;
+    InMemoryStorageEntry* leftmost = 0;
+    for (; it != last && (*it)->getName().size() == prefix.size(); ++it) {
+      if (matchesEntry(interest, *it, now) &&
+          (leftmost == 0 || (*it)->getFullName() < leftmost->getFullName()))
+        leftmost = *it;
     }
+    if (leftmost != 0)
+      return leftmost;
+
+    while (it != last) {
+      const Name& name = (*it)->getName();
+
+      //the child of a packet named as the Interest is its implicit digest
+      if (name.size() > prefix.size() && exclude.isExcluded(name.get(prefix.size()))) {
+        const name::Component* firstExcluded = nullptr;
+        const name::Component* lastExcluded = nullptr;
+        getExcludedRange(exclude, name.get(prefix.size()), firstExcluded, lastExcluded);
+        if (lastExcluded == nullptr)
+          return 0;
+
+        it = index.lower_bound(Name(prefix).append(*lastExcluded).getSuccessor());
+        continue;
+      }
 
-  bool hasLeftmostSelector = (interest.getChildSelector() <= 0);
-  bool hasRightmostSelector = !hasLeftmostSelector;
-
-  if (hasLeftmostSelector)
-    {
-      if (interest.matchesData((*startingPoint)->getData()))
-        {
-          return *startingPoint;
-        }
+      if (matchesEntry(interest, *it, now))
+        return *it;
+      ++it;
     }
 
-  //iterate to the right
-  Cache::index<byFullName>::type::iterator rightmost = startingPoint;
-  if (startingPoint != m_cache.get<byFullName>().end())
-    {
-      Cache::index<byFullName>::type::iterator rightmostCandidate = startingPoint;
-      Name currentChildPrefix("");
-
-      while (true)
-        {
-          ++rightmostCandidate;
-
-          bool isInBoundaries = (rightmostCandidate != m_cache.get<byFullName>().end());
-          bool isInPrefix = false;
-          if (isInBoundaries)
-            {
-              isInPrefix = interest.getName().isPrefixOf((*rightmostCandidate)->getFullName());
-            }
-
-          if (isInPrefix)
-            {
-              if (interest.matchesData((*rightmostCandidate)->getData()))
-                {
-                  if (hasLeftmostSelector)
-                    {
-                      return *rightmostCandidate;
-                    }
-
-                  if (hasRightmostSelector)
-                    {
-                      // get prefix which is one component longer than Interest name
-                      const Name& childPrefix = (*rightmostCandidate)->getFullName()
-                                                  .getPrefix(interest.getName().size() + 1);
-
-                      if (currentChildPrefix.empty() || (childPrefix != currentChildPrefix))
-                        {
-                          currentChildPrefix = childPrefix;
-                          rightmost = rightmostCandidate;
-                        }
-                    }
-                }
-            }
-          else
-            break;
-        }
+    return 0;
+  }
+
+  //walk the children from the right; the leftmost matching packet of the rightmost child
+  //having one is returned
+  while (last != first) {
+    const Name& name = (*std::prev(last))->getName();
+
+    //packets named as the Interest sort before its children; the child of each is its
+    //implicit digest, which is computed only to order several matching packets
+    if (name.size() == prefix.size()) {
+      InMemoryStorageEntry* rightmost = 0;
+      for (Cache::index<byName>::type::iterator it = first; it != last; ++it) {
+        if (matchesEntry(interest, *it, now) &&
+            (rightmost == 0 || rightmost->getFullName() < (*it)->getFullName()))
+          rightmost = *it;
+      }
+      return rightmost;
     }
 
-  if (rightmost != startingPoint)
-    {
-      return *rightmost;
+    const name::Component& child = name.get(prefix.size());
+    if (exclude.isExcluded(child)) {
+      const name::Component* firstExcluded = nullptr;
+      const name::Component* lastExcluded = nullptr;
+      getExcludedRange(exclude, child, firstExcluded, lastExcluded);
+      last = index.lower_bound(Name(prefix).append(*firstExcluded));
+      continue;
     }
 
-  if (hasRightmostSelector) // if rightmost was not found, try starting point
-    {
-      if (interest.matchesData((*startingPoint)->getData()))
-        {
-          return *startingPoint;
-        }
+    Cache::index<byName>::type::iterator childFirst =
+      index.lower_bound(Name(prefix).append(child));
+    for (Cache::index<byName>::type::iterator it = childFirst; it != last; ++it) {
+      if (matchesEntry(interest, *it, now))
+        return *it;
     }
+    last = childFirst;
+  }
 
   return 0;
 }
@@ -321,6 +418,12 @@ InMemoryStorage::selectChild(const Interest& interest,
 InMemoryStorage::Cache::iterator
 InMemoryStorage::freeEntry(Cache::iterator it)
 {
+  m_nBytes -= getEntrySize((*it)->getData());
+
+  InMemoryStorageEntry::FreshnessWheel::Position position = (*it)->getFreshnessPosition();
+  m_freshnessWheel.erase(position);
+  m_staleEntries.get<byEntity>().erase(*it);
+
   //push the *empty* entry into mem pool
   (*it)->release();
   m_freeEntries.push(*it);
@@ -328,22 +431,38 @@ InMemoryStorage::freeEntry(Cache::iterator it)
   return m_cache.erase(it);
 }
 
+InMemoryStorage::Cache::index<InMemoryStorage::byName>::type::iterator
+InMemoryStorage::findByFullName(const Name& fullName) const
+{
+  if (fullName.empty() || !fullName.get(-1).isImplicitSha256Digest())
+    return m_cache.get<byName>().end();
+
+  std::pair<Cache::index<byName>::type::iterator, Cache::index<byName>::type::iterator> range =
+    m_cache.get<byName>().equal_range(fullName.getPrefix(-1));
+  for (Cache::index<byName>::type::iterator it = range.first; it != range.second; ++it) {
+    if ((*it)->getFullName() == fullName)
+      return it;
+  }
+
+  return m_cache.get<byName>().end();
+}
+
 void
 InMemoryStorage::erase(const Name& prefix, const bool isPrefix)
 {
   if (isPrefix) {
-    Cache::index<byFullName>::type::iterator it = m_cache.get<byFullName>().lower_bound(prefix);
+    Cache::index<byName>::type::iterator it = m_cache.get<byName>().lower_bound(prefix);
 
-    while (it != m_cache.get<byFullName>().end() && prefix.isPrefixOf((*it)->getName())) {
+    while (it != m_cache.get<byName>().end() && prefix.isPrefixOf((*it)->getName())) {
       //let derived class do something with the entry
       beforeErase(*it);
       it = freeEntry(it);
     }
   }
   else {
-    Cache::index<byFullName>::type::iterator it = m_cache.get<byFullName>().find(prefix);
+    Cache::index<byName>::type::iterator it = findByFullName(prefix);
 
-    if (it == m_cache.get<byFullName>().end())
+    if (it == m_cache.get<byName>().end())
       return;
 
     //let derived class do something with the entry
@@ -351,6 +470,9 @@ InMemoryStorage::erase(const Name& prefix, const bool isPrefix)
     freeEntry(it);
   }
 
+  if (m_overflow != nullptr)
+    m_overflow->erase(prefix, isPrefix);
+
   if (m_freeEntries.size() > (2 * size()))
     setCapacity(getCapacity() / 2);
 }
@@ -358,18 +480,78 @@ InMemoryStorage::erase(const Name& prefix, const bool isPrefix)
 void
 InMemoryStorage::eraseImpl(const Name& name)
 {
-  Cache::index<byFullName>::type::iterator it = m_cache.get<byFullName>().find(name);
+  Cache::index<byName>::type::iterator it = findByFullName(name);
 
-  if (it == m_cache.get<byFullName>().end())
+  if (it == m_cache.get<byName>().end())
     return;
 
   freeEntry(it);
 }
 
+bool
+InMemoryStorage::evictOne()
+{
+  return evictStaleItem() || evictItem();
+}
+
+void
+InMemoryStorage::expireStaleItems(const time::steady_clock::TimePoint& now)
+{
+  m_freshnessWheel.advance(now, [this] (InMemoryStorageEntry* entry) {
+      entry->setFreshnessPosition(InMemoryStorageEntry::FreshnessWheel::Position());
+      m_staleEntries.insert(entry);
+    });
+}
+
+bool
+InMemoryStorage::evictStaleItem()
+{
+  if (m_staleEntries.empty())
+    return false;
+
+  //a stale packet is dropped rather than moved to the overflow storage
+  InMemoryStorageEntry* entry = *m_staleEntries.get<byStaleTime>().begin();
+  beforeErase(entry);
+  freeEntry(findEntry(entry));
+  return true;
+}
+
+void
+InMemoryStorage::eraseImpl(InMemoryStorageEntry* entry)
+{
+  Cache::index<byName>::type::iterator it = findEntry(entry);
+  if (it == m_cache.get<byName>().end())
+    return;
+
+  if (m_overflow != nullptr) {
+    try {
+      m_overflow->insert(entry->getData(), entry->getFreshUntil());
+    }
+    catch (const DiskStorage::Error&) {
+      //the packet is dropped
+    }
+  }
+
+  freeEntry(it);
+}
+
+InMemoryStorage::Cache::index<InMemoryStorage::byName>::type::iterator
+InMemoryStorage::findEntry(const InMemoryStorageEntry* entry) const
+{
+  std::pair<Cache::index<byName>::type::iterator, Cache::index<byName>::type::iterator> range =
+    m_cache.get<byName>().equal_range(entry->getName());
+  for (Cache::index<byName>::type::iterator it = range.first; it != range.second; ++it) {
+    if (*it == entry)
+      return it;
+  }
+
+  return m_cache.get<byName>().end();
+}
+
 InMemoryStorage::const_iterator
 InMemoryStorage::begin() const
 {
-  Cache::index<byFullName>::type::iterator it = m_cache.get<byFullName>().begin();
+  Cache::index<byName>::type::iterator it = m_cache.get<byName>().begin();
 
   return const_iterator(&((*it)->getData()), &m_cache, it);
 }
@@ -377,13 +559,25 @@ InMemoryStorage::begin() const
 InMemoryStorage::const_iterator
 InMemoryStorage::end() const
 {
-  Cache::index<byFullName>::type::iterator it = m_cache.get<byFullName>().end();
+  Cache::index<byName>::type::iterator it = m_cache.get<byName>().end();
 
   const Data* ptr = NULL;
 
   return const_iterator(ptr, &m_cache, it);
 }
 
+size_t
+InMemoryStorage::getEntrySize(const Data& data)
+{
+  // nodes in the storage index, in the index of the replacement policy and in the freshness
+  // wheel, of about four pointers each, and the control block shared by the owners of the Data
+  static const size_t INDEX_OVERHEAD = 14 * sizeof(void*);
+
+  return data.wireEncode().size() + sizeof(Data) +
+         data.getName().size() * sizeof(name::Component) +
+         sizeof(InMemoryStorageEntry) + INDEX_OVERHEAD;
+}
+
 void
 InMemoryStorage::afterInsert(InMemoryStorageEntry* entry)
 {
@@ -403,8 +597,8 @@ void
 InMemoryStorage::printCache(std::ostream& os) const
 {
   //start from the upper layer towards bottom
-  const Cache::index<byFullName>::type& cacheIndex = m_cache.get<byFullName>();
-  for (Cache::index<byFullName>::type::iterator it = cacheIndex.begin();
+  const Cache::index<byName>::type& cacheIndex = m_cache.get<byName>();
+  for (Cache::index<byName>::type::iterator it = cacheIndex.begin();
        it != cacheIndex.end(); it++)
     os << (*it)->getFullName() << std::endl;
 }
@@ -27,6 +27,7 @@
 #include "../data.hpp"
 
 #include "in-memory-storage-entry.hpp"
+#include "disk-storage.hpp"
 
 #include <boost/multi_index/member.hpp>
 #include <boost/multi_index_container.hpp>
@@ -34,6 +35,7 @@
 #include <boost/multi_index/sequenced_index.hpp>
 #include <boost/multi_index/identity.hpp>
 #include <boost/multi_index/mem_fun.hpp>
+#include <boost/multi_index/hashed_index.hpp>
 
 #include <stack>
 #include <iterator>
@@ -47,17 +49,20 @@ class InMemoryStorage : noncopyable
 {
 public:
   //multi_index_container to implement storage
-  class byFullName;
+  class byName;
 
+  /** Entries are indexed by Data name, without the implicit digest, so that inserting a packet
+   *  does not require hashing it.  Packets with the same name are kept in insertion order.
+   */
   typedef boost::multi_index_container<
     InMemoryStorageEntry*,
     boost::multi_index::indexed_by<
 
-      // by Full Name
-      boost::multi_index::ordered_unique<
-        boost::multi_index::tag<byFullName>,
+      // by Name
+      boost::multi_index::ordered_non_unique<
+        boost::multi_index::tag<byName>,
         boost::multi_index::const_mem_fun<InMemoryStorageEntry, const Name&,
-                                          &InMemoryStorageEntry::getFullName>,
+                                          &InMemoryStorageEntry::getName>,
         std::less<Name>
       >
 
@@ -72,7 +77,7 @@ public:
   {
   public:
     const_iterator(const Data* ptr, const Cache* cache,
-                   Cache::index<byFullName>::type::iterator it);
+                   Cache::index<byName>::type::iterator it);
 
     const_iterator&
     operator++();
@@ -95,11 +100,12 @@ public:
   private:
     const Data* m_ptr;
     const Cache* m_cache;
-    Cache::index<byFullName>::type::iterator m_it;
+    Cache::index<byName>::type::iterator m_it;
   };
 
   /** @brief Represents an error might be thrown during reduce the current capacity of the
-   *  in-memory storage through function setCapacity(size_t nMaxPackets).
+   *  in-memory storage through function setCapacity(size_t nMaxPackets), or when a packet
+   *  does not fit in the limit in bytes.
    */
   class Error : public std::runtime_error
   {
@@ -107,10 +113,21 @@ public:
     Error() : std::runtime_error("Cannot reduce the capacity of the in-memory storage!")
     {
     }
+
+    explicit
+    Error(const std::string& what)
+      : std::runtime_error(what)
+    {
+    }
   };
 
+  /** @param limit maximum number of packets
+   *  @param limitInBytes maximum number of bytes accounted to the stored packets,
+   *         see sizeInBytes()
+   */
   explicit
-  InMemoryStorage(size_t limit = std::numeric_limits<size_t>::max());
+  InMemoryStorage(size_t limit = std::numeric_limits<size_t>::max(),
+                  size_t limitInBytes = std::numeric_limits<size_t>::max());
 
   /** @note Please make sure to implement it to free m_freeEntries and evict
     * all items in the derived class for anybody who wishes to inherit this class
@@ -123,19 +140,25 @@ public:
    *  @note Packets are considered duplicate if the name with implicit digest matches.
    *  The new Data packet with the identical name, but a different payload
    *  will be placed in the in-memory storage.
+   *  The implicit digest is computed only when a packet with the same name is already stored.
    *
    *  @note It will invoke afterInsert(shared_ptr<InMemoryStorageEntry>).
+   *
+   *  @throw Error the packet exceeds the limit in bytes and not enough packets can be evicted
+   *         to make room for it; the storage is left with the packets not evicted
    */
   void
   insert(const Data& data);
 
   /** @brief Finds the best match Data for an Interest
    *
-   *  @note It will invoke afterAccess(shared_ptr<InMemoryStorageEntry>).
-   *  As currently it is impossible to determine whether a Name contains implicit digest or not,
-   *  therefore this find function is not able to locate a packet according to an interest(
-   *  including implicit digest) whose name is not the full name of the data matching the
-   *  implicit digest.
+   *  If the Interest has MustBeFresh, packets whose FreshnessPeriod has elapsed since their
+   *  insertion are skipped.
+   *  If no packet in memory matches, the overflow storage is searched, and a packet found
+   *  there is moved back to memory.
+   *
+   *  @note It will invoke afterAccess(shared_ptr<InMemoryStorageEntry>), except when
+   *  the Interest name ends with an implicit digest matching a stored packet.
    *
    *  @return{ the best match, if any; otherwise a null shared_ptr }
    */
@@ -146,8 +169,10 @@ public:
    *  the implicit digest.
    *
    *  If packets with the same name but different digests exist
-   *  and the Name supplied is the one without implicit digest, a packet
-   *  will be arbitrarily chosen to return.
+   *  and the Name supplied is the one without implicit digest, the one
+   *  inserted first is returned.
+   *  If no packet in memory matches, the overflow storage is searched, and a packet found
+   *  there is moved back to memory.
    *
    *  @note It will invoke afterAccess(shared_ptr<InMemoryStorageEntry>).
    *
@@ -164,10 +189,30 @@ public:
    *  @note Please do not use this function directly in any derived class to erase
    *  entry in the cache, use eraseHelper instead.
    *  @note It will invoke beforeErase(shared_ptr<InMemoryStorageEntry>).
+   *  @note The packets are erased from the overflow storage as well.
    */
   void
   erase(const Name& prefix, const bool isPrefix = true);
 
+  /** @brief Sets the storage to which evicted packets are moved, null to drop them
+   *
+   *  Packets evicted by the replacement policy are appended to @p overflow, unless they are
+   *  stale.  It is searched only when no packet in memory matches a find, so that a packet in
+   *  memory may be returned even though a better match was moved to @p overflow.
+   *  Packets which fail to be written to @p overflow are dropped.
+   */
+  void
+  setOverflowStorage(const shared_ptr<DiskStorage>& overflow)
+  {
+    m_overflow = overflow;
+  }
+
+  const shared_ptr<DiskStorage>&
+  getOverflowStorage() const
+  {
+    return m_overflow;
+  }
+
   /** @return{ maximum number of packets that can be allowed to store in in-memory storage }
    */
   size_t
@@ -176,6 +221,15 @@ public:
     return m_limit;
   }
 
+  /** @return{ maximum number of bytes that can be accounted to the packets in in-memory
+   *  storage }
+   */
+  size_t
+  getLimitInBytes() const
+  {
+    return m_limitInBytes;
+  }
+
   /** @return{ number of packets stored in in-memory storage }
    */
   size_t
@@ -184,8 +238,25 @@ public:
     return m_nPackets;
   }
 
+  /** @return{ number of bytes accounted to the packets stored in in-memory storage }
+   *
+   *  Each packet accounts for its wire encoding, its decoded Data and Name, its entry and
+   *  the nodes holding it in the storage index and in the index of the replacement policy.
+   *  Entries in the memory pool are not accounted.
+   */
+  size_t
+  sizeInBytes() const
+  {
+    return m_nBytes;
+  }
+
+  /** @return{ number of bytes accounted to @p data once stored, see sizeInBytes() }
+   */
+  static size_t
+  getEntrySize(const Data& data);
+
   /** @brief Returns begin iterator of the in-memory storage ordering by
-   *  name with digest
+   *  name, then by insertion
    *
    *  @return{ const_iterator pointing to the beginning of the m_cache }
    */
@@ -193,7 +264,7 @@ public:
   begin() const;
 
   /** @brief Returns end iterator of the in-memory storage ordering by
-   *  name with digest
+   *  name, then by insertion
    *
    *  @return{ const_iterator pointing to the end of the m_cache }
    */
@@ -231,6 +302,18 @@ NDN_CXX_PUBLIC_WITH_TESTS_ELSE_PROTECTED:
   virtual bool
   evictItem() = 0;
 
+  /** @brief Removes the packet which became stale first, if any
+   *
+   *  When room is needed, it is called before evictItem(), so that stale packets are evicted
+   *  first.  Packets become stale once their FreshnessPeriod has elapsed since their insertion,
+   *  as found by a timing wheel advanced on each insertion.
+   *  It will invoke beforeErase(shared_ptr<InMemoryStorageEntry>).
+   *
+   *  @return{ whether a Data was removed }
+   */
+  virtual bool
+  evictStaleItem();
+
 NDN_CXX_PUBLIC_WITH_TESTS_ELSE_PROTECTED:
   /** @brief sets current capacity of in-memory storage (in packets)
    */
@@ -263,37 +346,98 @@ NDN_CXX_PUBLIC_WITH_TESTS_ELSE_PROTECTED:
   void
   eraseImpl(const Name& name);
 
+  /** @brief deletes @p entry from the in-memory storage
+   *
+   *  Unlike eraseImpl(const Name&), it does not need the implicit digest of the packet.
+   *  The packet is moved to the overflow storage, if any.
+   *  It won't invoke beforeErase(shared_ptr<Entry>).
+   */
+  void
+  eraseImpl(InMemoryStorageEntry* entry);
+
   /** @brief Prints contents of the in-memory storage
    */
   void
   printCache(std::ostream& os) const;
 
 NDN_CXX_PUBLIC_WITH_TESTS_ELSE_PRIVATE:
+  /** @brief Inserts a Data packet, which is fresh until @p freshUntil if not null, or for
+   *  its FreshnessPeriod otherwise
+   */
+  void
+  insertImpl(const Data& data, const time::steady_clock::TimePoint* freshUntil);
+
+  /** @brief Moves a packet found in the overflow storage back to memory
+   *  @return{ @p data }
+   */
+  shared_ptr<const Data>
+  promote(const shared_ptr<const Data>& data, const time::steady_clock::TimePoint& freshUntil);
+
   /** @brief free in-memory storage entries by an iterator pointing to that entry.
       @return An iterator pointing to the element that followed the last element erased.
    */
   Cache::iterator
   freeEntry(Cache::iterator it);
 
+  /** @brief Finds the entry whose full name is @p fullName
+   *  @return the entry, or the end of the index if @p fullName does not end with an implicit
+   *          digest or no entry matches it
+   */
+  Cache::index<byName>::type::iterator
+  findByFullName(const Name& fullName) const;
+
+  /** @return the position of @p entry in the index, or the end of the index
+   */
+  Cache::index<byName>::type::iterator
+  findEntry(const InMemoryStorageEntry* entry) const;
+
+  /** @brief Evicts a stale packet if any, otherwise one according to the replacement policy
+   *  @return{ whether a Data was removed }
+   */
+  bool
+  evictOne();
+
+  /** @brief Marks the packets which became stale at @p now as the first to evict
+   */
+  void
+  expireStaleItems(const time::steady_clock::TimePoint& now);
+
   /** @brief Implements child selector (leftmost, rightmost, undeclared).
-   *  Operates on the first layer of a skip list.
-   *
-   *  startingPoint must be less than Interest Name.
-   *  startingPoint can be equal to Interest Name only
-   *  when the item is in the begin() position.
    *
-   *  Iterates toward greater Names, terminates when application cache entry falls out of Interest
-   *  prefix. When childSelector = leftmost, returns first application cache entry that satisfies
-   *  other selectors. When childSelector = rightmost, it goes till the end, and returns application
-   *  cache entry that satisfies other selectors. Returned application cache entry is the leftmost
-   *  child of the rightmost child.
+   *  Packets under the Interest name are visited in canonical order, or child by child from the
+   *  right with a rightmost ChildSelector, in which case the leftmost matching packet of the
+   *  rightmost child having one is returned.  The bounds of a child, and of a range of children
+   *  excluded by the Interest, are found by a lookup in the index: packets are visited only in
+   *  the children which are not excluded, until a match is found.
+   *  If the Interest has MustBeFresh, entries which are not fresh at @p now are skipped.
    *  @return{ the best match, if any; otherwise 0 }
    */
   InMemoryStorageEntry*
-  selectChild(const Interest& interest,
-              Cache::index<byFullName>::type::iterator startingPoint) const;
+  selectChild(const Interest& interest, const time::steady_clock::TimePoint& now) const;
 
 private:
+  //multi_index_container of stale entries, in the order they became stale
+  class byStaleTime;
+  class byEntity;
+
+  typedef boost::multi_index_container<
+    InMemoryStorageEntry*,
+    boost::multi_index::indexed_by<
+
+      // by Entry itself
+      boost::multi_index::hashed_unique<
+        boost::multi_index::tag<byEntity>,
+        boost::multi_index::identity<InMemoryStorageEntry*>
+      >,
+
+      // by time the entry became stale
+      boost::multi_index::sequenced<
+        boost::multi_index::tag<byStaleTime>
+      >
+
+    >
+  > StaleIndex;
+
   Cache m_cache;
   /// user defined maximum capacity of the in-memory storage in packets
   size_t m_limit;
@@ -301,8 +445,18 @@ private:
   size_t m_capacity;
   /// current number of packets in in-memory storage
   size_t m_nPackets;
+  /// user defined maximum number of bytes accounted to the packets
+  size_t m_limitInBytes;
+  /// current number of bytes accounted to the packets
+  size_t m_nBytes;
   /// memory pool
   std::stack<InMemoryStorageEntry*> m_freeEntries;
+  /// entries which will become stale, by the time they do
+  InMemoryStorageEntry::FreshnessWheel m_freshnessWheel;
+  /// entries which became stale
+  StaleIndex m_staleEntries;
+  /// where evicted packets are moved, if any
+  shared_ptr<DiskStorage> m_overflow;
 };
 
 } // namespace util
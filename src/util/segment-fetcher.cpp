@@ -22,19 +22,111 @@
 #include "segment-fetcher.hpp"
 
 #include "../encoding/buffer-stream.hpp"
+#include "../security/validator.hpp"
+
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <unistd.h>
 
 namespace ndn {
 namespace util {
 
+SegmentSink::~SegmentSink()
+{
+}
+
+FdSegmentSink::FdSegmentSink(int fd, const FinishCallback& finishCallback)
+  : m_fd(fd)
+  , m_finishCallback(finishCallback)
+  , m_nBytes(0)
+{
+}
+
+void
+FdSegmentSink::write(const uint8_t* data, size_t size)
+{
+  while (size > 0) {
+    ssize_t nWritten = ::write(m_fd, data, size);
+    if (nWritten < 0) {
+      if (errno == EINTR)
+        continue;
+      throw Error(std::string("cannot write to file descriptor (") + std::strerror(errno) + ")");
+    }
+
+    data += nWritten;
+    size -= nWritten;
+    m_nBytes += nWritten;
+  }
+}
+
+void
+FdSegmentSink::finish()
+{
+  if (static_cast<bool>(m_finishCallback))
+    m_finishCallback();
+}
+
+/**
+ * @brief SegmentSink collecting the content in memory, for the fetch methods taking a
+ *        complete callback
+ */
+class BufferSegmentSink : public SegmentSink
+{
+public:
+  explicit
+  BufferSegmentSink(const SegmentFetcher::CompleteCallback& completeCallback)
+    : m_completeCallback(completeCallback)
+  {
+  }
+
+  virtual void
+  write(const uint8_t* data, size_t size)
+  {
+    m_buffer.write(reinterpret_cast<const char*>(data), size);
+  }
+
+  virtual void
+  finish()
+  {
+    m_completeCallback(m_buffer.buf());
+  }
+
+private:
+  SegmentFetcher::CompleteCallback m_completeCallback;
+  OBufferStream m_buffer;
+};
+
+SegmentFetcher::Options::Options()
+  : initCwnd(1.0)
+  , initSsthresh(std::numeric_limits<double>::max())
+  , aiStep(1.0)
+  , mdCoef(0.5)
+  , initRto(time::seconds(1))
+  , minRto(time::milliseconds(200))
+  , maxRto(time::seconds(60))
+  , maxRetries(3)
+{
+}
+
 SegmentFetcher::SegmentFetcher(Face& face,
                                const VerifySegment& verifySegment,
-                               const CompleteCallback& completeCallback,
+                               const shared_ptr<SegmentSink>& sink,
                                const ErrorCallback& errorCallback)
   : m_face(face)
   , m_verifySegment(verifySegment)
-  , m_completeCallback(completeCallback)
+  , m_sink(sink)
   , m_errorCallback(errorCallback)
-  , m_buffer(make_shared<OBufferStream>())
+  , m_validator(nullptr)
+  , m_isStopped(false)
+  , m_discovery()
+  , m_nextSegment(0)
+  , m_finalSegment(std::numeric_limits<uint64_t>::max())
+  , m_nextToAppend(0)
+  , m_cwnd(0)
+  , m_ssthresh(0)
+  , m_hasRttMeasurement(false)
 {
 }
 
@@ -47,11 +139,75 @@ SegmentFetcher::fetch(Face& face,
 {
   shared_ptr<SegmentFetcher> fetcher =
     shared_ptr<SegmentFetcher>(new SegmentFetcher(face, verifySegment,
-                                                  completeCallback, errorCallback));
+                                                  make_shared<BufferSegmentSink>(completeCallback),
+                                                  errorCallback));
 
   fetcher->fetchFirstSegment(baseInterest, fetcher);
 }
 
+void
+SegmentFetcher::fetch(Face& face,
+                      const Interest& baseInterest,
+                      const VerifySegment& verifySegment,
+                      const CompleteCallback& completeCallback,
+                      const ErrorCallback& errorCallback,
+                      const Options& options)
+{
+  shared_ptr<SegmentFetcher> fetcher =
+    shared_ptr<SegmentFetcher>(new SegmentFetcher(face, verifySegment,
+                                                  make_shared<BufferSegmentSink>(completeCallback),
+                                                  errorCallback));
+
+  fetcher->startPipeline(baseInterest, options, fetcher);
+}
+
+void
+SegmentFetcher::fetch(Face& face,
+                      const Interest& baseInterest,
+                      Validator& validator,
+                      const CompleteCallback& completeCallback,
+                      const ErrorCallback& errorCallback,
+                      const Options& options)
+{
+  shared_ptr<SegmentFetcher> fetcher =
+    shared_ptr<SegmentFetcher>(new SegmentFetcher(face, DontVerifySegment(),
+                                                  make_shared<BufferSegmentSink>(completeCallback),
+                                                  errorCallback));
+  fetcher->m_validator = &validator;
+
+  fetcher->startPipeline(baseInterest, options, fetcher);
+}
+
+void
+SegmentFetcher::fetch(Face& face,
+                      const Interest& baseInterest,
+                      const VerifySegment& verifySegment,
+                      const shared_ptr<SegmentSink>& sink,
+                      const ErrorCallback& errorCallback,
+                      const Options& options)
+{
+  shared_ptr<SegmentFetcher> fetcher =
+    shared_ptr<SegmentFetcher>(new SegmentFetcher(face, verifySegment, sink, errorCallback));
+
+  fetcher->startPipeline(baseInterest, options, fetcher);
+}
+
+void
+SegmentFetcher::fetch(Face& face,
+                      const Interest& baseInterest,
+                      Validator& validator,
+                      const shared_ptr<SegmentSink>& sink,
+                      const ErrorCallback& errorCallback,
+                      const Options& options)
+{
+  shared_ptr<SegmentFetcher> fetcher =
+    shared_ptr<SegmentFetcher>(new SegmentFetcher(face, DontVerifySegment(), sink,
+                                                  errorCallback));
+  fetcher->m_validator = &validator;
+
+  fetcher->startPipeline(baseInterest, options, fetcher);
+}
+
 void
 SegmentFetcher::fetchFirstSegment(const Interest& baseInterest,
                                   const shared_ptr<SegmentFetcher>& self)
@@ -96,18 +252,11 @@ SegmentFetcher::onSegmentReceived(const Interest& origInterest,
       fetchNextSegment(origInterest, data.getName(), 0, self);
     }
     else {
-      m_buffer->write(reinterpret_cast<const char*>(data.getContent().value()),
-                      data.getContent().value_size());
-
       const name::Component& finalBlockId = data.getMetaInfo().getFinalBlockId();
-      if (finalBlockId.empty() ||
-          finalBlockId.toSegment() > currentSegment)
-        {
-          fetchNextSegment(origInterest, data.getName(), currentSegment + 1, self);
-        }
-      else {
-        return m_completeCallback(m_buffer->buf());
-      }
+      bool isFinal = !finalBlockId.empty() && finalBlockId.toSegment() <= currentSegment;
+
+      if (append(data.getContent(), isFinal) && !isFinal)
+        fetchNextSegment(origInterest, data.getName(), currentSegment + 1, self);
     }
   }
   catch (const tlv::Error& e) {
@@ -115,5 +264,443 @@ SegmentFetcher::onSegmentReceived(const Interest& origInterest,
   }
 }
 
+bool
+SegmentFetcher::append(const Block& content, bool isFinal)
+{
+  try {
+    m_sink->write(content.value(), content.value_size());
+    if (isFinal)
+      m_sink->finish();
+  }
+  catch (const SegmentSink::Error& e) {
+    fail(SINK_FAIL, std::string("Error while writing content: ") + e.what());
+    return false;
+  }
+  return true;
+}
+
+void
+SegmentFetcher::startPipeline(const Interest& baseInterest, const Options& options,
+                              const shared_ptr<SegmentFetcher>& self)
+{
+  m_options = options;
+  m_baseInterest = baseInterest;
+  m_cwnd = std::max(options.initCwnd, 1.0);
+  m_ssthresh = options.initSsthresh;
+  m_rto = options.initRto;
+
+  sendDiscoveryInterest(0, self);
+}
+
+void
+SegmentFetcher::sendDiscoveryInterest(size_t nRetries, const shared_ptr<SegmentFetcher>& self)
+{
+  Interest interest(m_baseInterest);
+  interest.refreshNonce();
+  interest.setChildSelector(1);
+  interest.setMustBeFresh(true);
+  interest.setInterestLifetime(getInterestLifetime());
+
+  m_discovery.sendTime = time::steady_clock::now();
+  m_discovery.nRetries = nRetries;
+  m_discovery.id = m_face.expressInterest(interest,
+                                          bind(&SegmentFetcher::onDiscoveryData, this, _2, self),
+                                          bind(&SegmentFetcher::onDiscoveryTimeout, this, self));
+}
+
+void
+SegmentFetcher::sendSegmentInterests(const shared_ptr<SegmentFetcher>& self)
+{
+  size_t windowSize = static_cast<size_t>(std::floor(m_cwnd));
+
+  while (!m_isStopped && m_inFlight.size() < windowSize) {
+    if (!m_retxQueue.empty()) {
+      std::map<uint64_t, size_t>::iterator retx = m_retxQueue.begin();
+      uint64_t segmentNo = retx->first;
+      size_t nRetries = retx->second;
+      m_retxQueue.erase(retx);
+      sendSegmentInterest(segmentNo, nRetries, self);
+    }
+    else if (m_nextSegment <= m_finalSegment) {
+      uint64_t segmentNo = m_nextSegment++;
+      // the segment which answered the discovery Interest may be there already
+      if (segmentNo >= m_nextToAppend && m_reorderBuffer.count(segmentNo) == 0 &&
+          m_validating.count(segmentNo) == 0)
+        sendSegmentInterest(segmentNo, 0, self);
+    }
+    else {
+      break;
+    }
+  }
+}
+
+void
+SegmentFetcher::sendSegmentInterest(uint64_t segmentNo, size_t nRetries,
+                                    const shared_ptr<SegmentFetcher>& self)
+{
+  Interest interest(m_baseInterest); // to preserve any special selectors
+  interest.refreshNonce();
+  interest.setChildSelector(0);
+  interest.setMustBeFresh(false);
+  interest.setName(Name(m_versionedName).appendSegment(segmentNo));
+  interest.setInterestLifetime(getInterestLifetime());
+
+  InFlight& inFlight = m_inFlight[segmentNo];
+  inFlight.sendTime = time::steady_clock::now();
+  inFlight.nRetries = nRetries;
+  inFlight.id = m_face.expressInterest(interest,
+                                       bind(&SegmentFetcher::onSegmentData, this, _1, _2, self),
+                                       bind(&SegmentFetcher::onSegmentTimeout, this, _1, self));
+}
+
+time::milliseconds
+SegmentFetcher::getInterestLifetime() const
+{
+  time::milliseconds lifetime = m_baseInterest.getInterestLifetime();
+  if (lifetime < time::milliseconds::zero())
+    lifetime = DEFAULT_INTEREST_LIFETIME;
+
+  return std::min(lifetime, time::duration_cast<time::milliseconds>(m_rto));
+}
+
+void
+SegmentFetcher::onDiscoveryData(const Data& data, const shared_ptr<SegmentFetcher>& self)
+{
+  if (m_isStopped)
+    return;
+
+  onDataArrival(m_discovery.sendTime, m_discovery.nRetries > 0);
+  m_discovery.id = nullptr;
+
+  uint64_t segmentNo = 0;
+  try {
+    segmentNo = data.getName().get(-1).toSegment();
+  }
+  catch (const tlv::Error& e) {
+    return fail(DATA_HAS_NO_SEGMENT, std::string("Error while decoding segment: ") + e.what());
+  }
+
+  m_versionedName = data.getName().getPrefix(-1);
+  verifySegment(data, segmentNo, self);
+  sendSegmentInterests(self);
+}
+
+void
+SegmentFetcher::onDiscoveryTimeout(const shared_ptr<SegmentFetcher>& self)
+{
+  if (m_isStopped)
+    return;
+
+  m_discovery.id = nullptr;
+  if (m_discovery.nRetries >= m_options.maxRetries)
+    return fail(INTEREST_TIMEOUT, "Timeout");
+
+  onTimeout(m_discovery.sendTime);
+  sendDiscoveryInterest(m_discovery.nRetries + 1, self);
+}
+
+void
+SegmentFetcher::onSegmentData(const Interest& interest, const Data& data,
+                              const shared_ptr<SegmentFetcher>& self)
+{
+  if (m_isStopped)
+    return;
+
+  uint64_t segmentNo = interest.getName().get(-1).toSegment();
+  std::map<uint64_t, InFlight>::iterator inFlight = m_inFlight.find(segmentNo);
+  if (inFlight == m_inFlight.end())
+    return;
+
+  onDataArrival(inFlight->second.sendTime, inFlight->second.nRetries > 0);
+  m_inFlight.erase(inFlight);
+
+  verifySegment(data, segmentNo, self);
+  sendSegmentInterests(self);
+}
+
+void
+SegmentFetcher::onSegmentTimeout(const Interest& interest,
+                                  const shared_ptr<SegmentFetcher>& self)
+{
+  if (m_isStopped)
+    return;
+
+  uint64_t segmentNo = interest.getName().get(-1).toSegment();
+  std::map<uint64_t, InFlight>::iterator inFlight = m_inFlight.find(segmentNo);
+  if (inFlight == m_inFlight.end())
+    return;
+
+  size_t nRetries = inFlight->second.nRetries;
+  if (nRetries >= m_options.maxRetries)
+    return fail(INTEREST_TIMEOUT, "Timeout");
+
+  onTimeout(inFlight->second.sendTime);
+  m_inFlight.erase(inFlight);
+  m_retxQueue[segmentNo] = nRetries + 1;
+  sendSegmentInterests(self);
+}
+
+void
+SegmentFetcher::onDataArrival(const time::steady_clock::TimePoint& sendTime,
+                              bool isRetransmitted)
+{
+  if (m_cwnd < m_ssthresh)
+    m_cwnd += 1.0;
+  else
+    m_cwnd += m_options.aiStep / m_cwnd;
+
+  // an answer to a retransmitted Interest cannot be matched with the Interest that caused it
+  if (isRetransmitted)
+    return;
+
+  time::nanoseconds rtt = time::steady_clock::now() - sendTime;
+  if (!m_hasRttMeasurement) {
+    m_sRtt = rtt;
+    m_rttVar = rtt / 2;
+    m_hasRttMeasurement = true;
+  }
+  else {
+    time::nanoseconds error = m_sRtt > rtt ? m_sRtt - rtt : rtt - m_sRtt;
+    m_rttVar = (m_rttVar * 3 + error) / 4;
+    m_sRtt = (m_sRtt * 7 + rtt) / 8;
+  }
+
+  m_rto = m_sRtt + m_rttVar * 4;
+  m_rto = std::max<time::nanoseconds>(m_rto, m_options.minRto);
+  m_rto = std::min<time::nanoseconds>(m_rto, m_options.maxRto);
+}
+
+void
+SegmentFetcher::onTimeout(const time::steady_clock::TimePoint& sendTime)
+{
+  m_rto = std::min<time::nanoseconds>(m_rto * 2, m_options.maxRto);
+
+  // the Interests sent before the last decrease were sent with the window being decreased
+  if (sendTime < m_lastDecrease)
+    return;
+
+  m_ssthresh = std::max(m_cwnd * m_options.mdCoef, 2.0);
+  m_cwnd = std::max(m_ssthresh, 1.0);
+  m_lastDecrease = time::steady_clock::now();
+}
+
+void
+SegmentFetcher::verifySegment(const Data& data, uint64_t segmentNo,
+                              const shared_ptr<SegmentFetcher>& self)
+{
+  const name::Component& finalBlockId = data.getMetaInfo().getFinalBlockId();
+  if (!finalBlockId.empty()) {
+    try {
+      m_finalSegment = finalBlockId.toSegment();
+    }
+    catch (const tlv::Error& e) {
+      return fail(DATA_HAS_NO_SEGMENT, std::string("Error while decoding FinalBlockId: ") +
+                                       e.what());
+    }
+
+    // nothing to fetch beyond the last segment
+    for (std::map<uint64_t, InFlight>::iterator i = m_inFlight.upper_bound(m_finalSegment);
+         i != m_inFlight.end(); ) {
+      m_face.removePendingInterest(i->second.id);
+      i = m_inFlight.erase(i);
+    }
+    m_retxQueue.erase(m_retxQueue.upper_bound(m_finalSegment), m_retxQueue.end());
+  }
+
+  const Signature& signature = data.getSignature();
+  if (signature.getType() == tlv::DigestSha256 && signature.hasKeyLocator() &&
+      signature.getKeyLocator().getType() == KeyLocator::KeyLocator_Name)
+    return verifyWithManifest(data, segmentNo, signature.getKeyLocator().getName(), self);
+
+  if (m_validator == nullptr) {
+    if (!m_verifySegment(data))
+      return fail(SEGMENT_VERIFICATION_FAIL, "Segment validation fail");
+    return reassemble(segmentNo, data);
+  }
+
+  m_validating.insert(segmentNo);
+  m_validator->validate(data,
+                        bind(&SegmentFetcher::onSegmentValidated, this, segmentNo, _1, self),
+                        bind(&SegmentFetcher::onSegmentValidationFailed, this, _2));
+}
+
+void
+SegmentFetcher::onSegmentValidated(uint64_t segmentNo, const shared_ptr<const Data>& data,
+                                   const shared_ptr<SegmentFetcher>& self)
+{
+  if (m_isStopped)
+    return;
+
+  m_validating.erase(segmentNo);
+  reassemble(segmentNo, *data);
+}
+
+void
+SegmentFetcher::onSegmentValidationFailed(const std::string& reason)
+{
+  if (m_isStopped)
+    return;
+
+  fail(SEGMENT_VERIFICATION_FAIL, "Segment validation fail: " + reason);
+}
+
+void
+SegmentFetcher::verifyWithManifest(const Data& data, uint64_t segmentNo,
+                                   const Name& manifestName,
+                                   const shared_ptr<SegmentFetcher>& self)
+{
+  ManifestEntry& entry = m_manifests[manifestName];
+  if (entry.manifest != nullptr)
+    return checkWithManifest(segmentNo, data, *entry.manifest);
+
+  m_validating.insert(segmentNo);
+  entry.waiting[segmentNo] = make_shared<Data>(data);
+  if (entry.waiting.size() == 1 && entry.id == nullptr)
+    sendManifestInterest(manifestName, 0, self);
+}
+
+void
+SegmentFetcher::sendManifestInterest(const Name& manifestName, size_t nRetries,
+                                     const shared_ptr<SegmentFetcher>& self)
+{
+  Interest interest(manifestName);
+  interest.setInterestLifetime(getInterestLifetime());
+
+  ManifestEntry& entry = m_manifests[manifestName];
+  entry.nRetries = nRetries;
+  entry.id = m_face.expressInterest(interest,
+                                    bind(&SegmentFetcher::onManifestData, this,
+                                         manifestName, _2, self),
+                                    bind(&SegmentFetcher::onManifestTimeout, this,
+                                         manifestName, self));
+}
+
+void
+SegmentFetcher::onManifestData(const Name& manifestName, const Data& data,
+                               const shared_ptr<SegmentFetcher>& self)
+{
+  if (m_isStopped)
+    return;
+
+  m_manifests[manifestName].id = nullptr;
+
+  if (m_validator == nullptr) {
+    if (!m_verifySegment(data))
+      return fail(SEGMENT_VERIFICATION_FAIL, "Manifest validation fail");
+    return onManifestValidated(manifestName, make_shared<Data>(data), self);
+  }
+
+  m_validator->validate(data,
+                        bind(&SegmentFetcher::onManifestValidated, this, manifestName, _1, self),
+                        bind(&SegmentFetcher::onSegmentValidationFailed, this, _2));
+}
+
+void
+SegmentFetcher::onManifestTimeout(const Name& manifestName,
+                                  const shared_ptr<SegmentFetcher>& self)
+{
+  if (m_isStopped)
+    return;
+
+  ManifestEntry& entry = m_manifests[manifestName];
+  entry.id = nullptr;
+  if (entry.nRetries >= m_options.maxRetries)
+    return fail(INTEREST_TIMEOUT, "Timeout");
+
+  sendManifestInterest(manifestName, entry.nRetries + 1, self);
+}
+
+void
+SegmentFetcher::onManifestValidated(const Name& manifestName,
+                                    const shared_ptr<const Data>& data,
+                                    const shared_ptr<SegmentFetcher>& self)
+{
+  if (m_isStopped)
+    return;
+
+  ManifestEntry& entry = m_manifests[manifestName];
+  try {
+    entry.manifest = make_shared<Manifest>(data->getContent().blockFromValue());
+  }
+  catch (const tlv::Error& e) {
+    return fail(SEGMENT_VERIFICATION_FAIL, std::string("Error while decoding manifest: ") +
+                                           e.what());
+  }
+
+  // the entry is gone if fetching stops while the waiting segments are checked
+  shared_ptr<Manifest> manifest = entry.manifest;
+  std::map<uint64_t, shared_ptr<const Data> > waiting;
+  waiting.swap(entry.waiting);
+  for (std::map<uint64_t, shared_ptr<const Data> >::iterator i = waiting.begin();
+       i != waiting.end() && !m_isStopped; ++i) {
+    m_validating.erase(i->first);
+    checkWithManifest(i->first, *i->second, *manifest);
+  }
+  sendSegmentInterests(self);
+}
+
+void
+SegmentFetcher::checkWithManifest(uint64_t segmentNo, const Data& data,
+                                  const Manifest& manifest)
+{
+  if (!manifest.matches(segmentNo, data))
+    return fail(SEGMENT_VERIFICATION_FAIL, "Segment does not match its manifest");
+
+  reassemble(segmentNo, data);
+}
+
+void
+SegmentFetcher::reassemble(uint64_t segmentNo, const Data& data)
+{
+  if (segmentNo < m_nextToAppend || segmentNo > m_finalSegment)
+    return;
+
+  m_reorderBuffer.insert(std::make_pair(segmentNo, data.getContent()));
+
+  std::map<uint64_t, Block>::iterator next = m_reorderBuffer.begin();
+  while (next != m_reorderBuffer.end() && next->first == m_nextToAppend) {
+    Block content = next->second;
+    m_reorderBuffer.erase(next);
+    ++m_nextToAppend;
+
+    bool isFinal = m_nextToAppend > m_finalSegment;
+    if (isFinal)
+      stop();
+    if (!append(content, isFinal) || isFinal)
+      return;
+
+    next = m_reorderBuffer.begin();
+  }
+}
+
+void
+SegmentFetcher::fail(uint32_t code, const std::string& msg)
+{
+  stop();
+  m_errorCallback(code, msg);
+}
+
+void
+SegmentFetcher::stop()
+{
+  m_isStopped = true;
+
+  if (m_discovery.id != nullptr)
+    m_face.removePendingInterest(m_discovery.id);
+  m_discovery.id = nullptr;
+  for (std::map<uint64_t, InFlight>::iterator i = m_inFlight.begin(); i != m_inFlight.end(); ++i)
+    m_face.removePendingInterest(i->second.id);
+  for (std::map<Name, ManifestEntry>::iterator i = m_manifests.begin();
+       i != m_manifests.end(); ++i) {
+    if (i->second.id != nullptr)
+      m_face.removePendingInterest(i->second.id);
+  }
+
+  m_inFlight.clear();
+  m_manifests.clear();
+  m_retxQueue.clear();
+  m_reorderBuffer.clear();
+}
+
 } // util
 } // ndn
@@ -24,13 +24,94 @@
 
 #include "../common.hpp"
 #include "../face.hpp"
+#include "../security/manifest.hpp"
+
+#include <map>
+#include <set>
 
 namespace ndn {
 
-class OBufferStream;
+class Validator;
 
 namespace util {
 
+/**
+ * @brief Receiver of the content fetched by SegmentFetcher
+ *
+ * The content is written in order, as soon as it is contiguous, so that it does not need to
+ * be held in memory until the last segment arrives.
+ */
+class SegmentSink : noncopyable
+{
+public:
+  class Error : public std::runtime_error
+  {
+  public:
+    explicit
+    Error(const std::string& what)
+      : std::runtime_error(what)
+    {
+    }
+  };
+
+  virtual
+  ~SegmentSink();
+
+  /**
+   * @brief Receives the next @p size bytes of content
+   * @throws Error to abort fetching with SegmentFetcher::SINK_FAIL
+   */
+  virtual void
+  write(const uint8_t* data, size_t size) = 0;
+
+  /**
+   * @brief Called once all the content has been written
+   */
+  virtual void
+  finish() = 0;
+};
+
+/**
+ * @brief SegmentSink writing the content to a file descriptor, e.g., a file or a pipe
+ *
+ * The file descriptor is not closed by the sink.  Writes block until all the content is
+ * written, so a non-blocking descriptor must not be used.
+ */
+class FdSegmentSink : public SegmentSink
+{
+public:
+  typedef function<void ()> FinishCallback;
+
+  /**
+   * @param finishCallback called once all the content has been written, may be empty
+   */
+  explicit
+  FdSegmentSink(int fd, const FinishCallback& finishCallback = FinishCallback());
+
+  /**
+   * @throws Error if writing fails
+   */
+  virtual void
+  write(const uint8_t* data, size_t size);
+
+  virtual void
+  finish();
+
+  /**
+   * @return the number of bytes written so far
+   */
+  uint64_t
+  getNBytes() const
+  {
+    return m_nBytes;
+  }
+
+private:
+  int m_fd;
+  FinishCallback m_finishCallback;
+  uint64_t m_nBytes;
+};
+
 /**
  * @brief Functor to skip validation of individual packets by SegmentFetcher
  */
@@ -83,11 +164,39 @@ public:
  * - `DATA_HAS_NO_SEGMENT`: if any of the retrieved Data packets don't have segment
  *   as a last component of the name (not counting implicit digest)
  * - `SEGMENT_VERIFICATION_FAIL`: if any retrieved segment fails user-provided validation
+ * - `SINK_FAIL`: if the SegmentSink given to fetch fails to take the content
  *
  * In order to validate individual segments, an VerifySegment callback needs to be specified.
  * If the callback returns false, fetching process is aborted with SEGMENT_VERIFICATION_FAIL.
  * If data validation is not required, provided DontVerifySegment() functor can be used.
  *
+ * When fetch is given Options, the segments are fetched through a pipeline instead of one at
+ * a time:
+ *
+ * - Interests for the following segments are sent without waiting for the previous Data,
+ *   as many as the congestion window allows.  The window grows by one segment per received
+ *   Data in slow start, then by Options::aiStep per window, and is multiplied by
+ *   Options::mdCoef when an Interest times out, at most once per round trip.
+ * - The lifetime of each Interest is the retransmission timeout, computed from the measured
+ *   round-trip times as in RFC 6298 and bounded by the lifetime of the base Interest.
+ *   A timed out segment is requested again, up to Options::maxRetries times, before
+ *   fetching is aborted with INTEREST_TIMEOUT.
+ * - Segments arriving out of order are kept until the segments before them arrive.  The
+ *   segment received in response to the first Interest is kept whatever its number.
+ * - When fetch is given a Validator, the segments are validated asynchronously, so that the
+ *   validation of several segments can be in progress while fetching continues.
+ *
+ * When fetch is given a SegmentSink, the content is written to it as soon as it is
+ * contiguous, instead of being delivered at once to the complete callback.  Only the
+ * segments arriving out of order are then held in memory.
+ *
+ * In pipelined fetching, a segment with a DigestSha256 signature whose KeyLocator is a name
+ * is authenticated by the Manifest carried by the Data of that name (see
+ * KeyChain::signWithManifests).  Each manifest is fetched once and verified like a segment,
+ * by the VerifySegment callback or the Validator; the segments it lists are then only
+ * compared with their digests.  A segment not listed by its manifest, or a manifest that
+ * cannot be decoded, aborts fetching with SEGMENT_VERIFICATION_FAIL.
+ *
  * Examples:
  *
  *     void
@@ -122,7 +231,27 @@ public:
   enum ErrorCode {
     INTEREST_TIMEOUT = 1,
     DATA_HAS_NO_SEGMENT = 2,
-    SEGMENT_VERIFICATION_FAIL = 3
+    SEGMENT_VERIFICATION_FAIL = 3,
+    SINK_FAIL = 4
+  };
+
+  /**
+   * @brief Parameters of pipelined fetching
+   */
+  class Options
+  {
+  public:
+    Options();
+
+  public:
+    double initCwnd;        ///< initial congestion window, in segments
+    double initSsthresh;    ///< initial slow start threshold, in segments
+    double aiStep;          ///< additive increase of the window per window of received segments
+    double mdCoef;          ///< multiplicative decrease of the window on timeout
+    time::milliseconds initRto; ///< retransmission timeout before the first RTT measurement
+    time::milliseconds minRto;
+    time::milliseconds maxRto;
+    size_t maxRetries;      ///< number of times a segment is requested again after timeouts
   };
 
   /**
@@ -149,12 +278,77 @@ public:
         const CompleteCallback& completeCallback,
         const ErrorCallback& errorCallback);
 
+  /**
+   * @brief Initiate pipelined segment fetching
+   *
+   * Parameters are the same as above, @p options tuning the pipeline.
+   */
+  static
+  void
+  fetch(Face& face,
+        const Interest& baseInterest,
+        const VerifySegment& verifySegment,
+        const CompleteCallback& completeCallback,
+        const ErrorCallback& errorCallback,
+        const Options& options);
+
+  /**
+   * @brief Initiate pipelined segment fetching, validating segments with @p validator
+   *
+   * The validation of a segment does not hold back the fetching of the next ones.  If a
+   * segment fails validation, fetching is aborted with SEGMENT_VERIFICATION_FAIL.
+   *
+   * @note Make sure the lifetime of the validator is longer than the fetching.
+   */
+  static
+  void
+  fetch(Face& face,
+        const Interest& baseInterest,
+        Validator& validator,
+        const CompleteCallback& completeCallback,
+        const ErrorCallback& errorCallback,
+        const Options& options = Options());
+
+  /**
+   * @brief Initiate pipelined segment fetching, writing the content to @p sink as it arrives
+   *
+   * SegmentSink::finish is called instead of a complete callback.
+   */
+  static
+  void
+  fetch(Face& face,
+        const Interest& baseInterest,
+        const VerifySegment& verifySegment,
+        const shared_ptr<SegmentSink>& sink,
+        const ErrorCallback& errorCallback,
+        const Options& options = Options());
+
+  /**
+   * @brief Initiate pipelined segment fetching, validating segments with @p validator and
+   *        writing the content to @p sink as it arrives
+   */
+  static
+  void
+  fetch(Face& face,
+        const Interest& baseInterest,
+        Validator& validator,
+        const shared_ptr<SegmentSink>& sink,
+        const ErrorCallback& errorCallback,
+        const Options& options = Options());
+
 private:
   SegmentFetcher(Face& face,
                  const VerifySegment& verifySegment,
-                 const CompleteCallback& completeCallback,
+                 const shared_ptr<SegmentSink>& sink,
                  const ErrorCallback& errorCallback);
 
+  /**
+   * @brief Writes the content of a segment to the sink, and finishes it after the last one
+   * @return false if fetching failed
+   */
+  bool
+  append(const Block& content, bool isFinal);
+
   void
   fetchFirstSegment(const Interest& baseInterest, const shared_ptr<SegmentFetcher>& self);
 
@@ -167,13 +361,154 @@ private:
                     const Data& data, bool isSegmentZeroExpected,
                     const shared_ptr<SegmentFetcher>& self);
 
+private: // pipelined fetching
+  struct InFlight
+  {
+    const PendingInterestId* id;
+    time::steady_clock::TimePoint sendTime;
+    size_t nRetries;
+  };
+
+  void
+  startPipeline(const Interest& baseInterest, const Options& options,
+                const shared_ptr<SegmentFetcher>& self);
+
+  void
+  sendDiscoveryInterest(size_t nRetries, const shared_ptr<SegmentFetcher>& self);
+
+  void
+  sendSegmentInterests(const shared_ptr<SegmentFetcher>& self);
+
+  void
+  sendSegmentInterest(uint64_t segmentNo, size_t nRetries,
+                      const shared_ptr<SegmentFetcher>& self);
+
+  time::milliseconds
+  getInterestLifetime() const;
+
+  void
+  onDiscoveryData(const Data& data, const shared_ptr<SegmentFetcher>& self);
+
+  void
+  onDiscoveryTimeout(const shared_ptr<SegmentFetcher>& self);
+
+  void
+  onSegmentData(const Interest& interest, const Data& data,
+                const shared_ptr<SegmentFetcher>& self);
+
+  void
+  onSegmentTimeout(const Interest& interest, const shared_ptr<SegmentFetcher>& self);
+
+  /**
+   * @brief Updates the window and the retransmission timeout for a Data answering an Interest
+   *        sent at @p sendTime, only measuring the RTT if the Interest was not retransmitted
+   */
+  void
+  onDataArrival(const time::steady_clock::TimePoint& sendTime, bool isRetransmitted);
+
+  /**
+   * @brief Backs off the retransmission timeout and shrinks the window, once per round trip
+   */
+  void
+  onTimeout(const time::steady_clock::TimePoint& sendTime);
+
+  void
+  verifySegment(const Data& data, uint64_t segmentNo, const shared_ptr<SegmentFetcher>& self);
+
+  void
+  onSegmentValidated(uint64_t segmentNo, const shared_ptr<const Data>& data,
+                     const shared_ptr<SegmentFetcher>& self);
+
+  void
+  onSegmentValidationFailed(const std::string& reason);
+
+  /**
+   * @brief Authenticates @p data with the manifest named @p manifestName, once it is fetched
+   *        and verified
+   */
+  void
+  verifyWithManifest(const Data& data, uint64_t segmentNo, const Name& manifestName,
+                     const shared_ptr<SegmentFetcher>& self);
+
+  void
+  sendManifestInterest(const Name& manifestName, size_t nRetries,
+                       const shared_ptr<SegmentFetcher>& self);
+
+  void
+  onManifestData(const Name& manifestName, const Data& data,
+                 const shared_ptr<SegmentFetcher>& self);
+
+  void
+  onManifestTimeout(const Name& manifestName, const shared_ptr<SegmentFetcher>& self);
+
+  void
+  onManifestValidated(const Name& manifestName, const shared_ptr<const Data>& data,
+                      const shared_ptr<SegmentFetcher>& self);
+
+  /**
+   * @brief Reassembles @p data if it is listed by @p manifest as segment @p segmentNo
+   */
+  void
+  checkWithManifest(uint64_t segmentNo, const Data& data, const Manifest& manifest);
+
+  /**
+   * @brief Appends the content of @p data once the segments before it are appended
+   */
+  void
+  reassemble(uint64_t segmentNo, const Data& data);
+
+  void
+  fail(uint32_t code, const std::string& msg);
+
+  /**
+   * @brief Cancels all pending Interests; callbacks of validations in progress are ignored
+   */
+  void
+  stop();
+
 private:
   Face& m_face;
   VerifySegment m_verifySegment;
-  CompleteCallback m_completeCallback;
+  shared_ptr<SegmentSink> m_sink;
   ErrorCallback m_errorCallback;
 
-  shared_ptr<OBufferStream> m_buffer;
+  Options m_options;
+  Validator* m_validator;
+  Interest m_baseInterest;
+  Name m_versionedName;
+  bool m_isStopped;
+
+  struct ManifestEntry
+  {
+    ManifestEntry()
+      : id(nullptr)
+      , nRetries(0)
+    {
+    }
+
+    shared_ptr<Manifest> manifest; ///< null until the manifest is verified
+    std::map<uint64_t, shared_ptr<const Data> > waiting; ///< segments waiting for it
+    const PendingInterestId* id;
+    size_t nRetries;
+  };
+
+  InFlight m_discovery;
+  std::map<uint64_t, InFlight> m_inFlight;
+  std::map<uint64_t, size_t> m_retxQueue; ///< segments to request again, with their retries
+  std::set<uint64_t> m_validating;
+  std::map<uint64_t, Block> m_reorderBuffer; ///< contents waiting for the previous segments
+  std::map<Name, ManifestEntry> m_manifests;
+  uint64_t m_nextSegment;   ///< lowest segment never requested
+  uint64_t m_finalSegment;  ///< last segment, or the largest number until FinalBlockId is known
+  uint64_t m_nextToAppend;
+
+  double m_cwnd;
+  double m_ssthresh;
+  bool m_hasRttMeasurement;
+  time::nanoseconds m_sRtt;
+  time::nanoseconds m_rttVar;
+  time::nanoseconds m_rto;
+  time::steady_clock::TimePoint m_lastDecrease;
 };
 
 } // util
@@ -0,0 +1,134 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2015 Regents of the University of Tokyo.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+
+#ifndef NDN_TESTS_SECURITY_IBAS_PARAMS_FIXTURE_HPP
+#define NDN_TESTS_SECURITY_IBAS_PARAMS_FIXTURE_HPP
+
+#include "util/ibas-hash.hpp"
+#include "util/random.hpp"
+
+#include <boost/filesystem.hpp>
+#include <boost/lexical_cast.hpp>
+#include "boost-test.hpp"
+
+namespace ndn {
+
+/**
+ * @brief Generates Type A params, a PKG key and the private params of two identities with PBC
+ */
+class IbasParamsFixture
+{
+public:
+  IbasParamsFixture()
+    : isPairingInitialized(false)
+  {
+    boost::system::error_code error;
+    tmpPath = boost::filesystem::temp_directory_path(error);
+    BOOST_REQUIRE(boost::system::errc::success == error.value());
+    tmpPath /= boost::lexical_cast<std::string>(random::generateWord32());
+    boost::filesystem::create_directories(tmpPath);
+
+    paramsPath = (tmpPath / "params.conf").string();
+    alicePath = (tmpPath / "Alice.id").string();
+    bobPath = (tmpPath / "Bob.id").string();
+
+    generateParams(160, 512);
+  }
+
+  ~IbasParamsFixture()
+  {
+    if (isPairingInitialized)
+      pairing_clear(pairing);
+    boost::filesystem::remove_all(tmpPath);
+  }
+
+  /**
+   * @brief Replaces the params with new ones, for a group order of @p rBits bits and a field
+   *        order of @p qBits bits
+   */
+  void
+  generateParams(int rBits, int qBits)
+  {
+    if (isPairingInitialized)
+      pairing_clear(pairing);
+
+    pbc_param_t param;
+    pbc_param_init_a_gen(param, rBits, qBits);
+    pairing_init_pbc_param(pairing, param);
+    isPairingInitialized = true;
+
+    element_t s, p, q;
+    element_init_Zr(s, pairing);
+    element_init_G1(p, pairing);
+    element_init_G1(q, pairing);
+    element_random(s);
+    element_random(p);
+    element_mul_zn(q, p, s);
+
+    FILE* paramsFile = fopen(paramsPath.c_str(), "w");
+    pbc_param_out_str(paramsFile, param);
+    element_fprintf(paramsFile, "P %B\n", p);
+    element_fprintf(paramsFile, "Q %B\n", q);
+    fclose(paramsFile);
+
+    writePrivateParams(alicePath, "Alice", s);
+    writePrivateParams(bobPath, "Bob", s);
+
+    element_clear(s);
+    element_clear(p);
+    element_clear(q);
+    pbc_param_clear(param);
+  }
+
+  void
+  writePrivateParams(const std::string& path, const std::string& identity, element_t s)
+  {
+    element_t sP0, sP1;
+    element_init_G1(sP0, pairing);
+    element_init_G1(sP1, pairing);
+    util::calculateH1(sP0, identity + "0", pairing);
+    util::calculateH1(sP1, identity + "1", pairing);
+    element_mul_zn(sP0, sP0, s);
+    element_mul_zn(sP1, sP1, s);
+
+    FILE* file = fopen(path.c_str(), "w");
+    fprintf(file, "id %s\n", identity.c_str());
+    element_fprintf(file, "s_P_0 %B\n", sP0);
+    element_fprintf(file, "s_P_1 %B\n", sP1);
+    fclose(file);
+
+    element_clear(sP0);
+    element_clear(sP1);
+  }
+
+public:
+  boost::filesystem::path tmpPath;
+  std::string paramsPath;
+  std::string alicePath;
+  std::string bobPath;
+  pairing_t pairing;
+  bool isPairingInitialized;
+};
+
+} // namespace ndn
+
+#endif // NDN_TESTS_SECURITY_IBAS_PARAMS_FIXTURE_HPP
@@ -23,6 +23,7 @@
 #include "security/key-chain.hpp"
 #include "identity-management-fixture.hpp"
 #include "boost-test.hpp"
+#include "ibas-params-fixture.hpp"
 
 namespace ndn {
 
@@ -523,6 +524,112 @@ BOOST_AUTO_TEST_CASE(FixedSignerCheckerTest1)
   BOOST_CHECK_EQUAL(result, 1);
 }
 
+BOOST_AUTO_TEST_CASE(IbasCheckerTest1)
+{
+  using security::conf::IbasChecker;
+
+  Name identity("/SecurityTestConfChecker/IbasCheckerTest1");
+  BOOST_REQUIRE(addIdentity(identity, RsaKeyParams()));
+
+  Name packetName("/Test/Data");
+  const std::string fromMallory = "From: Mallory\nMessage\n";
+  const std::string noFrom = "Message\n";
+
+  shared_ptr<Data> data1 = make_shared<Data>(packetName);
+  m_keyChain.signByIdentity(*data1, identity);
+
+  shared_ptr<Data> data2 = make_shared<Data>(packetName);
+  data2->setContent(reinterpret_cast<const uint8_t*>(fromMallory.c_str()), fromMallory.size());
+  data2->setSignature(SignatureSha256Ibas());
+
+  shared_ptr<Data> data3 = make_shared<Data>(packetName);
+  data3->setContent(reinterpret_cast<const uint8_t*>(noFrom.c_str()), noFrom.size());
+  data3->setSignature(SignatureSha256Ibas());
+
+  std::vector<std::string> signers;
+  BOOST_CHECK_THROW(IbasChecker{signers}, security::conf::Error);
+
+  signers.push_back("Alice");
+  signers.push_back("GovernmentOffice");
+  IbasChecker checker(signers);
+
+  int8_t result = 0;
+
+  result = checker.check(*data1,
+                         bind(dataCheckedFalse, _1),
+                         bind(dataCheckFailedFalse, _1, _2));
+  BOOST_CHECK_EQUAL(result, -1);
+
+  result = checker.check(*data2,
+                         bind(dataCheckedFalse, _1),
+                         bind(dataCheckFailedFalse, _1, _2));
+  BOOST_CHECK_EQUAL(result, -1);
+
+  result = checker.check(*data3,
+                         bind(dataCheckedFalse, _1),
+                         bind(dataCheckFailedFalse, _1, _2));
+  BOOST_CHECK_EQUAL(result, -1);
+
+  shared_ptr<Interest> interest = make_shared<Interest>(packetName);
+  m_keyChain.signByIdentity(*interest, identity);
+
+  result = checker.check(*interest,
+                         bind(interestCheckedFalse, _1),
+                         bind(interestCheckFailedFalse, _1, _2));
+  BOOST_CHECK_EQUAL(result, -1);
+}
+
+static shared_ptr<Data>
+makeIbasData(const std::string& content, IbasSigner& signer)
+{
+  shared_ptr<Data> data = make_shared<Data>("/Test/Data");
+  data->setContent(reinterpret_cast<const uint8_t*>(content.c_str()), content.size());
+  data->setSignature(SignatureSha256Ibas());
+
+  EncodingBuffer encoder;
+  data->wireEncode(encoder, true);
+  data->wireEncode(encoder, signer.sign(encoder.buf(), encoder.size()));
+  return data;
+}
+
+BOOST_FIXTURE_TEST_CASE(IbasCheckerTest2, IbasParamsFixture)
+{
+  using security::conf::IbasChecker;
+
+  IbasSigner alice("pbc", paramsPath);
+  alice.setPrivateParams(alicePath);
+  IbasSigner bob("pbc", paramsPath);
+  bob.setPrivateParams(bobPath);
+
+  shared_ptr<Data> data1 = makeIbasData("From: Alice\nMessage\n", alice);
+  shared_ptr<Data> data2 = makeIbasData("From: Bob\nMessage\n", bob);
+  shared_ptr<Data> data3 = makeIbasData("From: Alice\nMessage\n", bob);
+
+  std::vector<std::string> signers;
+  signers.push_back("Alice");
+  signers.push_back("GovernmentOffice");
+  IbasChecker checker(signers, make_shared<IbasSigner>("pbc", paramsPath));
+
+  int8_t result = 0;
+
+  result = checker.check(*data1,
+                         bind(dataChecked, _1),
+                         bind(dataCheckFailed, _1, _2));
+  BOOST_CHECK_EQUAL(result, 1);
+
+  // signer not in the list
+  result = checker.check(*data2,
+                         bind(dataCheckedFalse, _1),
+                         bind(dataCheckFailedFalse, _1, _2));
+  BOOST_CHECK_EQUAL(result, -1);
+
+  // signed by another identity than the one in the content
+  result = checker.check(*data3,
+                         bind(dataCheckedFalse, _1),
+                         bind(dataCheckFailedFalse, _1, _2));
+  BOOST_CHECK_EQUAL(result, -1);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 } // namespace ndn
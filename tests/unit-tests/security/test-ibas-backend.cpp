@@ -0,0 +1,302 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2015 Regents of the University of Tokyo.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "security/ibas-backend-pbc.hpp"
+#include "security/ibas-backend-type-a.hpp"
+#include "util/ibas-hash.hpp"
+
+#include <boost/lexical_cast.hpp>
+#include "boost-test.hpp"
+#include "ibas-params-fixture.hpp"
+
+#include <fstream>
+
+namespace ndn {
+
+BOOST_FIXTURE_TEST_SUITE(SecurityTestIbasBackend, IbasParamsFixture)
+
+BOOST_AUTO_TEST_CASE(Create)
+{
+  BOOST_CHECK(dynamic_cast<IbasBackendPbc*>(IbasBackend::create("", paramsPath).get()));
+  BOOST_CHECK(dynamic_cast<IbasBackendPbc*>(IbasBackend::create("pbc", paramsPath).get()));
+  BOOST_CHECK(dynamic_cast<IbasBackendTypeA<8>*>(IbasBackend::create("type-a",
+                                                                     paramsPath).get()));
+  BOOST_CHECK_THROW(IbasBackend::create("unknown", paramsPath), IbasBackend::Error);
+
+  unique_ptr<IbasBackend> backend = IbasBackend::create("type-a", paramsPath);
+  BOOST_CHECK(!backend->canSign());
+  BOOST_CHECK_THROW(backend->setupUserParams("Alice"), IbasBackend::Error);
+}
+
+BOOST_AUTO_TEST_CASE(CreateErrors)
+{
+  std::ofstream(paramsPath.c_str()) << "type a\n";
+  BOOST_CHECK_THROW(IbasBackend::create("type-a", paramsPath), IbasBackend::Error);
+
+  std::ofstream(paramsPath.c_str()) << "type a\nq 12x4\n";
+  BOOST_CHECK_THROW(IbasBackend::create("type-a", paramsPath), IbasBackend::Error);
+
+  // 2^520
+  std::ofstream(paramsPath.c_str()) << "type a\nq "
+    "34323988300653048574909503995406966086347176500716527046972317295927715916988280"
+    "26061279820330727277488648155695740429018560993999858321906287014145557528576\n";
+  try {
+    IbasBackend::create("type-a", paramsPath);
+    BOOST_ERROR("q of more than 512 bits is accepted");
+  }
+  catch (const IbasBackend::Error& e) {
+    BOOST_CHECK_EQUAL(e.what(), std::string("Type A backend supports q of at most 512 bits"));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(LoadMalformedPrivateParams)
+{
+  std::string missingPath = (tmpPath / "Missing.id").string();
+  std::ofstream(missingPath.c_str()) << "id Mallory\n";
+  std::string garbagePath = (tmpPath / "Garbage.id").string();
+  std::ofstream(garbagePath.c_str()) << "id Mallory\ns_P_0 [1, 2]\ns_P_1 [3, 4]\n";
+  std::string malformedPath = (tmpPath / "Malformed.id").string();
+  std::ofstream(malformedPath.c_str()) << "id Mallory\ns_P_0 [1x, 2]\ns_P_1 [3, 4\n";
+
+  const std::string w = "w-malformed";
+  const std::string message = "message";
+  IbasBackend::MessageList messages;
+  messages.push_back(std::make_pair(message, std::string("Alice")));
+
+  const char* types[] = {"pbc", "type-a"};
+  for (const char* type : types) {
+    BOOST_TEST_MESSAGE(type);
+    unique_ptr<IbasBackend> backend = IbasBackend::create(type, paramsPath);
+    BOOST_CHECK_THROW(backend->loadPrivateParams((tmpPath / "None.id").string()),
+                      IbasBackend::Error);
+    BOOST_CHECK_THROW(backend->loadPrivateParams(missingPath), IbasBackend::Error);
+    BOOST_CHECK_THROW(backend->loadPrivateParams(garbagePath), IbasBackend::Error);
+    BOOST_CHECK_THROW(backend->loadPrivateParams(malformedPath), IbasBackend::Error);
+    BOOST_CHECK(!backend->canSign());
+
+    // the params loaded before are kept
+    backend->loadPrivateParams(alicePath);
+    BOOST_CHECK_THROW(backend->loadPrivateParams(garbagePath), IbasBackend::Error);
+    BOOST_REQUIRE(backend->canSign());
+    Buffer signature;
+    backend->sign(reinterpret_cast<const uint8_t*>(message.data()), message.size(), w,
+                  nullptr, 0, signature);
+    BOOST_CHECK(backend->verify(messages, w, signature.buf(), signature.size()));
+  }
+}
+
+template<size_t N>
+static void
+checkSignAndVerify(const std::string& paramsPath, const std::string& alicePath,
+                   const std::string& bobPath)
+{
+  const std::string w = "w-limbs";
+  const std::string first = "first message";
+  const std::string second = "second message";
+
+  unique_ptr<IbasBackend> alice = IbasBackend::create("type-a", paramsPath);
+  unique_ptr<IbasBackend> bob = IbasBackend::create("type-a", paramsPath);
+  unique_ptr<IbasBackend> pbc = IbasBackend::create("pbc", paramsPath);
+  BOOST_REQUIRE(dynamic_cast<IbasBackendTypeA<N>*>(alice.get()) != nullptr);
+  alice->loadPrivateParams(alicePath);
+  bob->loadPrivateParams(bobPath);
+
+  IbasBackend::MessageList messages;
+  messages.push_back(std::make_pair(first, std::string("Alice")));
+
+  Buffer signature;
+  alice->sign(reinterpret_cast<const uint8_t*>(first.data()), first.size(), w,
+              nullptr, 0, signature);
+  BOOST_CHECK(alice->verify(messages, w, signature.buf(), signature.size()));
+  BOOST_CHECK(pbc->verify(messages, w, signature.buf(), signature.size()));
+  BOOST_CHECK(!alice->verify(messages, w + "x", signature.buf(), signature.size()));
+
+  Buffer aggregated;
+  bob->sign(reinterpret_cast<const uint8_t*>(second.data()), second.size(), w,
+            signature.buf(), signature.size(), aggregated);
+  messages.push_back(std::make_pair(second, std::string("Bob")));
+  BOOST_CHECK(alice->verify(messages, w, aggregated.buf(), aggregated.size()));
+  BOOST_CHECK(pbc->verify(messages, w, aggregated.buf(), aggregated.size()));
+
+  messages.pop_back();
+  BOOST_CHECK(!alice->verify(messages, w, aggregated.buf(), aggregated.size()));
+}
+
+BOOST_AUTO_TEST_CASE(SignAndVerify4Limbs)
+{
+  generateParams(160, 240);
+  checkSignAndVerify<4>(paramsPath, alicePath, bobPath);
+}
+
+BOOST_AUTO_TEST_CASE(SignAndVerify6Limbs)
+{
+  generateParams(160, 360);
+  checkSignAndVerify<6>(paramsPath, alicePath, bobPath);
+}
+
+BOOST_AUTO_TEST_CASE(HashToPoint)
+{
+  IbasBackendTypeA<8> typeA(paramsPath);
+  const IbasBackendTypeA<8>::Curve& curve = typeA.getCurve();
+  BOOST_REQUIRE_EQUAL(curve.getCompressedLength(), 65U);
+
+  element_t expected;
+  element_init_G1(expected, pairing);
+  for (int i = 0; i < 32; i++) {
+    std::string str = "/ndn/ibas/" + boost::lexical_cast<std::string>(i);
+
+    util::calculateH1(expected, str, pairing);
+    std::vector<uint8_t> expectedBytes(element_length_in_bytes_compressed(expected));
+    element_to_bytes_compressed(&expectedBytes[0], expected);
+
+    std::vector<uint8_t> actualBytes(curve.getCompressedLength());
+    curve.toBytesCompressed(&actualBytes[0], typeA.calculateH1(str));
+
+    BOOST_CHECK_EQUAL_COLLECTIONS(actualBytes.begin(), actualBytes.end(),
+                                  expectedBytes.begin(), expectedBytes.end());
+  }
+  element_clear(expected);
+}
+
+BOOST_AUTO_TEST_CASE(HashToScalarAndMul)
+{
+  IbasBackendTypeA<8> typeA(paramsPath);
+  const IbasBackendTypeA<8>::Curve& curve = typeA.getCurve();
+
+  element_t c, point;
+  element_init_Zr(c, pairing);
+  element_init_G1(point, pairing);
+  for (int i = 0; i < 8; i++) {
+    std::string str = "message" + boost::lexical_cast<std::string>(i);
+
+    util::calculateH3(c, str, pairing);
+    std::vector<uint8_t> expectedScalar(element_length_in_bytes(c));
+    element_to_bytes(&expectedScalar[0], c);
+
+    std::vector<uint8_t> actualScalar(expectedScalar.size());
+    IbasBackendTypeA<8>::Integer scalar = typeA.calculateH3(str);
+    scalar.toBytes(&actualScalar[0], actualScalar.size());
+    BOOST_CHECK_EQUAL_COLLECTIONS(actualScalar.begin(), actualScalar.end(),
+                                  expectedScalar.begin(), expectedScalar.end());
+
+    util::calculateH1(point, str, pairing);
+    element_mul_zn(point, point, c);
+    std::vector<uint8_t> expectedBytes(element_length_in_bytes_compressed(point));
+    element_to_bytes_compressed(&expectedBytes[0], point);
+
+    std::vector<uint8_t> actualBytes(curve.getCompressedLength());
+    curve.toBytesCompressed(&actualBytes[0], curve.mul(typeA.calculateH1(str), scalar));
+    BOOST_CHECK_EQUAL_COLLECTIONS(actualBytes.begin(), actualBytes.end(),
+                                  expectedBytes.begin(), expectedBytes.end());
+  }
+  element_clear(c);
+  element_clear(point);
+}
+
+BOOST_AUTO_TEST_CASE(CrossVerify)
+{
+  const std::string w = "w-0123456789";
+  const std::string message = "Hello, world!";
+  const uint8_t* data = reinterpret_cast<const uint8_t*>(message.data());
+
+  IbasBackend::MessageList messages;
+  messages.push_back(std::make_pair(message, std::string("Alice")));
+
+  unique_ptr<IbasBackend> pbc = IbasBackend::create("pbc", paramsPath);
+  unique_ptr<IbasBackend> typeA = IbasBackend::create("type-a", paramsPath);
+  pbc->loadPrivateParams(alicePath);
+  typeA->loadPrivateParams(alicePath);
+
+  Buffer pbcSignature;
+  pbc->sign(data, message.size(), w, nullptr, 0, pbcSignature);
+  Buffer typeASignature;
+  typeA->sign(data, message.size(), w, nullptr, 0, typeASignature);
+  BOOST_CHECK_EQUAL(pbcSignature.size(), typeASignature.size());
+
+  BOOST_CHECK(pbc->verify(messages, w, pbcSignature.buf(), pbcSignature.size()));
+  BOOST_CHECK(typeA->verify(messages, w, pbcSignature.buf(), pbcSignature.size()));
+  BOOST_CHECK(pbc->verify(messages, w, typeASignature.buf(), typeASignature.size()));
+  BOOST_CHECK(typeA->verify(messages, w, typeASignature.buf(), typeASignature.size()));
+
+  // Tampered message, identity and w
+  IbasBackend::MessageList tampered;
+  tampered.push_back(std::make_pair(message + "!", std::string("Alice")));
+  BOOST_CHECK(!pbc->verify(tampered, w, typeASignature.buf(), typeASignature.size()));
+  BOOST_CHECK(!typeA->verify(tampered, w, pbcSignature.buf(), pbcSignature.size()));
+  tampered[0] = std::make_pair(message, std::string("Bob"));
+  BOOST_CHECK(!pbc->verify(tampered, w, typeASignature.buf(), typeASignature.size()));
+  BOOST_CHECK(!typeA->verify(tampered, w, pbcSignature.buf(), pbcSignature.size()));
+  BOOST_CHECK(!pbc->verify(messages, w + "x", typeASignature.buf(), typeASignature.size()));
+  BOOST_CHECK(!typeA->verify(messages, w + "x", pbcSignature.buf(), pbcSignature.size()));
+
+  // Malformed signature
+  BOOST_CHECK(!typeA->verify(messages, w, pbcSignature.buf(), pbcSignature.size() - 1));
+  BOOST_CHECK(!typeA->verify(IbasBackend::MessageList(), w,
+                             pbcSignature.buf(), pbcSignature.size()));
+}
+
+BOOST_AUTO_TEST_CASE(CrossAggregate)
+{
+  const std::string w = "w-aggregate";
+  const std::string first = "first message";
+  const std::string second = "second message";
+
+  IbasBackend::MessageList messages;
+  messages.push_back(std::make_pair(first, std::string("Alice")));
+  messages.push_back(std::make_pair(second, std::string("Bob")));
+
+  unique_ptr<IbasBackend> pbc = IbasBackend::create("pbc", paramsPath);
+  unique_ptr<IbasBackend> typeA = IbasBackend::create("type-a", paramsPath);
+  pbc->loadPrivateParams(alicePath);
+  typeA->loadPrivateParams(bobPath);
+
+  // Alice signs with PBC, Bob aggregates with the Type A backend, and vice versa
+  Buffer aliceSignature;
+  pbc->sign(reinterpret_cast<const uint8_t*>(first.data()), first.size(), w,
+            nullptr, 0, aliceSignature);
+  Buffer aggregated;
+  typeA->sign(reinterpret_cast<const uint8_t*>(second.data()), second.size(), w,
+              aliceSignature.buf(), aliceSignature.size(), aggregated);
+  BOOST_CHECK_EQUAL(aggregated.size(), aliceSignature.size());
+
+  BOOST_CHECK(pbc->verify(messages, w, aggregated.buf(), aggregated.size()));
+  BOOST_CHECK(typeA->verify(messages, w, aggregated.buf(), aggregated.size()));
+
+  IbasBackend::MessageList partial(messages.begin(), messages.begin() + 1);
+  BOOST_CHECK(!pbc->verify(partial, w, aggregated.buf(), aggregated.size()));
+  BOOST_CHECK(!typeA->verify(partial, w, aggregated.buf(), aggregated.size()));
+
+  pbc->loadPrivateParams(bobPath);
+  typeA->loadPrivateParams(alicePath);
+  aliceSignature.clear();
+  typeA->sign(reinterpret_cast<const uint8_t*>(first.data()), first.size(), w,
+              nullptr, 0, aliceSignature);
+  aggregated.clear();
+  pbc->sign(reinterpret_cast<const uint8_t*>(second.data()), second.size(), w,
+            aliceSignature.buf(), aliceSignature.size(), aggregated);
+
+  BOOST_CHECK(pbc->verify(messages, w, aggregated.buf(), aggregated.size()));
+  BOOST_CHECK(typeA->verify(messages, w, aggregated.buf(), aggregated.size()));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace ndn
@@ -0,0 +1,274 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2015 Regents of the University of Tokyo.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "security/ibas-daemon.hpp"
+#include "security/ibas-daemon-tlv.hpp"
+#include "security/ibas-backend-daemon.hpp"
+#include "encoding/block-helpers.hpp"
+#include "util/crypto.hpp"
+#include "util/random.hpp"
+
+#include <boost/filesystem.hpp>
+#include <boost/lexical_cast.hpp>
+#include "boost-test.hpp"
+
+#include <fstream>
+#include <thread>
+
+namespace ndn {
+
+/**
+ * @brief Backend whose signature is the XOR of SHA256(ID || m || w) of the aggregated messages
+ */
+class DummyIbasBackend : public IbasBackend
+{
+public:
+  explicit
+  DummyIbasBackend(size_t& nCreated)
+  {
+    ++nCreated;
+  }
+
+  virtual void
+  loadPrivateParams(const std::string& privateParamsFilePath)
+  {
+    std::ifstream infile(privateParamsFilePath);
+    std::string param;
+    infile >> param >> m_identity;
+  }
+
+  virtual bool
+  canSign() const
+  {
+    return !m_identity.empty();
+  }
+
+  virtual void
+  sign(const uint8_t* data, size_t dataLength, const std::string& w,
+       const uint8_t* previous, size_t previousLength, Buffer& signature)
+  {
+    ConstBufferPtr digest = calculate(std::string(data, data + dataLength), m_identity, w);
+    Buffer result(digest->begin(), digest->end());
+    if (previous != nullptr && previousLength == result.size()) {
+      for (size_t i = 0; i < result.size(); i++)
+        result[i] ^= previous[i];
+    }
+    signature.insert(signature.end(), result.begin(), result.end());
+  }
+
+  virtual bool
+  verify(const MessageList& messages, const std::string& w,
+         const uint8_t* signature, size_t signatureLength)
+  {
+    Buffer expected(crypto::SHA256_DIGEST_SIZE);
+    for (MessageList::const_iterator it = messages.begin(); it != messages.end(); ++it) {
+      ConstBufferPtr digest = calculate(it->first, it->second, w);
+      for (size_t i = 0; i < expected.size(); i++)
+        expected[i] ^= (*digest)[i];
+    }
+    return signatureLength == expected.size() &&
+           std::equal(expected.begin(), expected.end(), signature);
+  }
+
+private:
+  static ConstBufferPtr
+  calculate(const std::string& message, const std::string& identity, const std::string& w)
+  {
+    std::string str = identity + message + w;
+    return crypto::sha256(reinterpret_cast<const uint8_t*>(str.data()), str.size());
+  }
+
+private:
+  std::string m_identity;
+};
+
+class IbasDaemonFixture
+{
+public:
+  IbasDaemonFixture()
+    : nCreatedBackends(0)
+  {
+    boost::system::error_code error;
+    tmpPath = boost::filesystem::temp_directory_path(error);
+    BOOST_REQUIRE(boost::system::errc::success == error.value());
+    tmpPath /= boost::lexical_cast<std::string>(random::generateWord32());
+    boost::filesystem::create_directories(tmpPath);
+
+    socketPath = (tmpPath / "ibasd.sock").string();
+    alicePath = (tmpPath / "Alice.id").string();
+    bobPath = (tmpPath / "Bob.id").string();
+    std::ofstream(alicePath.c_str()) << "id Alice\n";
+    std::ofstream(bobPath.c_str()) << "id Bob\n";
+
+    startDaemon();
+  }
+
+  ~IbasDaemonFixture()
+  {
+    stopDaemon();
+    boost::filesystem::remove_all(tmpPath);
+  }
+
+  unique_ptr<IbasBackend>
+  createBackend()
+  {
+    return unique_ptr<IbasBackend>(new DummyIbasBackend(nCreatedBackends));
+  }
+
+  void
+  startDaemon()
+  {
+    daemon.reset(new IbasDaemon(ioService, socketPath,
+                                bind(&IbasDaemonFixture::createBackend, this)));
+    daemon->start();
+
+    ioService.reset();
+    work.reset(new boost::asio::io_service::work(ioService));
+    ioThread = std::thread([this] { ioService.run(); });
+  }
+
+  void
+  stopDaemon()
+  {
+    work.reset();
+    ioService.stop();
+    ioThread.join();
+    daemon.reset();
+  }
+
+public:
+  boost::filesystem::path tmpPath;
+  std::string socketPath;
+  std::string alicePath;
+  std::string bobPath;
+
+  size_t nCreatedBackends;
+  boost::asio::io_service ioService;
+  unique_ptr<boost::asio::io_service::work> work;
+  unique_ptr<IbasDaemon> daemon;
+  std::thread ioThread;
+};
+
+BOOST_FIXTURE_TEST_SUITE(SecurityTestIbasDaemon, IbasDaemonFixture)
+
+BOOST_AUTO_TEST_CASE(SignAndVerify)
+{
+  const std::string w = "w-daemon";
+  const std::string message = "Hello, world!";
+  const uint8_t* data = reinterpret_cast<const uint8_t*>(message.data());
+
+  IbasBackendDaemon client(socketPath);
+  BOOST_CHECK(!client.canSign());
+  Buffer signature;
+  BOOST_CHECK_THROW(client.sign(data, message.size(), w, nullptr, 0, signature),
+                    IbasBackend::Error);
+  BOOST_CHECK_THROW(client.loadPrivateParams((tmpPath / "Mallory.id").string()),
+                    IbasBackend::Error);
+  BOOST_CHECK(!client.canSign());
+
+  client.loadPrivateParams(alicePath);
+  BOOST_CHECK(client.canSign());
+  client.sign(data, message.size(), w, nullptr, 0, signature);
+  BOOST_CHECK_EQUAL(signature.size(), crypto::SHA256_DIGEST_SIZE);
+
+  IbasBackend::MessageList messages;
+  messages.push_back(std::make_pair(message, std::string("Alice")));
+  BOOST_CHECK(client.verify(messages, w, signature.buf(), signature.size()));
+  BOOST_CHECK(!client.verify(messages, w + "x", signature.buf(), signature.size()));
+
+  // Another application aggregates Bob's signature through the same daemon
+  IbasBackendDaemon client2(socketPath);
+  client2.loadPrivateParams(bobPath);
+  Buffer aggregated;
+  client2.sign(data, message.size(), w, signature.buf(), signature.size(), aggregated);
+
+  messages.push_back(std::make_pair(message, std::string("Bob")));
+  BOOST_CHECK(client2.verify(messages, w, aggregated.buf(), aggregated.size()));
+  BOOST_CHECK(client.verify(messages, w, aggregated.buf(), aggregated.size()));
+  BOOST_CHECK(!client.verify(messages, w, signature.buf(), signature.size()));
+
+  // One verifier and one backend per private params file, loaded once
+  client.loadPrivateParams(alicePath);
+  client.sign(data, message.size(), w, nullptr, 0, signature);
+  BOOST_CHECK_EQUAL(nCreatedBackends, 3);
+}
+
+BOOST_AUTO_TEST_CASE(Reconnect)
+{
+  const std::string message = "message";
+  const uint8_t* data = reinterpret_cast<const uint8_t*>(message.data());
+
+  IbasBackendDaemon client(socketPath);
+  client.loadPrivateParams(alicePath);
+  Buffer signature;
+  client.sign(data, message.size(), "w", nullptr, 0, signature);
+
+  stopDaemon();
+  BOOST_CHECK(!boost::filesystem::exists(socketPath));
+  signature.clear();
+  BOOST_CHECK_THROW(client.sign(data, message.size(), "w", nullptr, 0, signature),
+                    IbasBackend::Error);
+
+  startDaemon();
+  client.sign(data, message.size(), "w", nullptr, 0, signature);
+  BOOST_CHECK_EQUAL(signature.size(), crypto::SHA256_DIGEST_SIZE);
+}
+
+BOOST_AUTO_TEST_CASE(AlreadyRunning)
+{
+  IbasDaemon daemon2(ioService, socketPath, bind(&IbasDaemonFixture::createBackend, this));
+  BOOST_CHECK_THROW(daemon2.start(), IbasDaemon::Error);
+}
+
+BOOST_AUTO_TEST_CASE(BadRequest)
+{
+  Block response = daemon->processRequest(nonNegativeIntegerBlock(ibasd::tlv::W, 1));
+  response.parse();
+  BOOST_CHECK_EQUAL(readNonNegativeInteger(response.get(ibasd::tlv::StatusCode)),
+                    static_cast<uint64_t>(ibasd::STATUS_BAD_REQUEST));
+
+  Block request(ibasd::tlv::SignRequest);
+  request.encode();
+  response = daemon->processRequest(request);
+  response.parse();
+  BOOST_CHECK_EQUAL(readNonNegativeInteger(response.get(ibasd::tlv::StatusCode)),
+                    static_cast<uint64_t>(ibasd::STATUS_BAD_REQUEST));
+}
+
+BOOST_AUTO_TEST_CASE(OverlongPath)
+{
+  const std::string message = "message";
+  const uint8_t* data = reinterpret_cast<const uint8_t*>(message.data());
+
+  // stat() fails with ENAMETOOLONG; the request is answered and the daemon keeps serving
+  IbasBackendDaemon client(socketPath);
+  BOOST_CHECK_THROW(client.loadPrivateParams((tmpPath / std::string(5000, 'a')).string()),
+                    IbasBackend::Error);
+
+  client.loadPrivateParams(alicePath);
+  Buffer signature;
+  client.sign(data, message.size(), "w", nullptr, 0, signature);
+  BOOST_CHECK_EQUAL(signature.size(), crypto::SHA256_DIGEST_SIZE);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace ndn
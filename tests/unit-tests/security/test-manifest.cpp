@@ -0,0 +1,103 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2015 Regents of the University of Tokyo.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+
+#include "security/manifest.hpp"
+#include "security/key-chain.hpp"
+#include "security/validator.hpp"
+#include "encoding/tlv-security.hpp"
+#include "identity-management-fixture.hpp"
+#include "boost-test.hpp"
+
+namespace ndn {
+
+BOOST_FIXTURE_TEST_SUITE(SecurityTestManifest, security::IdentityManagementFixture)
+
+static shared_ptr<Data>
+makeSegment(uint64_t segmentNo)
+{
+  Name name = Name("/TestManifest/version0").appendSegment(segmentNo);
+  shared_ptr<Data> data = make_shared<Data>(name);
+  uint8_t content[] = {static_cast<uint8_t>(segmentNo)};
+  data->setContent(content, sizeof(content));
+  return data;
+}
+
+BOOST_AUTO_TEST_CASE(EncodeDecode)
+{
+  std::vector<shared_ptr<Data> > segments;
+  Manifest manifest(7);
+  for (uint64_t segmentNo = 7; segmentNo < 10; ++segmentNo) {
+    segments.push_back(makeSegment(segmentNo));
+    m_keyChain.signWithSha256(*segments.back());
+    manifest.addSegment(*segments.back());
+  }
+
+  Manifest decoded(manifest.wireEncode());
+  BOOST_CHECK_EQUAL(decoded.getFirstSegment(), 7);
+  BOOST_CHECK_EQUAL(decoded.size(), 3);
+  BOOST_CHECK(!decoded.covers(6));
+  BOOST_CHECK(decoded.covers(9));
+  BOOST_CHECK(!decoded.covers(10));
+
+  BOOST_CHECK(decoded.matches(8, *segments[1]));
+  BOOST_CHECK(!decoded.matches(9, *segments[1]));
+  BOOST_CHECK(!decoded.matches(10, *segments[1]));
+
+  BOOST_CHECK_THROW(Manifest(Block(tlv::Content)), Manifest::Error);
+  BOOST_CHECK_THROW(Manifest(Block(tlv::security::Manifest)), Manifest::Error);
+}
+
+BOOST_AUTO_TEST_CASE(SignWithManifests)
+{
+  std::vector<shared_ptr<Data> > segments;
+  for (uint64_t segmentNo = 0; segmentNo < 5; ++segmentNo)
+    segments.push_back(makeSegment(segmentNo));
+
+  std::vector<shared_ptr<Data> > manifests =
+    m_keyChain.signWithManifests(segments, 2, "/TestManifest/version0/_manifest");
+  BOOST_REQUIRE_EQUAL(manifests.size(), 3);
+
+  for (uint64_t segmentNo = 0; segmentNo < 5; ++segmentNo) {
+    const Data& segment = *segments[segmentNo];
+    const Data& manifestData = *manifests[segmentNo / 2];
+    BOOST_CHECK_EQUAL(manifestData.getName(),
+                      Name("/TestManifest/version0/_manifest").appendSegment(segmentNo / 2 * 2));
+    BOOST_CHECK_NE(manifestData.getSignature().getType(), tlv::DigestSha256);
+
+    DigestSha256 signature(segment.getSignature());
+    BOOST_CHECK(Validator::verifySignature(segment, signature));
+    BOOST_CHECK_EQUAL(signature.getKeyLocator().getName(), manifestData.getName());
+
+    Manifest manifest(manifestData.getContent().blockFromValue());
+    BOOST_CHECK(manifest.matches(segmentNo, segment));
+  }
+
+  BOOST_CHECK_EQUAL(Manifest(manifests[2]->getContent().blockFromValue()).size(), 1);
+
+  std::vector<shared_ptr<Data> > unsegmented(1, make_shared<Data>("/TestManifest/unsegmented"));
+  BOOST_CHECK_THROW(m_keyChain.signWithManifests(unsegmented, 2, "/TestManifest/_manifest"),
+                    KeyChain::Error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace ndn
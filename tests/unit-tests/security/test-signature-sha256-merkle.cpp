@@ -0,0 +1,141 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2015 Regents of the University of Tokyo.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+
+#include "security/signature-sha256-merkle.hpp"
+#include "security/key-chain.hpp"
+#include "security/validator.hpp"
+#include "encoding/block-helpers.hpp"
+#include "identity-management-fixture.hpp"
+#include "boost-test.hpp"
+
+namespace ndn {
+
+BOOST_FIXTURE_TEST_SUITE(SecurityTestSignatureSha256Merkle, security::IdentityManagementFixture)
+
+static std::vector<shared_ptr<Data> >
+makeBatch(const Name& prefix, size_t nPackets)
+{
+  std::vector<shared_ptr<Data> > packets;
+  for (size_t i = 0; i < nPackets; ++i) {
+    shared_ptr<Data> data = make_shared<Data>(Name(prefix).appendNumber(i));
+    uint8_t content[] = {static_cast<uint8_t>(i)};
+    data->setContent(content, sizeof(content));
+    packets.push_back(data);
+  }
+  return packets;
+}
+
+BOOST_AUTO_TEST_CASE(RsaBatch)
+{
+  Name identityName("/SecurityTestSignatureSha256Merkle/RsaBatch");
+  BOOST_REQUIRE(addIdentity(identityName));
+  Name certificateName = m_keyChain.getDefaultCertificateNameForIdentity(identityName);
+  shared_ptr<PublicKey> publicKey =
+    m_keyChain.getPublicKeyFromTpm(m_keyChain.getDefaultKeyNameForIdentity(identityName));
+
+  std::vector<shared_ptr<Data> > packets = makeBatch(identityName, 5);
+  m_keyChain.signBatch(packets, certificateName);
+
+  for (size_t i = 0; i < packets.size(); ++i) {
+    Data decoded(Block(packets[i]->wireEncode().wire(), packets[i]->wireEncode().size()));
+
+    SignatureSha256Merkle signature(decoded.getSignature());
+    BOOST_CHECK_EQUAL(signature.getKeyLocator().getName(), certificateName.getPrefix(-1));
+    BOOST_CHECK_EQUAL(signature.getRootSignatureType(), tlv::SignatureSha256WithRsa);
+    BOOST_CHECK_EQUAL(signature.getLeafIndex(), i);
+    BOOST_CHECK_EQUAL(signature.getNLeaves(), 5);
+
+    BOOST_CHECK(Validator::verifySignature(decoded, *publicKey));
+  }
+
+  // the signature of a packet does not fit another packet of the batch
+  Data moved(*packets[3]);
+  moved.setSignature(packets[1]->getSignature());
+  BOOST_CHECK(!Validator::verifySignature(moved, *publicKey));
+
+  // the root is verified already, but the tampered packet does not lead to it
+  Data tampered(*packets[2]);
+  uint8_t content[] = {42};
+  tampered.setContent(content, sizeof(content));
+  BOOST_CHECK(!Validator::verifySignature(tampered, *publicKey));
+}
+
+BOOST_AUTO_TEST_CASE(EcdsaBatch)
+{
+  Name identityName("/SecurityTestSignatureSha256Merkle/EcdsaBatch");
+  BOOST_REQUIRE(addIdentity(identityName, EcdsaKeyParams()));
+  shared_ptr<PublicKey> publicKey =
+    m_keyChain.getPublicKeyFromTpm(m_keyChain.getDefaultKeyNameForIdentity(identityName));
+
+  std::vector<shared_ptr<Data> > packets = makeBatch(identityName, 3);
+  m_keyChain.signBatch(packets, m_keyChain.getDefaultCertificateNameForIdentity(identityName));
+
+  for (size_t i = 0; i < packets.size(); ++i) {
+    SignatureSha256Merkle signature(packets[i]->getSignature());
+    BOOST_CHECK_EQUAL(signature.getRootSignatureType(), tlv::SignatureSha256WithEcdsa);
+    BOOST_CHECK(Validator::verifySignature(*packets[i], *publicKey));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(SinglePacket)
+{
+  Name identityName("/SecurityTestSignatureSha256Merkle/SinglePacket");
+  BOOST_REQUIRE(addIdentity(identityName));
+  shared_ptr<PublicKey> publicKey =
+    m_keyChain.getPublicKeyFromTpm(m_keyChain.getDefaultKeyNameForIdentity(identityName));
+
+  std::vector<shared_ptr<Data> > packets = makeBatch(identityName, 1);
+  m_keyChain.signBatch(packets, m_keyChain.getDefaultCertificateNameForIdentity(identityName));
+  BOOST_CHECK(Validator::verifySignature(*packets[0], *publicKey));
+
+  std::vector<shared_ptr<Data> > empty;
+  BOOST_CHECK_NO_THROW(m_keyChain.signBatch(empty));
+}
+
+BOOST_AUTO_TEST_CASE(MalformedProof)
+{
+  SignatureSha256Merkle signature(KeyLocator(Name("/test/key")));
+  BOOST_CHECK_EQUAL(signature.getType(), tlv::SignatureSha256Merkle);
+
+  Block emptyValue(tlv::SignatureValue);
+  emptyValue.encode();
+  signature.setValue(emptyValue);
+  BOOST_CHECK_THROW(SignatureSha256Merkle(static_cast<const Signature&>(signature)),
+                    SignatureSha256Merkle::Error);
+
+  // the proof holds one sibling, while a tree of 4 leaves needs two
+  uint8_t buf[] = {0};
+  std::vector<ConstBufferPtr> siblings(1, SignatureSha256Merkle::hashLeaf(buf, sizeof(buf)));
+  signature.setValue(SignatureSha256Merkle::encodeValue(tlv::SignatureSha256WithRsa,
+                                                        dataBlock(tlv::SignatureValue, buf,
+                                                                  sizeof(buf)),
+                                                        0, 4, siblings));
+  SignatureSha256Merkle decoded(static_cast<const Signature&>(signature));
+  BOOST_CHECK(!static_cast<bool>(decoded.computeRoot(buf, sizeof(buf))));
+
+  BOOST_CHECK_THROW(SignatureSha256WithRsa(static_cast<const Signature&>(signature)),
+                    Signature::Error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace ndn
@@ -23,11 +23,15 @@
 #include "util/scheduler.hpp"
 #include "security/key-chain.hpp"
 #include "util/dummy-client-face.hpp"
+#include "encoding/block-helpers.hpp"
 
 #include "boost-test.hpp"
 #include "unit-test-time-fixture.hpp"
 #include "test-make-interest-data.hpp"
 
+#include <atomic>
+#include <thread>
+
 namespace ndn {
 namespace tests {
 
@@ -100,6 +104,174 @@ BOOST_AUTO_TEST_CASE(ExpressInterestTimeout)
   BOOST_CHECK_EQUAL(face->sentDatas.size(), 0);
 }
 
+BOOST_AUTO_TEST_CASE(ExpressInterestTimeoutOrder)
+{
+  std::vector<Name> timeouts;
+  auto express = [&] (const Name& name, const time::milliseconds& lifetime) {
+    face->expressInterest(Interest(name, lifetime),
+                          bind([] {
+                              BOOST_FAIL("Unexpected data");
+                            }),
+                          [&timeouts] (const Interest& interest) {
+                            timeouts.push_back(interest.getName());
+                          });
+  };
+
+  express("/A", time::milliseconds(300));
+  express("/B", time::milliseconds(20));
+  express("/C", time::milliseconds(21));
+  face->processEvents(time::milliseconds(-1));
+
+  // Each Interest times out on its own deadline
+  advanceClocks(time::milliseconds(1), 19);
+  BOOST_CHECK_EQUAL(timeouts.size(), 0);
+
+  advanceClocks(time::milliseconds(1));
+  BOOST_REQUIRE_EQUAL(timeouts.size(), 1);
+  BOOST_CHECK_EQUAL(timeouts[0], Name("/B"));
+
+  advanceClocks(time::milliseconds(1));
+  BOOST_REQUIRE_EQUAL(timeouts.size(), 2);
+  BOOST_CHECK_EQUAL(timeouts[1], Name("/C"));
+
+  express("/D", time::milliseconds(5));
+  face->processEvents(time::milliseconds(-1));
+  advanceClocks(time::milliseconds(1), 5);
+  BOOST_REQUIRE_EQUAL(timeouts.size(), 3);
+  BOOST_CHECK_EQUAL(timeouts[2], Name("/D"));
+
+  advanceClocks(time::milliseconds(1), 272);
+  BOOST_CHECK_EQUAL(timeouts.size(), 3);
+  advanceClocks(time::milliseconds(1), 2);
+  BOOST_REQUIRE_EQUAL(timeouts.size(), 4);
+  BOOST_CHECK_EQUAL(timeouts[3], Name("/A"));
+  BOOST_CHECK_EQUAL(face->getNPendingInterests(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(AggregateInterests)
+{
+  size_t nData = 0;
+  size_t nTimeouts = 0;
+  auto express = [&] (const Interest& interest) {
+    return face->expressInterest(interest,
+                                 bind([&nData] { ++nData; }),
+                                 bind([&nTimeouts] { ++nTimeouts; }));
+  };
+
+  express(Interest("/Hello/World", time::milliseconds(50)));
+  express(Interest("/Hello/World", time::milliseconds(50)));
+  const PendingInterestId* removedId = express(Interest("/Hello/World", time::milliseconds(50)));
+  express(Interest("/Hello/World", time::milliseconds(50)).setMustBeFresh(true));
+  advanceClocks(time::milliseconds(10));
+
+  // Identical Interests are sent once
+  BOOST_CHECK_EQUAL(face->sentInterests.size(), 2);
+  BOOST_CHECK_EQUAL(face->getNPendingInterests(), 4);
+
+  face->removePendingInterest(removedId);
+  advanceClocks(time::milliseconds(10));
+
+  face->receive(*util::makeData("/Hello/World/!"));
+  advanceClocks(time::milliseconds(10));
+  BOOST_CHECK_EQUAL(nData, 3);
+  BOOST_CHECK_EQUAL(face->getNPendingInterests(), 0);
+
+  // An aggregated Interest is sent again when the sent one expires before it times out
+  face->sentInterests.clear();
+  express(Interest("/Hello/Moon", time::milliseconds(50)));
+  advanceClocks(time::milliseconds(10));
+  express(Interest("/Hello/Moon", time::milliseconds(100)));
+  advanceClocks(time::milliseconds(10));
+  BOOST_CHECK_EQUAL(face->sentInterests.size(), 1);
+
+  advanceClocks(time::milliseconds(10), 4);
+  BOOST_CHECK_EQUAL(nTimeouts, 1);
+  BOOST_REQUIRE_EQUAL(face->sentInterests.size(), 2);
+  BOOST_CHECK_EQUAL(face->sentInterests[1].getName(), Name("/Hello/Moon"));
+  BOOST_CHECK_NE(face->sentInterests[1].getNonce(), face->sentInterests[0].getNonce());
+
+  face->receive(*util::makeData("/Hello/Moon"));
+  advanceClocks(time::milliseconds(10));
+  BOOST_CHECK_EQUAL(nData, 4);
+  BOOST_CHECK_EQUAL(nTimeouts, 1);
+}
+
+BOOST_AUTO_TEST_CASE(ReceiveBatch)
+{
+  std::vector<std::string> calls;
+  face->expressInterest(Interest("/A", time::seconds(1)),
+                        [&] (const Interest&, const Data&) {
+                          // the Data later in the batch has already been matched
+                          BOOST_CHECK_EQUAL(face->getNPendingInterests(), 0);
+                          calls.push_back("A");
+                        });
+  face->expressInterest(Interest("/B", time::seconds(1)),
+                        bind([&calls] { calls.push_back("B"); }));
+  face->setInterestFilter("/I", bind([&calls] { calls.push_back("I"); }));
+  advanceClocks(time::milliseconds(10));
+
+  std::vector<Block> wires;
+  wires.push_back(util::makeData("/A/1")->wireEncode());
+  wires.push_back(Interest("/I/1").wireEncode());
+  wires.push_back(util::makeData("/C/1")->wireEncode());
+  wires.push_back(util::makeData("/B/1")->wireEncode());
+  face->receive(wires);
+
+  BOOST_REQUIRE_EQUAL(calls.size(), 3);
+  BOOST_CHECK_EQUAL(calls[0], "A");
+  BOOST_CHECK_EQUAL(calls[1], "I");
+  BOOST_CHECK_EQUAL(calls[2], "B");
+}
+
+BOOST_AUTO_TEST_CASE(ReceiveBatchMalformed)
+{
+  size_t nData = 0;
+  size_t nTimeouts = 0;
+  face->expressInterest(Interest("/A", time::seconds(1)),
+                        bind([&nData] { ++nData; }),
+                        bind([&nTimeouts] { ++nTimeouts; }));
+  advanceClocks(time::milliseconds(10));
+
+  // only the malformed packet is dropped
+  std::vector<Block> wires;
+  wires.push_back(util::makeData("/A/1")->wireEncode());
+  const uint8_t garbage[] = {0xFF, 0xFF};
+  wires.push_back(dataBlock(tlv::Data, garbage, sizeof(garbage)));
+  BOOST_CHECK_NO_THROW(face->receive(wires));
+
+  BOOST_CHECK_EQUAL(nData, 1);
+  BOOST_CHECK_EQUAL(face->getNPendingInterests(), 0);
+  advanceClocks(time::milliseconds(100), 20);
+  BOOST_CHECK_EQUAL(nTimeouts, 0);
+}
+
+BOOST_AUTO_TEST_CASE(ReceiveBatchThrowingCallback)
+{
+  std::vector<std::string> calls;
+  face->expressInterest(Interest("/A", time::seconds(1)),
+                        [&] (const Interest&, const Data&) {
+                          calls.push_back("A");
+                          throw std::runtime_error("onData error");
+                        });
+  face->expressInterest(Interest("/A/1", time::seconds(1)),
+                        bind([&calls] { calls.push_back("A/1"); }));
+  face->expressInterest(Interest("/B", time::seconds(1)),
+                        bind([&calls] { calls.push_back("B"); }));
+  advanceClocks(time::milliseconds(10));
+
+  // the pending Interests which left the PIT get their Data, then the exception is rethrown
+  std::vector<Block> wires;
+  wires.push_back(util::makeData("/A/1")->wireEncode());
+  wires.push_back(util::makeData("/B/1")->wireEncode());
+  BOOST_CHECK_THROW(face->receive(wires), std::runtime_error);
+
+  BOOST_REQUIRE_EQUAL(calls.size(), 3);
+  BOOST_CHECK_EQUAL(calls[0], "A");
+  BOOST_CHECK_EQUAL(calls[1], "A/1");
+  BOOST_CHECK_EQUAL(calls[2], "B");
+  BOOST_CHECK_EQUAL(face->getNPendingInterests(), 0);
+}
+
 BOOST_AUTO_TEST_CASE(RemovePendingInterest)
 {
   const PendingInterestId* interestId =
@@ -119,6 +291,68 @@ BOOST_AUTO_TEST_CASE(RemovePendingInterest)
   advanceClocks(time::milliseconds(10), 100);
 }
 
+BOOST_AUTO_TEST_CASE(SatisfyManyPendingInterests)
+{
+  shared_ptr<Data> data = util::makeData("/A/B");
+
+  std::map<std::string, size_t> nData;
+  std::map<std::string, const PendingInterestId*> ids;
+  auto express = [&] (const std::string& label, const Interest& interest) {
+    ids[label] = face->expressInterest(interest,
+                                       [&nData, label] (const Interest&, const Data&) {
+                                         ++nData[label];
+                                       },
+                                       bind([] {
+                                           BOOST_FAIL("Unexpected timeout");
+                                         }));
+  };
+
+  express("root", Interest("/", time::seconds(10)));
+  express("A", Interest("/A", time::seconds(10)));
+  express("A-min3", Interest("/A", time::seconds(10)).setMinSuffixComponents(3));
+  express("AB", Interest("/A/B", time::seconds(10)));
+  express("AB-2", Interest("/A/B", time::seconds(10)));
+  express("AB-digest", Interest(data->getFullName(), time::seconds(10)));
+  express("ABC", Interest("/A/B/C", time::seconds(10)));
+  express("AC", Interest("/A/C", time::seconds(10)));
+  for (int i = 0; i < 1000; ++i) {
+    express("segment", Interest(Name("/A/B/C").appendSegment(i), time::seconds(10)));
+  }
+  advanceClocks(time::milliseconds(10));
+  BOOST_CHECK_EQUAL(face->getNPendingInterests(), 1008);
+
+  face->receive(*data);
+  advanceClocks(time::milliseconds(10));
+
+  BOOST_CHECK_EQUAL(nData["root"], 1);
+  BOOST_CHECK_EQUAL(nData["A"], 1);
+  BOOST_CHECK_EQUAL(nData["A-min3"], 0);
+  BOOST_CHECK_EQUAL(nData["AB"], 1);
+  BOOST_CHECK_EQUAL(nData["AB-2"], 1);
+  BOOST_CHECK_EQUAL(nData["AB-digest"], 1);
+  BOOST_CHECK_EQUAL(nData["ABC"], 0);
+  BOOST_CHECK_EQUAL(nData["AC"], 0);
+  BOOST_CHECK_EQUAL(face->getNPendingInterests(), 1003);
+
+  face->removePendingInterest(ids["ABC"]);
+  face->removePendingInterest(ids["segment"]);
+  advanceClocks(time::milliseconds(10));
+  BOOST_CHECK_EQUAL(face->getNPendingInterests(), 1001);
+
+  face->receive(*util::makeData("/A/B/C/D"));
+  face->receive(*util::makeData(Name("/A/B/C").appendSegment(10)));
+  advanceClocks(time::milliseconds(10));
+
+  BOOST_CHECK_EQUAL(nData["ABC"], 0);
+  BOOST_CHECK_EQUAL(nData["A-min3"], 1);
+  BOOST_CHECK_EQUAL(nData["segment"], 1);
+  BOOST_CHECK_EQUAL(face->getNPendingInterests(), 999);
+
+  face->removePendingInterest(ids["A"]); // already satisfied
+  advanceClocks(time::milliseconds(10));
+  BOOST_CHECK_EQUAL(face->getNPendingInterests(), 999);
+}
+
 BOOST_AUTO_TEST_CASE(SetUnsetInterestFilter)
 {
   size_t nInterests = 0;
@@ -257,6 +491,54 @@ BOOST_AUTO_TEST_CASE(SimilarFilters)
   BOOST_CHECK_EQUAL(nInInterests3, 0);
 }
 
+BOOST_AUTO_TEST_CASE(ManyFilters)
+{
+  std::vector<std::string> dispatched;
+  auto setFilter = [&] (const InterestFilter& filter) {
+    std::ostringstream os;
+    os << filter;
+    std::string label = os.str();
+    return face->setInterestFilter(filter,
+                                   [&dispatched, label] (const InterestFilter&, const Interest&) {
+                                     dispatched.push_back(label);
+                                   },
+                                   RegisterPrefixSuccessCallback(),
+                                   bind([] {
+                                       BOOST_FAIL("Unexpected setInterestFilter failure");
+                                     }));
+  };
+
+  for (int i = 0; i < 100; ++i) {
+    setFilter(Name("/collection").appendNumber(i));
+  }
+  setFilter(InterestFilter("/Hello", "<World><>"));
+  setFilter("/Hello/World");
+  const RegisteredPrefixId* helloId = setFilter("/Hello");
+  setFilter(InterestFilter("/Hello", "<Moon>"));
+  setFilter("/Hello/World/!/?");
+  advanceClocks(time::milliseconds(10), 10);
+
+  // Matching filters are dispatched in the order they were set
+  face->receive(Interest("/Hello/World/!"));
+  BOOST_REQUIRE_EQUAL(dispatched.size(), 3);
+  BOOST_CHECK_EQUAL(dispatched[0], "/Hello?regex=<World><>");
+  BOOST_CHECK_EQUAL(dispatched[1], "/Hello/World");
+  BOOST_CHECK_EQUAL(dispatched[2], "/Hello");
+
+  dispatched.clear();
+  face->receive(Interest(Name("/collection").appendNumber(50).append("x")));
+  BOOST_REQUIRE_EQUAL(dispatched.size(), 1);
+  BOOST_CHECK_EQUAL(dispatched[0], Name("/collection").appendNumber(50).toUri());
+
+  face->unsetInterestFilter(helloId);
+  advanceClocks(time::milliseconds(10), 10);
+
+  dispatched.clear();
+  face->receive(Interest("/Hello/Moon"));
+  BOOST_REQUIRE_EQUAL(dispatched.size(), 1);
+  BOOST_CHECK_EQUAL(dispatched[0], "/Hello?regex=<Moon>");
+}
+
 BOOST_AUTO_TEST_CASE(SetRegexFilterError)
 {
   face->setInterestFilter(InterestFilter("/Hello/World", "<><b><c>?"),
@@ -362,6 +644,65 @@ BOOST_AUTO_TEST_CASE(ProcessEvents)
   BOOST_CHECK_EQUAL(nRegSuccesses, 1);
 }
 
+BOOST_AUTO_TEST_CASE(SubmitFromThreads)
+{
+  size_t nData = 0;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.push_back(std::thread([this, t, &nData] {
+      for (int i = 0; i < 250; ++i) {
+        Name name = Name("/Hello").appendNumber(t).appendNumber(i);
+        face->expressInterest(Interest(name, time::seconds(10)),
+                              bind([&nData] { ++nData; }));
+        face->put(*util::makeData(Name(name).append("!")));
+      }
+    }));
+  }
+  for (std::vector<std::thread>::iterator i = threads.begin(); i != threads.end(); ++i)
+    i->join();
+
+  advanceClocks(time::milliseconds(10));
+  BOOST_REQUIRE_EQUAL(face->sentInterests.size(), 1000);
+  BOOST_CHECK_EQUAL(face->sentDatas.size(), 1000);
+  BOOST_CHECK_EQUAL(face->getNPendingInterests(), 1000);
+
+  // the operations submitted by each thread are performed in order
+  std::vector<uint64_t> next(4, 0);
+  for (size_t i = 0; i < face->sentInterests.size(); ++i) {
+    const Name& name = face->sentInterests[i].getName();
+    uint64_t t = name.get(1).toNumber();
+    BOOST_CHECK_EQUAL(name.get(2).toNumber(), next[t]++);
+  }
+
+  for (size_t i = 0; i < face->sentDatas.size(); ++i) {
+    face->receive(face->sentDatas[i]);
+  }
+  advanceClocks(time::milliseconds(10));
+  BOOST_CHECK_EQUAL(nData, 1000);
+  BOOST_CHECK_EQUAL(face->getNPendingInterests(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(ProcessEventsOnThreads)
+{
+  // handlers run concurrently on the pool and submit to the Face, whose own handlers
+  // run one at a time
+  std::atomic<size_t> nHandlers(0);
+  for (int i = 0; i < 1000; ++i) {
+    io.post([this, i, &nHandlers] {
+      ++nHandlers;
+      face->put(*util::makeData(Name("/A").appendNumber(i)));
+    });
+  }
+
+  face->processEvents(time::milliseconds::zero(), false, 4);
+  BOOST_CHECK_EQUAL(nHandlers, 1000);
+  BOOST_CHECK_EQUAL(face->sentDatas.size(), 1000);
+
+  io.post([] { throw std::runtime_error("handler error"); });
+  BOOST_CHECK_THROW(face->processEvents(time::milliseconds::zero(), false, 4),
+                    std::runtime_error);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 } // tests
@@ -0,0 +1,246 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2015 Regents of the University of Tokyo.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "transport/shm-transport.hpp"
+
+#ifdef NDN_CXX_HAVE_EVENTFD
+
+#include "transport/shm-loopback-peer.hpp"
+#include "encoding/block-helpers.hpp"
+#include "encoding/encoding-buffer.hpp"
+#include "encoding/tlv-nfd.hpp"
+#include "util/random.hpp"
+#include "transport-fixture.hpp"
+
+#include <boost/filesystem.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include "boost-test.hpp"
+
+namespace ndn {
+
+class ShmTransportFixture : public TransportFixture
+{
+public:
+  explicit
+  ShmTransportFixture(size_t capacity = SHM_CHANNEL_DEFAULT_CAPACITY)
+    : socketPath((boost::filesystem::temp_directory_path() /
+                  boost::lexical_cast<std::string>(random::generateWord32())).string())
+    , peer(io, socketPath)
+    , transport(make_shared<ShmTransport>(socketPath, capacity))
+    , nBatches(0)
+  {
+    transport->setReceiveBatchCallback(bind(&ShmTransportFixture::onReceive, this, _1));
+    transport->connect(io, [] (const Block&) { BOOST_FAIL("packets are received as batches"); });
+  }
+
+  ~ShmTransportFixture()
+  {
+    if (transport->isConnected())
+      transport->close();
+  }
+
+  void
+  onReceive(const std::vector<Block>& wires)
+  {
+    ++nBatches;
+    received.insert(received.end(), wires.begin(), wires.end());
+  }
+
+  static Block
+  makePacket(size_t valueSize, uint8_t fill)
+  {
+    std::vector<uint8_t> value(valueSize, fill);
+    return dataBlock(tlv::Content, value.data(), value.size());
+  }
+
+  /**
+   * @brief Polls the io_service until @p nPackets have been received or one second passes
+   */
+  void
+  receive(size_t nPackets)
+  {
+    for (int i = 0; i < 1000 && received.size() < nPackets; ++i) {
+      io.poll();
+      io.reset();
+      if (received.size() < nPackets)
+        usleep(1000);
+    }
+  }
+
+public:
+  boost::asio::io_service io;
+  std::string socketPath;
+  ShmLoopbackPeer peer;
+  shared_ptr<ShmTransport> transport;
+  std::vector<Block> received;
+  size_t nBatches;
+};
+
+BOOST_FIXTURE_TEST_SUITE(TransportTestShmTransport, ShmTransportFixture)
+
+BOOST_AUTO_TEST_CASE(GetDefaultSocketName)
+{
+  initializeConfig("tests/unit-tests/transport/test-homes/shm-transport/ok");
+  BOOST_CHECK_EQUAL(ShmTransport::getDefaultSocketName(*m_config), "/tmp/test/nfd-shm.sock");
+
+  initializeConfig("tests/unit-tests/transport/test-homes/unix-transport/ok");
+  BOOST_CHECK_THROW(ShmTransport::getDefaultSocketName(*m_config), Transport::Error);
+}
+
+BOOST_AUTO_TEST_CASE(Loopback)
+{
+  BOOST_CHECK(transport->isConnected());
+
+  std::vector<Block> packets;
+  for (uint8_t i = 0; i < 3; ++i) {
+    packets.push_back(makePacket(100, i));
+    transport->send(packets.back());
+  }
+  BOOST_CHECK_EQUAL(transport->getSendQueueSize(), 0);
+
+  receive(3);
+  BOOST_CHECK_EQUAL(peer.getNPackets(), 3);
+  BOOST_REQUIRE_EQUAL(received.size(), 3);
+  for (size_t i = 0; i < 3; ++i) {
+    BOOST_CHECK(received[i] == packets[i]);
+  }
+
+  // the blocks committed together are read together
+  BOOST_CHECK_EQUAL(nBatches, 1);
+}
+
+BOOST_AUTO_TEST_CASE(HeaderAndPayload)
+{
+  Block header = makePacket(10, 1);
+  Block payload = makePacket(1000, 2);
+  transport->send(header, payload);
+
+  receive(2);
+  BOOST_REQUIRE_EQUAL(received.size(), 2);
+  BOOST_CHECK(received[0] == header);
+  BOOST_CHECK(received[1] == payload);
+}
+
+BOOST_AUTO_TEST_CASE(PauseResume)
+{
+  transport->pause();
+  BOOST_CHECK(!transport->isExpectingData());
+
+  transport->send(makePacket(100, 1));
+  receive(1);
+  BOOST_CHECK_EQUAL(peer.getNPackets(), 1);
+  BOOST_CHECK_EQUAL(received.size(), 0);
+
+  transport->resume();
+  BOOST_CHECK(transport->isExpectingData());
+  receive(1);
+  BOOST_CHECK_EQUAL(received.size(), 1);
+}
+
+class SmallShmTransportFixture : public ShmTransportFixture
+{
+public:
+  SmallShmTransportFixture()
+    : ShmTransportFixture(16384)
+  {
+  }
+};
+
+BOOST_FIXTURE_TEST_CASE(RingFull, SmallShmTransportFixture)
+{
+  size_t nFull = 0;
+  size_t nDrained = 0;
+  transport->setSendQueueHighWaterMark(65536);
+  transport->onSendQueueFull.connect([&] { ++nFull; });
+  transport->onSendQueueDrained.connect([&] { ++nDrained; });
+
+  // the peer does not run before all packets are sent, so most of them stay queued
+  std::vector<Block> packets;
+  for (size_t i = 0; i < 100; ++i) {
+    packets.push_back(makePacket(1000, static_cast<uint8_t>(i)));
+    transport->send(packets.back());
+  }
+  BOOST_CHECK_EQUAL(nFull, 1);
+  BOOST_CHECK_GT(transport->getSendQueueSize(), 65536);
+
+  receive(packets.size());
+  BOOST_CHECK_EQUAL(nDrained, 1);
+  BOOST_CHECK_EQUAL(transport->getSendQueueSize(), 0);
+  BOOST_REQUIRE_EQUAL(received.size(), packets.size());
+  for (size_t i = 0; i < packets.size(); ++i) {
+    BOOST_CHECK(received[i] == packets[i]);
+  }
+}
+
+BOOST_FIXTURE_TEST_CASE(RingFullHeaderAndPayload, SmallShmTransportFixture)
+{
+  // the ring is left with room for the header but not for the payload
+  std::vector<Block> packets;
+  for (size_t i = 0; i < 16; ++i) {
+    packets.push_back(makePacket(1000, static_cast<uint8_t>(i)));
+    transport->send(packets.back());
+  }
+  BOOST_CHECK_EQUAL(transport->getSendQueueSize(), 0);
+
+  // like a LocalControlHeader, the header is a TLV prefix whose TLV-LENGTH covers the payload
+  Block payload = makePacket(8000, 0xAA);
+  EncodingBuffer encoder;
+  encoder.prependVarNumber(payload.size());
+  encoder.prependVarNumber(tlv::nfd::LocalControlHeader);
+  Block header = encoder.block(false);
+  transport->send(header, payload);
+  BOOST_CHECK_GT(transport->getSendQueueSize(), 0);
+
+  receive(packets.size() + 1);
+  BOOST_CHECK(transport->isConnected());
+  BOOST_CHECK_EQUAL(transport->getSendQueueSize(), 0);
+  BOOST_REQUIRE_EQUAL(received.size(), packets.size() + 1);
+  for (size_t i = 0; i < packets.size(); ++i) {
+    BOOST_CHECK(received[i] == packets[i]);
+  }
+  BOOST_CHECK_EQUAL(received.back().type(), tlv::nfd::LocalControlHeader);
+  BOOST_CHECK_EQUAL_COLLECTIONS(received.back().value_begin(), received.back().value_end(),
+                                payload.begin(), payload.end());
+}
+
+BOOST_AUTO_TEST_CASE(PeerClosed)
+{
+  io.poll(); // the peer accepts the channel
+  io.reset();
+
+  peer.close();
+  BOOST_CHECK_THROW(receive(1), Transport::Error);
+  BOOST_CHECK(!transport->isConnected());
+}
+
+BOOST_AUTO_TEST_CASE(NoPeer)
+{
+  peer.close();
+  ShmTransport other(socketPath);
+  BOOST_CHECK_THROW(other.connect(io, [] (const Block&) {}), Transport::Error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace ndn
+
+#endif // NDN_CXX_HAVE_EVENTFD
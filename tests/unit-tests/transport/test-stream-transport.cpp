@@ -0,0 +1,398 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2015 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "transport/unix-transport.hpp"
+#include "encoding/block-helpers.hpp"
+#include "util/random.hpp"
+
+#include <boost/filesystem.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include "boost-test.hpp"
+
+namespace ndn {
+
+class StreamTransportFixture
+{
+public:
+  explicit
+  StreamTransportFixture(TransportIoBackend ioBackend = TRANSPORT_IO_ASIO)
+    : acceptor(io)
+    , peer(io)
+  {
+    socketPath = (boost::filesystem::temp_directory_path() /
+                  boost::lexical_cast<std::string>(random::generateWord32())).string();
+
+    boost::filesystem::remove(socketPath);
+    acceptor.open();
+    acceptor.bind(boost::asio::local::stream_protocol::endpoint(socketPath));
+    acceptor.listen();
+
+    transport = make_shared<UnixTransport>(socketPath, ioBackend);
+    transport->connect(io, bind(&StreamTransportFixture::onReceive, this, _1));
+    acceptor.accept(peer);
+  }
+
+  ~StreamTransportFixture()
+  {
+    if (transport->isConnected())
+      transport->close();
+    boost::system::error_code error;
+    peer.close(error);
+    acceptor.close(error);
+    boost::filesystem::remove(socketPath, error);
+  }
+
+  void
+  onReceive(const Block& wire)
+  {
+    received.push_back(wire);
+  }
+
+  static Block
+  makePacket(size_t valueSize, uint8_t fill)
+  {
+    std::vector<uint8_t> value(valueSize, fill);
+    return dataBlock(tlv::Content, value.data(), value.size());
+  }
+
+  void
+  write(const uint8_t* buffer, size_t size)
+  {
+    boost::asio::write(peer, boost::asio::buffer(buffer, size));
+  }
+
+  /**
+   * @brief Polls the io_service until @p nPackets have been received or one second passes
+   */
+  void
+  receive(size_t nPackets)
+  {
+    for (int i = 0; i < 1000 && received.size() < nPackets; ++i) {
+      io.poll();
+      io.reset();
+      if (received.size() < nPackets)
+        usleep(1000);
+    }
+  }
+
+public:
+  boost::asio::io_service io;
+  std::string socketPath;
+  boost::asio::local::stream_protocol::acceptor acceptor;
+  boost::asio::local::stream_protocol::socket peer;
+  shared_ptr<UnixTransport> transport;
+  std::vector<Block> received;
+};
+
+BOOST_FIXTURE_TEST_SUITE(TransportTestStreamTransport, StreamTransportFixture)
+
+BOOST_AUTO_TEST_CASE(ZeroCopyReceive)
+{
+  std::vector<Block> packets;
+  Buffer wire;
+  for (uint8_t i = 0; i < 3; ++i) {
+    packets.push_back(makePacket(100, i));
+    wire.insert(wire.end(), packets.back().begin(), packets.back().end());
+  }
+  write(wire.buf(), wire.size());
+  receive(3);
+
+  BOOST_REQUIRE_EQUAL(received.size(), 3);
+  for (size_t i = 0; i < 3; ++i) {
+    BOOST_CHECK(received[i] == packets[i]);
+  }
+
+  // Blocks which arrived in one read refer to the same slab, one after another
+  BOOST_CHECK(received[1].wire() == received[0].wire() + received[0].size());
+  BOOST_CHECK(received[2].wire() == received[1].wire() + received[1].size());
+}
+
+BOOST_AUTO_TEST_CASE(ReceiveBatch)
+{
+  std::vector<size_t> batchSizes;
+  transport->setReceiveBatchCallback([this, &batchSizes] (const std::vector<Block>& wires) {
+    batchSizes.push_back(wires.size());
+    received.insert(received.end(), wires.begin(), wires.end());
+  });
+
+  // one read completes two packets and a part of the third one
+  Block packets[] = {makePacket(100, 1), makePacket(200, 2), makePacket(300, 3)};
+  Buffer wire;
+  for (size_t i = 0; i < 3; ++i) {
+    wire.insert(wire.end(), packets[i].begin(), packets[i].end());
+  }
+  write(wire.buf(), wire.size() - 10);
+  receive(2);
+  write(wire.buf() + wire.size() - 10, 10);
+  receive(3);
+
+  BOOST_REQUIRE_EQUAL(batchSizes.size(), 2);
+  BOOST_CHECK_EQUAL(batchSizes[0], 2);
+  BOOST_CHECK_EQUAL(batchSizes[1], 1);
+  BOOST_REQUIRE_EQUAL(received.size(), 3);
+  for (size_t i = 0; i < 3; ++i) {
+    BOOST_CHECK(received[i] == packets[i]);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(PartialPacket)
+{
+  Block packet = makePacket(5000, 0xAA);
+  write(packet.wire(), 3000);
+  receive(1);
+  BOOST_CHECK_EQUAL(received.size(), 0);
+
+  write(packet.wire() + 3000, packet.size() - 3000);
+  receive(1);
+  BOOST_REQUIRE_EQUAL(received.size(), 1);
+  BOOST_CHECK(received[0] == packet);
+}
+
+BOOST_AUTO_TEST_CASE(SlabRollover)
+{
+  // Blocks are kept, so every slab stays referenced while later packets are received,
+  // and packets straddle slab boundaries
+  std::vector<Block> packets;
+  for (size_t i = 0; i < 200; ++i) {
+    packets.push_back(makePacket(1000 + (i * 37) % 7000, static_cast<uint8_t>(i)));
+    const Block& packet = packets.back();
+    for (size_t offset = 0; offset < packet.size(); offset += 3001) {
+      write(packet.wire() + offset, std::min<size_t>(3001, packet.size() - offset));
+    }
+    if (i % 10 == 9)
+      receive(i + 1); // keep the socket buffer from filling up
+  }
+  receive(packets.size());
+
+  BOOST_REQUIRE_EQUAL(received.size(), packets.size());
+  for (size_t i = 0; i < packets.size(); ++i) {
+    BOOST_CHECK(received[i] == packets[i]);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(OversizedPacket)
+{
+  Block packet = makePacket(MAX_NDN_PACKET_SIZE + 10, 0);
+  write(packet.wire(), packet.size());
+  BOOST_CHECK_THROW(receive(1), Transport::Error);
+  BOOST_CHECK_EQUAL(received.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(SendQueue)
+{
+  io.poll(); // complete the connection
+  io.reset();
+  BOOST_REQUIRE(transport->isConnected());
+
+  size_t nFull = 0;
+  size_t nDrained = 0;
+  transport->setSendQueueHighWaterMark(65536);
+  transport->onSendQueueFull.connect([&] { ++nFull; });
+  transport->onSendQueueDrained.connect([&] { ++nDrained; });
+
+  // The peer is not reading yet, so the socket buffer fills up and packets stay queued
+  Buffer expected;
+  for (size_t i = 0; i < 100; ++i) {
+    Block packet = makePacket(8000, static_cast<uint8_t>(i));
+    if (i % 2 == 0) {
+      transport->send(packet);
+    }
+    else {
+      Block header = makePacket(10, static_cast<uint8_t>(i));
+      transport->send(header, packet);
+      expected.insert(expected.end(), header.begin(), header.end());
+    }
+    expected.insert(expected.end(), packet.begin(), packet.end());
+  }
+  BOOST_CHECK_EQUAL(nFull, 1);
+  BOOST_CHECK_EQUAL(nDrained, 0);
+  BOOST_CHECK_GT(transport->getSendQueueSize(), 65536);
+
+  Buffer actual(expected.size());
+  size_t nRead = 0;
+  for (int i = 0; i < 10000 && nRead < actual.size(); ++i) {
+    io.poll();
+    io.reset();
+    if (peer.available() == 0) {
+      usleep(1000);
+      continue;
+    }
+    nRead += peer.read_some(boost::asio::buffer(actual.buf() + nRead, actual.size() - nRead));
+  }
+  io.poll();
+
+  BOOST_CHECK_EQUAL(nFull, 1);
+  BOOST_CHECK_EQUAL(nDrained, 1);
+  BOOST_CHECK_EQUAL(transport->getSendQueueSize(), 0);
+  BOOST_CHECK_EQUAL_COLLECTIONS(actual.begin(), actual.end(), expected.begin(), expected.end());
+}
+
+class UringStreamTransportFixture : public StreamTransportFixture
+{
+public:
+  UringStreamTransportFixture()
+    : StreamTransportFixture(TRANSPORT_IO_URING)
+  {
+    if (transport->getIoBackend() != TRANSPORT_IO_URING)
+      BOOST_TEST_MESSAGE("io_uring is not available, the transport falls back to Asio");
+  }
+};
+
+BOOST_FIXTURE_TEST_SUITE(IoUring, UringStreamTransportFixture)
+
+BOOST_AUTO_TEST_CASE(Receive)
+{
+  std::vector<Block> packets;
+  for (size_t i = 0; i < 100; ++i) {
+    packets.push_back(makePacket(1000 + (i * 37) % 7000, static_cast<uint8_t>(i)));
+    const Block& packet = packets.back();
+    for (size_t offset = 0; offset < packet.size(); offset += 3001) {
+      write(packet.wire() + offset, std::min<size_t>(3001, packet.size() - offset));
+    }
+    if (i % 10 == 9)
+      receive(i + 1);
+  }
+  receive(packets.size());
+
+  BOOST_REQUIRE_EQUAL(received.size(), packets.size());
+  for (size_t i = 0; i < packets.size(); ++i) {
+    BOOST_CHECK(received[i] == packets[i]);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(PauseResume)
+{
+  Block packet1 = makePacket(100, 1);
+  write(packet1.wire(), packet1.size());
+  receive(1);
+  BOOST_REQUIRE_EQUAL(received.size(), 1);
+
+  transport->pause();
+  io.poll();
+  io.reset();
+  BOOST_CHECK(!transport->isExpectingData());
+
+  transport->resume();
+  Block packet2 = makePacket(200, 2);
+  write(packet2.wire(), packet2.size());
+  receive(2);
+  BOOST_REQUIRE_EQUAL(received.size(), 2);
+  BOOST_CHECK(received[1] == packet2);
+}
+
+BOOST_AUTO_TEST_CASE(Send)
+{
+  io.poll(); // complete the connection
+  io.reset();
+  BOOST_REQUIRE(transport->isConnected());
+
+  // more blocks than fit in one write, and more bytes than the socket buffer holds
+  Buffer expected;
+  for (size_t i = 0; i < 2000; ++i) {
+    Block packet = makePacket(i % 2 == 0 ? 10 : 1000, static_cast<uint8_t>(i));
+    transport->send(packet);
+    expected.insert(expected.end(), packet.begin(), packet.end());
+  }
+
+  Buffer actual(expected.size());
+  size_t nRead = 0;
+  for (int i = 0; i < 10000 && nRead < actual.size(); ++i) {
+    io.poll();
+    io.reset();
+    if (peer.available() == 0) {
+      usleep(1000);
+      continue;
+    }
+    nRead += peer.read_some(boost::asio::buffer(actual.buf() + nRead, actual.size() - nRead));
+  }
+  io.poll();
+
+  BOOST_CHECK_EQUAL(transport->getSendQueueSize(), 0);
+  BOOST_CHECK_EQUAL_COLLECTIONS(actual.begin(), actual.end(), expected.begin(), expected.end());
+}
+
+BOOST_AUTO_TEST_CASE(ThrowingCallback)
+{
+  io.poll(); // complete the connection
+  io.reset();
+  BOOST_REQUIRE(transport->isConnected());
+
+  size_t nCalls = 0;
+  transport->setReceiveBatchCallback([this, &nCalls] (const std::vector<Block>& wires) {
+    received.insert(received.end(), wires.begin(), wires.end());
+    if (++nCalls == 1)
+      throw std::runtime_error("receive callback error");
+  });
+
+  // the send completes after the receive whose callback throws, and is handled later
+  Block packet1 = makePacket(100, 1);
+  write(packet1.wire(), packet1.size());
+  usleep(10000);
+  Block sent1 = makePacket(200, 1);
+  transport->send(sent1);
+  usleep(10000);
+  BOOST_CHECK_THROW(receive(1), std::runtime_error);
+  BOOST_REQUIRE_EQUAL(received.size(), 1);
+  BOOST_CHECK(received[0] == packet1);
+
+  Block sent2 = makePacket(300, 2);
+  transport->send(sent2);
+  Block packet2 = makePacket(400, 2);
+  write(packet2.wire(), packet2.size());
+  receive(2);
+  BOOST_REQUIRE_EQUAL(received.size(), 2);
+  BOOST_CHECK(received[1] == packet2);
+
+  Buffer expected;
+  expected.insert(expected.end(), sent1.begin(), sent1.end());
+  expected.insert(expected.end(), sent2.begin(), sent2.end());
+  Buffer actual(expected.size());
+  size_t nRead = 0;
+  for (int i = 0; i < 1000 && nRead < actual.size(); ++i) {
+    io.poll();
+    io.reset();
+    if (peer.available() == 0) {
+      usleep(1000);
+      continue;
+    }
+    nRead += peer.read_some(boost::asio::buffer(actual.buf() + nRead, actual.size() - nRead));
+  }
+
+  BOOST_CHECK_EQUAL(transport->getSendQueueSize(), 0);
+  BOOST_CHECK_EQUAL_COLLECTIONS(actual.begin(), actual.end(), expected.begin(), expected.end());
+}
+
+BOOST_AUTO_TEST_CASE(EndOfStream)
+{
+  io.poll(); // complete the connection
+  io.reset();
+
+  peer.close();
+  BOOST_CHECK_THROW(receive(1), Transport::Error);
+  BOOST_CHECK(!transport->isConnected());
+}
+
+BOOST_AUTO_TEST_SUITE_END() // IoUring
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace ndn
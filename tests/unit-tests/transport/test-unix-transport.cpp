@@ -76,6 +76,19 @@ BOOST_AUTO_TEST_CASE(GetDefaultSocketNameBadMalformedUri)
                         });
 }
 
+BOOST_AUTO_TEST_CASE(GetDefaultIoBackend)
+{
+  initializeConfig("tests/unit-tests/transport/test-homes/unix-transport/ok");
+  BOOST_CHECK_EQUAL(Transport::getDefaultIoBackend(*m_config), TRANSPORT_IO_ASIO);
+
+  initializeConfig("tests/unit-tests/transport/test-homes/unix-transport/ok-io-uring");
+  BOOST_CHECK_EQUAL(Transport::getDefaultIoBackend(*m_config), TRANSPORT_IO_URING);
+  BOOST_CHECK_EQUAL(UnixTransport::create(*m_config)->getIoBackend(), TRANSPORT_IO_URING);
+
+  initializeConfig("tests/unit-tests/transport/test-homes/unix-transport/bad-io-backend");
+  BOOST_CHECK_THROW(Transport::getDefaultIoBackend(*m_config), ConfigFile::Error);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 } // namespace ndn
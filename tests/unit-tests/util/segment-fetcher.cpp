@@ -24,6 +24,9 @@
 #include "boost-test.hpp"
 #include "util/dummy-client-face.hpp"
 #include "security/key-chain.hpp"
+#include "security/validator-null.hpp"
+
+#include <unistd.h>
 #include "../unit-test-time-fixture.hpp"
 
 namespace ndn {
@@ -70,6 +73,7 @@ public:
   {
     ++nDatas;
     dataSize = data->size();
+    lastData = data;
   }
 
 
@@ -81,6 +85,7 @@ public:
   uint32_t lastError;
   uint32_t nDatas;
   size_t dataSize;
+  ConstBufferPtr lastData;
 };
 
 BOOST_FIXTURE_TEST_CASE(Timeout, Fixture)
@@ -290,7 +295,336 @@ BOOST_FIXTURE_TEST_CASE(TripleWithInitialSegmentFetching, Fixture)
     BOOST_CHECK_EQUAL(interest.getChildSelector(), 0);
   }
 }
+BOOST_FIXTURE_TEST_CASE(PipelinedOutOfOrder, Fixture)
+{
+  SegmentFetcher::Options options;
+  options.initCwnd = 2;
+  SegmentFetcher::fetch(*face, Interest("/hello/world", time::seconds(1000)),
+                        DontVerifySegment(),
+                        bind(&Fixture::onData, this, _1),
+                        bind(&Fixture::onError, this, _1),
+                        options);
+
+  advanceClocks(time::milliseconds(1), 10);
+  BOOST_REQUIRE_EQUAL(face->sentInterests.size(), 1);
+  BOOST_CHECK_EQUAL(face->sentInterests[0].getChildSelector(), 1);
+
+  // each segment holds its number, and segment 3 is the last one
+  for (uint8_t segment : {0, 3, 2, 1}) {
+    shared_ptr<Data> data = make_shared<Data>(Name("/hello/world/version0").appendSegment(segment));
+    data->setContent(&segment, 1);
+    data->setFinalBlockId(name::Component::fromSegment(3));
+    keyChain.sign(*data);
+
+    face->receive(*data);
+    advanceClocks(time::milliseconds(1), 10);
+
+    if (segment == 0) {
+      // the window grew from 2 to 3 Interests, sent without waiting for each other
+      BOOST_REQUIRE_EQUAL(face->sentInterests.size(), 4);
+      for (uint64_t i = 1; i <= 3; ++i) {
+        const Interest& interest = face->sentInterests[i];
+        BOOST_CHECK_EQUAL(interest.getName(), Name("/hello/world/version0").appendSegment(i));
+        BOOST_CHECK_EQUAL(interest.getMustBeFresh(), false);
+        BOOST_CHECK_EQUAL(interest.getChildSelector(), 0);
+        // the measured RTT is 10ms, so the timeout is the minimum one
+        BOOST_CHECK_EQUAL(interest.getInterestLifetime(), options.minRto);
+      }
+    }
+  }
+
+  BOOST_CHECK_EQUAL(nErrors, 0);
+  BOOST_REQUIRE_EQUAL(nDatas, 1);
+  BOOST_CHECK_EQUAL(face->sentInterests.size(), 4);
+
+  const uint8_t expected[] = {0, 1, 2, 3};
+  BOOST_CHECK_EQUAL_COLLECTIONS(lastData->begin(), lastData->end(),
+                                expected, expected + sizeof(expected));
+}
+
+BOOST_FIXTURE_TEST_CASE(PipelinedRetransmission, Fixture)
+{
+  SegmentFetcher::fetch(*face, Interest("/hello/world", time::seconds(1000)),
+                        DontVerifySegment(),
+                        bind(&Fixture::onData, this, _1),
+                        bind(&Fixture::onError, this, _1),
+                        SegmentFetcher::Options());
+
+  advanceClocks(time::milliseconds(1), 10);
+  shared_ptr<Data> data = makeData("/hello/world/version0", 0, false);
+  data->setFinalBlockId(name::Component::fromSegment(1));
+  keyChain.sign(*data);
+  face->receive(*data);
+  advanceClocks(time::milliseconds(1), 10);
+  BOOST_REQUIRE_EQUAL(face->sentInterests.size(), 2);
+
+  // segment 1 times out after the minimum timeout, and is requested again with a doubled one
+  advanceClocks(time::milliseconds(10), 25);
+  BOOST_CHECK_EQUAL(nErrors, 0);
+  BOOST_REQUIRE_EQUAL(face->sentInterests.size(), 3);
+  BOOST_CHECK_EQUAL(face->sentInterests[2].getName(), face->sentInterests[1].getName());
+  BOOST_CHECK_NE(face->sentInterests[2].getNonce(), face->sentInterests[1].getNonce());
+  BOOST_CHECK_EQUAL(face->sentInterests[2].getInterestLifetime(), time::milliseconds(400));
+
+  face->receive(*makeData("/hello/world/version0", 1, true));
+  advanceClocks(time::milliseconds(1), 10);
+
+  BOOST_CHECK_EQUAL(nErrors, 0);
+  BOOST_CHECK_EQUAL(nDatas, 1);
+  BOOST_CHECK_EQUAL(dataSize, 28);
+}
+
+BOOST_FIXTURE_TEST_CASE(PipelinedRetriesExhausted, Fixture)
+{
+  SegmentFetcher::Options options;
+  options.initRto = time::milliseconds(100);
+  options.maxRetries = 2;
+  SegmentFetcher::fetch(*face, Interest("/hello/world", time::seconds(1000)),
+                        DontVerifySegment(),
+                        bind(&Fixture::onData, this, _1),
+                        bind(&Fixture::onError, this, _1),
+                        options);
 
+  // timeouts of 100ms, 200ms and 400ms
+  advanceClocks(time::milliseconds(10), 69);
+  BOOST_CHECK_EQUAL(nErrors, 0);
+  BOOST_CHECK_EQUAL(face->sentInterests.size(), 3);
+
+  advanceClocks(time::milliseconds(10), 10);
+  BOOST_CHECK_EQUAL(nErrors, 1);
+  BOOST_CHECK_EQUAL(lastError, static_cast<uint32_t>(SegmentFetcher::INTEREST_TIMEOUT));
+  BOOST_CHECK_EQUAL(nDatas, 0);
+  BOOST_CHECK_EQUAL(face->sentInterests.size(), 3);
+}
+
+BOOST_FIXTURE_TEST_CASE(PipelinedValidator, Fixture)
+{
+  ValidatorNull validator;
+  SegmentFetcher::fetch(*face, Interest("/hello/world", time::seconds(1000)),
+                        validator,
+                        bind(&Fixture::onData, this, _1),
+                        bind(&Fixture::onError, this, _1));
+
+  advanceClocks(time::milliseconds(1), 10);
+  face->receive(*makeData("/hello/world/version0", 1, false));
+  advanceClocks(time::milliseconds(1), 10);
+  face->receive(*makeData("/hello/world/version0", 0, false));
+  face->receive(*makeData("/hello/world/version0", 2, true));
+  advanceClocks(time::milliseconds(1), 10);
+
+  BOOST_CHECK_EQUAL(nErrors, 0);
+  BOOST_CHECK_EQUAL(nDatas, 1);
+  BOOST_CHECK_EQUAL(dataSize, 42);
+}
+
+class RecordingSink : public SegmentSink
+{
+public:
+  RecordingSink()
+    : isFinished(false)
+  {
+  }
+
+  virtual void
+  write(const uint8_t* data, size_t size)
+  {
+    content.insert(content.end(), data, data + size);
+  }
+
+  virtual void
+  finish()
+  {
+    isFinished = true;
+  }
+
+public:
+  std::vector<uint8_t> content;
+  bool isFinished;
+};
+
+BOOST_FIXTURE_TEST_CASE(StreamToSink, Fixture)
+{
+  shared_ptr<RecordingSink> sink = make_shared<RecordingSink>();
+  SegmentFetcher::fetch(*face, Interest("/hello/world", time::seconds(1000)),
+                        DontVerifySegment(), sink,
+                        bind(&Fixture::onError, this, _1));
+
+  advanceClocks(time::milliseconds(1), 10);
+  face->receive(*makeData("/hello/world/version0", 0, false));
+  advanceClocks(time::milliseconds(1), 10);
+
+  // the first segment is written before the next ones arrive
+  BOOST_CHECK_EQUAL(sink->content.size(), 14);
+  BOOST_CHECK(!sink->isFinished);
+
+  // segment 2 waits for segment 1
+  face->receive(*makeData("/hello/world/version0", 2, true));
+  advanceClocks(time::milliseconds(1), 10);
+  BOOST_CHECK_EQUAL(sink->content.size(), 14);
+  BOOST_CHECK(!sink->isFinished);
+
+  face->receive(*makeData("/hello/world/version0", 1, false));
+  advanceClocks(time::milliseconds(1), 10);
+  BOOST_CHECK_EQUAL(sink->content.size(), 42);
+  BOOST_CHECK(sink->isFinished);
+  BOOST_CHECK_EQUAL(nErrors, 0);
+}
+
+BOOST_FIXTURE_TEST_CASE(StreamToFd, Fixture)
+{
+  int fds[2];
+  BOOST_REQUIRE_EQUAL(pipe(fds), 0);
+
+  bool isFinished = false;
+  shared_ptr<FdSegmentSink> sink = make_shared<FdSegmentSink>(fds[1], [&] { isFinished = true; });
+  SegmentFetcher::fetch(*face, Interest("/hello/world", time::seconds(1000)),
+                        DontVerifySegment(), sink,
+                        bind(&Fixture::onError, this, _1));
+
+  advanceClocks(time::milliseconds(1), 10);
+  face->receive(*makeData("/hello/world/version0", 0, false));
+  advanceClocks(time::milliseconds(1), 10);
+  face->receive(*makeData("/hello/world/version0", 1, true));
+  advanceClocks(time::milliseconds(1), 10);
+
+  BOOST_CHECK_EQUAL(nErrors, 0);
+  BOOST_CHECK(isFinished);
+  BOOST_CHECK_EQUAL(sink->getNBytes(), 28);
+
+  uint8_t buffer[64];
+  BOOST_CHECK_EQUAL(read(fds[0], buffer, sizeof(buffer)), 28);
+  BOOST_CHECK_EQUAL(std::string(reinterpret_cast<const char*>(buffer)), "Hello, world!");
+
+  close(fds[0]);
+  close(fds[1]);
+}
+
+BOOST_FIXTURE_TEST_CASE(SinkFailure, Fixture)
+{
+  SegmentFetcher::fetch(*face, Interest("/hello/world", time::seconds(1000)),
+                        DontVerifySegment(), make_shared<FdSegmentSink>(-1),
+                        bind(&Fixture::onError, this, _1));
+
+  advanceClocks(time::milliseconds(1), 10);
+  face->receive(*makeData("/hello/world/version0", 0, false));
+  advanceClocks(time::milliseconds(1), 10);
+
+  BOOST_CHECK_EQUAL(nErrors, 1);
+  BOOST_CHECK_EQUAL(lastError, static_cast<uint32_t>(SegmentFetcher::SINK_FAIL));
+  BOOST_CHECK_EQUAL(face->sentInterests.size(), 1);
+}
+
+class ManifestFixture : public Fixture
+{
+public:
+  ManifestFixture()
+    : nVerified(0)
+    , nAnswered(0)
+  {
+    // each segment holds its number, and segment 4 is the last one
+    for (uint8_t segment = 0; segment < 5; ++segment) {
+      Name name = Name("/hello/world/version0").appendSegment(segment);
+      shared_ptr<Data> data = make_shared<Data>(name);
+      data->setContent(&segment, 1);
+      data->setFinalBlockId(name::Component::fromSegment(4));
+      segments.push_back(data);
+    }
+
+    std::vector<shared_ptr<Data> > manifests =
+      keyChain.signWithManifests(segments, 2, "/hello/world/version0/_manifest");
+    for (size_t i = 0; i < segments.size(); ++i)
+      store[segments[i]->getName()] = segments[i];
+    for (size_t i = 0; i < manifests.size(); ++i)
+      store[manifests[i]->getName()] = manifests[i];
+  }
+
+  bool
+  verify(const Data& data)
+  {
+    ++nVerified;
+    return true;
+  }
+
+  /**
+   * @brief Answers the Interests sent so far from the store, until no Interest is left
+   *
+   * The discovery Interest is answered with segment 0.
+   */
+  void
+  answerInterests()
+  {
+    while (nAnswered < face->sentInterests.size()) {
+      Name name = face->sentInterests[nAnswered++].getName();
+      if (name == "/hello/world")
+        name = Name("/hello/world/version0").appendSegment(0);
+
+      std::map<Name, shared_ptr<Data> >::iterator data = store.find(name);
+      if (data != store.end())
+        face->receive(*data->second);
+      advanceClocks(time::milliseconds(1), 10);
+    }
+  }
+
+public:
+  std::vector<shared_ptr<Data> > segments;
+  std::map<Name, shared_ptr<Data> > store;
+  size_t nVerified;
+  size_t nAnswered;
+};
+
+BOOST_FIXTURE_TEST_CASE(Manifests, ManifestFixture)
+{
+  SegmentFetcher::fetch(*face, Interest("/hello/world", time::seconds(1000)),
+                        bind(&ManifestFixture::verify, this, _1),
+                        bind(&Fixture::onData, this, _1),
+                        bind(&Fixture::onError, this, _1),
+                        SegmentFetcher::Options());
+
+  advanceClocks(time::milliseconds(1), 10);
+  answerInterests();
+
+  BOOST_CHECK_EQUAL(nErrors, 0);
+  BOOST_REQUIRE_EQUAL(nDatas, 1);
+  const uint8_t expected[] = {0, 1, 2, 3, 4};
+  BOOST_CHECK_EQUAL_COLLECTIONS(lastData->begin(), lastData->end(),
+                                expected, expected + sizeof(expected));
+
+  // only the manifests are verified, and each of them is fetched once
+  BOOST_CHECK_EQUAL(nVerified, 3);
+  size_t nManifestInterests = 0;
+  for (size_t i = 0; i < face->sentInterests.size(); ++i) {
+    if (Name("/hello/world/version0/_manifest").isPrefixOf(face->sentInterests[i].getName()))
+      ++nManifestInterests;
+  }
+  BOOST_CHECK_EQUAL(nManifestInterests, 3);
+}
+
+BOOST_FIXTURE_TEST_CASE(ManifestMismatch, ManifestFixture)
+{
+  // segment 3 is replaced, with a digest signature pointing to the same manifest
+  std::vector<shared_ptr<Data> > forged;
+  forged.push_back(make_shared<Data>(*segments[2]));
+  forged.push_back(make_shared<Data>(*segments[3]));
+  const uint8_t content[] = {42};
+  forged[1]->setContent(content, sizeof(content));
+  keyChain.signWithManifests(forged, 2, "/hello/world/version0/_manifest");
+  BOOST_REQUIRE(forged[1]->getSignature().getKeyLocator() ==
+                segments[3]->getSignature().getKeyLocator());
+  store[forged[1]->getName()] = forged[1];
+
+  SegmentFetcher::fetch(*face, Interest("/hello/world", time::seconds(1000)),
+                        bind(&ManifestFixture::verify, this, _1),
+                        bind(&Fixture::onData, this, _1),
+                        bind(&Fixture::onError, this, _1),
+                        SegmentFetcher::Options());
+
+  advanceClocks(time::milliseconds(1), 10);
+  answerInterests();
+
+  BOOST_CHECK_EQUAL(nErrors, 1);
+  BOOST_CHECK_EQUAL(lastError, static_cast<uint32_t>(SegmentFetcher::SEGMENT_VERIFICATION_FAIL));
+  BOOST_CHECK_EQUAL(nDatas, 0);
+}
 
 BOOST_AUTO_TEST_SUITE_END()
 
@@ -0,0 +1,203 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2015 Regents of the University of Tokyo.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+
+#include "util/disk-storage.hpp"
+#include "util/in-memory-storage-lru.hpp"
+#include "util/random.hpp"
+
+#include <boost/filesystem.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include "boost-test.hpp"
+#include "../test-make-interest-data.hpp"
+
+namespace ndn {
+namespace util {
+
+class DiskStorageFixture
+{
+public:
+  DiskStorageFixture()
+  {
+    boost::system::error_code error;
+    tmpPath = boost::filesystem::temp_directory_path(error);
+    BOOST_REQUIRE(boost::system::errc::success == error.value());
+    tmpPath /= "disk-storage-" + boost::lexical_cast<std::string>(random::generateWord32());
+  }
+
+  ~DiskStorageFixture()
+  {
+    boost::filesystem::remove_all(tmpPath);
+  }
+
+public:
+  boost::filesystem::path tmpPath;
+};
+
+BOOST_FIXTURE_TEST_SUITE(UtilDiskStorage, DiskStorageFixture)
+
+BOOST_AUTO_TEST_CASE(InsertAndFind)
+{
+  DiskStorage storage(tmpPath.string());
+  BOOST_CHECK(boost::filesystem::is_directory(tmpPath));
+
+  shared_ptr<Data> data1 = makeData("/a/1");
+  shared_ptr<Data> data2 = makeData("/a/2");
+  time::steady_clock::TimePoint freshUntil = time::steady_clock::now() + time::seconds(10);
+  storage.insert(*data1, freshUntil);
+  storage.insert(*data2);
+  storage.insert(*makeData("/a/1"), freshUntil);
+  BOOST_CHECK_EQUAL(storage.size(), 2);
+  BOOST_CHECK_EQUAL(storage.sizeInBytes(), data1->wireEncode().size() + data2->wireEncode().size());
+
+  time::steady_clock::TimePoint found;
+  BOOST_REQUIRE(static_cast<bool>(storage.find(Name("/a"), &found)));
+  BOOST_CHECK_EQUAL(storage.find(Name("/a"))->getName(), "/a/1");
+  BOOST_CHECK(found == freshUntil);
+  BOOST_CHECK_EQUAL(*storage.find(data2->getFullName()), *data2);
+  BOOST_CHECK(!static_cast<bool>(storage.find(Name("/b"))));
+
+  shared_ptr<Interest> interest = makeInterest("/a");
+  interest->setChildSelector(1);
+  BOOST_CHECK_EQUAL(storage.find(*interest)->getName(), "/a/2");
+  interest->setChildSelector(0);
+  BOOST_CHECK_EQUAL(storage.find(*interest)->getName(), "/a/1");
+
+  interest->setName(data2->getFullName());
+  BOOST_CHECK_EQUAL(*storage.find(*interest), *data2);
+
+  shared_ptr<Interest> fresh = makeInterest("/a");
+  fresh->setChildSelector(1);
+  fresh->setMustBeFresh(true);
+  BOOST_CHECK_EQUAL(storage.find(*fresh)->getName(), "/a/2");
+  storage.insert(*makeData("/a/3"), time::steady_clock::TimePoint::min());
+  BOOST_CHECK_EQUAL(storage.find(*fresh)->getName(), "/a/2");
+  fresh->setChildSelector(0);
+  fresh->setName("/a/3");
+  BOOST_CHECK(!static_cast<bool>(storage.find(*fresh)));
+}
+
+BOOST_AUTO_TEST_CASE(ExtractAndErase)
+{
+  DiskStorage storage(tmpPath.string());
+  storage.insert(*makeData("/a/1"));
+  storage.insert(*makeData("/a/2"));
+  storage.insert(*makeData("/b/1"));
+
+  BOOST_CHECK_EQUAL(storage.extract(*makeInterest("/a"))->getName(), "/a/1");
+  BOOST_CHECK_EQUAL(storage.size(), 2);
+  BOOST_CHECK(!static_cast<bool>(storage.extract(Name("/a/1"))));
+
+  storage.erase("/b/1", false);
+  BOOST_CHECK_EQUAL(storage.size(), 2);
+  storage.erase(makeData("/b/1")->getFullName(), false);
+  BOOST_CHECK_EQUAL(storage.size(), 1);
+
+  storage.erase("/a");
+  BOOST_CHECK_EQUAL(storage.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(Reopen)
+{
+  shared_ptr<Data> data = makeData("/a/1");
+  {
+    DiskStorage storage(tmpPath.string());
+    storage.insert(*data);
+    storage.insert(*makeData("/a/2"));
+  }
+
+  DiskStorage storage(tmpPath.string());
+  BOOST_CHECK_EQUAL(storage.size(), 2);
+  BOOST_CHECK_EQUAL(*storage.find(Name("/a/1")), *data);
+
+  // restored packets are stale
+  shared_ptr<Interest> interest = makeInterest("/a");
+  interest->setMustBeFresh(true);
+  BOOST_CHECK(!static_cast<bool>(storage.find(*interest)));
+
+  storage.insert(*makeData("/a/3"));
+  BOOST_CHECK_EQUAL(storage.size(), 3);
+  BOOST_CHECK_EQUAL(storage.find(*interest)->getName(), "/a/3");
+}
+
+BOOST_AUTO_TEST_CASE(DropSegments)
+{
+  size_t packetSize = makeData("/a/1")->wireEncode().size();
+  DiskStorage storage(tmpPath.string(), 4 * packetSize, 2 * packetSize);
+
+  storage.insert(*makeData("/a/1"));
+  storage.insert(*makeData("/a/2"));
+  storage.insert(*makeData("/a/3"));
+  BOOST_CHECK_EQUAL(storage.getNSegments(), 2);
+
+  // a segment is dropped once all its packets are erased, unless it is the active one
+  storage.erase("/a/3", true);
+  BOOST_CHECK_EQUAL(storage.getNSegments(), 2);
+  storage.erase("/a/1", true);
+  BOOST_CHECK_EQUAL(storage.getNSegments(), 2);
+  storage.erase("/a/2", true);
+  BOOST_CHECK_EQUAL(storage.getNSegments(), 1);
+  BOOST_CHECK_EQUAL(storage.sizeInBytes(), packetSize);
+
+  // the oldest segment is dropped once the limit in bytes is exceeded
+  for (int i = 4; i < 10; ++i)
+    storage.insert(*makeData("/a/" + boost::lexical_cast<std::string>(i)));
+  BOOST_CHECK_LE(storage.sizeInBytes(), storage.getLimitInBytes());
+  BOOST_CHECK_EQUAL(storage.getNSegments(), 2);
+  BOOST_CHECK_EQUAL(storage.size(), 3);
+  BOOST_CHECK(!static_cast<bool>(storage.find(Name("/a/6"))));
+  BOOST_CHECK(static_cast<bool>(storage.find(Name("/a/7"))));
+
+  BOOST_CHECK_THROW(storage.insert(*makeData(Name("/a").append(std::string(100, 'x')))),
+                    DiskStorage::Error);
+}
+
+BOOST_AUTO_TEST_CASE(Overflow)
+{
+  InMemoryStorageLru ims(2);
+  shared_ptr<DiskStorage> overflow = make_shared<DiskStorage>(tmpPath.string());
+  ims.setOverflowStorage(overflow);
+
+  ims.insert(*makeData("/1"));
+  ims.insert(*makeData("/2"));
+  ims.insert(*makeData("/3"));
+  BOOST_CHECK_EQUAL(ims.size(), 2);
+  BOOST_CHECK_EQUAL(overflow->size(), 1);
+
+  // a packet found in the overflow storage is moved back to memory
+  BOOST_CHECK_EQUAL(ims.find(*makeInterest("/1"))->getName(), "/1");
+  BOOST_CHECK_EQUAL(ims.size(), 2);
+  BOOST_CHECK_EQUAL(overflow->size(), 1);
+  BOOST_CHECK(static_cast<bool>(overflow->find(Name("/2"))));
+
+  BOOST_CHECK_EQUAL(ims.find(Name("/2"))->getName(), "/2");
+  BOOST_CHECK(static_cast<bool>(overflow->find(Name("/3"))));
+
+  ims.erase("/3");
+  BOOST_CHECK_EQUAL(overflow->size(), 0);
+  BOOST_CHECK(!static_cast<bool>(ims.find(Name("/3"))));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace util
+} // namespace ndn
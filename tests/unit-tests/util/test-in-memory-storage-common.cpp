@@ -23,10 +23,12 @@
 #include "util/in-memory-storage-fifo.hpp"
 #include "util/in-memory-storage-lfu.hpp"
 #include "util/in-memory-storage-lru.hpp"
+#include "util/in-memory-storage-tiny-lfu.hpp"
 #include "security/key-chain.hpp"
 
 #include "boost-test.hpp"
 #include "../test-make-interest-data.hpp"
+#include "../unit-test-time-fixture.hpp"
 
 #include <boost/mpl/list.hpp>
 
@@ -38,7 +40,7 @@ BOOST_AUTO_TEST_SUITE(UtilInMemoryStorage)
 BOOST_AUTO_TEST_SUITE(Common)
 
 typedef boost::mpl::list<InMemoryStoragePersistent, InMemoryStorageFifo, InMemoryStorageLfu,
-                         InMemoryStorageLru> InMemoryStorages;
+                         InMemoryStorageLru, InMemoryStorageTinyLfu> InMemoryStorages;
 
 BOOST_AUTO_TEST_CASE_TEMPLATE(Insertion, T, InMemoryStorages)
 {
@@ -210,6 +212,43 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(InsertAndNotFindByFullName, T, InMemoryStorages)
   BOOST_CHECK(!static_cast<bool>(found));
 }
 
+BOOST_AUTO_TEST_CASE_TEMPLATE(InsertSameNameAndFindByFullName, T, InMemoryStorages)
+{
+  T ims;
+
+  Name name("/a");
+  uint32_t content1 = 1;
+  shared_ptr<Data> data1 = makeData(name);
+  data1->setContent(reinterpret_cast<const uint8_t*>(&content1), sizeof(content1));
+  signData(data1);
+  ims.insert(*data1);
+  ims.insert(*data1);
+
+  uint32_t content2 = 2;
+  shared_ptr<Data> data2 = makeData(name);
+  data2->setContent(reinterpret_cast<const uint8_t*>(&content2), sizeof(content2));
+  signData(data2);
+  ims.insert(*data2);
+
+  BOOST_CHECK_EQUAL(ims.size(), 2);
+
+  shared_ptr<const Data> found = ims.find(name);
+  BOOST_REQUIRE(static_cast<bool>(found));
+  BOOST_CHECK_EQUAL(found->getFullName(), data1->getFullName());
+
+  found = ims.find(data2->getFullName());
+  BOOST_REQUIRE(static_cast<bool>(found));
+  BOOST_CHECK_EQUAL(found->getFullName(), data2->getFullName());
+
+  found = ims.find(Interest(data2->getFullName()));
+  BOOST_REQUIRE(static_cast<bool>(found));
+  BOOST_CHECK_EQUAL(found->getFullName(), data2->getFullName());
+
+  ims.erase(data1->getFullName(), false);
+  BOOST_CHECK_EQUAL(ims.size(), 1);
+  BOOST_CHECK(!static_cast<bool>(ims.find(data1->getFullName())));
+}
+
 BOOST_AUTO_TEST_CASE_TEMPLATE(InsertAndEraseByName, T, InMemoryStorages)
 {
   T ims;
@@ -291,6 +330,33 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(DigestCalculation, T, InMemoryStorages)
                                 entry->getFullName()[-1].value_end());
 }
 
+BOOST_AUTO_TEST_CASE_TEMPLATE(SizeInBytes, T, InMemoryStorages)
+{
+  T ims;
+  BOOST_CHECK_EQUAL(ims.sizeInBytes(), 0);
+
+  shared_ptr<Data> data1 = makeData("/a");
+  ims.insert(*data1);
+  size_t size1 = InMemoryStorage::getEntrySize(*data1);
+  BOOST_CHECK_GT(size1, data1->wireEncode().size());
+  BOOST_CHECK_EQUAL(ims.sizeInBytes(), size1);
+
+  shared_ptr<Data> data2 = makeData("/b/c");
+  data2->setContent(std::vector<uint8_t>(1000).data(), 1000);
+  signData(data2);
+  ims.insert(*data2);
+  ims.insert(*data2);
+  size_t size2 = InMemoryStorage::getEntrySize(*data2);
+  BOOST_CHECK_GT(size2, size1 + 1000);
+  BOOST_CHECK_EQUAL(ims.sizeInBytes(), size1 + size2);
+
+  ims.erase("/a");
+  BOOST_CHECK_EQUAL(ims.sizeInBytes(), size2);
+
+  ims.erase("/");
+  BOOST_CHECK_EQUAL(ims.sizeInBytes(), 0);
+}
+
 BOOST_AUTO_TEST_CASE_TEMPLATE(Iterator, T, InMemoryStorages)
 {
   T ims;
@@ -699,6 +765,109 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(InsertAndEvict, T, InMemoryStoragesLimited)
   BOOST_CHECK(!static_cast<bool>(found));
 }
 
+static shared_ptr<Data>
+makeFreshData(const Name& name, const time::milliseconds& freshnessPeriod)
+{
+  shared_ptr<Data> data = makeData(name);
+  data->setFreshnessPeriod(freshnessPeriod);
+  return signData(data);
+}
+
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(MustBeFresh, T, InMemoryStorages,
+                                 ndn::tests::UnitTestTimeFixture)
+{
+  T ims;
+
+  shared_ptr<Data> data1 = makeFreshData("/fresh/1", time::seconds(1));
+  ims.insert(*data1);
+  ims.insert(*makeFreshData("/fresh/2", time::milliseconds(0)));
+  ims.insert(*makeData("/fresh/3"));
+
+  shared_ptr<Interest> interest1 = makeInterest("/fresh/1");
+  interest1->setMustBeFresh(true);
+  shared_ptr<Interest> interest2 = makeInterest("/fresh/2");
+  interest2->setMustBeFresh(true);
+  shared_ptr<Interest> interest3 = makeInterest("/fresh/3");
+  interest3->setMustBeFresh(true);
+  shared_ptr<Interest> fullNameInterest = makeInterest(data1->getFullName());
+  fullNameInterest->setMustBeFresh(true);
+
+  BOOST_CHECK(static_cast<bool>(ims.find(*interest1)));
+  BOOST_CHECK(static_cast<bool>(ims.find(*fullNameInterest)));
+  BOOST_CHECK(!static_cast<bool>(ims.find(*interest2)));
+  BOOST_CHECK(static_cast<bool>(ims.find(*makeInterest("/fresh/2"))));
+
+  advanceClocks(time::milliseconds(1500));
+
+  BOOST_CHECK(!static_cast<bool>(ims.find(*interest1)));
+  BOOST_CHECK(!static_cast<bool>(ims.find(*fullNameInterest)));
+  BOOST_CHECK(static_cast<bool>(ims.find(*makeInterest("/fresh/1"))));
+  BOOST_CHECK(static_cast<bool>(ims.find(*interest3)));
+
+  // a stale packet does not hide a fresh one under the same prefix
+  shared_ptr<Interest> prefixInterest = makeInterest("/fresh");
+  prefixInterest->setMustBeFresh(true);
+  shared_ptr<const Data> found = ims.find(*prefixInterest);
+  BOOST_REQUIRE(static_cast<bool>(found));
+  BOOST_CHECK_EQUAL(found->getName(), "/fresh/3");
+}
+
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(EvictStaleFirst, T, InMemoryStoragesLimited,
+                                 ndn::tests::UnitTestTimeFixture)
+{
+  T ims(3);
+
+  ims.insert(*makeFreshData("/1", time::seconds(100)));
+  ims.insert(*makeFreshData("/2", time::seconds(1)));
+  ims.insert(*makeFreshData("/3", time::seconds(100)));
+  ims.find(*makeInterest("/1"));
+  ims.find(*makeInterest("/3"));
+
+  advanceClocks(time::seconds(2));
+  ims.insert(*makeFreshData("/4", time::seconds(100)));
+
+  BOOST_CHECK_EQUAL(ims.size(), 3);
+  BOOST_CHECK(!static_cast<bool>(ims.find(Name("/2"))));
+  BOOST_CHECK(static_cast<bool>(ims.find(Name("/1"))));
+  BOOST_CHECK(static_cast<bool>(ims.find(Name("/3"))));
+
+  // once no packet is stale, the replacement policy applies
+  ims.insert(*makeFreshData("/5", time::seconds(100)));
+  BOOST_CHECK_EQUAL(ims.size(), 3);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(InsertAndEvictByBytes, T, InMemoryStoragesLimited)
+{
+  size_t entrySize = InMemoryStorage::getEntrySize(*makeData("/insert/1"));
+  T ims(10, 3 * entrySize);
+  BOOST_CHECK_EQUAL(ims.getLimitInBytes(), 3 * entrySize);
+
+  for (int i = 1; i <= 5; i++) {
+    std::ostringstream convert;
+    convert << i;
+    ims.insert(*makeData("/insert/" + convert.str()));
+    BOOST_CHECK_LE(ims.sizeInBytes(), ims.getLimitInBytes());
+  }
+
+  BOOST_CHECK_EQUAL(ims.size(), 3);
+  BOOST_CHECK_EQUAL(ims.sizeInBytes(), 3 * entrySize);
+  BOOST_CHECK(!static_cast<bool>(ims.find(*makeInterest("/insert/1"))));
+
+  // a larger packet makes room for itself
+  shared_ptr<Data> large = makeData("/insert/large");
+  large->setContent(std::vector<uint8_t>(entrySize).data(), entrySize);
+  signData(large);
+  ims.insert(*large);
+  BOOST_CHECK_EQUAL(ims.size(), 1);
+  BOOST_CHECK(static_cast<bool>(ims.find(*makeInterest("/insert/large"))));
+
+  shared_ptr<Data> tooLarge = makeData("/insert/too-large");
+  tooLarge->setContent(std::vector<uint8_t>(3 * entrySize).data(), 3 * entrySize);
+  signData(tooLarge);
+  BOOST_CHECK_THROW(ims.insert(*tooLarge), InMemoryStorage::Error);
+  BOOST_CHECK_EQUAL(ims.size(), 1);
+}
+
 ///as Find function is implemented at the base case, therefore testing for one derived class is
 ///sufficient for all
 class FindFixture
@@ -786,6 +955,42 @@ BOOST_AUTO_TEST_CASE(Rightmost)
   BOOST_CHECK_EQUAL(find(), 4);
 }
 
+BOOST_AUTO_TEST_CASE(ExcludeChildren)
+{
+  insert(1, "ndn:/A");
+  for (uint32_t i = 0; i < 100; ++i) {
+    insert(2 * i + 2, Name("ndn:/B").appendNumber(i).append("p"));
+    insert(2 * i + 3, Name("ndn:/B").appendNumber(i).append("q"));
+  }
+  insert(202, "ndn:/C");
+
+  startInterest("ndn:/B")
+    .setExclude(Exclude().excludeBefore(name::Component::fromNumber(49))
+                         .excludeOne(name::Component::fromNumber(50)));
+  BOOST_CHECK_EQUAL(find(), 104);
+
+  startInterest("ndn:/B")
+    .setChildSelector(1)
+    .setExclude(Exclude().excludeOne(name::Component::fromNumber(89))
+                         .excludeAfter(name::Component::fromNumber(90)));
+  BOOST_CHECK_EQUAL(find(), 178);
+
+  startInterest("ndn:/B")
+    .setChildSelector(1)
+    .setExclude(Exclude().excludeRange(name::Component::fromNumber(10),
+                                       name::Component::fromNumber(99)));
+  BOOST_CHECK_EQUAL(find(), 20);
+
+  startInterest("ndn:/B")
+    .setExclude(Exclude().excludeAfter(name::Component::fromNumber(0)));
+  BOOST_CHECK_EQUAL(find(), 0);
+
+  startInterest("ndn:/B")
+    .setChildSelector(1)
+    .setExclude(Exclude().excludeBefore(name::Component::fromNumber(99)));
+  BOOST_CHECK_EQUAL(find(), 0);
+}
+
 /// @todo Expected failures, needs to be fixed as part of Issue #2118
 BOOST_AUTO_TEST_CASE_EXPECTED_FAILURES(Leftmost_ExactName1, 1)
 BOOST_AUTO_TEST_CASE(Leftmost_ExactName1)
@@ -925,6 +1130,22 @@ BOOST_AUTO_TEST_CASE(DigestOrder)
   BOOST_CHECK_NE(leftmost, rightmost);
 }
 
+BOOST_AUTO_TEST_CASE(DigestOrderReversed)
+{
+  insert(2, "ndn:/A");
+  insert(1, "ndn:/A");
+
+  startInterest("ndn:/A")
+    .setChildSelector(0);
+  uint32_t leftmost = find();
+
+  startInterest("ndn:/A")
+    .setChildSelector(1);
+  uint32_t rightmost = find();
+
+  BOOST_CHECK_NE(leftmost, rightmost);
+}
+
 /// @todo Expected failures, needs to be fixed as part of Issue #2118
 BOOST_AUTO_TEST_CASE_EXPECTED_FAILURES(DigestExclude, 1)
 BOOST_AUTO_TEST_CASE(DigestExclude)
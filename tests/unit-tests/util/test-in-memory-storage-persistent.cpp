@@ -57,6 +57,23 @@ BOOST_AUTO_TEST_CASE(InsertAndDouble)
   BOOST_CHECK_EQUAL(ims.getCapacity(), 20);
 }
 
+BOOST_AUTO_TEST_CASE(LimitInBytes)
+{
+  size_t entrySize = InMemoryStorage::getEntrySize(*makeData("/1"));
+  InMemoryStoragePersistent ims(2 * entrySize);
+
+  ims.insert(*makeData("/1"));
+  ims.insert(*makeData("/2"));
+  BOOST_CHECK_EQUAL(ims.sizeInBytes(), 2 * entrySize);
+
+  BOOST_CHECK_THROW(ims.insert(*makeData("/3")), InMemoryStorage::Error);
+  BOOST_CHECK_EQUAL(ims.size(), 2);
+
+  ims.erase("/1");
+  ims.insert(*makeData("/3"));
+  BOOST_CHECK_EQUAL(ims.size(), 2);
+}
+
 BOOST_AUTO_TEST_SUITE_END() // Persistent
 BOOST_AUTO_TEST_SUITE_END() // UtilInMemoryStorage
 
@@ -0,0 +1,150 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2015 Regents of the University of Tokyo.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+
+#include "util/in-memory-storage-sharded.hpp"
+#include "util/in-memory-storage-lru.hpp"
+#include "util/in-memory-storage-persistent.hpp"
+#include "security/key-chain.hpp"
+
+#include "boost-test.hpp"
+#include "../test-make-interest-data.hpp"
+
+#include <thread>
+
+namespace ndn {
+namespace util {
+
+BOOST_AUTO_TEST_SUITE(UtilInMemoryStorage)
+BOOST_AUTO_TEST_SUITE(Sharded)
+
+static unique_ptr<InMemoryStorage>
+makePersistent()
+{
+  return unique_ptr<InMemoryStorage>(new InMemoryStoragePersistent);
+}
+
+static unique_ptr<InMemoryStorage>
+makeLru()
+{
+  return unique_ptr<InMemoryStorage>(new InMemoryStorageLru(2));
+}
+
+BOOST_AUTO_TEST_CASE(ShardIndex)
+{
+  InMemoryStorageSharded ims(4, 2, &makePersistent);
+  BOOST_CHECK_EQUAL(ims.getNShards(), 4);
+
+  BOOST_CHECK_EQUAL(ims.getShardIndex("/a"), 4);
+  BOOST_CHECK_LT(ims.getShardIndex("/a/b"), 4);
+  BOOST_CHECK_EQUAL(ims.getShardIndex("/a/b/c"), ims.getShardIndex("/a/b"));
+
+  shared_ptr<Data> data = makeData("/a/b");
+  BOOST_CHECK_EQUAL(ims.getShardIndex(data->getFullName()), ims.getShardIndex("/a/b"));
+  BOOST_CHECK_EQUAL(ims.getShardIndex(makeData("/a")->getFullName()), 4);
+}
+
+BOOST_AUTO_TEST_CASE(InsertAndFind)
+{
+  InMemoryStorageSharded ims(4, 2, &makePersistent);
+
+  for (int i = 0; i < 20; i++) {
+    std::ostringstream convert;
+    convert << i;
+    ims.insert(*makeData("/a/" + convert.str() + "/data"));
+  }
+  shared_ptr<Data> shortData = makeData("/a");
+  ims.insert(*shortData);
+  BOOST_CHECK_EQUAL(ims.size(), 21);
+  BOOST_CHECK_GT(ims.sizeInBytes(), 0);
+
+  shared_ptr<const Data> found = ims.find(*makeInterest("/a/7"));
+  BOOST_REQUIRE(static_cast<bool>(found));
+  BOOST_CHECK_EQUAL(found->getName(), "/a/7/data");
+  BOOST_CHECK(static_cast<bool>(ims.find(Name("/a/12/data"))));
+  BOOST_CHECK(static_cast<bool>(ims.find(shortData->getFullName())));
+  BOOST_CHECK(!static_cast<bool>(ims.find(*makeInterest("/b"))));
+
+  // Interests shorter than the sharding prefix look in every shard
+  shared_ptr<Interest> interest = makeInterest("/a");
+  found = ims.find(*interest);
+  BOOST_REQUIRE(static_cast<bool>(found));
+  BOOST_CHECK_EQUAL(found->getName(), "/a");
+
+  interest->setChildSelector(1);
+  found = ims.find(*interest);
+  BOOST_REQUIRE(static_cast<bool>(found));
+  BOOST_CHECK_EQUAL(found->getName(), "/a/19/data"); // canonical order
+
+  ims.erase("/a/3");
+  BOOST_CHECK_EQUAL(ims.size(), 20);
+  ims.erase("/a");
+  BOOST_CHECK_EQUAL(ims.size(), 0);
+  BOOST_CHECK_EQUAL(ims.sizeInBytes(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(PolicyPerShard)
+{
+  InMemoryStorageSharded ims(1, 1, &makeLru);
+
+  ims.insert(*makeData("/1"));
+  ims.insert(*makeData("/2"));
+  ims.find(*makeInterest("/1"));
+  ims.insert(*makeData("/3"));
+
+  BOOST_CHECK_EQUAL(ims.size(), 2);
+  BOOST_CHECK(static_cast<bool>(ims.find(Name("/1"))));
+  BOOST_CHECK(!static_cast<bool>(ims.find(Name("/2"))));
+}
+
+BOOST_AUTO_TEST_CASE(Concurrent)
+{
+  InMemoryStorageSharded ims(8, 2, &makePersistent);
+
+  std::vector<shared_ptr<Data>> packets;
+  for (int i = 0; i < 400; i++) {
+    std::ostringstream convert;
+    convert << i;
+    packets.push_back(makeData("/producer/" + convert.str()));
+  }
+
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < 4; t++) {
+    threads.push_back(std::thread([&ims, &packets, t] {
+      for (size_t i = t; i < packets.size(); i += 4) {
+        ims.insert(*packets[i]);
+        ims.find(packets[i]->getName());
+      }
+    }));
+  }
+  for (size_t t = 0; t < threads.size(); t++)
+    threads[t].join();
+
+  BOOST_CHECK_EQUAL(ims.size(), packets.size());
+  for (size_t i = 0; i < packets.size(); i++)
+    BOOST_CHECK(static_cast<bool>(ims.find(packets[i]->getFullName())));
+}
+
+BOOST_AUTO_TEST_SUITE_END() // Sharded
+BOOST_AUTO_TEST_SUITE_END() // UtilInMemoryStorage
+
+} // namespace util
+} // namespace ndn
@@ -0,0 +1,135 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2015 Regents of the University of Tokyo.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+
+#include "util/in-memory-storage-tiny-lfu.hpp"
+#include "util/in-memory-storage-lru.hpp"
+#include "security/key-chain.hpp"
+
+#include "boost-test.hpp"
+#include "../test-make-interest-data.hpp"
+
+namespace ndn {
+namespace util {
+
+BOOST_AUTO_TEST_SUITE(UtilInMemoryStorage)
+BOOST_AUTO_TEST_SUITE(TinyLfu)
+
+static Name
+makeName(const std::string& prefix, int i)
+{
+  std::ostringstream convert;
+  convert << i;
+  return Name(prefix + convert.str());
+}
+
+BOOST_AUTO_TEST_CASE(EstimateFrequency)
+{
+  InMemoryStorageTinyLfu ims(100);
+
+  ims.insert(*makeData("/1"));
+  BOOST_CHECK_EQUAL(ims.estimateFrequency("/1"), 1);
+  BOOST_CHECK_EQUAL(ims.estimateFrequency("/2"), 0);
+
+  shared_ptr<Interest> interest = makeInterest("/1");
+  for (int i = 0; i < 3; i++)
+    ims.find(*interest);
+  BOOST_CHECK_EQUAL(ims.estimateFrequency("/1"), 4);
+
+  for (int i = 0; i < 20; i++)
+    ims.find(*interest);
+  BOOST_CHECK_EQUAL(ims.estimateFrequency("/1"), 15);
+}
+
+BOOST_AUTO_TEST_CASE(EvictItem)
+{
+  InMemoryStorageTinyLfu ims(3);
+  BOOST_CHECK_EQUAL(ims.evictItem(), false);
+
+  ims.insert(*makeData("/1"));
+  ims.insert(*makeData("/2"));
+  ims.insert(*makeData("/3"));
+  ims.insert(*makeData("/4"));
+  BOOST_CHECK_EQUAL(ims.size(), 3);
+
+  // on a tie, the packet leaving the window is evicted rather than the older one
+  BOOST_CHECK(static_cast<bool>(ims.find(Name("/1"))));
+  BOOST_CHECK(!static_cast<bool>(ims.find(Name("/3"))));
+
+  BOOST_CHECK_EQUAL(ims.evictItem(), true);
+  BOOST_CHECK_EQUAL(ims.evictItem(), true);
+  BOOST_CHECK_EQUAL(ims.evictItem(), true);
+  BOOST_CHECK_EQUAL(ims.size(), 0);
+  BOOST_CHECK_EQUAL(ims.evictItem(), false);
+}
+
+BOOST_AUTO_TEST_CASE(LimitInBytes)
+{
+  size_t entrySize = InMemoryStorage::getEntrySize(*makeData("/1"));
+  InMemoryStorageTinyLfu ims(100, 3 * entrySize);
+
+  for (int i = 0; i < 10; i++) {
+    ims.insert(*makeData(makeName("/", i)));
+    BOOST_CHECK_LE(ims.sizeInBytes(), ims.getLimitInBytes());
+  }
+  BOOST_CHECK_EQUAL(ims.size(), 3);
+}
+
+template<class Storage>
+static int
+countHotAfterScan(Storage& ims)
+{
+  for (int i = 0; i < 50; i++)
+    ims.insert(*makeData(makeName("/hot/", i)));
+  for (int round = 0; round < 3; round++) {
+    for (int i = 0; i < 50; i++)
+      ims.find(*makeInterest(makeName("/hot/", i)));
+  }
+
+  for (int i = 0; i < 500; i++) {
+    Name name = makeName("/scan/", i);
+    if (!static_cast<bool>(ims.find(*makeInterest(name))))
+      ims.insert(*makeData(name));
+  }
+
+  int nHot = 0;
+  for (int i = 0; i < 50; i++) {
+    if (static_cast<bool>(ims.find(makeName("/hot/", i))))
+      ++nHot;
+  }
+  return nHot;
+}
+
+BOOST_AUTO_TEST_CASE(ScanResistance)
+{
+  InMemoryStorageTinyLfu tinyLfu(100);
+  BOOST_CHECK_EQUAL(countHotAfterScan(tinyLfu), 50);
+  BOOST_CHECK_EQUAL(tinyLfu.size(), 100);
+
+  InMemoryStorageLru lru(100);
+  BOOST_CHECK_EQUAL(countHotAfterScan(lru), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END() // TinyLfu
+BOOST_AUTO_TEST_SUITE_END() // UtilInMemoryStorage
+
+} // namespace util
+} // namespace ndn
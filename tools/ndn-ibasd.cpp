@@ -0,0 +1,119 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2015 Regents of the University of Tokyo.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "security/ibas-daemon.hpp"
+#include "security/ibas-backend-daemon.hpp"
+#include "util/config-file.hpp"
+
+#include <boost/program_options.hpp>
+
+#include <iostream>
+
+namespace ndn {
+
+static unique_ptr<IbasBackend>
+createBackend(const std::string& backendType, const std::string& paramsPath)
+{
+  return IbasBackend::create(backendType, paramsPath);
+}
+
+int
+main(int argc, char** argv)
+{
+  namespace po = boost::program_options;
+
+  ConfigFile config;
+  std::string backendType = config.getParsedConfiguration().get<std::string>("ibas", "pbc");
+  if (backendType == "daemon")
+    backendType = "pbc";
+  std::string socketPath = IbasBackendDaemon::getDefaultSocketPath(config);
+  const char* home = getenv("HOME");
+  std::string paramsPath = std::string(home != nullptr ? home : "") + "/.ndn/ibas/params.conf";
+
+  po::options_description description("Usage: ndn-ibasd [options]\n"
+                                      "Serves IBAS signing and verification to local "
+                                      "applications configured with ibas=daemon\n"
+                                      "Options");
+  description.add_options()
+    ("help,h", "produce help message")
+    ("backend,b", po::value<std::string>(&backendType)->default_value(backendType),
+                  "IBAS backend: pbc or type-a")
+    ("socket,s",  po::value<std::string>(&socketPath)->default_value(socketPath),
+                  "path of the Unix socket")
+    ("params,p",  po::value<std::string>(&paramsPath)->default_value(paramsPath),
+                  "path of the public params file")
+    ;
+
+  po::variables_map vm;
+  try
+    {
+      po::store(po::parse_command_line(argc, argv, description), vm);
+      po::notify(vm);
+    }
+  catch (const std::exception& e)
+    {
+      std::cerr << "ERROR: " << e.what() << std::endl;
+      std::cerr << description << std::endl;
+      return 1;
+    }
+
+  if (vm.count("help") != 0)
+    {
+      std::cerr << description << std::endl;
+      return 0;
+    }
+
+  if (backendType == "daemon")
+    {
+      std::cerr << "ERROR: ndn-ibasd cannot forward to itself" << std::endl;
+      return 1;
+    }
+
+  try
+    {
+      // Fail early if the params cannot be loaded by the backend
+      createBackend(backendType, paramsPath);
+
+      boost::asio::io_service ioService;
+      IbasDaemon daemon(ioService, socketPath, bind(&createBackend, backendType, paramsPath));
+      daemon.start();
+
+      boost::asio::signal_set terminationSignals(ioService, SIGINT, SIGTERM);
+      terminationSignals.async_wait(bind(&boost::asio::io_service::stop, &ioService));
+
+      std::cerr << "Listening on " << socketPath << " (" << backendType << ")" << std::endl;
+      ioService.run();
+    }
+  catch (const std::exception& e)
+    {
+      std::cerr << "ERROR: " << e.what() << std::endl;
+      return 1;
+    }
+  return 0;
+}
+
+} // namespace ndn
+
+int
+main(int argc, char** argv)
+{
+  return ndn::main(argc, argv);
+}
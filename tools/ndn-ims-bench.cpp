@@ -0,0 +1,281 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2015 Regents of the University of Tokyo.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+
+#include "util/in-memory-storage-fifo.hpp"
+#include "util/in-memory-storage-lfu.hpp"
+#include "util/in-memory-storage-lru.hpp"
+#include "util/in-memory-storage-persistent.hpp"
+#include "util/in-memory-storage-tiny-lfu.hpp"
+#include "security/digest-sha256.hpp"
+#include "encoding/block-helpers.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <unordered_map>
+
+#include <unistd.h>
+
+namespace ndn {
+
+using util::InMemoryStorage;
+
+struct Request
+{
+  shared_ptr<Interest> interest;
+  shared_ptr<Data> data;
+};
+
+static shared_ptr<Data>
+makeData(const Name& name, size_t payloadSize)
+{
+  static const uint8_t ZEROS[32] = {0};
+
+  shared_ptr<Data> data = make_shared<Data>(name);
+  std::vector<uint8_t> payload(payloadSize, 0xAA);
+  data->setContent(payload.data(), payload.size());
+
+  // the storage is measured, not signing: the digest is left empty
+  DigestSha256 signature;
+  signature.setValue(dataBlock(tlv::SignatureValue, ZEROS, sizeof(ZEROS)));
+  data->setSignature(signature);
+  data->wireEncode();
+  return data;
+}
+
+/**
+ * @brief Makes a trace of requests to nNames names with Zipf popularity of parameter skew,
+ *        interrupted every 4 * scanLength requests by scanLength requests to new names
+ */
+static std::vector<Name>
+generateTrace(size_t nRequests, size_t nNames, double skew, size_t scanLength)
+{
+  std::vector<double> cdf(nNames);
+  double sum = 0;
+  for (size_t rank = 0; rank < nNames; ++rank) {
+    sum += 1.0 / std::pow(rank + 1, skew);
+    cdf[rank] = sum;
+  }
+
+  std::mt19937 generator(1);
+  std::uniform_real_distribution<double> uniform(0, sum);
+  std::vector<Name> trace;
+  size_t nScanned = 0;
+  while (trace.size() < nRequests) {
+    for (size_t i = 0; i < 4 * std::max<size_t>(scanLength, 1) && trace.size() < nRequests; ++i) {
+      size_t rank = std::lower_bound(cdf.begin(), cdf.end(), uniform(generator)) - cdf.begin();
+      trace.push_back(Name("/bench/popular").appendNumber(std::min(rank, nNames - 1)));
+    }
+    for (size_t i = 0; i < scanLength && trace.size() < nRequests; ++i)
+      trace.push_back(Name("/bench/scan").appendNumber(nScanned++));
+  }
+  return trace;
+}
+
+static std::vector<Name>
+readTrace(std::istream& is)
+{
+  std::vector<Name> trace;
+  std::string line;
+  while (std::getline(is, line)) {
+    if (line.empty() || line[0] == '#')
+      continue;
+    trace.push_back(Name(line));
+  }
+  return trace;
+}
+
+static void
+run(const std::string& policy, InMemoryStorage& ims, const std::vector<Request>& requests)
+{
+  size_t nHits = 0;
+  time::steady_clock::TimePoint start = time::steady_clock::now();
+  for (std::vector<Request>::const_iterator it = requests.begin(); it != requests.end(); ++it) {
+    if (ims.find(*it->interest) != nullptr)
+      ++nHits;
+    else
+      ims.insert(*it->data);
+  }
+  time::nanoseconds duration = time::steady_clock::now() - start;
+
+  double seconds = std::max<double>(duration.count(), 1) / 1e9;
+  std::cout << std::left << std::setw(12) << policy << std::right
+            << std::setw(10) << std::fixed << std::setprecision(2)
+            << 100.0 * nHits / requests.size() << "%"
+            << std::setw(14) << std::setprecision(0) << requests.size() / seconds
+            << std::setw(10) << ims.size()
+            << std::setw(14) << ims.sizeInBytes() << std::endl;
+}
+
+static int
+usage(const std::string& filename)
+{
+  std::cerr << "Usage: \n    "
+            << filename << " [-c capacity] [-b limitInBytes] [-s payloadSize]"
+            << " [-n nRequests] [-k nNames] [-z skew] [-S scanLength] [trace-file]\n"
+            << "\n"
+            << "Replays a trace of requests against each InMemoryStorage policy: a request\n"
+            << "is looked up, and the Data is inserted on a miss.  The trace file lists one\n"
+            << "name per line ('-' for the standard input).  Without it, a trace of nRequests\n"
+            << "(default: 1000000) to nNames names (default: 10 * capacity) with Zipf\n"
+            << "popularity (default skew: 0.9) is generated, with a scan of scanLength new\n"
+            << "names (default: capacity) every 4 * scanLength requests.\n"
+            << "\n"
+            << "The capacity (default: 10000) is in packets.  Payloads are payloadSize bytes\n"
+            << "(default: 1024).  The persistent storage is not limited, and gives the hit\n"
+            << "ratio of an infinite cache.\n";
+  return 1;
+}
+
+int
+main(int argc, char** argv)
+{
+  size_t capacity = 10000;
+  size_t limitInBytes = std::numeric_limits<size_t>::max();
+  size_t payloadSize = 1024;
+  size_t nRequests = 1000000;
+  size_t nNames = 0;
+  double skew = 0.9;
+  long scanLength = -1;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "b:c:k:n:s:S:z:")) != -1)
+    {
+      switch (opt)
+        {
+        case 'b':
+          limitInBytes = std::max(atol(optarg), 1L);
+          break;
+        case 'c':
+          capacity = std::max(atol(optarg), 1L);
+          break;
+        case 'k':
+          nNames = std::max(atol(optarg), 1L);
+          break;
+        case 'n':
+          nRequests = std::max(atol(optarg), 1L);
+          break;
+        case 's':
+          payloadSize = std::max(atol(optarg), 0L);
+          break;
+        case 'S':
+          scanLength = std::max(atol(optarg), 0L);
+          break;
+        case 'z':
+          skew = atof(optarg);
+          break;
+        default:
+          return usage(argv[0]);
+        }
+    }
+
+  std::vector<Name> trace;
+  if (optind < argc)
+    {
+      std::string path = argv[optind];
+      if (path == "-")
+        trace = readTrace(std::cin);
+      else
+        {
+          std::ifstream file(path.c_str());
+          if (!file)
+            {
+              std::cerr << "ERROR: cannot open " << path << std::endl;
+              return 1;
+            }
+          trace = readTrace(file);
+        }
+    }
+  else
+    {
+      trace = generateTrace(nRequests, nNames > 0 ? nNames : 10 * capacity, skew,
+                            scanLength >= 0 ? scanLength : capacity);
+    }
+
+  if (trace.empty())
+    {
+      std::cerr << "ERROR: the trace is empty" << std::endl;
+      return 1;
+    }
+
+  // packets and Interests are made beforehand, so that only the storage is measured
+  std::unordered_map<Name, shared_ptr<Data>> packets;
+  std::vector<Request> requests(trace.size());
+  for (size_t i = 0; i < trace.size(); ++i)
+    {
+      shared_ptr<Data>& data = packets[trace[i]];
+      if (data == nullptr)
+        data = makeData(trace[i], payloadSize);
+      requests[i].interest = make_shared<Interest>(trace[i]);
+      requests[i].data = data;
+    }
+
+  std::cout << requests.size() << " requests to " << packets.size() << " names, capacity "
+            << capacity << " packets";
+  if (limitInBytes != std::numeric_limits<size_t>::max())
+    std::cout << " and " << limitInBytes << " bytes";
+  std::cout << "\n\n"
+            << std::left << std::setw(12) << "policy" << std::right
+            << std::setw(11) << "hit ratio" << std::setw(14) << "requests/s"
+            << std::setw(10) << "packets" << std::setw(14) << "bytes" << std::endl;
+
+  try
+    {
+      {
+        util::InMemoryStorageFifo ims(capacity, limitInBytes);
+        run("fifo", ims, requests);
+      }
+      {
+        util::InMemoryStorageLru ims(capacity, limitInBytes);
+        run("lru", ims, requests);
+      }
+      {
+        util::InMemoryStorageLfu ims(capacity, limitInBytes);
+        run("lfu", ims, requests);
+      }
+      {
+        util::InMemoryStorageTinyLfu ims(capacity, limitInBytes);
+        run("tiny-lfu", ims, requests);
+      }
+      {
+        util::InMemoryStoragePersistent ims;
+        run("persistent", ims, requests);
+      }
+    }
+  catch (std::exception& e)
+    {
+      std::cerr << "ERROR: " << e.what() << std::endl;
+      return 1;
+    }
+  return 0;
+}
+
+} // namespace ndn
+
+int
+main(int argc, char** argv)
+{
+  return ndn::main(argc, argv);
+}
@@ -24,16 +24,51 @@
 #include "face.hpp"
 #include "security/key-chain.hpp"
 
+#include <boost/asio/io_service.hpp>
+
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 namespace ndn {
 
 const size_t MAX_SEG_SIZE = 4096;
 
+/**
+ * @return the prefix of the manifests of the content named @p name, a sibling of it
+ *
+ * Under @p name, a manifest could be the rightmost child, and answer the Interest with
+ * ChildSelector=1 by which SegmentFetcher discovers the content.
+ *
+ * @pre @p name is not empty
+ */
+static Name
+getManifestPrefix(const Name& name)
+{
+  return name.getPrefix(-1).append("_manifest").append(name.get(-1));
+}
+
 class Producer
 {
 public:
-  Producer(const char* name)
+  /**
+   * @param nSegmentsPerManifest if not zero, segments are signed with manifests listing this
+   *                             number of segments, served under getManifestPrefix(name)
+   */
+  Producer(const char* name, size_t nSegmentsPerManifest, bool isVerbose)
     : m_name(name)
-    , m_isVerbose(false)
+    , m_nSegmentsPerManifest(nSegmentsPerManifest)
+    , m_isVerbose(isVerbose)
   {
     int segnum = 0;
     char* buf = new char[MAX_SEG_SIZE];
@@ -50,15 +85,28 @@ public:
             data->setFreshnessPeriod(time::milliseconds(10000)); // 10 sec
             data->setContent(reinterpret_cast<const uint8_t*>(buf), got);
 
-            m_keychain.sign(*data);
+            if (nSegmentsPerManifest == 0)
+              m_keychain.sign(*data);
             m_store.push_back(data);
             segnum++;
           }
       }
     while (static_cast<bool>(std::cin));
 
+    if (nSegmentsPerManifest > 0 && !m_store.empty())
+      {
+        // the manifests cover the segments once they are final
+        for (size_t i = 0; i < m_store.size(); ++i)
+          m_store[i]->setFinalBlockId(name::Component::fromSegment(m_store.size() - 1));
+
+        m_manifestPrefix = getManifestPrefix(m_name);
+        m_manifests = m_keychain.signWithManifests(m_store, nSegmentsPerManifest,
+                                                   m_manifestPrefix);
+      }
+
     if (m_isVerbose)
-      std::cerr << "Created " << segnum << " chunks for prefix [" << m_name << "]" << std::endl;
+      std::cerr << "Created " << segnum << " chunks and " << m_manifests.size()
+                << " manifests for prefix [" << m_name << "]" << std::endl;
   }
 
   void
@@ -75,6 +123,19 @@ public:
       }
   }
 
+  void
+  onManifestInterest(const Interest& interest)
+  {
+    if (m_isVerbose)
+      std::cerr << "<< I: " << interest << std::endl;
+
+    // manifests are named by the first segment they list
+    size_t segnum = static_cast<size_t>(interest.getName().rbegin()->toSegment());
+    if (segnum % m_nSegmentsPerManifest == 0 &&
+        segnum / m_nSegmentsPerManifest < m_manifests.size())
+      m_face.put(*m_manifests[segnum / m_nSegmentsPerManifest]);
+  }
+
   void
   onRegisterFailed(const Name& prefix, const std::string& reason)
   {
@@ -97,6 +158,11 @@ public:
                              bind(&Producer::onInterest, this, _2),
                              RegisterPrefixSuccessCallback(),
                              bind(&Producer::onRegisterFailed, this, _1, _2));
+    if (!m_manifests.empty())
+      m_face.setInterestFilter(m_manifestPrefix,
+                               bind(&Producer::onManifestInterest, this, _2),
+                               RegisterPrefixSuccessCallback(),
+                               bind(&Producer::onRegisterFailed, this, _1, _2));
     m_face.processEvents();
   }
 
@@ -106,40 +172,396 @@ private:
   KeyChain m_keychain;
 
   std::vector< shared_ptr<Data> > m_store;
+  size_t m_nSegmentsPerManifest;
+  Name m_manifestPrefix;
+  std::vector< shared_ptr<Data> > m_manifests;
 
   bool m_isVerbose;
 };
 
+/**
+ * @brief Read-only memory mapping of a whole file
+ */
+class MappedFile : noncopyable
+{
+public:
+  explicit
+  MappedFile(const char* path)
+    : m_data(nullptr)
+    , m_size(0)
+  {
+    int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+      throw std::runtime_error(std::string("cannot open ") + path + " (" +
+                               std::strerror(errno) + ")");
+
+    struct stat status;
+    if (::fstat(fd, &status) == 0 && status.st_size > 0)
+      {
+        m_size = status.st_size;
+        void* data = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED)
+          m_data = static_cast<const uint8_t*>(data);
+      }
+    ::close(fd);
+
+    if (m_size > 0 && m_data == nullptr)
+      throw std::runtime_error(std::string("cannot map ") + path + " (" +
+                               std::strerror(errno) + ")");
+  }
+
+  ~MappedFile()
+  {
+    if (m_data != nullptr)
+      ::munmap(const_cast<uint8_t*>(m_data), m_size);
+  }
+
+  const uint8_t*
+  data() const
+  {
+    return m_data;
+  }
+
+  size_t
+  size() const
+  {
+    return m_size;
+  }
+
+private:
+  const uint8_t* m_data;
+  size_t m_size;
+};
+
+/**
+ * @brief Producer of the segments of a mapped file, signed by a pool of workers
+ *
+ * Only the segments ahead of the last requested one, up to a window, are signed before they
+ * are requested; the others are signed on demand, before the segments ahead.  Signed
+ * segments behind the last requested one are dropped, so memory use is bounded by the
+ * window, whatever the size of the file.
+ *
+ * Each worker signs with its own KeyChain, as KeyChain is not thread-safe.  KeyChains are
+ * created, and the signing certificate resolved, before the workers start.  Signed segments,
+ * and signing errors, are handed back to the thread running the Face through its io_service.
+ */
+class MappedProducer : noncopyable
+{
+public:
+  MappedProducer(const char* name, const char* path, size_t nWorkers, size_t windowSize,
+                 bool isVerbose)
+    : m_name(name)
+    , m_file(path)
+    , m_nSegments((m_file.size() + MAX_SEG_SIZE - 1) / MAX_SEG_SIZE)
+    , m_windowSize(std::max<size_t>(windowSize, 1))
+    , m_nextToSign(0)
+    , m_lastRequested(0)
+    , m_isStopped(false)
+    , m_isVerbose(isVerbose)
+  {
+    if (m_isVerbose)
+      std::cerr << "Serving " << m_nSegments << " chunks for prefix [" << m_name << "]"
+                << std::endl;
+
+    nWorkers = std::max<size_t>(nWorkers, 1);
+    for (size_t i = 0; i < nWorkers; ++i)
+      m_keyChains.push_back(unique_ptr<KeyChain>(new KeyChain));
+    // creates the default identity if needed, which workers must not race to do
+    m_certName = m_keyChains.front()->getDefaultCertificate()->getName();
+
+    for (size_t i = 0; i < nWorkers; ++i)
+      m_workers.push_back(std::thread(&MappedProducer::sign, this, std::ref(*m_keyChains[i])));
+
+    fillWindow();
+  }
+
+  ~MappedProducer()
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_isStopped = true;
+    }
+    m_hasTasks.notify_all();
+
+    for (size_t i = 0; i < m_workers.size(); ++i)
+      m_workers[i].join();
+  }
+
+  void
+  onInterest(const Interest& interest)
+  {
+    if (m_isVerbose)
+      std::cerr << "<< I: " << interest << std::endl;
+
+    uint64_t segnum = interest.getName().rbegin()->toSegment();
+    if (segnum >= m_nSegments)
+      return;
+
+    if (segnum > m_lastRequested)
+      {
+        m_lastRequested = segnum;
+        m_signed.erase(m_signed.begin(), m_signed.lower_bound(segnum));
+      }
+
+    std::map<uint64_t, shared_ptr<Data> >::iterator data = m_signed.find(segnum);
+    if (data != m_signed.end())
+      m_face.put(*data->second);
+    else if (m_requested.insert(segnum).second && m_signing.insert(segnum).second)
+      schedule(segnum, true);
+
+    fillWindow();
+  }
+
+  void
+  onRegisterFailed(const Name& prefix, const std::string& reason)
+  {
+    std::cerr << "ERROR: Failed to register prefix '"
+              << prefix << "' in local hub's daemon (" << reason << ")"
+              << std::endl;
+    m_face.shutdown();
+  }
+
+  void
+  run()
+  {
+    if (m_nSegments == 0)
+      {
+        std::cerr << "Nothing to serve. Exiting." << std::endl;
+        return;
+      }
+
+    m_face.setInterestFilter(m_name,
+                             bind(&MappedProducer::onInterest, this, _2),
+                             RegisterPrefixSuccessCallback(),
+                             bind(&MappedProducer::onRegisterFailed, this, _1, _2));
+    m_face.processEvents();
+  }
+
+private:
+  /**
+   * @brief Schedules the signing of the segments ahead of the last requested one, up to the
+   *        window
+   */
+  void
+  fillWindow()
+  {
+    m_nextToSign = std::max(m_nextToSign, m_lastRequested);
+    while (m_nextToSign < m_nSegments && m_nextToSign < m_lastRequested + m_windowSize)
+      {
+        uint64_t segnum = m_nextToSign++;
+        if (m_signed.count(segnum) == 0 && m_signing.insert(segnum).second)
+          schedule(segnum, false);
+      }
+  }
+
+  void
+  schedule(uint64_t segnum, bool isUrgent)
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (isUrgent)
+        m_tasks.push_front(segnum);
+      else
+        m_tasks.push_back(segnum);
+    }
+    m_hasTasks.notify_one();
+  }
+
+  /**
+   * @brief Runs a worker, until the producer is destroyed
+   */
+  void
+  sign(KeyChain& keyChain)
+  {
+    while (true)
+      {
+        uint64_t segnum = 0;
+        {
+          std::unique_lock<std::mutex> lock(m_mutex);
+          m_hasTasks.wait(lock, [this] { return m_isStopped || !m_tasks.empty(); });
+          if (m_isStopped)
+            return;
+
+          segnum = m_tasks.front();
+          m_tasks.pop_front();
+        }
+
+        size_t offset = segnum * MAX_SEG_SIZE;
+        shared_ptr<Data> data = make_shared<Data>(Name(m_name).appendSegment(segnum));
+        data->setFreshnessPeriod(time::milliseconds(10000)); // 10 sec
+        data->setContent(m_file.data() + offset, std::min(MAX_SEG_SIZE, m_file.size() - offset));
+        data->setFinalBlockId(name::Component::fromSegment(m_nSegments - 1));
+        try
+          {
+            keyChain.sign(*data, m_certName);
+          }
+        catch (const std::exception& e)
+          {
+            m_face.getIoService().post(bind(&MappedProducer::onSignFailed, this, segnum,
+                                            std::string(e.what())));
+            continue;
+          }
+
+        m_face.getIoService().post(bind(&MappedProducer::onSigned, this, segnum, data));
+      }
+  }
+
+  void
+  onSignFailed(uint64_t segnum, const std::string& reason)
+  {
+    std::cerr << "ERROR: Failed to sign segment " << segnum << " (" << reason << ")"
+              << std::endl;
+
+    // signed again when requested again
+    m_signing.erase(segnum);
+    m_requested.erase(segnum);
+  }
+
+  void
+  onSigned(uint64_t segnum, const shared_ptr<Data>& data)
+  {
+    m_signing.erase(segnum);
+
+    bool isRequested = m_requested.erase(segnum) > 0;
+    if (isRequested)
+      m_face.put(*data);
+
+    // segments behind the last requested one were already served, or are not needed anymore
+    if (segnum >= m_lastRequested || isRequested)
+      m_signed[segnum] = data;
+  }
+
+private:
+  Name m_name;
+  Face m_face;
+  MappedFile m_file;
+  uint64_t m_nSegments;
+  size_t m_windowSize;
+
+  // owned by the thread running the Face
+  std::map<uint64_t, shared_ptr<Data> > m_signed;
+  std::set<uint64_t> m_signing;   ///< segments queued or being signed
+  std::set<uint64_t> m_requested; ///< segments requested before they were signed
+  uint64_t m_nextToSign;
+  uint64_t m_lastRequested;
+
+  // shared with the workers
+  std::mutex m_mutex;
+  std::condition_variable m_hasTasks;
+  std::deque<uint64_t> m_tasks;
+  bool m_isStopped;
+
+  std::vector<unique_ptr<KeyChain> > m_keyChains; ///< one per worker
+  Name m_certName;
+  std::vector<std::thread> m_workers;
+  bool m_isVerbose;
+};
+
+int
+usage(const std::string& filename)
+{
+  std::cerr << "Usage: \n    "
+            << filename << " [-f file [-j nWorkers] [-w windowSize] | -m nSegments] [-v]"
+            << " /ndn/name\n"
+            << "\n"
+            << "Without -f, the content is read from the standard input, and all segments are\n"
+            << "signed before serving.  With -f, the file is mapped in memory, and segments are\n"
+            << "signed by nWorkers threads (default: number of cores) up to windowSize segments\n"
+            << "(default: 64) ahead of the last requested one, or on demand.\n"
+            << "\n"
+            << "With -m, segments read from the standard input only carry a digest, and are\n"
+            << "authenticated by signed manifests listing nSegments segments each, served\n"
+            << "under /ndn/_manifest/name.\n";
+  return 1;
+}
+
+template<class ProducerType>
+void
+serve(ProducerType& producer)
+{
+  while (true)
+    {
+      try
+        {
+          // this will exit when daemon dies... so try to connect again if possible
+          producer.run();
+        }
+      catch (std::exception& e)
+        {
+          std::cerr << "ERROR: " << e.what() << std::endl;
+          // and keep going
+          sleep(1);
+        }
+    }
+}
+
 int
 main(int argc, char** argv)
 {
-  if (argc < 2)
+  const char* path = nullptr;
+  int nWorkers = std::max<int>(std::thread::hardware_concurrency(), 1);
+  int windowSize = 64;
+  int nSegmentsPerManifest = 0;
+  bool isVerbose = false;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "f:j:m:w:v")) != -1)
     {
-      std::cerr << "Usage: ./ndnputchunks [data_prefix]\n";
-      return -1;
+      switch (opt)
+        {
+        case 'f':
+          path = optarg;
+          break;
+        case 'j':
+          nWorkers = std::max(atoi(optarg), 1);
+          break;
+        case 'm':
+          nSegmentsPerManifest = std::max(atoi(optarg), 1);
+          break;
+        case 'w':
+          windowSize = std::max(atoi(optarg), 1);
+          break;
+        case 'v':
+          isVerbose = true;
+          break;
+        default:
+          return usage(argv[0]);
+        }
     }
 
-  try
+  if (optind >= argc)
     {
-      time::steady_clock::TimePoint startTime = time::steady_clock::now();
+      return usage(argv[0]);
+    }
+  const char* name = argv[optind];
 
-      std::cerr << "Preparing the input..." << std::endl;
-      Producer producer(argv[1]);
-      std::cerr << "Ready... (took " << (time::steady_clock::now() - startTime) << std::endl;
+  if (nSegmentsPerManifest > 0 && path != nullptr)
+    {
+      std::cerr << "ERROR: -m cannot be used with -f" << std::endl;
+      return usage(argv[0]);
+    }
+  if (nSegmentsPerManifest > 0 && Name(name).empty())
+    {
+      std::cerr << "ERROR: -m needs a name of at least one component" << std::endl;
+      return usage(argv[0]);
+    }
 
-      while (true)
+  try
+    {
+      if (path != nullptr)
+        {
+          MappedProducer producer(name, path, nWorkers, windowSize, isVerbose);
+          serve(producer);
+        }
+      else
         {
-          try
-            {
-              // this will exit when daemon dies... so try to connect again if possible
-              producer.run();
-            }
-          catch (std::exception& e)
-            {
-              std::cerr << "ERROR: " << e.what() << std::endl;
-              // and keep going
-              sleep(1);
-            }
+          time::steady_clock::TimePoint startTime = time::steady_clock::now();
+
+          std::cerr << "Preparing the input..." << std::endl;
+          Producer producer(name, nSegmentsPerManifest, isVerbose);
+          std::cerr << "Ready... (took " << (time::steady_clock::now() - startTime) << std::endl;
+
+          serve(producer);
         }
     }
   catch (std::exception& e)